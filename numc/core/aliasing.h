@@ -0,0 +1,196 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_ALIASING_H__
+#define __NC_ALIASING_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal How the source of an assignment reads the buffer of its destination, see source_aliasing */
+enum AliasingType {
+    /** \internal the source does not read the memory written by the assignment */
+    NoAliasing = 0,
+    /** \internal the source reads the destination coefficients, each one at the position it is written to */
+    InPlaceAliasing = 1,
+    /** \internal the source reads coefficients the assignment may have already overwritten */
+    UnsafeAliasing = 2
+};
+
+/** \internal
+  * \brief The memory written by an assignment, as seen by the alias analysis
+  *
+  * \c begin and \c end delimit the bytes of the buffer of the destination before the assignment, \c shape and
+  * \c strides give the layout it is written with, i.e. the shape of the source. \c reallocated tells that the
+  * destination gets a new buffer, in which case the old one must not be read at all.
+  */
+struct assignment_destination
+{
+    const void* data;
+    const char* begin;
+    const char* end;
+    Index scalarSize;
+    const Shape& shape;
+    Strides strides;
+    bool reallocated;
+};
+
+/** \internal Sets [\a begin, \a end) to the bytes spanned by the coefficients of \a shape laid out with \a strides
+  * from \a data, whatever the signs of the strides. */
+inline void buffer_span(const void* data, Index scalarSize, const Shape& shape, const Strides& strides,
+                        const char*& begin, const char*& end)
+{
+    Index lo = 0, hi = 0;
+    for(Index i=0; i<shape.dims(); ++i)
+    {
+        const Index extent = (shape[i] - 1) * strides[i];
+        if(extent < 0) lo += extent;
+        else hi += extent;
+    }
+    begin = static_cast<const char*>(data) + lo * scalarSize;
+    end = static_cast<const char*>(data) + (hi + 1) * scalarSize;
+}
+
+/** \internal \returns the AliasingType of the coefficients of \a shape laid out with \a strides from \a data,
+  * read by the source of the assignment to \a dst.
+  *
+  * Reading the memory of the destination is only safe when the operand walks it exactly as the destination
+  * is written: same first coefficient, same shape (hence no broadcasting) and same strides. */
+template<typename Scalar>
+inline int leaf_aliasing(const assignment_destination& dst, const Scalar* data, const Shape& shape, const Strides& strides)
+{
+    if(shape.size() == 0 || dst.begin == dst.end)
+        return NoAliasing;
+
+    const char* begin;
+    const char* end;
+    buffer_span(data, Index(sizeof(Scalar)), shape, strides, begin, end);
+    if(end <= dst.begin || begin >= dst.end)
+        return NoAliasing;
+
+    if(dst.reallocated || static_cast<const void*>(data) != dst.data || Index(sizeof(Scalar)) != dst.scalarSize
+       || shape != dst.shape)
+        return UnsafeAliasing;
+    for(Index i=0; i<shape.dims(); ++i)
+    {
+        if(shape[i] != 1 && strides[i] != dst.strides[i])
+            return UnsafeAliasing;
+    }
+    return InPlaceAliasing;
+}
+
+
+/** \internal
+  * \brief Alias analysis of the source of an assignment
+  *
+  * source_aliasing<Xpr>::run(xpr, dst) walks the expression tree down to the leaves holding a buffer, and
+  * returns the worst AliasingType of their coefficients against the destination \a dst. It only compares
+  * pointers, shapes and strides, its cost does not depend on the number of coefficients:
+  * \code
+  * a = a * 2.f + b;          // InPlaceAliasing, evaluated in a single pass
+  * a = a.transpose() + b;    // UnsafeAliasing, evaluated into a temporary first
+  * a = b.exp();              // NoAliasing, large destinations are written with non-temporal stores
+  * \endcode
+  *
+  * \sa call_assignment(), NoAlias
+  */
+template<typename Xpr> struct source_aliasing;
+
+template<typename Xpr> struct source_aliasing<const Xpr> : source_aliasing<Xpr> {};
+
+template<typename Scalar>
+struct source_aliasing< Array<Scalar> >
+{
+    static inline int run(const Array<Scalar>& xpr, const assignment_destination& dst)
+    {
+        return leaf_aliasing(dst, xpr.data(), xpr.shape(), xpr.strides());
+    }
+};
+
+template<typename Scalar, Index... Dims>
+struct source_aliasing< FixedArray<Scalar, Dims...> >
+{
+    static inline int run(const FixedArray<Scalar, Dims...>& xpr, const assignment_destination& dst)
+    {
+        return leaf_aliasing(dst, xpr.data(), xpr.shape(), xpr.strides());
+    }
+};
+
+template<typename Scalar>
+struct source_aliasing< ArrayView<Scalar> >
+{
+    static inline int run(const ArrayView<Scalar>& xpr, const assignment_destination& dst)
+    {
+        return leaf_aliasing(dst, xpr.data(), xpr.shape(), xpr.strides());
+    }
+};
+
+template<typename PlainObjectType, int MapOptions>
+struct source_aliasing< Map<PlainObjectType, MapOptions> >
+{
+    static inline int run(const Map<PlainObjectType, MapOptions>& xpr, const assignment_destination& dst)
+    {
+        return leaf_aliasing(dst, xpr.data(), xpr.shape(), xpr.strides());
+    }
+};
+
+template<typename NullaryOp, typename PlainObjectType>
+struct source_aliasing< CwiseNullaryOp<NullaryOp, PlainObjectType> >
+{
+    static inline int run(const CwiseNullaryOp<NullaryOp, PlainObjectType>&, const assignment_destination&)
+    {
+        return NoAliasing;
+    }
+};
+
+template<typename UnaryOp, typename XprType>
+struct source_aliasing< CwiseUnaryOp<UnaryOp, XprType> >
+{
+    typedef typename remove_all<XprType>::type Arg;
+
+    static inline int run(const CwiseUnaryOp<UnaryOp, XprType>& xpr, const assignment_destination& dst)
+    {
+        return source_aliasing<Arg>::run(xpr.nestedExpression(), dst);
+    }
+};
+
+template<typename BinaryOp, typename LhsType, typename RhsType>
+struct source_aliasing< CwiseBinaryOp<BinaryOp, LhsType, RhsType> >
+{
+    typedef typename remove_all<LhsType>::type Lhs;
+    typedef typename remove_all<RhsType>::type Rhs;
+
+    static inline int run(const CwiseBinaryOp<BinaryOp, LhsType, RhsType>& xpr, const assignment_destination& dst)
+    {
+        const int lhs = source_aliasing<Lhs>::run(xpr.lhs(), dst);
+        if(lhs == UnsafeAliasing) return lhs;
+        return numext::maxi(lhs, source_aliasing<Rhs>::run(xpr.rhs(), dst));
+    }
+};
+
+template<typename TernaryOp, typename Arg1Type, typename Arg2Type, typename Arg3Type>
+struct source_aliasing< CwiseTernaryOp<TernaryOp, Arg1Type, Arg2Type, Arg3Type> >
+{
+    typedef typename remove_all<Arg1Type>::type Arg1;
+    typedef typename remove_all<Arg2Type>::type Arg2;
+    typedef typename remove_all<Arg3Type>::type Arg3;
+
+    static inline int run(const CwiseTernaryOp<TernaryOp, Arg1Type, Arg2Type, Arg3Type>& xpr, const assignment_destination& dst)
+    {
+        const int arg1 = source_aliasing<Arg1>::run(xpr.arg1(), dst);
+        if(arg1 == UnsafeAliasing) return arg1;
+        const int arg2 = numext::maxi(arg1, source_aliasing<Arg2>::run(xpr.arg2(), dst));
+        if(arg2 == UnsafeAliasing) return arg2;
+        return numext::maxi(arg2, source_aliasing<Arg3>::run(xpr.arg3(), dst));
+    }
+};
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,21 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_MATH_FUNCTIONS_AVX_H__
+#define __NC_MATH_FUNCTIONS_AVX_H__
+
+NS_INTERNAL_BEGIN
+
+NC_MAKE_PACKET_MATH_FUNCTIONS_FLOAT(Packet8f, Packet4d)
+NC_MAKE_PACKET_MATH_FUNCTIONS_DOUBLE(Packet4d)
+
+NS_INTERNAL_END
+
+#endif
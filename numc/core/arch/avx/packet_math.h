@@ -0,0 +1,275 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PACKET_MATH_AVX_H__
+#define __NC_PACKET_MATH_AVX_H__
+
+NS_INTERNAL_BEGIN
+
+typedef __m256  Packet8f;
+typedef __m256i Packet8i;
+typedef __m256d Packet4d;
+
+// AVX512 provides 512 bits packets for the same scalar types, the AVX ones are then only
+// used as half packets.
+#ifndef NC_VECTORIZE_AVX512
+template<> struct packet_traits<float>  : default_packet_traits
+{
+    typedef Packet8f type;
+    typedef Packet4f half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 8,
+        HasHalfPacket = 1,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 1,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+template<> struct packet_traits<double> : default_packet_traits
+{
+    typedef Packet4d type;
+    typedef Packet2d half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 4,
+        HasHalfPacket = 1,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 0,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+
+// 256 bits integer arithmetic only comes with AVX2
+#ifdef NC_VECTORIZE_AVX2
+template<> struct packet_traits<int>    : default_packet_traits
+{
+    typedef Packet8i type;
+    typedef Packet4i half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 8,
+        HasHalfPacket = 1
+    };
+};
+#endif
+#endif
+
+template<> struct unpacket_traits<Packet8f> { typedef float  type; typedef Packet4f half; enum {size=8, alignment=Aligned32}; };
+template<> struct unpacket_traits<Packet4d> { typedef double type; typedef Packet2d half; enum {size=4, alignment=Aligned32}; };
+template<> struct unpacket_traits<Packet8i> { typedef int    type; typedef Packet4i half; enum {size=8, alignment=Aligned32}; };
+
+template<> NC_STRONG_INLINE Packet8f pset1<Packet8f>(const float&  from) { return _mm256_set1_ps(from); }
+template<> NC_STRONG_INLINE Packet4d pset1<Packet4d>(const double& from) { return _mm256_set1_pd(from); }
+template<> NC_STRONG_INLINE Packet8i pset1<Packet8i>(const int&    from) { return _mm256_set1_epi32(from); }
+
+template<> NC_STRONG_INLINE Packet8f padd<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_add_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d padd<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_add_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f psub<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_sub_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d psub<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_sub_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pnegate(const Packet8f& a)
+{
+    return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f));
+}
+template<> NC_STRONG_INLINE Packet4d pnegate(const Packet4d& a)
+{
+    return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));
+}
+
+template<> NC_STRONG_INLINE Packet8f pmul<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_mul_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pmul<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_mul_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pdiv<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_div_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pdiv<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_div_pd(a,b); }
+
+// NC_VECTORIZE_FMA is also set by AVX512F, which does not enable the 128/256 bits FMA encodings
+#ifdef __FMA__
+template<> NC_STRONG_INLINE Packet8f pmadd(const Packet8f& a, const Packet8f& b, const Packet8f& c) { return _mm256_fmadd_ps(a,b,c); }
+template<> NC_STRONG_INLINE Packet4d pmadd(const Packet4d& a, const Packet4d& b, const Packet4d& c) { return _mm256_fmadd_pd(a,b,c); }
+#endif
+
+template<> NC_STRONG_INLINE Packet8f pmin<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_min_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pmin<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_min_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pmax<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_max_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pmax<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_max_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pabs(const Packet8f& a)
+{
+    const Packet8f mask = _mm256_castsi256_ps(_mm256_setr_epi32(0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF));
+    return _mm256_and_ps(a,mask);
+}
+template<> NC_STRONG_INLINE Packet4d pabs(const Packet4d& a)
+{
+    const Packet4d mask = _mm256_castsi256_pd(_mm256_setr_epi32(0xFFFFFFFF,0x7FFFFFFF,0xFFFFFFFF,0x7FFFFFFF,0xFFFFFFFF,0x7FFFFFFF,0xFFFFFFFF,0x7FFFFFFF));
+    return _mm256_and_pd(a,mask);
+}
+
+#ifdef NC_VECTORIZE_AVX2
+template<> NC_STRONG_INLINE Packet8i padd<Packet8i>(const Packet8i& a, const Packet8i& b) { return _mm256_add_epi32(a,b); }
+template<> NC_STRONG_INLINE Packet8i psub<Packet8i>(const Packet8i& a, const Packet8i& b) { return _mm256_sub_epi32(a,b); }
+template<> NC_STRONG_INLINE Packet8i pnegate(const Packet8i& a) { return _mm256_sub_epi32(_mm256_setzero_si256(), a); }
+template<> NC_STRONG_INLINE Packet8i pmul<Packet8i>(const Packet8i& a, const Packet8i& b) { return _mm256_mullo_epi32(a,b); }
+template<> NC_STRONG_INLINE Packet8i pmin<Packet8i>(const Packet8i& a, const Packet8i& b) { return _mm256_min_epi32(a,b); }
+template<> NC_STRONG_INLINE Packet8i pmax<Packet8i>(const Packet8i& a, const Packet8i& b) { return _mm256_max_epi32(a,b); }
+template<> NC_STRONG_INLINE Packet8i pabs(const Packet8i& a) { return _mm256_abs_epi32(a); }
+#endif
+
+template<> NC_STRONG_INLINE Packet8f pand<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_and_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pand<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_and_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f por<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_or_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d por<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_or_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pxor<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_xor_ps(a,b); }
+template<> NC_STRONG_INLINE Packet4d pxor<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_xor_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet8f pandnot<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_andnot_ps(b,a); }
+template<> NC_STRONG_INLINE Packet4d pandnot<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_andnot_pd(b,a); }
+
+template<> NC_STRONG_INLINE Packet8f pcmp_le<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_cmp_ps(a,b,_CMP_LE_OQ); }
+template<> NC_STRONG_INLINE Packet4d pcmp_le<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_cmp_pd(a,b,_CMP_LE_OQ); }
+
+template<> NC_STRONG_INLINE Packet8f pcmp_lt<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_cmp_ps(a,b,_CMP_LT_OQ); }
+template<> NC_STRONG_INLINE Packet4d pcmp_lt<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_cmp_pd(a,b,_CMP_LT_OQ); }
+
+template<> NC_STRONG_INLINE Packet8f pcmp_eq<Packet8f>(const Packet8f& a, const Packet8f& b) { return _mm256_cmp_ps(a,b,_CMP_EQ_OQ); }
+template<> NC_STRONG_INLINE Packet4d pcmp_eq<Packet4d>(const Packet4d& a, const Packet4d& b) { return _mm256_cmp_pd(a,b,_CMP_EQ_OQ); }
+
+template<> NC_STRONG_INLINE bool predux_any<Packet8f>(const Packet8f& mask) { return _mm256_movemask_ps(mask) != 0; }
+template<> NC_STRONG_INLINE bool predux_any<Packet4d>(const Packet4d& mask) { return _mm256_movemask_pd(mask) != 0; }
+
+template<> NC_STRONG_INLINE Packet8f pselect<Packet8f>(const Packet8f& mask, const Packet8f& a, const Packet8f& b) { return _mm256_blendv_ps(b,a,mask); }
+template<> NC_STRONG_INLINE Packet4d pselect<Packet4d>(const Packet4d& mask, const Packet4d& a, const Packet4d& b) { return _mm256_blendv_pd(b,a,mask); }
+
+#ifdef NC_VECTORIZE_AVX2
+template<int N> NC_STRONG_INLINE Packet8f plogical_shift_left(const Packet8f& a)  { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(a), N)); }
+template<int N> NC_STRONG_INLINE Packet4d plogical_shift_left(const Packet4d& a)  { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), N)); }
+template<int N> NC_STRONG_INLINE Packet8f plogical_shift_right(const Packet8f& a) { return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(a), N)); }
+template<int N> NC_STRONG_INLINE Packet4d plogical_shift_right(const Packet4d& a) { return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a), N)); }
+#else
+// AVX has no 256 bits integer shifts, the two halves are shifted with SSE2
+template<int N> NC_STRONG_INLINE Packet8f plogical_shift_left(const Packet8f& a)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(plogical_shift_left<N>(_mm256_castps256_ps128(a))),
+                                plogical_shift_left<N>(_mm256_extractf128_ps(a, 1)), 1);
+}
+template<int N> NC_STRONG_INLINE Packet4d plogical_shift_left(const Packet4d& a)
+{
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(plogical_shift_left<N>(_mm256_castpd256_pd128(a))),
+                                plogical_shift_left<N>(_mm256_extractf128_pd(a, 1)), 1);
+}
+template<int N> NC_STRONG_INLINE Packet8f plogical_shift_right(const Packet8f& a)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(plogical_shift_right<N>(_mm256_castps256_ps128(a))),
+                                plogical_shift_right<N>(_mm256_extractf128_ps(a, 1)), 1);
+}
+template<int N> NC_STRONG_INLINE Packet4d plogical_shift_right(const Packet4d& a)
+{
+    return _mm256_insertf128_pd(_mm256_castpd128_pd256(plogical_shift_right<N>(_mm256_castpd256_pd128(a))),
+                                plogical_shift_right<N>(_mm256_extractf128_pd(a, 1)), 1);
+}
+#endif
+
+template<> NC_STRONG_INLINE Packet8f psqrt<Packet8f>(const Packet8f& a) { return _mm256_sqrt_ps(a); }
+template<> NC_STRONG_INLINE Packet4d psqrt<Packet4d>(const Packet4d& a) { return _mm256_sqrt_pd(a); }
+
+template<> NC_STRONG_INLINE Packet8f ptrunc<Packet8f>(const Packet8f& a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+template<> NC_STRONG_INLINE Packet4d ptrunc<Packet4d>(const Packet4d& a) { return _mm256_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+template<> NC_STRONG_INLINE Packet8f pfloor<Packet8f>(const Packet8f& a) { return _mm256_floor_ps(a); }
+template<> NC_STRONG_INLINE Packet4d pfloor<Packet4d>(const Packet4d& a) { return _mm256_floor_pd(a); }
+
+template<> NC_STRONG_INLINE Packet8f pceil<Packet8f>(const Packet8f& a) { return _mm256_ceil_ps(a); }
+template<> NC_STRONG_INLINE Packet4d pceil<Packet4d>(const Packet4d& a) { return _mm256_ceil_pd(a); }
+
+NC_STRONG_INLINE void pwiden(const Packet8f& a, Packet4d& lo, Packet4d& hi)
+{
+    lo = _mm256_cvtps_pd(_mm256_castps256_ps128(a));
+    hi = _mm256_cvtps_pd(_mm256_extractf128_ps(a, 1));
+}
+NC_STRONG_INLINE Packet8f pnarrow(const Packet4d& lo, const Packet4d& hi)
+{
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+}
+
+template<> NC_STRONG_INLINE Packet8f pload<Packet8f>(const float*   from) { return _mm256_load_ps(from); }
+template<> NC_STRONG_INLINE Packet4d pload<Packet4d>(const double*  from) { return _mm256_load_pd(from); }
+template<> NC_STRONG_INLINE Packet8i pload<Packet8i>(const int*     from) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(from)); }
+
+template<> NC_STRONG_INLINE Packet8f ploadu<Packet8f>(const float*  from) { return _mm256_loadu_ps(from); }
+template<> NC_STRONG_INLINE Packet4d ploadu<Packet4d>(const double* from) { return _mm256_loadu_pd(from); }
+template<> NC_STRONG_INLINE Packet8i ploadu<Packet8i>(const int*    from) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from)); }
+
+template<> NC_STRONG_INLINE void pstore<float>(float*   to, const Packet8f& from) { _mm256_store_ps(to, from); }
+template<> NC_STRONG_INLINE void pstore<double>(double* to, const Packet4d& from) { _mm256_store_pd(to, from); }
+template<> NC_STRONG_INLINE void pstore<int>(int*       to, const Packet8i& from) { _mm256_store_si256(reinterpret_cast<__m256i*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstoreu<float>(float*   to, const Packet8f& from) { _mm256_storeu_ps(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<double>(double* to, const Packet4d& from) { _mm256_storeu_pd(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<int>(int*       to, const Packet8i& from) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstream<float>(float*   to, const Packet8f& from) { _mm256_stream_ps(to, from); }
+template<> NC_STRONG_INLINE void pstream<double>(double* to, const Packet4d& from) { _mm256_stream_pd(to, from); }
+template<> NC_STRONG_INLINE void pstream<int>(int*       to, const Packet8i& from) { _mm256_stream_si256(reinterpret_cast<__m256i*>(to), from); }
+
+template<> NC_STRONG_INLINE float  pfirst<Packet8f>(const Packet8f& a) { return _mm_cvtss_f32(_mm256_castps256_ps128(a)); }
+template<> NC_STRONG_INLINE double pfirst<Packet4d>(const Packet4d& a) { return _mm_cvtsd_f64(_mm256_castpd256_pd128(a)); }
+template<> NC_STRONG_INLINE int    pfirst<Packet8i>(const Packet8i& a) { return _mm_cvtsi128_si32(_mm256_castsi256_si128(a)); }
+
+// Reductions fold the upper 128 bits onto the lower ones and finish with the SSE version.
+template<> NC_STRONG_INLINE float predux<Packet8f>(const Packet8f& a)
+{
+    return predux(Packet4f(_mm_add_ps(_mm256_castps256_ps128(a),_mm256_extractf128_ps(a,1))));
+}
+template<> NC_STRONG_INLINE double predux<Packet4d>(const Packet4d& a)
+{
+    return predux(Packet2d(_mm_add_pd(_mm256_castpd256_pd128(a),_mm256_extractf128_pd(a,1))));
+}
+template<> NC_STRONG_INLINE int predux<Packet8i>(const Packet8i& a)
+{
+    return predux(Packet4i(_mm_add_epi32(_mm256_castsi256_si128(a),_mm256_extractf128_si256(a,1))));
+}
+
+
+NS_INTERNAL_END
+
+#endif
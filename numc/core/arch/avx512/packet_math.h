@@ -0,0 +1,264 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PACKET_MATH_AVX512_H__
+#define __NC_PACKET_MATH_AVX512_H__
+
+NS_INTERNAL_BEGIN
+
+typedef __m512  Packet16f;
+typedef __m512i Packet16i;
+typedef __m512d Packet8d;
+
+template<> struct packet_traits<float>  : default_packet_traits
+{
+    typedef Packet16f type;
+    typedef Packet8f half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 16,
+        HasHalfPacket = 1,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 1,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+template<> struct packet_traits<double> : default_packet_traits
+{
+    typedef Packet8d type;
+    typedef Packet4d half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 8,
+        HasHalfPacket = 1,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 0,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+template<> struct packet_traits<int>    : default_packet_traits
+{
+    typedef Packet16i type;
+    typedef Packet8i half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 16,
+        HasHalfPacket = 1
+    };
+};
+
+template<> struct unpacket_traits<Packet16f> { typedef float  type; typedef Packet8f half; enum {size=16, alignment=Aligned64}; };
+template<> struct unpacket_traits<Packet8d>  { typedef double type; typedef Packet4d half; enum {size=8,  alignment=Aligned64}; };
+template<> struct unpacket_traits<Packet16i> { typedef int    type; typedef Packet8i half; enum {size=16, alignment=Aligned64}; };
+
+template<> NC_STRONG_INLINE Packet16f pset1<Packet16f>(const float&  from) { return _mm512_set1_ps(from); }
+template<> NC_STRONG_INLINE Packet8d  pset1<Packet8d>(const double&  from) { return _mm512_set1_pd(from); }
+template<> NC_STRONG_INLINE Packet16i pset1<Packet16i>(const int&    from) { return _mm512_set1_epi32(from); }
+
+template<> NC_STRONG_INLINE Packet16f padd<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_add_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  padd<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_add_pd(a,b); }
+template<> NC_STRONG_INLINE Packet16i padd<Packet16i>(const Packet16i& a, const Packet16i& b) { return _mm512_add_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet16f psub<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_sub_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  psub<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_sub_pd(a,b); }
+template<> NC_STRONG_INLINE Packet16i psub<Packet16i>(const Packet16i& a, const Packet16i& b) { return _mm512_sub_epi32(a,b); }
+
+// AVX512F has no floating point xor/and, they are done on the integer view of the packet
+template<> NC_STRONG_INLINE Packet16f pnegate(const Packet16f& a)
+{
+    return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x80000000)));
+}
+template<> NC_STRONG_INLINE Packet8d pnegate(const Packet8d& a)
+{
+    return _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(a), _mm512_set1_epi64(0x8000000000000000ULL)));
+}
+template<> NC_STRONG_INLINE Packet16i pnegate(const Packet16i& a)
+{
+    return _mm512_sub_epi32(_mm512_setzero_si512(), a);
+}
+
+template<> NC_STRONG_INLINE Packet16f pmul<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_mul_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  pmul<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_mul_pd(a,b); }
+template<> NC_STRONG_INLINE Packet16i pmul<Packet16i>(const Packet16i& a, const Packet16i& b) { return _mm512_mullo_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet16f pdiv<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_div_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  pdiv<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_div_pd(a,b); }
+
+// FMA is part of AVX512F
+template<> NC_STRONG_INLINE Packet16f pmadd(const Packet16f& a, const Packet16f& b, const Packet16f& c) { return _mm512_fmadd_ps(a,b,c); }
+template<> NC_STRONG_INLINE Packet8d  pmadd(const Packet8d& a, const Packet8d& b, const Packet8d& c)    { return _mm512_fmadd_pd(a,b,c); }
+
+template<> NC_STRONG_INLINE Packet16f pmin<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_min_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  pmin<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_min_pd(a,b); }
+template<> NC_STRONG_INLINE Packet16i pmin<Packet16i>(const Packet16i& a, const Packet16i& b) { return _mm512_min_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet16f pmax<Packet16f>(const Packet16f& a, const Packet16f& b) { return _mm512_max_ps(a,b); }
+template<> NC_STRONG_INLINE Packet8d  pmax<Packet8d>(const Packet8d& a, const Packet8d& b)    { return _mm512_max_pd(a,b); }
+template<> NC_STRONG_INLINE Packet16i pmax<Packet16i>(const Packet16i& a, const Packet16i& b) { return _mm512_max_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet16f pabs(const Packet16f& a)
+{
+    return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff)));
+}
+template<> NC_STRONG_INLINE Packet8d pabs(const Packet8d& a)
+{
+    return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(a), _mm512_set1_epi64(0x7fffffffffffffffLL)));
+}
+template<> NC_STRONG_INLINE Packet16i pabs(const Packet16i& a) { return _mm512_abs_epi32(a); }
+
+// AVX512F has no bitwise operations on floats, they go through the integer ones
+template<> NC_STRONG_INLINE Packet16f pand<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_and_epi32(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+template<> NC_STRONG_INLINE Packet8d  pand<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_and_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+
+template<> NC_STRONG_INLINE Packet16f por<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_or_epi32(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+template<> NC_STRONG_INLINE Packet8d  por<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_or_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+
+template<> NC_STRONG_INLINE Packet16f pxor<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(a), _mm512_castps_si512(b))); }
+template<> NC_STRONG_INLINE Packet8d  pxor<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_xor_epi64(_mm512_castpd_si512(a), _mm512_castpd_si512(b))); }
+
+template<> NC_STRONG_INLINE Packet16f pandnot<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_andnot_epi32(_mm512_castps_si512(b), _mm512_castps_si512(a))); }
+template<> NC_STRONG_INLINE Packet8d  pandnot<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_andnot_epi64(_mm512_castpd_si512(b), _mm512_castpd_si512(a))); }
+
+// the comparisons give a k-mask, which is expanded to a packet mask for the generic code
+template<> NC_STRONG_INLINE Packet16f pcmp_le<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(_mm512_cmp_ps_mask(a,b,_CMP_LE_OQ), -1)); }
+template<> NC_STRONG_INLINE Packet8d  pcmp_le<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(_mm512_cmp_pd_mask(a,b,_CMP_LE_OQ), -1)); }
+
+template<> NC_STRONG_INLINE Packet16f pcmp_lt<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(_mm512_cmp_ps_mask(a,b,_CMP_LT_OQ), -1)); }
+template<> NC_STRONG_INLINE Packet8d  pcmp_lt<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(_mm512_cmp_pd_mask(a,b,_CMP_LT_OQ), -1)); }
+
+template<> NC_STRONG_INLINE Packet16f pcmp_eq<Packet16f>(const Packet16f& a, const Packet16f& b)
+{ return _mm512_castsi512_ps(_mm512_maskz_set1_epi32(_mm512_cmp_ps_mask(a,b,_CMP_EQ_OQ), -1)); }
+template<> NC_STRONG_INLINE Packet8d  pcmp_eq<Packet8d>(const Packet8d& a, const Packet8d& b)
+{ return _mm512_castsi512_pd(_mm512_maskz_set1_epi64(_mm512_cmp_pd_mask(a,b,_CMP_EQ_OQ), -1)); }
+
+template<> NC_STRONG_INLINE bool predux_any<Packet16f>(const Packet16f& mask)
+{ return _mm512_test_epi32_mask(_mm512_castps_si512(mask), _mm512_castps_si512(mask)) != 0; }
+template<> NC_STRONG_INLINE bool predux_any<Packet8d>(const Packet8d& mask)
+{ return _mm512_test_epi64_mask(_mm512_castpd_si512(mask), _mm512_castpd_si512(mask)) != 0; }
+
+template<> NC_STRONG_INLINE Packet16f pselect<Packet16f>(const Packet16f& mask, const Packet16f& a, const Packet16f& b)
+{ return _mm512_mask_blend_ps(_mm512_test_epi32_mask(_mm512_castps_si512(mask), _mm512_castps_si512(mask)), b, a); }
+template<> NC_STRONG_INLINE Packet8d  pselect<Packet8d>(const Packet8d& mask, const Packet8d& a, const Packet8d& b)
+{ return _mm512_mask_blend_pd(_mm512_test_epi64_mask(_mm512_castpd_si512(mask), _mm512_castpd_si512(mask)), b, a); }
+
+template<int N> NC_STRONG_INLINE Packet16f plogical_shift_left(const Packet16f& a)  { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(a), N)); }
+template<int N> NC_STRONG_INLINE Packet8d  plogical_shift_left(const Packet8d& a)   { return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a), N)); }
+template<int N> NC_STRONG_INLINE Packet16f plogical_shift_right(const Packet16f& a) { return _mm512_castsi512_ps(_mm512_srli_epi32(_mm512_castps_si512(a), N)); }
+template<int N> NC_STRONG_INLINE Packet8d  plogical_shift_right(const Packet8d& a)  { return _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_castpd_si512(a), N)); }
+
+template<> NC_STRONG_INLINE Packet16f psqrt<Packet16f>(const Packet16f& a) { return _mm512_sqrt_ps(a); }
+template<> NC_STRONG_INLINE Packet8d  psqrt<Packet8d>(const Packet8d& a)   { return _mm512_sqrt_pd(a); }
+
+template<> NC_STRONG_INLINE Packet16f ptrunc<Packet16f>(const Packet16f& a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+template<> NC_STRONG_INLINE Packet8d  ptrunc<Packet8d>(const Packet8d& a)   { return _mm512_roundscale_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+template<> NC_STRONG_INLINE Packet16f pfloor<Packet16f>(const Packet16f& a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+template<> NC_STRONG_INLINE Packet8d  pfloor<Packet8d>(const Packet8d& a)   { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+template<> NC_STRONG_INLINE Packet16f pceil<Packet16f>(const Packet16f& a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC); }
+template<> NC_STRONG_INLINE Packet8d  pceil<Packet8d>(const Packet8d& a)   { return _mm512_roundscale_pd(a, _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC); }
+
+NC_STRONG_INLINE void pwiden(const Packet16f& a, Packet8d& lo, Packet8d& hi)
+{
+    lo = _mm512_cvtps_pd(_mm512_castps512_ps256(a));
+    hi = _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1)));
+}
+NC_STRONG_INLINE Packet16f pnarrow(const Packet8d& lo, const Packet8d& hi)
+{
+    return _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(_mm512_cvtpd_ps(lo))),
+                                               _mm256_castps_pd(_mm512_cvtpd_ps(hi)), 1));
+}
+
+template<> NC_STRONG_INLINE Packet16f pload<Packet16f>(const float*  from) { return _mm512_load_ps(from); }
+template<> NC_STRONG_INLINE Packet8d  pload<Packet8d>(const double*  from) { return _mm512_load_pd(from); }
+template<> NC_STRONG_INLINE Packet16i pload<Packet16i>(const int*    from) { return _mm512_load_si512(reinterpret_cast<const void*>(from)); }
+
+template<> NC_STRONG_INLINE Packet16f ploadu<Packet16f>(const float* from) { return _mm512_loadu_ps(from); }
+template<> NC_STRONG_INLINE Packet8d  ploadu<Packet8d>(const double* from) { return _mm512_loadu_pd(from); }
+template<> NC_STRONG_INLINE Packet16i ploadu<Packet16i>(const int*   from) { return _mm512_loadu_si512(reinterpret_cast<const void*>(from)); }
+
+template<> NC_STRONG_INLINE void pstore<float>(float*   to, const Packet16f& from) { _mm512_store_ps(to, from); }
+template<> NC_STRONG_INLINE void pstore<double>(double* to, const Packet8d& from)  { _mm512_store_pd(to, from); }
+template<> NC_STRONG_INLINE void pstore<int>(int*       to, const Packet16i& from) { _mm512_store_si512(reinterpret_cast<void*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstoreu<float>(float*   to, const Packet16f& from) { _mm512_storeu_ps(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<double>(double* to, const Packet8d& from)  { _mm512_storeu_pd(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<int>(int*       to, const Packet16i& from) { _mm512_storeu_si512(reinterpret_cast<void*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstream<float>(float*   to, const Packet16f& from) { _mm512_stream_ps(to, from); }
+template<> NC_STRONG_INLINE void pstream<double>(double* to, const Packet8d& from)  { _mm512_stream_pd(to, from); }
+template<> NC_STRONG_INLINE void pstream<int>(int*       to, const Packet16i& from) { _mm512_stream_si512(reinterpret_cast<__m512i*>(to), from); }
+
+template<> NC_STRONG_INLINE float  pfirst<Packet16f>(const Packet16f& a) { return _mm_cvtss_f32(_mm512_castps512_ps128(a)); }
+template<> NC_STRONG_INLINE double pfirst<Packet8d>(const Packet8d& a)   { return _mm_cvtsd_f64(_mm512_castpd512_pd128(a)); }
+template<> NC_STRONG_INLINE int    pfirst<Packet16i>(const Packet16i& a) { return _mm_cvtsi128_si32(_mm512_castsi512_si128(a)); }
+
+// Reductions fold the upper 256 bits onto the lower ones and finish with the AVX version.
+// The 256 bits extractions of float lanes need AVX512DQ, so they go through the double view.
+template<> NC_STRONG_INLINE float predux<Packet16f>(const Packet16f& a)
+{
+    Packet8f lo = _mm512_castps512_ps256(a);
+    Packet8f hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1));
+    return predux(padd(lo, hi));
+}
+template<> NC_STRONG_INLINE double predux<Packet8d>(const Packet8d& a)
+{
+    return predux(padd(Packet4d(_mm512_castpd512_pd256(a)), Packet4d(_mm512_extractf64x4_pd(a, 1))));
+}
+template<> NC_STRONG_INLINE int predux<Packet16i>(const Packet16i& a)
+{
+    return predux(padd(Packet8i(_mm512_castsi512_si256(a)), Packet8i(_mm512_extracti64x4_epi64(a, 1))));
+}
+
+
+NS_INTERNAL_END
+
+#endif
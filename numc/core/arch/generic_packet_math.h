@@ -0,0 +1,378 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GENERIC_PACKET_MATH_H__
+#define __NC_GENERIC_PACKET_MATH_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \file generic_packet_math.h
+  *
+  * Default implementation for types not supported by the vectorization.
+  * In practice these functions are provided to make easier the writing
+  * of generic vectorized code. Every ISA specific header (arch/sse, arch/avx,
+  * arch/avx512, arch/neon) specializes them for its own packet types.
+  */
+
+struct default_packet_traits
+{
+    enum {
+        HasHalfPacket = 0,
+
+        HasAdd    = 1,
+        HasSub    = 1,
+        HasMul    = 1,
+        HasNegate = 1,
+        HasAbs    = 1,
+        HasMin    = 1,
+        HasMax    = 1,
+        HasDiv    = 0,
+
+        // the math functions are vectorized by arch/generic_packet_math_functions.h when the ISA provides
+        // the bitwise, comparison and rounding operations they are built on
+        HasSqrt   = 0,
+        HasRsqrt  = 0,
+        HasExp    = 0,
+        HasLog    = 0,
+        HasLog1p  = 0,
+        HasExpm1  = 0,
+        HasSin    = 0,
+        HasCos    = 0,
+        HasTanh   = 0,
+        HasErf    = 0,
+        HasPow    = 0,
+        HasRound  = 0,
+        HasFloor  = 0,
+        HasCeil   = 0
+    };
+};
+
+/** \internal
+  * \brief Describes the packet (SIMD register) type used to vectorize operations on \a T
+  *
+  * \li \c type is the packet type, and \c half a packet of half the size when the ISA has one,
+  * \li \c Vectorizable tells whether \a T is vectorized at all,
+  * \li \c size is the number of scalars in one packet,
+  * \li \c AlignedOnScalar is set when a packet may be loaded from any scalar boundary (size==1),
+  * \li \c HasXxx tell which operations have a packet implementation.
+  *
+  * The alignment required by aligned loads and stores is given by unpacket_traits<type>::alignment.
+  */
+template<typename T> struct packet_traits : default_packet_traits
+{
+    typedef T type;
+    typedef T half;
+    enum {
+        Vectorizable = 0,
+        size = 1,
+        AlignedOnScalar = 0,
+        HasHalfPacket = 0
+    };
+    enum {
+        HasAdd    = 0,
+        HasSub    = 0,
+        HasMul    = 0,
+        HasNegate = 0,
+        HasAbs    = 0,
+        HasMin    = 0,
+        HasMax    = 0
+    };
+};
+
+template<typename T> struct packet_traits<const T> : packet_traits<T> { };
+
+/** \internal
+  * \brief Maps a packet type back to its scalar type, size and required alignment in bytes
+  */
+template<typename T> struct unpacket_traits
+{
+    typedef T type;
+    typedef T half;
+    enum
+    {
+        size = 1,
+        alignment = 1
+    };
+};
+
+template<typename T> struct unpacket_traits<const T> : unpacket_traits<T> { };
+
+/** \internal \returns a + b (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+padd(const Packet& a, const Packet& b) { return a+b; }
+
+/** \internal \returns a - b (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+psub(const Packet& a, const Packet& b) { return a-b; }
+
+/** \internal \returns -a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pnegate(const Packet& a) { return -a; }
+
+/** \internal \returns a * b (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pmul(const Packet& a, const Packet& b) { return a*b; }
+
+/** \internal \returns a / b (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pdiv(const Packet& a, const Packet& b) { return a/b; }
+
+/** \internal \returns the min of \a a and \a b  (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pmin(const Packet& a, const Packet& b) { return (b < a) ? b : a; }
+
+/** \internal \returns the max of \a a and \a b  (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pmax(const Packet& a, const Packet& b) { return (a < b) ? b : a; }
+
+/** \internal \returns the absolute value of \a a */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pabs(const Packet& a) { using std::abs; return abs(a); }
+
+/** \internal \returns the bitwise and of \a a and \a b */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pand(const Packet& a, const Packet& b) { return a & b; }
+
+/** \internal \returns the bitwise or of \a a and \a b */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+por(const Packet& a, const Packet& b) { return a | b; }
+
+/** \internal \returns the bitwise xor of \a a and \a b */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pxor(const Packet& a, const Packet& b) { return a ^ b; }
+
+/** \internal \returns the bitwise and of \a a and not \a b */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pandnot(const Packet& a, const Packet& b) { return a & (~b); }
+
+/** \internal \returns a mask of the coefficients where a <= b, all their bits being set, the others cleared.
+  * The comparisons are ordered: they do not hold when either coefficient is NaN. */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pcmp_le(const Packet& a, const Packet& b) { return a <= b ? ~Packet(0) : Packet(0); }
+
+/** \internal \returns a mask of the coefficients where a < b, see pcmp_le() */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pcmp_lt(const Packet& a, const Packet& b) { return a < b ? ~Packet(0) : Packet(0); }
+
+/** \internal \returns a mask of the coefficients where a == b, see pcmp_le() */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pcmp_eq(const Packet& a, const Packet& b) { return a == b ? ~Packet(0) : Packet(0); }
+
+/** \internal \returns whether any coefficient of the mask \a mask is set */
+template<typename Packet> NC_DEVICE_FUNC inline bool
+predux_any(const Packet& mask) { return mask != Packet(0); }
+
+/** \internal \returns the bits of the coefficients of \a a shifted left by \a N, filled with zeros */
+template<int N, typename Packet> NC_DEVICE_FUNC inline Packet
+plogical_shift_left(const Packet& a) { return a << N; }
+
+/** \internal \returns the bits of the coefficients of \a a shifted right by \a N, filled with zeros */
+template<int N, typename Packet> NC_DEVICE_FUNC inline Packet
+plogical_shift_right(const Packet& a) { return a >> N; }
+
+/** \internal \returns the square root of \a a (coeff-wise), correctly rounded */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+psqrt(const Packet& a) { using std::sqrt; return sqrt(a); }
+
+/** \internal \returns \a a rounded towards zero (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+ptrunc(const Packet& a) { using std::trunc; return trunc(a); }
+
+/** \internal \returns \a a rounded downwards (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pfloor(const Packet& a) { using std::floor; return floor(a); }
+
+/** \internal \returns \a a rounded upwards (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pceil(const Packet& a) { using std::ceil; return ceil(a); }
+
+/** \internal \returns \a a rounded to the nearest integer, halfway cases away from zero (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pround(const Packet& a) { using std::round; return round(a); }
+
+/** \internal \returns the exponential of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pexp(const Packet& a) { using std::exp; return exp(a); }
+
+/** \internal \returns the natural logarithm of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+plog(const Packet& a) { using std::log; return log(a); }
+
+/** \internal \returns log(1 + a) (coeff-wise), accurate for small \a a */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+plog1p(const Packet& a) { using std::log1p; return log1p(a); }
+
+/** \internal \returns exp(a) - 1 (coeff-wise), accurate for small \a a */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pexpm1(const Packet& a) { using std::expm1; return expm1(a); }
+
+/** \internal \returns the sine of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+psin(const Packet& a) { using std::sin; return sin(a); }
+
+/** \internal \returns the cosine of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pcos(const Packet& a) { using std::cos; return cos(a); }
+
+/** \internal \returns the hyperbolic tangent of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+ptanh(const Packet& a) { using std::tanh; return tanh(a); }
+
+/** \internal \returns the error function of \a a (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+perf(const Packet& a) { using std::erf; return erf(a); }
+
+/** \internal \returns \a a raised to the power \a b (coeff-wise) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+ppow(const Packet& a, const Packet& b) { using std::pow; return pow(a, b); }
+
+/** \internal \returns a * b + c (coeff-wise).
+  * The ISA specific versions use a fused multiply-add instruction (single rounding) when
+  * the target has one (x86 FMA, AVX512F, NEON vfma), and a separate multiply and add otherwise.
+  */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pmadd(const Packet& a, const Packet& b, const Packet& c) { return padd(pmul(a, b), c); }
+
+/** \internal \returns a packet version of \a *from, from must be 16 bytes aligned */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pload(const typename unpacket_traits<Packet>::type* from) { return *from; }
+
+/** \internal \returns a packet version of \a *from, (un-aligned load) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+ploadu(const typename unpacket_traits<Packet>::type* from) { return *from; }
+
+/** \internal \returns a packet with constant coefficients \a a, e.g.: (a,a,a,a) */
+template<typename Packet> NC_DEVICE_FUNC inline Packet
+pset1(const typename unpacket_traits<Packet>::type& a) { return a; }
+
+/** \internal copy the packet \a from to \a *to, \a to must be 16 bytes aligned */
+template<typename Scalar, typename Packet> NC_DEVICE_FUNC inline void pstore(Scalar* to, const Packet& from)
+{ (*to) = from; }
+
+/** \internal copy the packet \a from to \a *to, (un-aligned store) */
+template<typename Scalar, typename Packet> NC_DEVICE_FUNC inline void pstoreu(Scalar* to, const Packet& from)
+{  (*to) = from; }
+
+/** \internal copy the packet \a from to \a *to with a non-temporal store, which does not bring the line
+  * into the caches. \a to must be aligned as for pstore(), the ISAs without such a store do a regular one. */
+template<typename Scalar, typename Packet> NC_DEVICE_FUNC inline void pstream(Scalar* to, const Packet& from)
+{ pstore(to, from); }
+
+/** \internal orders the pstream() stores before the following ones, to be called once a streaming loop is done */
+NC_DEVICE_FUNC inline void pstream_fence()
+{
+#ifdef NC_VECTORIZE_SSE
+    _mm_sfence();
+#endif
+}
+
+/** \internal tries to do cache prefetching of \a addr */
+template<typename Scalar> NC_DEVICE_FUNC inline void prefetch(const Scalar* addr)
+{
+#ifdef NC_CUDA_ARCH
+#if defined(__LP64__)
+    // 64-bit pointer operand constraint for inlined asm
+    asm(" prefetch.L1 [ %1 ];" : "=l"(addr) : "l"(addr));
+#else
+    // 32-bit pointer operand constraint for inlined asm
+    asm(" prefetch.L1 [ %1 ];" : "=r"(addr) : "r"(addr));
+#endif
+#elif (!NC_COMP_MSVC) && (NC_COMP_GNUC || NC_COMP_CLANG || NC_COMP_ICC)
+    __builtin_prefetch(addr);
+#endif
+}
+
+/** \internal \returns the first element of a packet */
+template<typename Packet> NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+pfirst(const Packet& a) { return a; }
+
+/** \internal \returns the sum of the elements of \a a*/
+template<typename Packet> NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+predux(const Packet& a) { return a; }
+
+
+/***************************************************************************
+* The following functions might not have to be overwritten for vectorized types
+***************************************************************************/
+
+/** \internal \returns a packet version of \a *from.
+  * The pointer \a from must be aligned on a \a Alignment bytes boundary. */
+template<typename Packet, int Alignment>
+NC_DEVICE_FUNC NC_ALWAYS_INLINE Packet ploadt(const typename unpacket_traits<Packet>::type* from)
+{
+    if(Alignment >= unpacket_traits<Packet>::alignment)
+        return pload<Packet>(from);
+    else
+        return ploadu<Packet>(from);
+}
+
+/** \internal copy the packet \a from to \a *to.
+  * The pointer \a from must be aligned on a \a Alignment bytes boundary. */
+template<typename Scalar, typename Packet, int Alignment>
+NC_DEVICE_FUNC NC_ALWAYS_INLINE void pstoret(Scalar* to, const Packet& from)
+{
+    if(Alignment >= unpacket_traits<Packet>::alignment)
+        pstore(to, from);
+    else
+        pstoreu(to, from);
+}
+
+/** \internal \returns the coefficients of \a a where the mask \a mask is set, and those of \a b elsewhere */
+template<typename Packet>
+NC_DEVICE_FUNC inline Packet pselect(const Packet& mask, const Packet& a, const Packet& b)
+{
+    return por(pand(a, mask), pandnot(b, mask));
+}
+
+/** \internal \returns 1 / sqrt(a) (coeff-wise) */
+template<typename Packet>
+NC_DEVICE_FUNC inline Packet prsqrt(const Packet& a)
+{
+    return pdiv(pset1<Packet>(typename unpacket_traits<Packet>::type(1)), psqrt(a));
+}
+
+/** \internal folds the coefficients of \a a with \a func, from the first to the last one.
+  * The horizontal reductions below are only called once per reduction, after the packet loop, so
+  * going through memory is good enough for the ISAs not specializing them. */
+template<typename Packet, typename Func>
+NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+predux_generic(const Packet& a, const Func& func)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    enum { Size = unpacket_traits<Packet>::size };
+    Scalar coeffs[Size];
+    pstoreu(coeffs, a);
+    Scalar r = coeffs[0];
+    for(int i=1; i<Size; ++i)
+        r = func(r, coeffs[i]);
+    return r;
+}
+
+template<typename Scalar> struct predux_mul_op { Scalar operator()(const Scalar& a, const Scalar& b) const { return a * b; } };
+template<typename Scalar> struct predux_min_op { Scalar operator()(const Scalar& a, const Scalar& b) const { return b < a ? b : a; } };
+template<typename Scalar> struct predux_max_op { Scalar operator()(const Scalar& a, const Scalar& b) const { return a < b ? b : a; } };
+
+/** \internal \returns the product of the elements of \a a */
+template<typename Packet> NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+predux_mul(const Packet& a) { return predux_generic(a, predux_mul_op<typename unpacket_traits<Packet>::type>()); }
+
+/** \internal \returns the min of the elements of \a a */
+template<typename Packet> NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+predux_min(const Packet& a) { return predux_generic(a, predux_min_op<typename unpacket_traits<Packet>::type>()); }
+
+/** \internal \returns the max of the elements of \a a */
+template<typename Packet> NC_DEVICE_FUNC inline typename unpacket_traits<Packet>::type
+predux_max(const Packet& a) { return predux_generic(a, predux_max_op<typename unpacket_traits<Packet>::type>()); }
+
+
+NS_INTERNAL_END
+
+#endif
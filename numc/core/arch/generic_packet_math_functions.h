@@ -0,0 +1,564 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GENERIC_PACKET_MATH_FUNCTIONS_H__
+#define __NC_GENERIC_PACKET_MATH_FUNCTIONS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \file generic_packet_math_functions.h
+  *
+  * Vectorized implementations of the math functions of generic_packet_math.h, written on top of the packet
+  * primitives (arithmetic, bitwise operations, comparisons, rounding and shifts) so that each ISA only has to
+  * instantiate them for its float and double packets, see NC_MAKE_PACKET_MATH_FUNCTIONS_FLOAT and
+  * NC_MAKE_PACKET_MATH_FUNCTIONS_DOUBLE. Most of them are the Cephes polynomials.
+  *
+  * The maximum errors below are in ULP of the correctly rounded result, measured against a long double
+  * reference with and without FMA, over every 61st float and over 2 10^7 random doubles of each range where
+  * the function is finite. Special values (0, infinities, NaN, overflow and underflow) follow the C library.
+  *
+  * function | float                                  | double
+  * ---------|----------------------------------------|----------------------------------------
+  * sqrt     | 0.5 (correctly rounded)                | 0.5
+  * rsqrt    | 1.5                                    | 1.5
+  * exp      | 1.1                                    | 1.8
+  * log      | 0.85                                   | 0.95
+  * log1p    | 2.5                                    | 2.5
+  * expm1    | 2.5                                    | 2.9
+  * sin, cos | 1.6 for |x| < 2^24, libm beyond        | 1.6 for |x| < 2^24, libm beyond
+  * tanh     | 1.35                                   | 1.45
+  * sigmoid  | 2.8                                    | 3
+  * erf      | 1.4                                    | 1.5
+  * pow      | 0.51 (computed in double)              | not vectorized, libm
+  */
+
+/** \internal \returns \a a * 2^n for the integer-valued \a n, in two steps so that the result may be a denormal
+  * or overflow to infinity. n must be in [-2 emin, 2 emax], e.g. [-252, 254] for float.
+  */
+template<typename Packet>
+NC_STRONG_INLINE Packet pldexp_fast(const Packet& a, const Packet& n)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    enum { MantissaBits = std::numeric_limits<Scalar>::digits - 1 };
+    // 2^k has the biased exponent k + bias, which is formed in the mantissa of 2^MantissaBits + k + bias
+    // and then shifted into place, the bits of 2^MantissaBits falling off the coefficient.
+    const Packet bias = pset1<Packet>(Scalar(1ULL << MantissaBits) + Scalar(std::numeric_limits<Scalar>::max_exponent - 1));
+    const Packet n1 = pfloor(pmul(n, pset1<Packet>(Scalar(0.5))));
+    const Packet n2 = psub(n, n1);
+    return pmul(pmul(a, plogical_shift_left<MantissaBits>(padd(n1, bias))),
+                plogical_shift_left<MantissaBits>(padd(n2, bias)));
+}
+
+/** \internal splits the positive normal \a a into m * 2^e with m in [0.5, 1), \returns m and sets \a e to the
+  * integer-valued exponent.
+  */
+template<typename Packet>
+NC_STRONG_INLINE Packet pfrexp_fast(const Packet& a, Packet& e)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    enum { MantissaBits = std::numeric_limits<Scalar>::digits - 1 };
+    const Packet magic = pset1<Packet>(Scalar(1ULL << MantissaBits));
+    // the biased exponent, read in the mantissa of magic
+    e = psub(psub(por(plogical_shift_right<MantissaBits>(a), magic), magic),
+             pset1<Packet>(Scalar(std::numeric_limits<Scalar>::max_exponent - 2)));
+    // the bits of infinity are those of the exponent
+    return por(pandnot(a, pset1<Packet>(std::numeric_limits<Scalar>::infinity())), pset1<Packet>(Scalar(0.5)));
+}
+
+/** \internal \returns \a a with the scalar function \a func applied to each coefficient, the fallback of the
+  * vectorized functions for the arguments out of their range. */
+template<typename Packet, typename Func>
+NC_DONT_INLINE Packet papply_scalar(const Packet& a, const Func& func)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    enum { Size = unpacket_traits<Packet>::size };
+    Scalar coeffs[Size];
+    pstoreu(coeffs, a);
+    for(int i=0; i<Size; ++i)
+        coeffs[i] = func(coeffs[i]);
+    return ploadu<Packet>(coeffs);
+}
+
+/** \internal \returns \a a rounded towards zero, for the ISAs without a rounding instruction: adding and
+  * subtracting 2^MantissaBits rounds the magnitudes below it to an integer.
+  */
+template<typename Packet>
+NC_STRONG_INLINE Packet ptrunc_generic(const Packet& a)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    enum { MantissaBits = std::numeric_limits<Scalar>::digits - 1 };
+    const Packet limit = pset1<Packet>(Scalar(1ULL << MantissaBits));
+    const Packet abs_a = pabs(a);
+    Packet r = psub(padd(abs_a, limit), limit);
+    r = psub(r, pand(pcmp_lt(abs_a, r), pset1<Packet>(Scalar(1))));
+    // the larger magnitudes, infinities and NaNs are kept as they are
+    r = pselect(pcmp_lt(abs_a, limit), r, abs_a);
+    return por(r, pand(a, pset1<Packet>(Scalar(-0.0))));
+}
+
+/** \internal \returns \a a rounded downwards, see ptrunc_generic() */
+template<typename Packet>
+NC_STRONG_INLINE Packet pfloor_generic(const Packet& a)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet t = ptrunc(a);
+    return psub(t, pand(pcmp_lt(a, t), pset1<Packet>(Scalar(1))));
+}
+
+/** \internal \returns \a a rounded upwards, see ptrunc_generic() */
+template<typename Packet>
+NC_STRONG_INLINE Packet pceil_generic(const Packet& a)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet t = ptrunc(a);
+    return padd(t, pand(pcmp_lt(t, a), pset1<Packet>(Scalar(1))));
+}
+
+/** \internal \returns \a a rounded to the nearest integer, halfway cases away from zero: adding the float just
+  * below 0.5 does not round up the coefficients just below a halfway case, as adding 0.5 would.
+  */
+template<typename Packet>
+NC_STRONG_INLINE Packet pround_generic(const Packet& a)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet prev_half = pset1<Packet>(Scalar(0.5) - std::numeric_limits<Scalar>::epsilon() / 4);
+    return ptrunc(padd(a, por(pand(a, pset1<Packet>(Scalar(-0.0))), prev_half)));
+}
+
+// The arguments are clamped with pmin(bound, x) and pmax(bound, x): the x86 min and max return their second
+// argument when either one is NaN, which lets the NaNs through.
+
+/** \internal exp of float packets, Cephes expf: exp(x) = 2^n exp(r) with |r| <= ln(2)/2 */
+template<typename Packet>
+NC_STRONG_INLINE Packet pexp_float(const Packet& a)
+{
+    const Packet x = pmax(pset1<Packet>(-104.f), pmin(pset1<Packet>(88.8f), a));
+    const Packet n = pfloor(pmadd(x, pset1<Packet>(1.44269504088896341f), pset1<Packet>(0.5f)));
+    // ln(2) = C1 - C2, n * C1 being exact
+    Packet r = pmadd(n, pset1<Packet>(-0.693359375f), x);
+    r = pmadd(n, pset1<Packet>(2.12194440e-4f), r);
+    const Packet z = pmul(r, r);
+
+    Packet y = pset1<Packet>(1.9875691500E-4f);
+    y = pmadd(y, r, pset1<Packet>(1.3981999507E-3f));
+    y = pmadd(y, r, pset1<Packet>(8.3334519073E-3f));
+    y = pmadd(y, r, pset1<Packet>(4.1665795894E-2f));
+    y = pmadd(y, r, pset1<Packet>(1.6666665459E-1f));
+    y = pmadd(y, r, pset1<Packet>(5.0000001201E-1f));
+    y = padd(pmadd(y, z, r), pset1<Packet>(1.f));
+    return pldexp_fast(y, n);
+}
+
+/** \internal exp of double packets, Cephes exp: exp(x) = 2^n (1 + 2 P(r) / (Q(r) - P(r))) */
+template<typename Packet>
+NC_STRONG_INLINE Packet pexp_double(const Packet& a)
+{
+    const Packet x = pmax(pset1<Packet>(-745.2), pmin(pset1<Packet>(709.8), a));
+    const Packet n = pfloor(pmadd(x, pset1<Packet>(1.4426950408889634073599), pset1<Packet>(0.5)));
+    Packet r = pmadd(n, pset1<Packet>(-6.93145751953125E-1), x);
+    r = pmadd(n, pset1<Packet>(-1.42860682030941723212E-6), r);
+    const Packet z = pmul(r, r);
+
+    Packet p = pset1<Packet>(1.26177193074810590878E-4);
+    p = pmadd(p, z, pset1<Packet>(3.02994407707441961300E-2));
+    p = pmadd(p, z, pset1<Packet>(9.99999999999999999910E-1));
+    p = pmul(p, r);
+    Packet q = pset1<Packet>(3.00198505138664455042E-6);
+    q = pmadd(q, z, pset1<Packet>(2.52448340349684104192E-3));
+    q = pmadd(q, z, pset1<Packet>(2.27265548208155028766E-1));
+    q = pmadd(q, z, pset1<Packet>(2.00000000000000000009E0));
+    const Packet y = pmadd(pdiv(p, psub(q, p)), pset1<Packet>(2.0), pset1<Packet>(1.0));
+    return pldexp_fast(y, n);
+}
+
+/** \internal fixes the log of the special values: NaN for the negative and NaN arguments, -inf at 0 and
+  * inf at inf */
+template<typename Packet>
+NC_STRONG_INLINE Packet plog_special_values(const Packet& a, const Packet& r)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet zero = pset1<Packet>(Scalar(0));
+    const Packet inf = pset1<Packet>(std::numeric_limits<Scalar>::infinity());
+    // a mask has all its bits set, which is a NaN: the negative arguments and the NaNs are not in 0 <= a
+    const Packet invalid = pandnot(pcmp_eq(zero, zero), pcmp_le(zero, a));
+    return pselect(pcmp_eq(a, zero), pnegate(inf), pselect(pcmp_eq(a, inf), inf, por(r, invalid)));
+}
+
+/** \internal log of float packets, Cephes logf: log(x) = e ln(2) + log(1 + f) with sqrt(1/2) <= 1 + f < sqrt(2) */
+template<typename Packet>
+NC_STRONG_INLINE Packet plog_float(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.f);
+    // the denormals are scaled into the normal range
+    const Packet denormal = pcmp_lt(a, pset1<Packet>(std::numeric_limits<float>::min()));
+    Packet e;
+    Packet m = pfrexp_fast(pselect(denormal, pmul(a, pset1<Packet>(16777216.f)), a), e);
+    e = psub(e, pand(denormal, pset1<Packet>(24.f)));
+
+    const Packet small = pcmp_lt(m, pset1<Packet>(0.707106781186547524f));
+    e = psub(e, pand(small, one));
+    m = padd(psub(m, one), pand(small, m));
+    const Packet z = pmul(m, m);
+
+    Packet y = pset1<Packet>(7.0376836292E-2f);
+    y = pmadd(y, m, pset1<Packet>(-1.1514610310E-1f));
+    y = pmadd(y, m, pset1<Packet>(1.1676998740E-1f));
+    y = pmadd(y, m, pset1<Packet>(-1.2420140846E-1f));
+    y = pmadd(y, m, pset1<Packet>(1.4249322787E-1f));
+    y = pmadd(y, m, pset1<Packet>(-1.6668057665E-1f));
+    y = pmadd(y, m, pset1<Packet>(2.0000714765E-1f));
+    y = pmadd(y, m, pset1<Packet>(-2.4999993993E-1f));
+    y = pmadd(y, m, pset1<Packet>(3.3333331174E-1f));
+    y = pmul(pmul(y, m), z);
+    y = pmadd(e, pset1<Packet>(-2.12194440e-4f), y);
+    y = pmadd(z, pset1<Packet>(-0.5f), y);
+    const Packet r = pmadd(e, pset1<Packet>(0.693359375f), padd(m, y));
+    return plog_special_values(a, r);
+}
+
+/** \internal log of double packets, Cephes log: log(1 + f) = f - f^2 / 2 + f^3 P(f) / Q(f) */
+template<typename Packet>
+NC_STRONG_INLINE Packet plog_double(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.0);
+    const Packet denormal = pcmp_lt(a, pset1<Packet>(std::numeric_limits<double>::min()));
+    Packet e;
+    Packet m = pfrexp_fast(pselect(denormal, pmul(a, pset1<Packet>(18014398509481984.0)), a), e);
+    e = psub(e, pand(denormal, pset1<Packet>(54.0)));
+
+    const Packet small = pcmp_lt(m, pset1<Packet>(0.70710678118654752440));
+    e = psub(e, pand(small, one));
+    m = padd(psub(m, one), pand(small, m));
+    const Packet z = pmul(m, m);
+
+    Packet p = pset1<Packet>(1.01875663804580931796E-4);
+    p = pmadd(p, m, pset1<Packet>(4.97494994976747001425E-1));
+    p = pmadd(p, m, pset1<Packet>(4.70579119878881725854E0));
+    p = pmadd(p, m, pset1<Packet>(1.44989225341610930846E1));
+    p = pmadd(p, m, pset1<Packet>(1.79368678507819816313E1));
+    p = pmadd(p, m, pset1<Packet>(7.70838733755885391666E0));
+    Packet q = padd(m, pset1<Packet>(1.12873587189167450590E1));
+    q = pmadd(q, m, pset1<Packet>(4.52279145837532221105E1));
+    q = pmadd(q, m, pset1<Packet>(8.29875266912776603211E1));
+    q = pmadd(q, m, pset1<Packet>(7.11544750618563894466E1));
+    q = pmadd(q, m, pset1<Packet>(2.31251620126765340583E1));
+    Packet y = pmul(m, pmul(z, pdiv(p, q)));
+    y = pmadd(e, pset1<Packet>(-2.121944400546905827679e-4), y);
+    y = pmadd(z, pset1<Packet>(-0.5), y);
+    const Packet r = pmadd(e, pset1<Packet>(0.693359375), padd(m, y));
+    return plog_special_values(a, r);
+}
+
+/** \internal log1p from log, with the correction of Kahan: log(u) * x / (u - 1) for u = 1 + x, which cancels
+  * the rounding error of u */
+template<typename Packet>
+NC_STRONG_INLINE Packet plog1p_generic(const Packet& x)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet one = pset1<Packet>(Scalar(1));
+    const Packet u = padd(x, one);
+    const Packet log_u = plog(u);
+    const Packet r = pmul(x, pdiv(log_u, psub(u, one)));
+    // u == 1 for the tiny x, whose log1p is x, and log_u == u at infinity
+    return pselect(por(pcmp_eq(u, one), pcmp_eq(log_u, u)), x, r);
+}
+
+/** \internal expm1 from exp, with the correction of Kahan: (u - 1) * x / log(u) for u = exp(x) */
+template<typename Packet>
+NC_STRONG_INLINE Packet pexpm1_generic(const Packet& x)
+{
+    typedef typename unpacket_traits<Packet>::type Scalar;
+    const Packet one = pset1<Packet>(Scalar(1));
+    const Packet neg_one = pset1<Packet>(Scalar(-1));
+    const Packet u = pexp(x);
+    const Packet u_minus_one = psub(u, one);
+    const Packet log_u = plog(u);
+    Packet r = pmul(u_minus_one, pdiv(x, log_u));
+    // at infinity, log_u == u
+    r = pselect(pcmp_eq(log_u, u), u, r);
+    // u == 1 for the tiny x, whose expm1 is x, and u - 1 == -1 for the large negative ones
+    return pselect(pcmp_eq(u, one), x, pselect(pcmp_eq(u_minus_one, neg_one), neg_one, r));
+}
+
+/** \internal \returns the even j = 2 ceil(floor(4 ax / pi) / 2) of the double packet \a ax = |x|, for which
+  * |x| - j pi/4 is in [-pi/4, pi/4] */
+template<typename Packet>
+NC_STRONG_INLINE Packet psincos_octant(const Packet& ax)
+{
+    const Packet j = pceil(pmul(pfloor(pmul(ax, pset1<Packet>(1.27323954473516268615))), pset1<Packet>(0.5)));
+    return padd(j, j);
+}
+
+/** \internal sin or cos of float packets, Cephes sinf and cosf: |x| = j pi/4 + r with j even and |r| <= pi/4,
+  * sin(r) or cos(r) being picked and signed from j mod 8. The reduction is done in double on the packets
+  * \a PacketD, j pi/4 being exact for |x| < 2^24, and the larger arguments go through libm.
+  */
+template<bool Cos, typename Packet, typename PacketD>
+NC_STRONG_INLINE Packet psincos_float(const Packet& x)
+{
+    const Packet ax = pabs(x);
+    if(predux_any(pcmp_lt(pset1<Packet>(16777216.f), ax)))
+        return Cos ? papply_scalar(x, [](float v) { return std::cos(v); })
+                   : papply_scalar(x, [](float v) { return std::sin(v); });
+
+    const Packet one = pset1<Packet>(1.f), two = pset1<Packet>(2.f), four = pset1<Packet>(4.f);
+    const Packet sign_mask = pset1<Packet>(-0.f);
+    // pi/4 = DP1 + DP2, DP1 having 27 bits so that j * DP1 is exact
+    const PacketD dp1 = pset1<PacketD>(-7.85398162901401519775E-1), dp2 = pset1<PacketD>(-4.96046789840270200E-10);
+    PacketD axlo, axhi;
+    pwiden(ax, axlo, axhi);
+    const PacketD jlo = psincos_octant(axlo), jhi = psincos_octant(axhi);
+    const Packet j = pnarrow(jlo, jhi);
+    const Packet r = pnarrow(pmadd(jlo, dp2, pmadd(jlo, dp1, axlo)), pmadd(jhi, dp2, pmadd(jhi, dp1, axhi)));
+    const Packet q = psub(j, pmul(pfloor(pmul(j, pset1<Packet>(0.125f))), pset1<Packet>(8.f)));
+    const Packet z = pmul(r, r);
+
+    Packet s = pset1<Packet>(-1.9515295891E-4f);
+    s = pmadd(s, z, pset1<Packet>(8.3321608736E-3f));
+    s = pmadd(s, z, pset1<Packet>(-1.6666654611E-1f));
+    s = pmadd(pmul(s, z), r, r);
+    Packet c = pset1<Packet>(2.443315711809948E-005f);
+    c = pmadd(c, z, pset1<Packet>(-1.388731625493765E-003f));
+    c = pmadd(c, z, pset1<Packet>(4.166664568298827E-002f));
+    c = pmadd(pmul(c, z), z, pmadd(z, pset1<Packet>(-0.5f), one));
+
+    // the octants 2 and 6 swap sin and cos, sin is negated from the octant 4 on and cos in the octants 2 and 4
+    const Packet q2 = pcmp_eq(q, two), q4 = pcmp_eq(q, four);
+    const Packet swap = por(q2, pcmp_eq(q, pset1<Packet>(6.f)));
+    if(Cos)
+        return pxor(pselect(swap, s, c), pand(por(q2, q4), sign_mask));
+    return pxor(pselect(swap, c, s), pxor(pand(x, sign_mask), pand(pcmp_le(four, q), sign_mask)));
+}
+
+/** \internal sin or cos of double packets, Cephes sin and cos, see psincos_float(). The reduction is accurate
+  * for |x| < 2^24, the larger arguments go through libm. */
+template<bool Cos, typename Packet>
+NC_STRONG_INLINE Packet psincos_double(const Packet& x)
+{
+    const Packet ax = pabs(x);
+    if(predux_any(pcmp_lt(pset1<Packet>(16777216.0), ax)))
+        return Cos ? papply_scalar(x, [](double v) { return std::cos(v); })
+                   : papply_scalar(x, [](double v) { return std::sin(v); });
+
+    const Packet one = pset1<Packet>(1.0), two = pset1<Packet>(2.0), four = pset1<Packet>(4.0);
+    const Packet sign_mask = pset1<Packet>(-0.0);
+    const Packet j = psincos_octant(ax);
+    Packet r = pmadd(j, pset1<Packet>(-7.85398125648498535156E-1), ax);
+    r = pmadd(j, pset1<Packet>(-3.77489470793079817668E-8), r);
+    r = pmadd(j, pset1<Packet>(-2.69515142907905952645E-15), r);
+    const Packet q = psub(j, pmul(pfloor(pmul(j, pset1<Packet>(0.125))), pset1<Packet>(8.0)));
+    const Packet z = pmul(r, r);
+
+    Packet s = pset1<Packet>(1.58962301576546568060E-10);
+    s = pmadd(s, z, pset1<Packet>(-2.50507477628578072866E-8));
+    s = pmadd(s, z, pset1<Packet>(2.75573136213857245213E-6));
+    s = pmadd(s, z, pset1<Packet>(-1.98412698295895385996E-4));
+    s = pmadd(s, z, pset1<Packet>(8.33333333332211858878E-3));
+    s = pmadd(s, z, pset1<Packet>(-1.66666666666666307295E-1));
+    s = pmadd(pmul(s, z), r, r);
+    Packet c = pset1<Packet>(-1.13585365213876817300E-11);
+    c = pmadd(c, z, pset1<Packet>(2.08757008419747316778E-9));
+    c = pmadd(c, z, pset1<Packet>(-2.75573141792967388112E-7));
+    c = pmadd(c, z, pset1<Packet>(2.48015872888517045348E-5));
+    c = pmadd(c, z, pset1<Packet>(-1.38888888888730564116E-3));
+    c = pmadd(c, z, pset1<Packet>(4.16666666666665929218E-2));
+    c = pmadd(pmul(c, z), z, pmadd(z, pset1<Packet>(-0.5), one));
+
+    const Packet q2 = pcmp_eq(q, two), q4 = pcmp_eq(q, four);
+    const Packet swap = por(q2, pcmp_eq(q, pset1<Packet>(6.0)));
+    if(Cos)
+        return pxor(pselect(swap, s, c), pand(por(q2, q4), sign_mask));
+    return pxor(pselect(swap, c, s), pxor(pand(x, sign_mask), pand(pcmp_le(four, q), sign_mask)));
+}
+
+/** \internal tanh of float packets, Cephes tanhf: x + x^3 P(x^2) below 0.625, and 1 - 2 / (exp(2x) + 1) above */
+template<typename Packet>
+NC_STRONG_INLINE Packet ptanh_float(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.f);
+    const Packet ax = pabs(a);
+    const Packet z = pmul(a, a);
+
+    Packet p = pset1<Packet>(-5.70498872745E-3f);
+    p = pmadd(p, z, pset1<Packet>(2.06390887954E-2f));
+    p = pmadd(p, z, pset1<Packet>(-5.37397155531E-2f));
+    p = pmadd(p, z, pset1<Packet>(1.33314422036E-1f));
+    p = pmadd(p, z, pset1<Packet>(-3.33332819422E-1f));
+    const Packet small = pmadd(pmul(a, z), p, a);
+
+    // exp overflows to infinity for the large arguments, for which tanh is 1
+    const Packet large = psub(one, pdiv(pset1<Packet>(2.f), padd(pexp_float(padd(ax, ax)), one)));
+    const Packet r = por(large, pand(a, pset1<Packet>(-0.f)));
+    return pselect(pcmp_lt(ax, pset1<Packet>(0.625f)), small, r);
+}
+
+/** \internal tanh of double packets, Cephes tanh: a rational approximation below 0.625, and
+  * 1 - 2 / (exp(2x) + 1) above */
+template<typename Packet>
+NC_STRONG_INLINE Packet ptanh_double(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.0);
+    const Packet ax = pabs(a);
+    const Packet z = pmul(a, a);
+
+    Packet p = pset1<Packet>(-9.64399179425052238628E-1);
+    p = pmadd(p, z, pset1<Packet>(-9.92877231001918586564E1));
+    p = pmadd(p, z, pset1<Packet>(-1.61468768441708447952E3));
+    Packet q = padd(z, pset1<Packet>(1.12811678491632931402E2));
+    q = pmadd(q, z, pset1<Packet>(2.23548839060100448583E3));
+    q = pmadd(q, z, pset1<Packet>(4.84406305325125486048E3));
+    const Packet small = pmadd(pmul(a, z), pdiv(p, q), a);
+
+    // exp overflows to infinity for the large arguments, for which tanh is 1
+    const Packet large = psub(one, pdiv(pset1<Packet>(2.0), padd(pexp_double(padd(ax, ax)), one)));
+    const Packet r = por(large, pand(a, pset1<Packet>(-0.0)));
+    return pselect(pcmp_lt(ax, pset1<Packet>(0.625)), small, r);
+}
+
+/** \internal erf of float packets, Cephes erff: x + x P(x^2) for |x| < 1, and 1 - exp(-x^2) Q(1/x) / x above, up
+  * to 3.92 beyond which erf is +-1 in float */
+template<typename Packet>
+NC_STRONG_INLINE Packet perf_float(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.f), bound = pset1<Packet>(3.92f);
+    const Packet ax = pabs(a);
+    const Packet z = pmul(a, a);
+
+    Packet p = pset1<Packet>(7.854026626e-05f);
+    p = pmadd(p, z, pset1<Packet>(-8.010247839e-04f));
+    p = pmadd(p, z, pset1<Packet>(5.188334733e-03f));
+    p = pmadd(p, z, pset1<Packet>(-2.685381658e-02f));
+    p = pmadd(p, z, pset1<Packet>(1.128358543e-01f));
+    p = pmadd(p, z, pset1<Packet>(-3.761262596e-01f));
+    p = pmadd(p, z, pset1<Packet>(1.283791661e-01f));
+    const Packet small = pmadd(a, p, a);
+
+    const Packet x = pmin(bound, ax);
+    const Packet v = pdiv(one, x);
+    Packet q = pset1<Packet>(5.338401720e-02f);
+    q = pmadd(q, v, pset1<Packet>(-3.064044416e-01f));
+    q = pmadd(q, v, pset1<Packet>(7.457839251e-01f));
+    q = pmadd(q, v, pset1<Packet>(-9.619199038e-01f));
+    q = pmadd(q, v, pset1<Packet>(6.061582565e-01f));
+    q = pmadd(q, v, pset1<Packet>(2.389856800e-02f));
+    q = pmadd(q, v, pset1<Packet>(-3.007676899e-01f));
+    q = pmadd(q, v, pset1<Packet>(3.494913457e-03f));
+    q = pmadd(q, v, pset1<Packet>(5.639559627e-01f));
+    const Packet erfc = pmul(pexp_float(pnegate(pmul(x, x))), pmul(q, v));
+    const Packet large = pselect(pcmp_le(bound, ax), one, psub(one, erfc));
+    // NaNs take the first branch
+    return pselect(pcmp_lt(one, ax), por(large, pand(a, pset1<Packet>(-0.f))), small);
+}
+
+/** \internal erf of double packets, Cephes erf: x T(x^2) / U(x^2) for |x| <= 1, and 1 - erfc(|x|) with
+  * erfc(x) = exp(-x^2) P(x) / Q(x) above, up to 6 beyond which erf is +-1 in double */
+template<typename Packet>
+NC_STRONG_INLINE Packet perf_double(const Packet& a)
+{
+    const Packet one = pset1<Packet>(1.0);
+    const Packet z = pmul(a, a);
+
+    // erf(x) = x + x (T(x^2) - U(x^2)) / U(x^2), the coefficients of T - U being given
+    Packet t = pset1<Packet>(-1.0);
+    t = pmadd(t, z, pset1<Packet>(-2.39567404248797934940E1));
+    t = pmadd(t, z, pset1<Packet>(-4.31331930059768410501E2));
+    t = pmadd(t, z, pset1<Packet>(-2.36231848376295829439E3));
+    t = pmadd(t, z, pset1<Packet>(-1.56256749202610426437E4));
+    t = pmadd(t, z, pset1<Packet>(6.32490704017590451258E3));
+    Packet u = padd(z, pset1<Packet>(3.35617141647503099647E1));
+    u = pmadd(u, z, pset1<Packet>(5.21357949780152679795E2));
+    u = pmadd(u, z, pset1<Packet>(4.59432382970980127987E3));
+    u = pmadd(u, z, pset1<Packet>(2.26290000613890934246E4));
+    u = pmadd(u, z, pset1<Packet>(4.92673942608635921086E4));
+    const Packet small = pmadd(a, pdiv(t, u), a);
+
+    const Packet x = pmin(pset1<Packet>(6.0), pabs(a));
+    Packet p = pset1<Packet>(2.46196981473530512524E-10);
+    p = pmadd(p, x, pset1<Packet>(5.64189564831068821977E-1));
+    p = pmadd(p, x, pset1<Packet>(7.46321056442269912687E0));
+    p = pmadd(p, x, pset1<Packet>(4.86371970985681366614E1));
+    p = pmadd(p, x, pset1<Packet>(1.96520832956077098242E2));
+    p = pmadd(p, x, pset1<Packet>(5.26445194995477358631E2));
+    p = pmadd(p, x, pset1<Packet>(9.34528527171957607540E2));
+    p = pmadd(p, x, pset1<Packet>(1.02755188689515710272E3));
+    p = pmadd(p, x, pset1<Packet>(5.57535335369399327526E2));
+    Packet q = padd(x, pset1<Packet>(1.32281951154744992508E1));
+    q = pmadd(q, x, pset1<Packet>(8.67072140885989742329E1));
+    q = pmadd(q, x, pset1<Packet>(3.54937778887819891062E2));
+    q = pmadd(q, x, pset1<Packet>(9.75708501743205489753E2));
+    q = pmadd(q, x, pset1<Packet>(1.82390916687909736289E3));
+    q = pmadd(q, x, pset1<Packet>(2.24633760818710981792E3));
+    q = pmadd(q, x, pset1<Packet>(1.65666309194161350182E3));
+    q = pmadd(q, x, pset1<Packet>(5.57535340817727675546E2));
+    const Packet erfc = pmul(pexp_double(pnegate(pmul(x, x))), pdiv(p, q));
+    const Packet large = por(psub(one, erfc), pand(a, pset1<Packet>(-0.0)));
+    // NaNs take the first branch
+    return pselect(pcmp_lt(one, pabs(a)), large, small);
+}
+
+/** \internal pow of float packets, computed as exp(y log|x|) in double, whose error is far below the
+  * rounding to float. The sign and the special values follow the C library. */
+template<typename Packet, typename PacketD>
+NC_STRONG_INLINE Packet ppow_float(const Packet& x, const Packet& y)
+{
+    const Packet zero = pset1<Packet>(0.f), one = pset1<Packet>(1.f), half = pset1<Packet>(0.5f);
+    const Packet sign_mask = pset1<Packet>(-0.f);
+    const Packet inf = pset1<Packet>(std::numeric_limits<float>::infinity());
+
+    PacketD xlo, xhi, ylo, yhi;
+    pwiden(pabs(x), xlo, xhi);
+    pwiden(y, ylo, yhi);
+    Packet r = pnarrow(pexp_double(pmul(ylo, plog_double(xlo))), pexp_double(pmul(yhi, plog_double(xhi))));
+
+    // a finite negative x gives a NaN for a non integer y, and keeps its sign for an odd one (like -0)
+    const Packet integer = pcmp_eq(pfloor(y), y);
+    const Packet odd = pandnot(integer, pcmp_eq(pfloor(pmul(y, half)), pmul(y, half)));
+    const Packet finite_negative = pand(pcmp_lt(x, zero), pcmp_lt(pnegate(inf), x));
+    r = por(r, pand(finite_negative, pandnot(pcmp_eq(y, y), integer)));
+    r = por(r, pand(pand(x, sign_mask), odd));
+    // pow(x, 0) = pow(1, y) = pow(-1, +-inf) = 1, even for NaNs
+    const Packet unit = por(por(pcmp_eq(y, zero), pcmp_eq(x, one)),
+                            pand(pcmp_eq(pabs(x), one), pcmp_eq(pabs(y), inf)));
+    return pselect(unit, one, r);
+}
+
+/** \internal Specializes the math functions of generic_packet_math.h for the float packet \a PACKET, whose
+  * double packets of the same size are \a PACKETD */
+#define NC_MAKE_PACKET_MATH_FUNCTIONS_FLOAT(PACKET, PACKETD)                                                     \
+template<> NC_STRONG_INLINE PACKET pexp<PACKET>(const PACKET& a)   { return pexp_float(a); }                     \
+template<> NC_STRONG_INLINE PACKET plog<PACKET>(const PACKET& a)   { return plog_float(a); }                     \
+template<> NC_STRONG_INLINE PACKET plog1p<PACKET>(const PACKET& a) { return plog1p_generic(a); }                 \
+template<> NC_STRONG_INLINE PACKET pexpm1<PACKET>(const PACKET& a) { return pexpm1_generic(a); }                 \
+template<> NC_STRONG_INLINE PACKET psin<PACKET>(const PACKET& a)                                                 \
+{ return psincos_float<false, PACKET, PACKETD>(a); }                                                             \
+template<> NC_STRONG_INLINE PACKET pcos<PACKET>(const PACKET& a)                                                 \
+{ return psincos_float<true, PACKET, PACKETD>(a); }                                                              \
+template<> NC_STRONG_INLINE PACKET ptanh<PACKET>(const PACKET& a)  { return ptanh_float(a); }                    \
+template<> NC_STRONG_INLINE PACKET perf<PACKET>(const PACKET& a)   { return perf_float(a); }                                    \
+template<> NC_STRONG_INLINE PACKET pround<PACKET>(const PACKET& a) { return pround_generic(a); }                 \
+template<> NC_STRONG_INLINE PACKET ppow<PACKET>(const PACKET& a, const PACKET& b)                                \
+{ return ppow_float<PACKET, PACKETD>(a, b); }
+
+/** \internal Specializes the math functions of generic_packet_math.h for the double packet \a PACKET */
+#define NC_MAKE_PACKET_MATH_FUNCTIONS_DOUBLE(PACKET)                                                             \
+template<> NC_STRONG_INLINE PACKET pexp<PACKET>(const PACKET& a)   { return pexp_double(a); }                    \
+template<> NC_STRONG_INLINE PACKET plog<PACKET>(const PACKET& a)   { return plog_double(a); }                    \
+template<> NC_STRONG_INLINE PACKET plog1p<PACKET>(const PACKET& a) { return plog1p_generic(a); }                 \
+template<> NC_STRONG_INLINE PACKET pexpm1<PACKET>(const PACKET& a) { return pexpm1_generic(a); }                 \
+template<> NC_STRONG_INLINE PACKET psin<PACKET>(const PACKET& a)   { return psincos_double<false>(a); }          \
+template<> NC_STRONG_INLINE PACKET pcos<PACKET>(const PACKET& a)   { return psincos_double<true>(a); }           \
+template<> NC_STRONG_INLINE PACKET ptanh<PACKET>(const PACKET& a)  { return ptanh_double(a); }                   \
+template<> NC_STRONG_INLINE PACKET perf<PACKET>(const PACKET& a)   { return perf_double(a); }                    \
+template<> NC_STRONG_INLINE PACKET pround<PACKET>(const PACKET& a) { return pround_generic(a); }
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,168 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PACKET_MATH_NEON_H__
+#define __NC_PACKET_MATH_NEON_H__
+
+NS_INTERNAL_BEGIN
+
+typedef float32x4_t Packet4f;
+typedef int32x4_t   Packet4i;
+
+template<> struct packet_traits<float>  : default_packet_traits
+{
+    typedef Packet4f type;
+    typedef Packet4f half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 4,
+        HasHalfPacket = 0,
+
+        // ARMv7 NEON has no vector division
+#if NC_ARCH_ARM64
+        HasDiv  = 1
+#else
+        HasDiv  = 0
+#endif
+    };
+};
+template<> struct packet_traits<int>    : default_packet_traits
+{
+    typedef Packet4i type;
+    typedef Packet4i half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 4,
+        HasHalfPacket = 0
+    };
+};
+
+template<> struct unpacket_traits<Packet4f> { typedef float type; enum {size=4, alignment=Aligned16}; typedef Packet4f half; };
+template<> struct unpacket_traits<Packet4i> { typedef int   type; enum {size=4, alignment=Aligned16}; typedef Packet4i half; };
+
+template<> NC_STRONG_INLINE Packet4f pset1<Packet4f>(const float& from) { return vdupq_n_f32(from); }
+template<> NC_STRONG_INLINE Packet4i pset1<Packet4i>(const int&   from) { return vdupq_n_s32(from); }
+
+template<> NC_STRONG_INLINE Packet4f padd<Packet4f>(const Packet4f& a, const Packet4f& b) { return vaddq_f32(a,b); }
+template<> NC_STRONG_INLINE Packet4i padd<Packet4i>(const Packet4i& a, const Packet4i& b) { return vaddq_s32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f psub<Packet4f>(const Packet4f& a, const Packet4f& b) { return vsubq_f32(a,b); }
+template<> NC_STRONG_INLINE Packet4i psub<Packet4i>(const Packet4i& a, const Packet4i& b) { return vsubq_s32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pnegate(const Packet4f& a) { return vnegq_f32(a); }
+template<> NC_STRONG_INLINE Packet4i pnegate(const Packet4i& a) { return vnegq_s32(a); }
+
+template<> NC_STRONG_INLINE Packet4f pmul<Packet4f>(const Packet4f& a, const Packet4f& b) { return vmulq_f32(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmul<Packet4i>(const Packet4i& a, const Packet4i& b) { return vmulq_s32(a,b); }
+
+#if NC_ARCH_ARM64
+template<> NC_STRONG_INLINE Packet4f pdiv<Packet4f>(const Packet4f& a, const Packet4f& b) { return vdivq_f32(a,b); }
+#endif
+
+// vfmaq_f32 is a true fused multiply-add, vmlaq_f32 rounds the product first
+#if NC_ARCH_ARM64 || defined(__ARM_FEATURE_FMA)
+template<> NC_STRONG_INLINE Packet4f pmadd(const Packet4f& a, const Packet4f& b, const Packet4f& c) { return vfmaq_f32(c,a,b); }
+#else
+template<> NC_STRONG_INLINE Packet4f pmadd(const Packet4f& a, const Packet4f& b, const Packet4f& c) { return vmlaq_f32(c,a,b); }
+#endif
+template<> NC_STRONG_INLINE Packet4i pmadd(const Packet4i& a, const Packet4i& b, const Packet4i& c) { return vmlaq_s32(c,a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pmin<Packet4f>(const Packet4f& a, const Packet4f& b) { return vminq_f32(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmin<Packet4i>(const Packet4i& a, const Packet4i& b) { return vminq_s32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pmax<Packet4f>(const Packet4f& a, const Packet4f& b) { return vmaxq_f32(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmax<Packet4i>(const Packet4i& a, const Packet4i& b) { return vmaxq_s32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pabs(const Packet4f& a) { return vabsq_f32(a); }
+template<> NC_STRONG_INLINE Packet4i pabs(const Packet4i& a) { return vabsq_s32(a); }
+
+// NEON loads and stores have no alignment constraint
+template<> NC_STRONG_INLINE Packet4f pload<Packet4f>(const float* from) { return vld1q_f32(from); }
+template<> NC_STRONG_INLINE Packet4i pload<Packet4i>(const int*   from) { return vld1q_s32(from); }
+
+template<> NC_STRONG_INLINE Packet4f ploadu<Packet4f>(const float* from) { return vld1q_f32(from); }
+template<> NC_STRONG_INLINE Packet4i ploadu<Packet4i>(const int*   from) { return vld1q_s32(from); }
+
+template<> NC_STRONG_INLINE void pstore<float>(float* to, const Packet4f& from) { vst1q_f32(to, from); }
+template<> NC_STRONG_INLINE void pstore<int>(int*     to, const Packet4i& from) { vst1q_s32(to, from); }
+
+template<> NC_STRONG_INLINE void pstoreu<float>(float* to, const Packet4f& from) { vst1q_f32(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<int>(int*     to, const Packet4i& from) { vst1q_s32(to, from); }
+
+template<> NC_STRONG_INLINE float pfirst<Packet4f>(const Packet4f& a) { return vgetq_lane_f32(a, 0); }
+template<> NC_STRONG_INLINE int   pfirst<Packet4i>(const Packet4i& a) { return vgetq_lane_s32(a, 0); }
+
+template<> NC_STRONG_INLINE float predux<Packet4f>(const Packet4f& a)
+{
+#if NC_ARCH_ARM64
+    return vaddvq_f32(a);
+#else
+    float32x2_t sum = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+    sum = vpadd_f32(sum, sum);
+    return vget_lane_f32(sum, 0);
+#endif
+}
+template<> NC_STRONG_INLINE int predux<Packet4i>(const Packet4i& a)
+{
+#if NC_ARCH_ARM64
+    return vaddvq_s32(a);
+#else
+    int32x2_t sum = vadd_s32(vget_low_s32(a), vget_high_s32(a));
+    sum = vpadd_s32(sum, sum);
+    return vget_lane_s32(sum, 0);
+#endif
+}
+
+
+#if NC_ARCH_ARM64
+
+typedef float64x2_t Packet2d;
+
+template<> struct packet_traits<double> : default_packet_traits
+{
+    typedef Packet2d type;
+    typedef Packet2d half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 2,
+        HasHalfPacket = 0,
+
+        HasDiv  = 1
+    };
+};
+
+template<> struct unpacket_traits<Packet2d> { typedef double type; enum {size=2, alignment=Aligned16}; typedef Packet2d half; };
+
+template<> NC_STRONG_INLINE Packet2d pset1<Packet2d>(const double& from) { return vdupq_n_f64(from); }
+template<> NC_STRONG_INLINE Packet2d padd<Packet2d>(const Packet2d& a, const Packet2d& b) { return vaddq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d psub<Packet2d>(const Packet2d& a, const Packet2d& b) { return vsubq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d pnegate(const Packet2d& a) { return vnegq_f64(a); }
+template<> NC_STRONG_INLINE Packet2d pmul<Packet2d>(const Packet2d& a, const Packet2d& b) { return vmulq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d pdiv<Packet2d>(const Packet2d& a, const Packet2d& b) { return vdivq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d pmadd(const Packet2d& a, const Packet2d& b, const Packet2d& c) { return vfmaq_f64(c,a,b); }
+template<> NC_STRONG_INLINE Packet2d pmin<Packet2d>(const Packet2d& a, const Packet2d& b) { return vminq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d pmax<Packet2d>(const Packet2d& a, const Packet2d& b) { return vmaxq_f64(a,b); }
+template<> NC_STRONG_INLINE Packet2d pabs(const Packet2d& a) { return vabsq_f64(a); }
+template<> NC_STRONG_INLINE Packet2d pload<Packet2d>(const double* from) { return vld1q_f64(from); }
+template<> NC_STRONG_INLINE Packet2d ploadu<Packet2d>(const double* from) { return vld1q_f64(from); }
+template<> NC_STRONG_INLINE void pstore<double>(double* to, const Packet2d& from) { vst1q_f64(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<double>(double* to, const Packet2d& from) { vst1q_f64(to, from); }
+template<> NC_STRONG_INLINE double pfirst<Packet2d>(const Packet2d& a) { return vgetq_lane_f64(a, 0); }
+template<> NC_STRONG_INLINE double predux<Packet2d>(const Packet2d& a) { return vaddvq_f64(a); }
+
+#endif
+
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,33 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_MATH_FUNCTIONS_SSE_H__
+#define __NC_MATH_FUNCTIONS_SSE_H__
+
+NS_INTERNAL_BEGIN
+
+// SSE2 has no rounding instruction
+#ifndef NC_VECTORIZE_SSE4_1
+template<> NC_STRONG_INLINE Packet4f ptrunc<Packet4f>(const Packet4f& a) { return ptrunc_generic(a); }
+template<> NC_STRONG_INLINE Packet2d ptrunc<Packet2d>(const Packet2d& a) { return ptrunc_generic(a); }
+
+template<> NC_STRONG_INLINE Packet4f pfloor<Packet4f>(const Packet4f& a) { return pfloor_generic(a); }
+template<> NC_STRONG_INLINE Packet2d pfloor<Packet2d>(const Packet2d& a) { return pfloor_generic(a); }
+
+template<> NC_STRONG_INLINE Packet4f pceil<Packet4f>(const Packet4f& a) { return pceil_generic(a); }
+template<> NC_STRONG_INLINE Packet2d pceil<Packet2d>(const Packet2d& a) { return pceil_generic(a); }
+#endif
+
+NC_MAKE_PACKET_MATH_FUNCTIONS_FLOAT(Packet4f, Packet2d)
+NC_MAKE_PACKET_MATH_FUNCTIONS_DOUBLE(Packet2d)
+
+NS_INTERNAL_END
+
+#endif
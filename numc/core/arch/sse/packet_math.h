@@ -0,0 +1,303 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PACKET_MATH_SSE_H__
+#define __NC_PACKET_MATH_SSE_H__
+
+NS_INTERNAL_BEGIN
+
+typedef __m128  Packet4f;
+typedef __m128i Packet4i;
+typedef __m128d Packet2d;
+
+// AVX and AVX512 provide wider packets for the same scalar types, the SSE ones are then only
+// used as half packets.
+#ifndef NC_VECTORIZE_AVX
+template<> struct packet_traits<float>  : default_packet_traits
+{
+    typedef Packet4f type;
+    typedef Packet4f half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 4,
+        HasHalfPacket = 0,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 1,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+template<> struct packet_traits<double> : default_packet_traits
+{
+    typedef Packet2d type;
+    typedef Packet2d half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 2,
+        HasHalfPacket = 0,
+
+        HasDiv  = 1,
+        HasSqrt = 1,
+        HasRsqrt = 1,
+        HasExp  = 1,
+        HasLog  = 1,
+        HasLog1p = 1,
+        HasExpm1 = 1,
+        HasSin  = 1,
+        HasCos  = 1,
+        HasTanh = 1,
+        HasErf  = 1,
+        HasPow  = 0,
+        HasRound = 1,
+        HasFloor = 1,
+        HasCeil = 1
+    };
+};
+#endif
+
+#ifndef NC_VECTORIZE_AVX2
+template<> struct packet_traits<int>    : default_packet_traits
+{
+    typedef Packet4i type;
+    typedef Packet4i half;
+    enum {
+        Vectorizable = 1,
+        AlignedOnScalar = 1,
+        size = 4,
+        HasHalfPacket = 0
+    };
+};
+#endif
+
+template<> struct unpacket_traits<Packet4f> { typedef float  type; enum {size=4, alignment=Aligned16}; typedef Packet4f half; };
+template<> struct unpacket_traits<Packet2d> { typedef double type; enum {size=2, alignment=Aligned16}; typedef Packet2d half; };
+template<> struct unpacket_traits<Packet4i> { typedef int    type; enum {size=4, alignment=Aligned16}; typedef Packet4i half; };
+
+
+template<> NC_STRONG_INLINE Packet4f pset1<Packet4f>(const float&  from) { return _mm_set_ps1(from); }
+template<> NC_STRONG_INLINE Packet2d pset1<Packet2d>(const double& from) { return _mm_set1_pd(from); }
+template<> NC_STRONG_INLINE Packet4i pset1<Packet4i>(const int&    from) { return _mm_set1_epi32(from); }
+
+template<> NC_STRONG_INLINE Packet4f padd<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_add_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d padd<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_add_pd(a,b); }
+template<> NC_STRONG_INLINE Packet4i padd<Packet4i>(const Packet4i& a, const Packet4i& b) { return _mm_add_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f psub<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_sub_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d psub<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_sub_pd(a,b); }
+template<> NC_STRONG_INLINE Packet4i psub<Packet4i>(const Packet4i& a, const Packet4i& b) { return _mm_sub_epi32(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pnegate(const Packet4f& a)
+{
+    const Packet4f mask = _mm_castsi128_ps(_mm_setr_epi32(0x80000000,0x80000000,0x80000000,0x80000000));
+    return _mm_xor_ps(a,mask);
+}
+template<> NC_STRONG_INLINE Packet2d pnegate(const Packet2d& a)
+{
+    const Packet2d mask = _mm_castsi128_pd(_mm_setr_epi32(0x0,0x80000000,0x0,0x80000000));
+    return _mm_xor_pd(a,mask);
+}
+template<> NC_STRONG_INLINE Packet4i pnegate(const Packet4i& a)
+{
+    return psub(Packet4i(_mm_setr_epi32(0,0,0,0)), a);
+}
+
+template<> NC_STRONG_INLINE Packet4f pmul<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_mul_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pmul<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_mul_pd(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmul<Packet4i>(const Packet4i& a, const Packet4i& b)
+{
+#ifdef NC_VECTORIZE_SSE4_1
+    return _mm_mullo_epi32(a,b);
+#else
+    // this version is slightly faster than 4 scalar products
+    return _mm_unpacklo_epi32(
+        _mm_shuffle_epi32(_mm_mul_epu32(a,b),_MM_SHUFFLE(0,0,2,0)),
+        _mm_shuffle_epi32(_mm_mul_epu32(_mm_srli_epi64(a,32),_mm_srli_epi64(b,32)),_MM_SHUFFLE(0,0,2,0)));
+#endif
+}
+
+template<> NC_STRONG_INLINE Packet4f pdiv<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_div_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pdiv<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_div_pd(a,b); }
+
+// NC_VECTORIZE_FMA is also set by AVX512F, which does not enable the 128/256 bits FMA encodings
+#ifdef __FMA__
+template<> NC_STRONG_INLINE Packet4f pmadd(const Packet4f& a, const Packet4f& b, const Packet4f& c) { return _mm_fmadd_ps(a,b,c); }
+template<> NC_STRONG_INLINE Packet2d pmadd(const Packet2d& a, const Packet2d& b, const Packet2d& c) { return _mm_fmadd_pd(a,b,c); }
+#endif
+
+template<> NC_STRONG_INLINE Packet4f pmin<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_min_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pmin<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_min_pd(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmin<Packet4i>(const Packet4i& a, const Packet4i& b)
+{
+#ifdef NC_VECTORIZE_SSE4_1
+    return _mm_min_epi32(a,b);
+#else
+    // after some bench, this version *is* faster than a scalar implementation
+    Packet4i mask = _mm_cmplt_epi32(a,b);
+    return _mm_or_si128(_mm_and_si128(mask,a),_mm_andnot_si128(mask,b));
+#endif
+}
+
+template<> NC_STRONG_INLINE Packet4f pmax<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_max_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pmax<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_max_pd(a,b); }
+template<> NC_STRONG_INLINE Packet4i pmax<Packet4i>(const Packet4i& a, const Packet4i& b)
+{
+#ifdef NC_VECTORIZE_SSE4_1
+    return _mm_max_epi32(a,b);
+#else
+    // after some bench, this version *is* faster than a scalar implementation
+    Packet4i mask = _mm_cmpgt_epi32(a,b);
+    return _mm_or_si128(_mm_and_si128(mask,a),_mm_andnot_si128(mask,b));
+#endif
+}
+
+template<> NC_STRONG_INLINE Packet4f pabs(const Packet4f& a)
+{
+    const Packet4f mask = _mm_castsi128_ps(_mm_setr_epi32(0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF,0x7FFFFFFF));
+    return _mm_and_ps(a,mask);
+}
+template<> NC_STRONG_INLINE Packet2d pabs(const Packet2d& a)
+{
+    const Packet2d mask = _mm_castsi128_pd(_mm_setr_epi32(0xFFFFFFFF,0x7FFFFFFF,0xFFFFFFFF,0x7FFFFFFF));
+    return _mm_and_pd(a,mask);
+}
+template<> NC_STRONG_INLINE Packet4i pabs(const Packet4i& a)
+{
+#ifdef NC_VECTORIZE_SSSE3
+    return _mm_abs_epi32(a);
+#else
+    Packet4i aux = _mm_srai_epi32(a,31);
+    return _mm_sub_epi32(_mm_xor_si128(a,aux),aux);
+#endif
+}
+
+template<> NC_STRONG_INLINE Packet4f pand<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_and_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pand<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_and_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f por<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_or_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d por<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_or_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pxor<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_xor_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pxor<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_xor_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pandnot<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_andnot_ps(b,a); }
+template<> NC_STRONG_INLINE Packet2d pandnot<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_andnot_pd(b,a); }
+
+template<> NC_STRONG_INLINE Packet4f pcmp_le<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_cmple_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pcmp_le<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_cmple_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pcmp_lt<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_cmplt_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pcmp_lt<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_cmplt_pd(a,b); }
+
+template<> NC_STRONG_INLINE Packet4f pcmp_eq<Packet4f>(const Packet4f& a, const Packet4f& b) { return _mm_cmpeq_ps(a,b); }
+template<> NC_STRONG_INLINE Packet2d pcmp_eq<Packet2d>(const Packet2d& a, const Packet2d& b) { return _mm_cmpeq_pd(a,b); }
+
+template<> NC_STRONG_INLINE bool predux_any<Packet4f>(const Packet4f& mask) { return _mm_movemask_ps(mask) != 0; }
+template<> NC_STRONG_INLINE bool predux_any<Packet2d>(const Packet2d& mask) { return _mm_movemask_pd(mask) != 0; }
+
+#ifdef NC_VECTORIZE_SSE4_1
+template<> NC_STRONG_INLINE Packet4f pselect<Packet4f>(const Packet4f& mask, const Packet4f& a, const Packet4f& b) { return _mm_blendv_ps(b,a,mask); }
+template<> NC_STRONG_INLINE Packet2d pselect<Packet2d>(const Packet2d& mask, const Packet2d& a, const Packet2d& b) { return _mm_blendv_pd(b,a,mask); }
+#endif
+
+template<int N> NC_STRONG_INLINE Packet4f plogical_shift_left(const Packet4f& a)  { return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(a), N)); }
+template<int N> NC_STRONG_INLINE Packet2d plogical_shift_left(const Packet2d& a)  { return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), N)); }
+template<int N> NC_STRONG_INLINE Packet4f plogical_shift_right(const Packet4f& a) { return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(a), N)); }
+template<int N> NC_STRONG_INLINE Packet2d plogical_shift_right(const Packet2d& a) { return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a), N)); }
+
+template<> NC_STRONG_INLINE Packet4f psqrt<Packet4f>(const Packet4f& a) { return _mm_sqrt_ps(a); }
+template<> NC_STRONG_INLINE Packet2d psqrt<Packet2d>(const Packet2d& a) { return _mm_sqrt_pd(a); }
+
+// without SSE4.1, the rounding functions are emulated in sse/math_functions.h
+#ifdef NC_VECTORIZE_SSE4_1
+template<> NC_STRONG_INLINE Packet4f ptrunc<Packet4f>(const Packet4f& a) { return _mm_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+template<> NC_STRONG_INLINE Packet2d ptrunc<Packet2d>(const Packet2d& a) { return _mm_round_pd(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+
+template<> NC_STRONG_INLINE Packet4f pfloor<Packet4f>(const Packet4f& a) { return _mm_floor_ps(a); }
+template<> NC_STRONG_INLINE Packet2d pfloor<Packet2d>(const Packet2d& a) { return _mm_floor_pd(a); }
+
+template<> NC_STRONG_INLINE Packet4f pceil<Packet4f>(const Packet4f& a) { return _mm_ceil_ps(a); }
+template<> NC_STRONG_INLINE Packet2d pceil<Packet2d>(const Packet2d& a) { return _mm_ceil_pd(a); }
+#endif
+
+/** \internal converts the floats of \a a to the doubles of \a lo (the first half) and \a hi */
+NC_STRONG_INLINE void pwiden(const Packet4f& a, Packet2d& lo, Packet2d& hi)
+{
+    lo = _mm_cvtps_pd(a);
+    hi = _mm_cvtps_pd(_mm_movehl_ps(a,a));
+}
+/** \internal \returns the doubles of \a lo and \a hi rounded to floats, the inverse of pwiden() */
+NC_STRONG_INLINE Packet4f pnarrow(const Packet2d& lo, const Packet2d& hi)
+{
+    return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+template<> NC_STRONG_INLINE Packet4f pload<Packet4f>(const float*   from) { return _mm_load_ps(from); }
+template<> NC_STRONG_INLINE Packet2d pload<Packet2d>(const double*  from) { return _mm_load_pd(from); }
+template<> NC_STRONG_INLINE Packet4i pload<Packet4i>(const int*     from) { return _mm_load_si128(reinterpret_cast<const __m128i*>(from)); }
+
+template<> NC_STRONG_INLINE Packet4f ploadu<Packet4f>(const float*  from) { return _mm_loadu_ps(from); }
+template<> NC_STRONG_INLINE Packet2d ploadu<Packet2d>(const double* from) { return _mm_loadu_pd(from); }
+template<> NC_STRONG_INLINE Packet4i ploadu<Packet4i>(const int*    from) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(from)); }
+
+template<> NC_STRONG_INLINE void pstore<float>(float*   to, const Packet4f& from) { _mm_store_ps(to, from); }
+template<> NC_STRONG_INLINE void pstore<double>(double* to, const Packet2d& from) { _mm_store_pd(to, from); }
+template<> NC_STRONG_INLINE void pstore<int>(int*       to, const Packet4i& from) { _mm_store_si128(reinterpret_cast<__m128i*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstoreu<float>(float*   to, const Packet4f& from) { _mm_storeu_ps(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<double>(double* to, const Packet2d& from) { _mm_storeu_pd(to, from); }
+template<> NC_STRONG_INLINE void pstoreu<int>(int*       to, const Packet4i& from) { _mm_storeu_si128(reinterpret_cast<__m128i*>(to), from); }
+
+template<> NC_STRONG_INLINE void pstream<float>(float*   to, const Packet4f& from) { _mm_stream_ps(to, from); }
+template<> NC_STRONG_INLINE void pstream<double>(double* to, const Packet2d& from) { _mm_stream_pd(to, from); }
+template<> NC_STRONG_INLINE void pstream<int>(int*       to, const Packet4i& from) { _mm_stream_si128(reinterpret_cast<__m128i*>(to), from); }
+
+template<> NC_STRONG_INLINE void prefetch<float>(const float*   addr) { _mm_prefetch((const char*)(addr), _MM_HINT_T0); }
+template<> NC_STRONG_INLINE void prefetch<double>(const double* addr) { _mm_prefetch((const char*)(addr), _MM_HINT_T0); }
+template<> NC_STRONG_INLINE void prefetch<int>(const int*       addr) { _mm_prefetch((const char*)(addr), _MM_HINT_T0); }
+
+template<> NC_STRONG_INLINE float  pfirst<Packet4f>(const Packet4f& a) { return _mm_cvtss_f32(a); }
+template<> NC_STRONG_INLINE double pfirst<Packet2d>(const Packet2d& a) { return _mm_cvtsd_f64(a); }
+template<> NC_STRONG_INLINE int    pfirst<Packet4i>(const Packet4i& a) { return _mm_cvtsi128_si32(a); }
+
+// Folds the upper half onto the lower half until a single scalar remains,
+// which is faster than the SSE3 horizontal adds on most micro-architectures.
+template<> NC_STRONG_INLINE float predux<Packet4f>(const Packet4f& a)
+{
+    Packet4f tmp = _mm_add_ps(a, _mm_movehl_ps(a,a));
+    return pfirst<Packet4f>(_mm_add_ss(tmp, _mm_shuffle_ps(tmp,tmp, 1)));
+}
+template<> NC_STRONG_INLINE double predux<Packet2d>(const Packet2d& a)
+{
+    return pfirst<Packet2d>(_mm_add_sd(a, _mm_unpackhi_pd(a,a)));
+}
+template<> NC_STRONG_INLINE int predux<Packet4i>(const Packet4i& a)
+{
+    Packet4i tmp = _mm_add_epi32(a, _mm_unpackhi_epi64(a,a));
+    return pfirst(tmp) + pfirst<Packet4i>(_mm_shuffle_epi32(tmp, 1));
+}
+
+
+NS_INTERNAL_END
+
+#endif
@@ -19,6 +19,14 @@ template<typename _Scalar>
 struct traits< Array<_Scalar> >
 {
     typedef _Scalar Scalar;
+
+    enum {
+        Flags = LinearAccessBit | DirectAccessBit | NestByRefBit
+              | (packet_traits<_Scalar>::Vectorizable ? PacketAccessBit : 0),
+        Alignment = AlignedMax,
+        SizeAtCompileTime = Dynamic,
+        InnerSizeAtCompileTime = Dynamic
+    };
 };
 
 NS_INTERNAL_END
@@ -26,20 +34,234 @@ NS_INTERNAL_END
 
 NS_BEGIN
 
-template<typename Scalar>
-class Array : public ArrayOp< Array<Scalar> >
+/** \class Array
+  * \ingroup Core_Module
+  *
+  * \brief General-purpose n-dimension array owning its coefficients
+  *
+  * \tparam Scalar the type of the coefficients
+  *
+  * The coefficients are stored contiguously in row-major order inside a DenseStorage, whose buffer
+  * is aligned on NC_MAX_ALIGN_BYTES. Copying an Array duplicates the buffer, moving it steals the
+  * buffer and leaves the source as an empty one-dimension array.
+  */
+template<typename _Scalar>
+class Array : public ArrayOp< Array<_Scalar> >
 {
+public:
+    typedef _Scalar Scalar;
+    typedef DenseStorage<Scalar> Storage;
 
 public:
-    NC_STRONG_INLINE Array(const Shape& shape) : _shape(shape) {}
+    NC_STRONG_INLINE Array() : _shape(0), _storage() {}
+
+    NC_STRONG_INLINE Array(const Shape& shape) : _shape(shape), _storage(shape.size()) {}
+
+    NC_STRONG_INLINE Array(std::initializer_list<Index> shape) : _shape(shape), _storage(_shape.size()) {}
+
+    template <typename T0, typename... T,
+              typename internal::enable_if<internal::is_integral<T0>::value, int>::type = 0>
+    NC_STRONG_INLINE Array(T0 d0, T... shape) : _shape(d0, shape...), _storage(_shape.size()) {}
+
+    NC_STRONG_INLINE Array(const Array& other) : _shape(other._shape), _storage(other._storage) {}
+
+    /** Constructs an Array holding the evaluation of the expression \a other */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE Array(const ArrayOp<OtherDerived>& other) : _shape(other.shape()), _storage(_shape.size())
+    {
+        internal::call_assignment_to_new(*this, other.derived());
+    }
+
+#if NC_HAS_RVALUE_REFERENCES
+    NC_STRONG_INLINE Array(Array&& other) NC_NOEXCEPT
+    : _shape(std::move(other._shape)), _storage(std::move(other._storage))
+    {
+        other._shape = Shape(0);
+    }
+
+    /** Constructs an Array of shape \a shape over the buffer of \a storage, which is left empty.
+      * This is how an Array adopts a buffer it did not allocate, see DenseStorage and load_npy(). */
+    NC_STRONG_INLINE Array(const Shape& shape, Storage&& storage) : _shape(shape), _storage(std::move(storage))
+    {
+        nc_assert(_storage.size() == shape.size());
+    }
+
+    NC_STRONG_INLINE Array& operator=(Array&& other) NC_NOEXCEPT
+    {
+        this->swap(other);
+        return *this;
+    }
+#endif
+
+    NC_STRONG_INLINE Array& operator=(const Array& other)
+    {
+        if (this != &other)
+        {
+            _storage.resize(other.size());
+            internal::smart_copy(other.data(), other.data() + other.size(), data());
+            _shape = other._shape;
+        }
+        return *this;
+    }
+
+    /** Evaluates the expression \a other into *this, *this is resized to the shape of \a other.
+      *
+      * The arrays and views read by \a other are first compared to the buffer of *this. A coefficient-wise
+      * expression reading each coefficient of *this at the position it writes it to, as \c a = \c a + \c b,
+      * is evaluated in a single pass. One reading *this through another layout, as \c a = \c a.transpose()
+      * or a broadcast row of *this, is evaluated into a temporary first. Use noalias() to skip this check.
+      */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE Array& operator=(const ArrayOp<OtherDerived>& other)
+    {
+        internal::call_assignment(*this, other.derived());
+        return *this;
+    }
+
+    /** Resizes *this to \a shape, the coefficients are lost when the size changes. */
+    NC_STRONG_INLINE void resize(const Shape& shape)
+    {
+        _storage.resize(shape.size());
+        _shape = shape;
+    }
+
+    NC_STRONG_INLINE void swap(Array& other)
+    {
+        numext::swap(_shape, other._shape);
+        _storage.swap(other._storage);
+    }
+
+    inline const Shape& shape() const { return _shape; }
+
+    inline Index size() const { return _shape.size(); }
+
+    inline Index dims() const { return _shape.dims(); }
+
+    inline const Scalar* data() const { return _storage.data(); }
+
+    inline Scalar* data() { return _storage.data(); }
+
+    /** \returns the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar& coeff(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _storage.data()[index];
+    }
+
+    /** \returns a reference to the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE Scalar& coeffRef(Index index)
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _storage.data()[index];
+    }
+
+    /** \returns a view of all the coefficients of *this, see ArrayView */
+    inline ArrayView<Scalar> view() { return ArrayView<Scalar>(data(), _shape); }
+
+    inline ArrayView<const Scalar> view() const { return ArrayView<const Scalar>(data(), _shape); }
+
+    /** \returns the row-major contiguous strides of *this */
+    inline Strides strides() const { return Strides(_shape); }
+
+    /** \returns a view of the coefficients selected by \a slices, see ArrayView::slice() */
+    inline ArrayView<Scalar> slice(std::initializer_list<Slice> slices) { return view().slice(slices); }
+
+    inline ArrayView<const Scalar> slice(std::initializer_list<Slice> slices) const { return view().slice(slices); }
+
+    /** \returns a view with the dimensions in reverse order, see ArrayView::transpose() */
+    inline ArrayView<Scalar> transpose() { return view().transpose(); }
+
+    inline ArrayView<const Scalar> transpose() const { return view().transpose(); }
+
+    /** \returns a view with the dimensions permuted by \a axes, see ArrayView::transpose() */
+    inline ArrayView<Scalar> transpose(std::initializer_list<Index> axes) { return view().transpose(axes); }
+
+    inline ArrayView<const Scalar> transpose(std::initializer_list<Index> axes) const { return view().transpose(axes); }
+
+    /** \returns a view of the coefficients with shape \a shape, see ArrayView::reshape() */
+    inline ArrayView<Scalar> reshape(const Shape& shape) { return view().reshape(shape); }
+
+    inline ArrayView<const Scalar> reshape(const Shape& shape) const { return view().reshape(shape); }
+
+    /** \returns a view without the dimensions of extent 1, see ArrayView::squeeze() */
+    inline ArrayView<Scalar> squeeze() { return view().squeeze(); }
+
+    inline ArrayView<const Scalar> squeeze() const { return view().squeeze(); }
+
+    inline ArrayView<Scalar> squeeze(Index axis) { return view().squeeze(axis); }
+
+    inline ArrayView<const Scalar> squeeze(Index axis) const { return view().squeeze(axis); }
+
+    /** \returns a view with a new dimension of extent 1 at \a axis, see ArrayView::expand_dims() */
+    inline ArrayView<Scalar> expand_dims(Index axis) { return view().expand_dims(axis); }
+
+    inline ArrayView<const Scalar> expand_dims(Index axis) const { return view().expand_dims(axis); }
+
+    /** \returns whether the buffer of *this was adopted from elsewhere, e.g. by from_buffer() or load_npy(),
+      * rather than allocated by it */
+    inline bool isExternal() const { return _storage.isExternal(); }
+
+    /** \returns whether from_buffer() adopts the buffer \a data of shape \a shape and strides \a strides as is:
+      * it must be contiguous in row-major order and aligned on NC_MAX_ALIGN_BYTES, as checked at run-time */
+    static bool can_adopt(const Scalar* data, const Shape& shape, const Strides& strides)
+    {
+        return strides == Strides(shape) && internal::is_aligned<NC_MAX_ALIGN_BYTES>(data);
+    }
+
+    /** \returns an Array over the buffer \a data of shape \a shape and strides \a strides, which it releases
+      * by calling \a deleter(data) when it drops it.
+      *
+      * When can_adopt() holds, the buffer is adopted without any copy and the Array enjoys the aligned
+      * vectorized paths as if it had allocated it. Otherwise its coefficients are copied into a new buffer and
+      * \a deleter is called right away: isExternal() on the result tells which way it went. Resizing the Array
+      * also releases the buffer. To read unaligned or strided memory in place, use a Map or an ArrayView.
+      * \code
+      * float* payload = static_cast<float*>(aligned_alloc(64, 1024 * 256 * sizeof(float)));
+      * Array<float> x = Array<float>::from_buffer(payload, Shape(1024, 256), [](float* p) { free(p); });
+      * bool shared = x.isExternal();   // true, payload being aligned on 64 bytes
+      * \endcode
+      *
+      * \sa Map, load_npy()
+      */
+    template<typename Deleter>
+    static Array from_buffer(Scalar* data, const Shape& shape, const Strides& strides, Deleter deleter)
+    {
+        nc_assert(shape.dims() == strides.dims());
+        if (can_adopt(data, shape, strides))
+            return Array(shape, Storage(data, shape.size(), new internal::deleter_buffer<Scalar, Deleter>(data, deleter)));
+
+        Array copy(ArrayView<const Scalar>(data, shape, strides));
+        deleter(data);
+        return copy;
+    }
+
+    template<typename Deleter>
+    static Array from_buffer(Scalar* data, const Shape& shape, Deleter deleter)
+    {
+        return from_buffer(data, shape, Strides(shape), deleter);
+    }
 
-    NC_STRONG_INLINE Array(std::initializer_list<Index>& shape) : _shape(shape) {}
+    /** \returns an Array over the buffer \a data, which remains owned by the caller and must outlive the
+      * Array: it is not released by it. Writes through the Array land in \a data, so the buffer is never
+      * copied: it must satisfy can_adopt(), which is checked at run-time in every build, a std::invalid_argument
+      * being thrown otherwise (the program aborts without exceptions). Use a Map for any other buffer. */
+    static Array from_buffer(Scalar* data, const Shape& shape, const Strides& strides)
+    {
+        if (!can_adopt(data, shape, strides))
+            NC_THROW_X(std::invalid_argument("numc: from_buffer: a buffer owned by the caller must be contiguous "
+                                             "and aligned, use a Map instead"));
+        typedef internal::deleter_buffer<Scalar, internal::no_op_deleter> Owner;
+        return Array(shape, Storage(data, shape.size(), new Owner(data, internal::no_op_deleter())));
+    }
 
-    template <typename... T>
-    NC_STRONG_INLINE Array(T... shape) : _shape(shape...) {}
+    static Array from_buffer(Scalar* data, const Shape& shape)
+    {
+        return from_buffer(data, shape, Strides(shape));
+    }
 
 protected:
     Shape _shape;
+    Storage _storage;
 };
 
 
@@ -11,22 +11,231 @@
 #ifndef __NC_ARRAY_OP_H__
 #define __NC_ARRAY_OP_H__
 
+// Defines METHOD as the coefficient-wise unary operator applying internal::OPNAME to the coefficients of *this.
+#define NC_MAKE_CWISE_UNARY_OP(METHOD, OPNAME) \
+    NC_DEVICE_FUNC NC_STRONG_INLINE \
+    const CwiseUnaryOp<internal::OPNAME<Scalar>, Derived> \
+    METHOD() const \
+    { \
+        return CwiseUnaryOp<internal::OPNAME<Scalar>, Derived>(derived()); \
+    }
+
+// Defines METHOD as the coefficient-wise binary operator applying internal::OPNAME
+// to the coefficients of *this and of \a other.
+#define NC_MAKE_CWISE_BINARY_OP(METHOD, OPNAME) \
+    template<typename OtherDerived> \
+    NC_DEVICE_FUNC NC_STRONG_INLINE \
+    const CwiseBinaryOp<internal::OPNAME<Scalar, typename internal::traits<OtherDerived>::Scalar>, Derived, OtherDerived> \
+    METHOD(const ArrayOp<OtherDerived>& other) const \
+    { \
+        return CwiseBinaryOp<internal::OPNAME<Scalar, typename internal::traits<OtherDerived>::Scalar>, Derived, OtherDerived>(derived(), other.derived()); \
+    }
+
+// Defines METHOD applying internal::OPNAME to the coefficients of *this and to a scalar, on either side,
+// the scalar being turned into a constant expression of the shape of *this.
+#define NC_MAKE_SCALAR_BINARY_OP(METHOD, OPNAME) \
+    NC_DEVICE_FUNC NC_STRONG_INLINE \
+    const CwiseBinaryOp<internal::OPNAME<Scalar, Scalar>, Derived, ConstantReturnType> \
+    METHOD(const Scalar& scalar) const \
+    { \
+        return CwiseBinaryOp<internal::OPNAME<Scalar, Scalar>, Derived, ConstantReturnType>(derived(), constant(scalar)); \
+    } \
+    NC_DEVICE_FUNC friend NC_STRONG_INLINE \
+    const CwiseBinaryOp<internal::OPNAME<Scalar, Scalar>, ConstantReturnType, Derived> \
+    METHOD(const Scalar& scalar, const ArrayOp& a) \
+    { \
+        return CwiseBinaryOp<internal::OPNAME<Scalar, Scalar>, ConstantReturnType, Derived>(a.constant(scalar), a.derived()); \
+    }
+
+
 NS_BEGIN
 
+/** \class ArrayOp
+  * \ingroup Core_Module
+  *
+  * \brief Base class of all array expressions, providing the coefficient-wise operators
+  *
+  * \tparam Derived the derived expression type (CRTP)
+  *
+  * Every operator returns a lightweight expression object, nothing is computed until the expression
+  * is assigned to an Array, at which point the whole expression tree is evaluated in a single loop.
+  */
 template<typename Derived>
 class ArrayOp
 {
 public:
     typedef typename internal::traits<Derived>::Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    typedef CwiseNullaryOp<internal::scalar_constant_op<Scalar>, Array<Scalar> > ConstantReturnType;
 public:
     inline Derived& derived() { return *static_cast<Derived*>(this); }
 
-    template<typename DerivedOther>
-    CwiseBinaryOp<internal::scalar_sum_op<Scalar, Scalar>, Derived, DerivedOther>
-    operator+( DerivedOther& other )
+    inline const Derived& derived() const { return *static_cast<const Derived*>(this); }
+
+    inline const Shape& shape() const { return derived().shape(); }
+
+    inline Index size() const { return derived().shape().size(); }
+
+    inline Index dims() const { return derived().shape().dims(); }
+
+    /** \returns an Array holding the evaluation of this expression.
+      *
+      * Expressions are evaluated lazily, each coefficient being computed when it is read. Calling eval()
+      * on an expensive sub-expression used several times computes it only once.
+      */
+    inline typename internal::plain_array_type<Derived>::type eval() const
+    {
+        return typename internal::plain_array_type<Derived>::type(derived());
+    }
+
+    /** \returns a pseudo expression of *this whose operator= skips the alias analysis, see class NoAlias.
+      *
+      * Only arrays and writable views can be assigned to. */
+    inline NoAlias<Derived> noalias()
+    {
+        NC_STATIC_ASSERT((internal::traits<Derived>::Flags & DirectAccessBit) != 0, "noalias() needs an Array, a FixedArray or an ArrayView")
+        return NoAlias<Derived>(derived());
+    }
+
+    NC_MAKE_CWISE_UNARY_OP(operator-, scalar_opposite_op)
+
+    /** \returns an expression of the coefficient-wise sum of *this and \a other, a fused multiply-add when a side
+      * is a coefficient-wise product, see internal::cwise_sum_return_type */
+    template<typename OtherDerived>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    const typename internal::cwise_sum_return_type<Derived, OtherDerived>::type
+    operator+(const ArrayOp<OtherDerived>& other) const
+    {
+        return internal::cwise_sum_return_type<Derived, OtherDerived>::make(derived(), other.derived());
+    }
+
+    NC_MAKE_CWISE_BINARY_OP(operator-, scalar_difference_op)
+
+    NC_MAKE_CWISE_BINARY_OP(operator*, scalar_product_op)
+
+    NC_MAKE_CWISE_BINARY_OP(operator/, scalar_quotient_op)
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    const typename internal::cwise_sum_return_type<Derived, ConstantReturnType>::type
+    operator+(const Scalar& scalar) const
+    {
+        return internal::cwise_sum_return_type<Derived, ConstantReturnType>::make(derived(), constant(scalar));
+    }
+
+    NC_DEVICE_FUNC friend NC_STRONG_INLINE
+    const typename internal::cwise_sum_return_type<ConstantReturnType, Derived>::type
+    operator+(const Scalar& scalar, const ArrayOp& a)
+    {
+        return internal::cwise_sum_return_type<ConstantReturnType, Derived>::make(a.constant(scalar), a.derived());
+    }
+
+    NC_MAKE_SCALAR_BINARY_OP(operator-, scalar_difference_op)
+
+    NC_MAKE_SCALAR_BINARY_OP(operator*, scalar_product_op)
+
+    NC_MAKE_SCALAR_BINARY_OP(operator/, scalar_quotient_op)
+
+    // coefficient-wise math functions, vectorized for float and double with the errors listed in
+    // arch/generic_packet_math_functions.h
+
+    NC_MAKE_CWISE_UNARY_OP(abs, scalar_abs_op)
+
+    /** \returns an expression of the squared absolute value |x|^2 of each coefficient x, real for complex ones */
+    NC_MAKE_CWISE_UNARY_OP(abs2, scalar_abs2_op)
+
+    NC_MAKE_CWISE_UNARY_OP(sqrt, scalar_sqrt_op)
+
+    /** \returns an expression of 1 / sqrt(x) for each coefficient x */
+    NC_MAKE_CWISE_UNARY_OP(rsqrt, scalar_rsqrt_op)
+
+    NC_MAKE_CWISE_UNARY_OP(exp, scalar_exp_op)
+
+    NC_MAKE_CWISE_UNARY_OP(log, scalar_log_op)
+
+    /** \returns an expression of log(1 + x) for each coefficient x, accurate for small x */
+    NC_MAKE_CWISE_UNARY_OP(log1p, scalar_log1p_op)
+
+    /** \returns an expression of exp(x) - 1 for each coefficient x, accurate for small x */
+    NC_MAKE_CWISE_UNARY_OP(expm1, scalar_expm1_op)
+
+    NC_MAKE_CWISE_UNARY_OP(sin, scalar_sin_op)
+
+    NC_MAKE_CWISE_UNARY_OP(cos, scalar_cos_op)
+
+    NC_MAKE_CWISE_UNARY_OP(tanh, scalar_tanh_op)
+
+    /** \returns an expression of the logistic sigmoid 1 / (1 + exp(-x)) of each coefficient x */
+    NC_MAKE_CWISE_UNARY_OP(sigmoid, scalar_sigmoid_op)
+
+    NC_MAKE_CWISE_UNARY_OP(erf, scalar_erf_op)
+
+    NC_MAKE_CWISE_UNARY_OP(floor, scalar_floor_op)
+
+    NC_MAKE_CWISE_UNARY_OP(ceil, scalar_ceil_op)
+
+    /** \returns an expression of the coefficients rounded to the nearest integer, halfway cases away from zero */
+    NC_MAKE_CWISE_UNARY_OP(round, scalar_round_op)
+
+    /** \returns an expression of the coefficients raised to the power \a exponent */
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    const CwiseUnaryOp<internal::scalar_pow_op<Scalar>, Derived> pow(const Scalar& exponent) const
+    {
+        return CwiseUnaryOp<internal::scalar_pow_op<Scalar>, Derived>(derived(), internal::scalar_pow_op<Scalar>(exponent));
+    }
+
+    /** \returns an expression of the shape of *this whose coefficients are all \a value */
+    NC_DEVICE_FUNC NC_STRONG_INLINE ConstantReturnType constant(const Scalar& value) const
     {
-        return CwiseBinaryOp<internal::scalar_sum_op<Scalar, Scalar>, Derived, DerivedOther>(derived(), other.derived());
+        return ConstantReturnType(shape(), internal::scalar_constant_op<Scalar>(value));
     }
+
+    // reductions of all the coefficients, see redux.h
+
+    template<typename Func>
+    Scalar redux(const Func& func) const;
+
+    Scalar sum() const;
+
+    Scalar prod() const;
+
+    Scalar min() const;
+
+    Scalar max() const;
+
+    Scalar mean() const;
+
+    RealScalar var() const;
+
+    RealScalar norm() const;
+
+    Index argmin() const;
+
+    Index argmax() const;
+
+    // reductions along some axes, see partial_redux.h
+
+    Array<Scalar> sum(std::initializer_list<Index> axes) const;
+
+    Array<Scalar> prod(std::initializer_list<Index> axes) const;
+
+    Array<Scalar> min(std::initializer_list<Index> axes) const;
+
+    Array<Scalar> max(std::initializer_list<Index> axes) const;
+
+    Array<Scalar> mean(std::initializer_list<Index> axes) const;
+
+    Array<RealScalar> var(std::initializer_list<Index> axes) const;
+
+    Array<RealScalar> norm(std::initializer_list<Index> axes) const;
+
+    Array<Index> argmin(Index axis) const;
+
+    Array<Index> argmax(Index axis) const;
+
+    // matrix product, see products/matmul.h
+
+    template<typename OtherDerived>
+    Array<Scalar> matmul(const ArrayOp<OtherDerived>& other) const;
 };
 
 NS_END
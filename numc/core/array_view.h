@@ -0,0 +1,398 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_ARRAY_VIEW_H__
+#define __NC_ARRAY_VIEW_H__
+
+
+NS_INTERNAL_BEGIN
+
+template<typename _Scalar>
+struct traits< ArrayView<_Scalar> >
+{
+    typedef typename remove_const<_Scalar>::type Scalar;
+
+    // The strides are only known at run-time, so a view can neither be linearized nor assumed aligned.
+    // Packets are read along the last dimension, when its stride turns out to be 1.
+    enum {
+        Flags = DirectAccessBit
+              | (packet_traits<Scalar>::Vectorizable ? PacketAccessBit : 0),
+        Alignment = Unaligned,
+        SizeAtCompileTime = Dynamic,
+        InnerSizeAtCompileTime = Dynamic
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class Slice
+  * \ingroup Core_Module
+  *
+  * \brief numpy-like start:stop:step range of indices along one dimension
+  *
+  * Negative start and stop count from the end of the dimension, out of range values are clamped, and a
+  * negative step walks the dimension backward. Slice::None stands for an omitted start or stop:
+  * \code
+  * a.slice({{1, 5}, {}})                         // a[1:5, :]
+  * a.slice({{}, {Slice::None, Slice::None, -1}})  // a[:, ::-1]
+  * a.slice({{Slice::None, -1, 2}})               // a[:-1:2]
+  * \endcode
+  */
+struct Slice
+{
+    static const Index None = (std::numeric_limits<Index>::min)();
+
+    Slice() : start(None), stop(None), step(1) {}
+
+    Slice(Index start, Index stop, Index step = 1) : start(start), stop(stop), step(step)
+    {
+        nc_assert(step != 0);
+    }
+
+    Index start;
+    Index stop;
+    Index step;
+};
+
+
+/** \class ArrayView
+  * \ingroup Core_Module
+  *
+  * \brief Non-owning n-dimension array over an existing buffer, with arbitrary strides
+  *
+  * \tparam _Scalar the type of the coefficients, const qualified for a read-only view
+  *
+  * An ArrayView is a pointer to its first coefficient together with a Shape and a Strides. Slicing,
+  * transposing, reshaping, squeezing and expanding dimensions only compute new metadata over the same
+  * buffer, they never copy nor allocate. Like a pointer, a view must not outlive the buffer it refers to.
+  *
+  * Copying an ArrayView copies the view itself, while assigning to it writes the coefficients of the right
+  * hand side into the viewed buffer:
+  * \code
+  * Array<float> batch(1024, 64);
+  * ArrayView<float> mini = batch.slice({{0, 32}});   // no copy
+  * mini = mini * mini;                              // writes into batch
+  * Array<float> t = batch.transpose();              // copies into a new array
+  * \endcode
+  */
+template<typename _Scalar>
+class ArrayView : public ArrayOp< ArrayView<_Scalar> >
+{
+public:
+    typedef typename internal::traits<ArrayView>::Scalar Scalar;
+    typedef _Scalar* PointerType;
+
+public:
+    /** Constructs a view of the contiguous row-major array of shape \a shape starting at \a data */
+    NC_STRONG_INLINE ArrayView(PointerType data, const Shape& shape) : _data(data), _shape(shape), _strides(shape) {}
+
+    NC_STRONG_INLINE ArrayView(PointerType data, const Shape& shape, const Strides& strides)
+    : _data(data), _shape(shape), _strides(strides)
+    {
+        nc_assert(shape.dims() == strides.dims());
+    }
+
+    NC_STRONG_INLINE ArrayView(const ArrayView& other) : _data(other._data), _shape(other._shape), _strides(other._strides) {}
+
+    /** Converts a mutable view into a read-only one */
+    template<typename OtherScalar>
+    NC_STRONG_INLINE ArrayView(const ArrayView<OtherScalar>& other,
+                               typename internal::enable_if<internal::is_same<_Scalar, const OtherScalar>::value, int>::type = 0)
+    : _data(other.data()), _shape(other.shape()), _strides(other.strides()) {}
+
+    /** Copies the coefficients of \a other into the viewed buffer, both views must have the same shape.
+      * Overlapping views are copied through a temporary, see operator=(const ArrayOp<OtherDerived>&). */
+    NC_STRONG_INLINE ArrayView& operator=(const ArrayView& other)
+    {
+        NC_STATIC_ASSERT(!internal::is_const<_Scalar>::value, "Cannot assign to a read-only ArrayView")
+        internal::call_assignment(*this, other);
+        return *this;
+    }
+
+    /** Evaluates the expression \a other into the viewed buffer, which is never resized:
+      * \a other must have the shape of *this.
+      *
+      * When \a other reads the viewed buffer through another layout, e.g. \c v = \c v.transpose() or an
+      * overlapping slice, it is evaluated into a temporary first. Use noalias() to skip this check. */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE ArrayView& operator=(const ArrayOp<OtherDerived>& other)
+    {
+        NC_STATIC_ASSERT(!internal::is_const<_Scalar>::value, "Cannot assign to a read-only ArrayView")
+        internal::call_assignment(*this, other.derived());
+        return *this;
+    }
+
+    inline const Shape& shape() const { return _shape; }
+
+    inline const Strides& strides() const { return _strides; }
+
+    inline Index size() const { return _shape.size(); }
+
+    inline Index dims() const { return _shape.dims(); }
+
+    /** \returns the address of the first coefficient */
+    inline PointerType data() const { return _data; }
+
+    /** \returns the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar& coeff(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _data[offset(index)];
+    }
+
+    /** \returns a reference to the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE _Scalar& coeffRef(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _data[offset(index)];
+    }
+
+    /** \returns whether the coefficients are laid out as in a row-major Array of the same shape */
+    bool is_contiguous() const
+    {
+        Index stride = 1;
+        for(Index i=dims()-1; i>=0; --i)
+        {
+            if(_shape[i] != 1 && _strides[i] != stride) return false;
+            stride *= _shape[i];
+        }
+        return true;
+    }
+
+    /** \returns the view of the coefficients selected by \a slices, the i-th slice applying to the i-th
+      * dimension. Missing trailing slices select whole dimensions, as in numpy. */
+    ArrayView slice(std::initializer_list<Slice> slices) const
+    {
+        nc_assert(Index(slices.size()) <= dims());
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        PointerType data = _data;
+
+        Index i = 0;
+        for(auto it = slices.begin(); it != slices.end(); ++it, ++i)
+        {
+            Index start, len;
+            normalize_slice(*it, _shape[i], start, len);
+            if(len > 0) data += start * _strides[i];
+            extents[i] = len;
+            strides[i] = _strides[i] * it->step;
+        }
+        for(; i<dims(); ++i)
+        {
+            extents[i] = _shape[i];
+            strides[i] = _strides[i];
+        }
+        return ArrayView(data, Shape(extents, dims()), Strides(strides, dims()));
+    }
+
+    /** \returns the view with the dimensions in reverse order */
+    ArrayView transpose() const
+    {
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        for(Index i=0; i<dims(); ++i)
+        {
+            extents[i] = _shape[dims()-1-i];
+            strides[i] = _strides[dims()-1-i];
+        }
+        return ArrayView(_data, Shape(extents, dims()), Strides(strides, dims()));
+    }
+
+    /** \returns the view whose i-th dimension is the dimension \a axes[i] of *this */
+    ArrayView transpose(std::initializer_list<Index> axes) const
+    {
+        nc_assert(Index(axes.size()) == dims());
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        Index i = 0;
+        for(auto it = axes.begin(); it != axes.end(); ++it, ++i)
+        {
+            const Index axis = *it < 0 ? *it + dims() : *it;
+            nc_assert(axis >= 0 && axis < dims());
+            extents[i] = _shape[axis];
+            strides[i] = _strides[axis];
+        }
+        return ArrayView(_data, Shape(extents, dims()), Strides(strides, dims()));
+    }
+
+    /** \returns the view of the same coefficients with shape \a shape, in row-major order.
+      *
+      * No copy is ever made, so the strides of *this must allow it: a contiguous view can take any shape
+      * of the same size, a strided one can only split or merge dimensions which are contiguous with
+      * each other (the rules of numpy's no-copy reshape).
+      */
+    ArrayView reshape(const Shape& shape) const
+    {
+        nc_assert(shape.size() == size());
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        const bool viewable = reshape_strides(shape, strides);
+        nc_assert(viewable && "reshape of a strided ArrayView would require a copy");
+        NC_UNUSED_VARIABLE(viewable);
+        return ArrayView(_data, shape, Strides(strides, shape.dims()));
+    }
+
+    /** \returns the view without the dimensions of extent 1 */
+    ArrayView squeeze() const
+    {
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        Index n = 0;
+        for(Index i=0; i<dims(); ++i)
+        {
+            if(_shape[i] == 1) continue;
+            extents[n] = _shape[i];
+            strides[n] = _strides[i];
+            ++n;
+        }
+        return ArrayView(_data, Shape(extents, n), Strides(strides, n));
+    }
+
+    /** \returns the view without the dimension \a axis, which must have an extent of 1 */
+    ArrayView squeeze(Index axis) const
+    {
+        if(axis < 0) axis += dims();
+        nc_assert(axis >= 0 && axis < dims() && _shape[axis] == 1);
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        for(Index i=0, n=0; i<dims(); ++i)
+        {
+            if(i == axis) continue;
+            extents[n] = _shape[i];
+            strides[n] = _strides[i];
+            ++n;
+        }
+        return ArrayView(_data, Shape(extents, dims()-1), Strides(strides, dims()-1));
+    }
+
+    /** \returns the view with a new dimension of extent 1 inserted at position \a axis */
+    ArrayView expand_dims(Index axis) const
+    {
+        if(axis < 0) axis += dims() + 1;
+        nc_assert(axis >= 0 && axis <= dims() && dims() < Index(MAX_ARRAY_DIMENSIONS));
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        for(Index i=0, n=0; i<=dims(); ++i)
+        {
+            if(i == axis)
+            {
+                // the stride of an extent 1 dimension is never used, this one keeps the view contiguous
+                extents[i] = 1;
+                strides[i] = axis < dims() ? _strides[axis] * _shape[axis] : 1;
+                continue;
+            }
+            extents[i] = _shape[n];
+            strides[i] = _strides[n];
+            ++n;
+        }
+        return ArrayView(_data, Shape(extents, dims()+1), Strides(strides, dims()+1));
+    }
+
+protected:
+    /** \internal \returns the offset of the coefficient at the linear (row-major) \a index from data() */
+    NC_STRONG_INLINE Index offset(Index index) const
+    {
+        return internal::unravel_offset(index, _shape.data(), _strides.data(), dims());
+    }
+
+    /** \internal resolves \a s against a dimension of extent \a n, as numpy's slice.indices() does */
+    static void normalize_slice(const Slice& s, Index n, Index& start, Index& len)
+    {
+        if(s.step > 0)
+        {
+            start = s.start == Slice::None ? 0 : s.start;
+            Index stop = s.stop == Slice::None ? n : s.stop;
+            if(start < 0) start += n;
+            if(stop < 0) stop += n;
+            start = numext::mini(numext::maxi(start, Index(0)), n);
+            stop = numext::mini(numext::maxi(stop, Index(0)), n);
+            len = stop > start ? (stop - start - 1) / s.step + 1 : 0;
+        }
+        else
+        {
+            start = s.start == Slice::None ? n-1 : s.start;
+            Index stop = s.stop == Slice::None ? Index(-1) : s.stop;
+            if(start < 0) start += n;
+            if(s.stop != Slice::None && stop < 0) stop += n;
+            start = numext::mini(numext::maxi(start, Index(-1)), n-1);
+            stop = numext::mini(numext::maxi(stop, Index(-1)), n-1);
+            len = start > stop ? (start - stop - 1) / (-s.step) + 1 : 0;
+        }
+    }
+
+    /** \internal computes in \a strides the strides giving the coefficients of *this the shape \a shape,
+      * \returns false when they do not exist */
+    bool reshape_strides(const Shape& shape, Index* strides) const
+    {
+        const Index newDims = shape.dims();
+        if(size() == 0 || is_contiguous())
+        {
+            Strides contiguous(shape);
+            for(Index i=0; i<newDims; ++i) strides[i] = contiguous[i];
+            return true;
+        }
+
+        // dimensions of extent 1 do not constrain the layout
+        Index oldExtents[MAX_ARRAY_DIMENSIONS];
+        Index oldStrides[MAX_ARRAY_DIMENSIONS];
+        Index oldDims = 0;
+        for(Index i=0; i<dims(); ++i)
+        {
+            if(_shape[i] == 1) continue;
+            oldExtents[oldDims] = _shape[i];
+            oldStrides[oldDims] = _strides[i];
+            ++oldDims;
+        }
+
+        // group the old and the new dimensions into runs of equal sizes, a run of old dimensions
+        // must be contiguous to be split into the new ones
+        Index oi = 0, oj = 1, ni = 0, nj = 1;
+        while(ni < newDims && oi < oldDims)
+        {
+            Index np = shape[ni];
+            Index op = oldExtents[oi];
+            while(np != op)
+            {
+                if(np < op) np *= shape[nj++];
+                else        op *= oldExtents[oj++];
+            }
+
+            for(Index ok = oi; ok < oj-1; ++ok)
+            {
+                if(oldStrides[ok] != oldExtents[ok+1] * oldStrides[ok+1]) return false;
+            }
+
+            strides[nj-1] = oldStrides[oj-1];
+            for(Index nk = nj-1; nk > ni; --nk)
+                strides[nk-1] = strides[nk] * shape[nk];
+
+            ni = nj++;
+            oi = oj++;
+        }
+
+        // trailing dimensions of extent 1
+        const Index lastStride = ni >= 1 ? strides[ni-1] : 1;
+        for(Index nk = ni; nk < newDims; ++nk)
+            strides[nk] = lastStride;
+        return true;
+    }
+
+protected:
+    PointerType _data;
+    Shape _shape;
+    Strides _strides;
+};
+
+
+NS_END
+
+#endif
@@ -0,0 +1,119 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_BROADCASTING_H__
+#define __NC_BROADCASTING_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * Computes in \a result the shape two operands of shapes \a a and \a b are broadcast to, following the
+  * numpy rules: the shapes are aligned on their last dimension, and two extents are compatible when they
+  * are equal or when one of them is 1 (missing leading dimensions count as 1).
+  * \returns false when the shapes are not compatible
+  */
+inline bool broadcast_shapes(const Shape& a, const Shape& b, Shape& result)
+{
+    const Index dims = numext::maxi(a.dims(), b.dims());
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    for(Index i=0; i<dims; ++i)
+    {
+        const Index ia = i - (dims - a.dims());
+        const Index ib = i - (dims - b.dims());
+        const Index ea = ia < 0 ? 1 : a[ia];
+        const Index eb = ib < 0 ? 1 : b[ib];
+        if(ea != eb && ea != 1 && eb != 1) return false;
+        extents[i] = ea == 1 ? eb : ea;
+    }
+    result = Shape(extents, dims);
+    return true;
+}
+
+
+/** \internal
+  * \class broadcast_mapper
+  *
+  * \brief Maps the (outer, inner) indices of a broadcast shape back to the ones of an operand
+  *
+  * The operand is virtually expanded with a stride of zero along each broadcast dimension, so it is never
+  * materialized. The kind of broadcast is resolved once, when the evaluator is built, such that the common
+  * cases cost nothing in the inner loop:
+  *  \li inner broadcast (a column, or a scalar), the operand is constant along a slice and is read once per slice,
+  *  \li outer broadcast of a row, the same operand slice is read again for every outer index and stays in cache,
+  *  \li the leading dimensions are only unraveled for the general case.
+  *
+  * An inactive mapper (the default, or an operand having the size of the target) is the identity.
+  */
+class broadcast_mapper
+{
+public:
+    enum OuterKind {
+        IdentityOuter,
+        ZeroOuter,
+        GeneralOuter
+    };
+
+    broadcast_mapper() : _active(false), _innerBroadcast(false), _outerKind(IdentityOuter) {}
+
+    broadcast_mapper(const Shape& shape, const Shape& target)
+    : _active(shape.size() != target.size()), _innerBroadcast(false), _outerKind(IdentityOuter)
+    {
+        // with equal sizes, every broadcast dimension has an extent of 1 in the target too,
+        // so that the row-major indices of both shapes are the same
+        if(!_active) return;
+
+        const Index dims = target.dims();
+        const Index offset = dims - shape.dims();
+        _innerBroadcast = inner_size(shape) == 1 && inner_size(target) != 1;
+
+        // strides of the leading dimensions, in units of the operand outer index
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index strides[MAX_ARRAY_DIMENSIONS];
+        Index stride = 1, targetStride = 1;
+        bool zero = true, identity = true;
+        for(Index i=dims-2; i>=0; --i)
+        {
+            const Index j = i - offset;
+            extents[i] = target[i];
+            strides[i] = (j < 0 || shape[j] == 1) ? 0 : stride;
+            if(j >= 0) stride *= shape[j];
+            zero = zero && (strides[i] == 0 || target[i] == 1);
+            identity = identity && (strides[i] == targetStride || target[i] == 1);
+            targetStride *= target[i];
+        }
+        _outerKind = identity ? IdentityOuter : zero ? ZeroOuter : GeneralOuter;
+        _outerShape = Shape(extents, numext::maxi(dims-1, Index(0)));
+        _outerStrides = Strides(strides, numext::maxi(dims-1, Index(0)));
+    }
+
+    NC_STRONG_INLINE bool active() const { return _active; }
+
+    NC_STRONG_INLINE bool innerBroadcast() const { return _innerBroadcast; }
+
+    NC_STRONG_INLINE Index outer(Index outer) const
+    {
+        if(_outerKind == IdentityOuter) return outer;
+        if(_outerKind == ZeroOuter) return 0;
+        return unravel_offset(outer, _outerShape.data(), _outerStrides.data(), _outerShape.dims());
+    }
+
+    NC_STRONG_INLINE Index inner(Index inner) const { return _innerBroadcast ? 0 : inner; }
+
+protected:
+    bool _active;
+    bool _innerBroadcast;
+    int _outerKind;
+    Shape _outerShape;
+    Strides _outerStrides;
+};
+
+NS_INTERNAL_END
+
+#endif
@@ -6,7 +6,13 @@
 #include "utils/disable_stupid_warnings.h"
 
 // standard libaraies
+#include <cmath>
 #include <complex>
+#include <new>
+#include <stdexcept>
+#include <initializer_list>
+#include <utility>
+#include <atomic>
 
 // utils
 #include "utils/macros/macros.h"
@@ -14,15 +20,94 @@
 #include "utils/meta.h"
 #include "utils/forward_declarations.h"
 #include "utils/xpr_helper.h"
+#include "utils/memory.h"
+
+// pooled buffers of the arrays
+#ifdef NC_USE_BUFFER_POOL
+  #include <mutex>
+  #include "utils/buffer_pool.h"
+#endif
 
 #include "num_traits.h"
 
+// cache sizes queried by the products and the assignments
+#if NC_OS_LINUX
+  #include <unistd.h>
+#endif
+#include "utils/cache_sizes.h"
+
+// cpu features probed by the runtime dispatch
+#ifdef NC_RUNTIME_DISPATCH
+  #if NC_ARCH_i386_OR_x86_64 && NC_COMP_MSVC
+    #include <intrin.h>
+  #elif NC_ARCH_i386_OR_x86_64
+    #include <cpuid.h>
+  #endif
+  #include "utils/cpuid.h"
+#endif
+
+// packet math
+#include "arch/generic_packet_math.h"
+#if defined NC_VECTORIZE_AVX512
+  #include "arch/sse/packet_math.h"
+  #include "arch/avx/packet_math.h"
+  #include "arch/avx512/packet_math.h"
+#elif defined NC_VECTORIZE_AVX
+  #include "arch/sse/packet_math.h"
+  #include "arch/avx/packet_math.h"
+#elif defined NC_VECTORIZE_SSE
+  #include "arch/sse/packet_math.h"
+#elif defined NC_VECTORIZE_NEON
+  #include "arch/neon/packet_math.h"
+#endif
+
+#include "arch/generic_packet_math_functions.h"
+#if defined NC_VECTORIZE_AVX512
+  #include "arch/sse/math_functions.h"
+  #include "arch/avx/math_functions.h"
+  #include "arch/avx512/math_functions.h"
+#elif defined NC_VECTORIZE_AVX
+  #include "arch/sse/math_functions.h"
+  #include "arch/avx/math_functions.h"
+#elif defined NC_VECTORIZE_SSE
+  #include "arch/sse/math_functions.h"
+#endif
+
+// threading
+#ifdef NC_PARALLELIZE
+  #include <cstdint>
+  #include <vector>
+  #include <thread>
+  #include <mutex>
+  #include <condition_variable>
+  #include "threading/thread_pool.h"
+#endif
+#include "threading/parallelizer.h"
+
+// external BLAS
+#ifdef NC_USE_BLAS
+  #include <climits>
+  #include NC_BLAS_HEADER
+#endif
+
 // core modules
 #include "shape.h"
+#include "strides.h"
+#include "broadcasting.h"
+#include "dense_storage.h"
 #include "functors/functors.h"
 #include "array_op.h"
 #include "ops/ops.h"
+#include "aliasing.h"
+#include "evaluators/evaluators.h"
+#include "no_alias.h"
+#include "array_view.h"
 #include "array.h"
+#include "fixed_array.h"
+#include "map.h"
+#include "redux.h"
+#include "partial_redux.h"
+#include "products/products.h"
 
 
 
@@ -0,0 +1,234 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_DENSE_STORAGE_H__
+#define __NC_DENSE_STORAGE_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns in \c value the largest alignment, bounded by NC_MAX_STATIC_ALIGN_BYTES, on which an array
+  * of \a Bytes bytes may be aligned without padding it, 0 when it is not worth aligning */
+template<int Bytes>
+struct compute_fixed_alignment
+{
+    enum {
+        value = (NC_MAX_STATIC_ALIGN_BYTES >= 64 && Bytes % 64 == 0) ? 64
+              : (NC_MAX_STATIC_ALIGN_BYTES >= 32 && Bytes % 32 == 0) ? 32
+              : (NC_MAX_STATIC_ALIGN_BYTES >= 16 && Bytes % 16 == 0) ? 16
+              : 0
+    };
+};
+
+/** \internal
+  * \brief Static array of \a Size coefficients aligned on \a Alignment bytes, the storage of FixedArray
+  *
+  * The alignment attribute needs a literal on some compilers, hence one specialization per alignment.
+  */
+template <typename T, int Size, int Alignment = compute_fixed_alignment<Size * int(sizeof(T))>::value>
+struct plain_array
+{
+    T array[Size];
+};
+
+template <typename T, int Size>
+struct plain_array<T, Size, 16>
+{
+    NC_ALIGN_TO_BOUNDARY(16) T array[Size];
+};
+
+template <typename T, int Size>
+struct plain_array<T, Size, 32>
+{
+    NC_ALIGN_TO_BOUNDARY(32) T array[Size];
+};
+
+template <typename T, int Size>
+struct plain_array<T, Size, 64>
+{
+    NC_ALIGN_TO_BOUNDARY(64) T array[Size];
+};
+
+/** \internal Allocates the buffer of a DenseStorage, from the buffer_pool when NC_USE_BUFFER_POOL is defined */
+template<typename T> NC_DEVICE_FUNC inline T* dense_storage_new(Index size)
+{
+#ifdef NC_USE_BUFFER_POOL
+    return pooled_new_auto<T>(std::size_t(size));
+#else
+    return conditional_aligned_new_auto<T,true>(std::size_t(size));
+#endif
+}
+
+template<typename T> NC_DEVICE_FUNC inline void dense_storage_delete(T* ptr, Index size)
+{
+#ifdef NC_USE_BUFFER_POOL
+    pooled_delete_auto<T>(ptr, std::size_t(size));
+#else
+    conditional_aligned_delete_auto<T,true>(ptr, std::size_t(size));
+#endif
+}
+
+/** \internal
+  * \brief Owner of a buffer adopted by a DenseStorage instead of being allocated by it, e.g. a file mapping
+  *
+  * The storage deletes its owner when it drops the buffer, the destructor of the derived class releases it.
+  */
+struct external_buffer
+{
+    virtual ~external_buffer() {}
+};
+
+/** \internal A buffer released by calling \a Deleter on it, see Array::from_buffer() */
+template<typename T, typename Deleter>
+struct deleter_buffer : public external_buffer
+{
+    deleter_buffer(T* data, const Deleter& deleter) : data(data), deleter(deleter) {}
+    ~deleter_buffer() { deleter(data); }
+
+    T* data;
+    Deleter deleter;
+};
+
+/** \internal The deleter of a buffer which is not owned: it is never released */
+struct no_op_deleter
+{
+    template<typename T> void operator()(T*) const {}
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \internal
+  * \class DenseStorage
+  * \ingroup Core_Module
+  *
+  * \brief Owning, heap allocated and aligned buffer of \a T used as the data of Array
+  *
+  * The buffer is obtained through internal::conditional_aligned_new_auto, hence it is aligned on
+  * NC_MAX_ALIGN_BYTES (64 bytes when AVX512 is enabled) so that packet loads never split a cache line.
+  * With NC_USE_BUFFER_POOL, it is recycled through internal::buffer_pool instead, see BufferPool.
+  * Copying duplicates the buffer, moving steals it and leaves the source empty.
+  *
+  * A storage may also adopt a buffer it did not allocate, together with the internal::external_buffer that
+  * releases it, as load_npy() does with a file mapping and Array::from_buffer() with a deleter. Such a buffer
+  * is dropped by deleting its owner, and replaced by an allocated one when the storage is resized.
+  */
+template<typename T>
+class DenseStorage
+{
+public:
+    NC_DEVICE_FUNC
+    NC_STRONG_INLINE DenseStorage() : _data(0), _size(0), _owner(0) {}
+
+    NC_DEVICE_FUNC
+    explicit DenseStorage(Index size)
+    : _data(internal::dense_storage_new<T>(size)), _size(size), _owner(0)
+    {
+        nc_assert(size >= 0);
+    }
+
+    /** Adopts the buffer \a data of \a size coefficients, released by deleting \a owner. The buffer must be
+      * aligned on NC_MAX_ALIGN_BYTES and hold constructed coefficients. */
+    NC_DEVICE_FUNC
+    DenseStorage(T* data, Index size, internal::external_buffer* owner)
+    : _data(data), _size(size), _owner(owner)
+    {
+        nc_assert(size >= 0 && owner != 0);
+        nc_assert(internal::is_aligned<NC_MAX_ALIGN_BYTES>(data));
+    }
+
+    NC_DEVICE_FUNC
+    DenseStorage(const DenseStorage& other)
+    : _data(internal::dense_storage_new<T>(other._size)), _size(other._size), _owner(0)
+    {
+        internal::smart_copy(other._data, other._data+other._size, _data);
+    }
+
+#if NC_HAS_RVALUE_REFERENCES
+    NC_DEVICE_FUNC
+    DenseStorage(DenseStorage&& other) NC_NOEXCEPT
+    : _data(other._data), _size(other._size), _owner(other._owner)
+    {
+        other._data = 0;
+        other._size = 0;
+        other._owner = 0;
+    }
+
+    NC_DEVICE_FUNC
+    DenseStorage& operator=(DenseStorage&& other) NC_NOEXCEPT
+    {
+        this->swap(other);
+        return *this;
+    }
+#endif
+
+    NC_DEVICE_FUNC
+    DenseStorage& operator=(const DenseStorage& other)
+    {
+        if (this != &other)
+        {
+            DenseStorage tmp(other);
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    NC_DEVICE_FUNC
+    ~DenseStorage() { drop(); }
+
+    NC_DEVICE_FUNC
+    void swap(DenseStorage& other)
+    {
+        numext::swap(_data, other._data);
+        numext::swap(_size, other._size);
+        numext::swap(_owner, other._owner);
+    }
+
+    /** Reallocates the buffer if \a size differs from the current size, the content is lost. */
+    NC_DEVICE_FUNC
+    void resize(Index size)
+    {
+        if (size != _size)
+        {
+            drop();
+            _data = 0;
+            _size = 0;
+            _owner = 0;
+            _data = internal::dense_storage_new<T>(size);
+            _size = size;
+        }
+    }
+
+    NC_DEVICE_FUNC inline Index size() const { return _size; }
+
+    NC_DEVICE_FUNC inline const T* data() const { return _data; }
+
+    NC_DEVICE_FUNC inline T* data() { return _data; }
+
+    /** \returns whether the buffer was adopted rather than allocated by *this */
+    NC_DEVICE_FUNC inline bool isExternal() const { return _owner != 0; }
+
+private:
+    NC_DEVICE_FUNC void drop()
+    {
+        if (_owner) delete _owner;
+        else internal::dense_storage_delete<T>(_data, _size);
+    }
+
+    T* _data;
+    Index _size;
+    internal::external_buffer* _owner;
+};
+
+
+NS_END
+
+#endif
@@ -0,0 +1,670 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_ASSIGN_EVALUATOR_H__
+#define __NC_ASSIGN_EVALUATOR_H__
+
+// Size in bytes above which the destination of a linear vectorized assignment which the source does not read
+// is written with non-temporal stores, by default the size of the last level cache
+#ifndef NC_STREAMING_THRESHOLD
+#define NC_STREAMING_THRESHOLD double(internal::cache_sizes::get().l3)
+#endif
+
+NS_INTERNAL_BEGIN
+
+/***************************************************************************
+* Part 1 : the logic deciding a strategy for traversal
+***************************************************************************/
+
+/** \internal
+  * \brief Compile-time planner choosing the traversal and the unrolling of an assignment loop
+  *
+  * The choice only depends on the flags and costs of the two evaluators:
+  *  \li a linear vectorized traversal when both sides have linear and packet access and the destination
+  *      has direct access (to align its stores),
+  *  \li a slice vectorized traversal when packet access is possible but one side cannot be linearized,
+  *      e.g. a view whose coefficients are only contiguous along the last dimension,
+  *  \li a scalar linear traversal, and the outer/inner scalar traversal as the last resort.
+  *
+  * When the size is known at compile-time and the total cost of the loop, as estimated from the
+  * CoeffReadCost of both evaluators, stays below NC_UNROLLING_LIMIT the linear loops are completely unrolled.
+  */
+template <typename DstEvaluator, typename SrcEvaluator, typename AssignFunc>
+struct copy_using_evaluator_traits
+{
+    typedef typename DstEvaluator::XprType Dst;
+    typedef typename Dst::Scalar DstScalar;
+    typedef typename find_best_packet<DstScalar, traits<Dst>::SizeAtCompileTime>::type PacketType;
+
+    enum {
+        DstFlags = DstEvaluator::Flags,
+        SrcFlags = SrcEvaluator::Flags
+    };
+
+public:
+    enum {
+        DstAlignment = DstEvaluator::Alignment,
+        SrcAlignment = SrcEvaluator::Alignment,
+        DstHasDirectAccess = (DstFlags & DirectAccessBit) == DirectAccessBit,
+        JointAlignment = NC_PLAIN_ENUM_MIN(DstAlignment,SrcAlignment)
+    };
+
+private:
+    enum {
+        Size = traits<Dst>::SizeAtCompileTime,
+        SrcSize = traits<typename SrcEvaluator::XprType>::SizeAtCompileTime,
+        InnerSize = traits<Dst>::InnerSizeAtCompileTime,
+        PacketSize = unpacket_traits<PacketType>::size,
+        LinearRequiredAlignment = unpacket_traits<PacketType>::alignment
+    };
+
+    enum {
+        MayLinearize = bool(DstFlags & SrcFlags & LinearAccessBit),
+        MightVectorize = bool(DstFlags & SrcFlags & PacketAccessBit)
+                      && bool(functor_traits<AssignFunc>::PacketAccess),
+        MayLinearVectorize = bool(MightVectorize) && bool(MayLinearize) && bool(DstHasDirectAccess) && PacketSize > 1
+                          && (int(Size) == Dynamic || int(Size) >= int(PacketSize)),
+        /* If the slices are too short (less than 3 packets), the head and tail scalar loops of every slice
+           cost more than what the packets save. */
+        MaySliceVectorize = bool(MightVectorize) && bool(DstHasDirectAccess) && PacketSize > 1
+                         && (int(InnerSize) == Dynamic || int(InnerSize) >= 3*int(PacketSize))
+    };
+
+public:
+    enum {
+        Traversal = int(MayLinearVectorize) ? int(LinearVectorizedTraversal)
+                  : int(MaySliceVectorize)  ? int(SliceVectorizedTraversal)
+                  : int(MayLinearize)       ? int(LinearTraversal)
+                                            : int(DefaultTraversal),
+        Vectorized = int(Traversal) == LinearVectorizedTraversal
+                  || int(Traversal) == SliceVectorizedTraversal
+    };
+
+private:
+    enum {
+        UnrollingLimit = NC_UNROLLING_LIMIT * (Vectorized ? int(PacketSize) : 1),
+        // a source of unknown size may be broadcast, which the unrolled loops do not handle
+        MayUnrollCompletely = int(Size) != Dynamic && int(SrcSize) == int(Size)
+                           && int(Size) * (int(DstEvaluator::CoeffReadCost) + int(SrcEvaluator::CoeffReadCost)) <= int(UnrollingLimit)
+    };
+
+public:
+    enum {
+        Unrolling = (int(Traversal) == LinearTraversal || int(Traversal) == LinearVectorizedTraversal) && bool(MayUnrollCompletely)
+                  ? int(CompleteUnrolling) : int(NoUnrolling)
+    };
+
+    enum {
+        RequiredAlignment = LinearRequiredAlignment
+    };
+};
+
+
+/***************************************************************************
+* Part 2 : dense assignment loops
+***************************************************************************/
+
+template<typename Kernel,
+         int Traversal = Kernel::AssignmentTraits::Traversal,
+         int Unrolling = Kernel::AssignmentTraits::Unrolling>
+struct dense_assignment_loop;
+
+
+/***********************
+*** Default traversal ***
+***********************/
+
+// The loops not unrolled also run on a sub-range, which is how an assignment is split over threads:
+// runRange() takes a range of linear indices, runOuterRange() a range of slices along the last dimension.
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, DefaultTraversal, NoUnrolling>
+{
+    NC_DEVICE_FUNC static inline void run(Kernel &kernel)
+    {
+        runOuterRange(kernel, 0, kernel.outerSize());
+    }
+
+    NC_DEVICE_FUNC static inline void runOuterRange(Kernel &kernel, Index outerBegin, Index outerEnd)
+    {
+        const Index innerSize = kernel.innerSize();
+        for(Index outer = outerBegin; outer < outerEnd; ++outer)
+            for(Index inner = 0; inner < innerSize; ++inner)
+                kernel.assignCoeffByOuterInner(outer, inner);
+    }
+};
+
+
+/************************
+*** Linear traversal  ***
+************************/
+
+template<typename Kernel, int Index_, int Stop>
+struct copy_using_evaluator_LinearTraversal_CompleteUnrolling
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        kernel.assignCoeff(Index_);
+        copy_using_evaluator_LinearTraversal_CompleteUnrolling<Kernel, Index_+1, Stop>::run(kernel);
+    }
+};
+
+template<typename Kernel, int Stop>
+struct copy_using_evaluator_LinearTraversal_CompleteUnrolling<Kernel, Stop, Stop>
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel&) { }
+};
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, LinearTraversal, NoUnrolling>
+{
+    NC_DEVICE_FUNC static inline void run(Kernel &kernel)
+    {
+        // broadcast operands are only reachable through (outer, inner) indices
+        if(kernel.broadcasting())
+            return dense_assignment_loop<Kernel, DefaultTraversal, NoUnrolling>::run(kernel);
+
+        runRange(kernel, 0, kernel.size());
+    }
+
+    NC_DEVICE_FUNC static inline void runRange(Kernel &kernel, Index begin, Index end)
+    {
+        for(Index i = begin; i < end; ++i)
+            kernel.assignCoeff(i);
+    }
+};
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, LinearTraversal, CompleteUnrolling>
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        typedef typename Kernel::DstXprType DstXprType;
+        copy_using_evaluator_LinearTraversal_CompleteUnrolling<Kernel, 0, traits<DstXprType>::SizeAtCompileTime>::run(kernel);
+    }
+};
+
+
+/***************************************************
+*** Linear vectorization                         ***
+***************************************************/
+
+
+// The goal of unaligned_dense_assignment_loop is simply to factorize the handling
+// of the non vectorizable beginning and ending parts
+
+template <bool IsAligned = false>
+struct unaligned_dense_assignment_loop
+{
+    // if IsAligned = true, then do nothing
+    template <typename Kernel>
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel&, Index, Index) {}
+};
+
+template <>
+struct unaligned_dense_assignment_loop<false>
+{
+    template <typename Kernel>
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel,
+                                                    Index start,
+                                                    Index end)
+    {
+        for (Index index = start; index < end; ++index)
+            kernel.assignCoeff(index);
+    }
+};
+
+template<typename Kernel, int Index_, int Stop>
+struct copy_using_evaluator_linearvec_CompleteUnrolling
+{
+    typedef typename Kernel::PacketType PacketType;
+    enum {
+        DstAlignment = Kernel::AssignmentTraits::DstAlignment,
+        SrcAlignment = Kernel::AssignmentTraits::JointAlignment
+    };
+
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        kernel.template assignPacket<DstAlignment, SrcAlignment, PacketType>(Index_);
+        enum { NextIndex = Index_ + unpacket_traits<PacketType>::size };
+        copy_using_evaluator_linearvec_CompleteUnrolling<Kernel, NextIndex, Stop>::run(kernel);
+    }
+};
+
+template<typename Kernel, int Stop>
+struct copy_using_evaluator_linearvec_CompleteUnrolling<Kernel, Stop, Stop>
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel&) { }
+};
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, LinearVectorizedTraversal, NoUnrolling>
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        // broadcast operands are only reachable through (outer, inner) indices, a row or a column broadcast
+        // along the last dimension is then read once per slice
+        if(kernel.broadcasting())
+            return dense_assignment_loop<Kernel, SliceVectorizedTraversal, NoUnrolling>::run(kernel);
+
+        runRange(kernel, 0, kernel.size());
+    }
+
+    /** \internal \a begin must be a multiple of the packet size, which keeps an aligned destination aligned */
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void runRange(Kernel &kernel, Index begin, Index end)
+    {
+        typedef typename Kernel::Scalar Scalar;
+        typedef typename Kernel::PacketType PacketType;
+        enum {
+            requestedAlignment = Kernel::AssignmentTraits::RequiredAlignment,
+            packetSize = unpacket_traits<PacketType>::size,
+            dstIsAligned = int(Kernel::AssignmentTraits::DstAlignment)>=int(requestedAlignment),
+            dstAlignment = packet_traits<Scalar>::AlignedOnScalar ? int(requestedAlignment)
+                                                                  : int(Kernel::AssignmentTraits::DstAlignment),
+            srcAlignment = Kernel::AssignmentTraits::JointAlignment
+        };
+        // peel the head until the destination is aligned, then the whole body runs aligned stores
+        const Index alignedStart = dstIsAligned ? begin : begin + first_aligned<requestedAlignment>(kernel.dstDataPtr() + begin, end-begin);
+        const Index alignedEnd = alignedStart + ((end-alignedStart)/packetSize)*packetSize;
+
+        unaligned_dense_assignment_loop<dstIsAligned!=0>::run(kernel, begin, alignedStart);
+
+        if(int(dstAlignment) >= int(requestedAlignment) && kernel.streaming())
+        {
+            // the destination does not fit in the caches and is not read: writing it through them would
+            // only evict the operands
+            for(Index index = alignedStart; index < alignedEnd; index += packetSize)
+                kernel.template assignPacketStreaming<srcAlignment, PacketType>(index);
+            pstream_fence();
+        }
+        else
+        {
+            for(Index index = alignedStart; index < alignedEnd; index += packetSize)
+                kernel.template assignPacket<dstAlignment, srcAlignment, PacketType>(index);
+        }
+
+        unaligned_dense_assignment_loop<>::run(kernel, alignedEnd, end);
+    }
+};
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, LinearVectorizedTraversal, CompleteUnrolling>
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        typedef typename Kernel::DstXprType DstXprType;
+        typedef typename Kernel::PacketType PacketType;
+
+        enum {
+            size = traits<DstXprType>::SizeAtCompileTime,
+            packetSize = unpacket_traits<PacketType>::size,
+            alignedSize = (size/packetSize)*packetSize
+        };
+
+        copy_using_evaluator_linearvec_CompleteUnrolling<Kernel, 0, alignedSize>::run(kernel);
+        copy_using_evaluator_LinearTraversal_CompleteUnrolling<Kernel, alignedSize, size>::run(kernel);
+    }
+};
+
+
+/***************************************************
+*** Slice vectorization                          ***
+***************************************************/
+
+template<typename Kernel>
+struct dense_assignment_loop<Kernel, SliceVectorizedTraversal, NoUnrolling>
+{
+    NC_DEVICE_FUNC static inline void run(Kernel &kernel)
+    {
+        runOuterRange(kernel, 0, kernel.outerSize());
+    }
+
+    NC_DEVICE_FUNC static inline void runOuterRange(Kernel &kernel, Index outerBegin, Index outerEnd)
+    {
+        typedef typename Kernel::Scalar Scalar;
+        typedef typename Kernel::PacketType PacketType;
+        enum {
+            packetSize = unpacket_traits<PacketType>::size,
+            requestedAlignment = int(Kernel::AssignmentTraits::RequiredAlignment),
+            alignable = packet_traits<Scalar>::AlignedOnScalar || int(Kernel::AssignmentTraits::DstAlignment)>=int(sizeof(Scalar)),
+            dstAlignment = alignable ? int(requestedAlignment)
+                                     : int(Kernel::AssignmentTraits::DstAlignment)
+        };
+        const Index innerSize = kernel.innerSize();
+        if(innerSize == 0) return;
+
+        const Scalar *dst_ptr = kernel.dstDataPtr();
+        if(!kernel.innerContiguous() || ((!bool(alignable)) && !is_aligned<sizeof(Scalar)>(dst_ptr)))
+        {
+            // either a side is strided along the last dimension (e.g. a transposed view), or the pointer
+            // is not aligned-on scalar, so packets cannot be used
+            return dense_assignment_loop<Kernel,DefaultTraversal,NoUnrolling>::runOuterRange(kernel, outerBegin, outerEnd);
+        }
+
+        for(Index outer = outerBegin; outer < outerEnd; ++outer)
+        {
+            // every slice has its own misalignment, the head is peeled slice by slice
+            const Index alignedStart = alignable ? first_aligned<requestedAlignment>(&kernel.dstEvaluator().coeffRef(outer, 0), innerSize) : 0;
+            const Index alignedEnd = alignedStart + ((innerSize-alignedStart) & ~Index(packetSize-1));
+
+            for(Index inner = 0; inner < alignedStart; ++inner)
+                kernel.assignCoeffByOuterInner(outer, inner);
+
+            for(Index inner = alignedStart; inner < alignedEnd; inner += packetSize)
+                kernel.template assignPacketByOuterInner<dstAlignment, Unaligned, PacketType>(outer, inner);
+
+            for(Index inner = alignedEnd; inner < innerSize; ++inner)
+                kernel.assignCoeffByOuterInner(outer, inner);
+        }
+    }
+};
+
+
+/***************************************************************************
+* Part 3 : Generic dense assignment kernel
+***************************************************************************/
+
+/** \internal
+  * \class generic_dense_assignment_kernel
+  *
+  * \brief Glues the evaluators of the destination and of the source together with an assignment functor
+  *
+  * The dense_assignment_loop only talks to the kernel, which is therefore the single place where
+  * coefficients are read from the source and written to the destination.
+  */
+template<typename DstEvaluatorTypeT, typename SrcEvaluatorTypeT, typename Functor>
+class generic_dense_assignment_kernel
+{
+public:
+    typedef DstEvaluatorTypeT DstEvaluatorType;
+    typedef SrcEvaluatorTypeT SrcEvaluatorType;
+    typedef typename DstEvaluatorType::XprType DstXprType;
+    typedef typename DstXprType::Scalar Scalar;
+    typedef copy_using_evaluator_traits<DstEvaluatorTypeT, SrcEvaluatorTypeT, Functor> AssignmentTraits;
+    typedef typename AssignmentTraits::PacketType PacketType;
+
+    /// \a unreadDst tells that the source does not read the destination, which may then be streamed
+    NC_DEVICE_FUNC generic_dense_assignment_kernel(DstEvaluatorType &dst, const SrcEvaluatorType &src, const Functor &func, DstXprType& dstExpr,
+                                                   bool unreadDst = false)
+    : _dst(dst), _src(src), _functor(func), _dstExpr(dstExpr),
+      _streaming(unreadDst && double(dstExpr.size()) * double(sizeof(Scalar)) > NC_STREAMING_THRESHOLD)
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index size() const { return _dstExpr.size(); }
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index innerSize() const { return inner_size(_dstExpr.shape()); }
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index outerSize() const { return outer_size(_dstExpr.shape()); }
+
+    NC_DEVICE_FUNC const Scalar* dstDataPtr() const { return _dstExpr.data(); }
+
+    /// \returns whether both sides can be read and written by packets along the last dimension
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return _dst.innerContiguous() && _src.innerContiguous(); }
+
+    /// \returns whether an operand of the source is broadcast, which rules out the linear traversals
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _src.broadcasting(); }
+
+    NC_DEVICE_FUNC DstEvaluatorType& dstEvaluator() { return _dst; }
+    NC_DEVICE_FUNC const SrcEvaluatorType& srcEvaluator() const { return _src; }
+
+    /// \returns whether the destination is written with non-temporal stores, see call_assignment_to_new()
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool streaming() const { return _streaming; }
+
+    /// Assign src(index) to dst(index) through dst.coeffRef(index)
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignCoeff(Index index)
+    {
+        _functor.assignCoeff(_dst.coeffRef(index), _src.coeff(index));
+    }
+
+    /// Assign src(outer,inner) to dst(outer,inner), inner running along the last dimension
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignCoeffByOuterInner(Index outer, Index inner)
+    {
+        _functor.assignCoeff(_dst.coeffRef(outer, inner), _src.coeff(outer, inner));
+    }
+
+    /// Assign the packet of src starting at index to dst, StoreMode and LoadMode being the alignments
+    /// guaranteed at that index for the destination and the source
+    template<int StoreMode, int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignPacket(Index index)
+    {
+        _functor.template assignPacket<StoreMode>(&_dst.coeffRef(index), _src.template packet<LoadMode,PacketType>(index));
+    }
+
+    /// Assign the packet of src starting at index to dst with a non-temporal store, dst being aligned there
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignPacketStreaming(Index index)
+    {
+        _functor.assignPacketStreaming(&_dst.coeffRef(index), _src.template packet<LoadMode,PacketType>(index));
+    }
+
+    template<int StoreMode, int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignPacketByOuterInner(Index outer, Index inner)
+    {
+        _functor.template assignPacket<StoreMode>(&_dst.coeffRef(outer, inner), _src.template packet<LoadMode,PacketType>(outer, inner));
+    }
+
+protected:
+    DstEvaluatorType& _dst;
+    const SrcEvaluatorType& _src;
+    const Functor &_functor;
+    DstXprType& _dstExpr;
+    const bool _streaming;
+};
+
+
+/***************************************************************************
+* Part 4 : Multithreaded assignment
+***************************************************************************/
+
+/** \internal
+  * \class parallel_dense_assignment_loop
+  *
+  * \brief Splits the dense_assignment_loop of a kernel over the thread pool when its cost is worth it
+  *
+  * The cost of an assignment is its size times the CoeffReadCost of both sides, divided by the packet size
+  * when it is vectorized, see parallel_threads() for the number of threads this buys. The linear traversals
+  * are split along the coefficients in multiples of the packet size, the others (and the linear ones with a
+  * broadcast operand) along the slices of the last dimension. The kernel is shared by the threads: evaluators
+  * are only read once built, and the threads write disjoint coefficients.
+  *
+  * Fixed size assignments are small and unrolled, they always run on the calling thread.
+  */
+template<typename Kernel, bool MayParallelize = int(traits<typename Kernel::DstXprType>::SizeAtCompileTime) == Dynamic>
+struct parallel_dense_assignment_loop
+{
+    NC_DEVICE_FUNC static NC_STRONG_INLINE void run(Kernel &kernel)
+    {
+        dense_assignment_loop<Kernel>::run(kernel);
+    }
+};
+
+#ifdef NC_PARALLELIZE
+template<typename Kernel>
+struct parallel_dense_assignment_loop<Kernel, true>
+{
+    typedef typename Kernel::AssignmentTraits AssignmentTraits;
+    enum {
+        Traversal = AssignmentTraits::Traversal,
+        Linear = int(Traversal) == LinearTraversal || int(Traversal) == LinearVectorizedTraversal,
+        OuterTraversal = int(Traversal) == LinearVectorizedTraversal || int(Traversal) == SliceVectorizedTraversal
+                       ? int(SliceVectorizedTraversal) : int(DefaultTraversal),
+        PacketSize = AssignmentTraits::Vectorized ? int(unpacket_traits<typename Kernel::PacketType>::size) : 1,
+        CoeffCost = int(Kernel::DstEvaluatorType::CoeffReadCost) + int(Kernel::SrcEvaluatorType::CoeffReadCost)
+    };
+    struct linear_range
+    {
+        Kernel* kernel;
+        void operator()(Index begin, Index end) const
+        {
+            dense_assignment_loop<Kernel, Traversal, NoUnrolling>::runRange(*kernel, begin, end);
+        }
+    };
+
+    struct outer_range
+    {
+        Kernel* kernel;
+        void operator()(Index begin, Index end) const
+        {
+            dense_assignment_loop<Kernel, OuterTraversal, NoUnrolling>::runOuterRange(*kernel, begin, end);
+        }
+    };
+
+    static inline void run(Kernel &kernel)
+    {
+        const int threads = parallel_threads(double(kernel.size()) * double(CoeffCost) / double(PacketSize));
+        if(threads <= 1)
+            return dense_assignment_loop<Kernel>::run(kernel);
+        split(kernel, threads, typename conditional<bool(Linear), true_type, false_type>::type());
+    }
+
+    static inline void split(Kernel &kernel, int threads, true_type)
+    {
+        if(kernel.broadcasting())
+            return split(kernel, threads, false_type());
+        linear_range range = { &kernel };
+        parallel_for(kernel.size(), Index(PacketSize), threads, range);
+    }
+
+    static inline void split(Kernel &kernel, int threads, false_type)
+    {
+        outer_range range = { &kernel };
+        parallel_for(kernel.outerSize(), Index(1), threads, range);
+    }
+};
+#endif
+
+
+/***************************************************************************
+* Part 5 : Entry points
+***************************************************************************/
+
+template<typename DstXprType, typename SrcXprType, typename Functor>
+NC_DEVICE_FUNC NC_STRONG_INLINE void call_dense_assignment_loop(DstXprType& dst, const SrcXprType& src, const Functor &func,
+                                                                bool unreadDst = false)
+{
+    typedef evaluator<DstXprType> DstEvaluatorType;
+    typedef evaluator<SrcXprType> SrcEvaluatorType;
+
+    nc_assert(dst.shape() == src.shape());
+
+    SrcEvaluatorType srcEvaluator(src);
+    DstEvaluatorType dstEvaluator(dst);
+
+    typedef generic_dense_assignment_kernel<DstEvaluatorType,SrcEvaluatorType,Functor> Kernel;
+    Kernel kernel(dstEvaluator, srcEvaluator, func, dst, unreadDst);
+
+    parallel_dense_assignment_loop<Kernel>::run(kernel);
+}
+
+/** \internal Resizes the destination \a dst of an assignment to \a shape. Only an Array can be resized, any other
+  * destination must already have the shape of the source. */
+template<typename Dst>
+NC_DEVICE_FUNC NC_STRONG_INLINE void resize_if_allowed(Dst&, const Shape&) {}
+
+template<typename Scalar>
+NC_STRONG_INLINE void resize_if_allowed(Array<Scalar>& dst, const Shape& shape)
+{
+    if (dst.shape() != shape)
+        dst.resize(shape);
+}
+
+/** \internal Evaluates \a src into \a dst, resized to the shape of \a src when it is an Array, without checking
+  * whether \a src reads \a dst. \a unreadDst tells that it does not, see call_assignment_to_new(). */
+template<typename Dst, typename Src>
+NC_DEVICE_FUNC NC_STRONG_INLINE void call_assignment_no_alias(Dst& dst, const Src& src, bool unreadDst = false)
+{
+    typedef assign_op<typename Dst::Scalar, typename Src::Scalar> Func;
+    resize_if_allowed(dst, src.shape());
+    call_dense_assignment_loop(dst, src, Func(), unreadDst);
+}
+
+/** \internal Evaluates \a src into \a dst, newly allocated with the shape of \a src. The source cannot read
+  * the destination, so a destination larger than NC_STREAMING_THRESHOLD is written with non-temporal stores:
+  * they save reading its lines before writing them, and leave the caches to the operands. */
+template<typename Dst, typename Src>
+NC_DEVICE_FUNC NC_STRONG_INLINE void call_assignment_to_new(Dst& dst, const Src& src)
+{
+    typedef assign_op<typename Dst::Scalar, typename Src::Scalar> Func;
+    call_dense_assignment_loop(dst, src, Func(), true);
+}
+
+/** \internal \returns the AliasingType of the source \a src of an assignment to \a dst, see source_aliasing */
+template<typename Dst, typename Src>
+inline int assignment_aliasing(const Dst& dst, const Src& src)
+{
+    const Strides dstStrides = dst.strides();
+    const bool reshaped = dst.shape() != src.shape();
+    assignment_destination destination = {
+        dst.data(), 0, 0, Index(sizeof(typename Dst::Scalar)),
+        src.shape(), reshaped ? Strides(src.shape()) : dstStrides, dst.size() != src.size()
+    };
+    if (dst.size() != 0)
+        buffer_span(dst.data(), destination.scalarSize, dst.shape(), dstStrides, destination.begin, destination.end);
+    return source_aliasing<Src>::run(src, destination);
+}
+
+/** \internal Evaluates \a src into a scratch_buffer, then copies it into \a dst. The buffer is given back to the
+  * scratch_arena of the thread once the assignment is done. */
+template<typename Dst, typename Src>
+inline void call_assignment_through_scratch(Dst& dst, const Src& src)
+{
+    typedef typename traits<Src>::Scalar Scalar;
+    scratch_buffer<Scalar> buffer(src.size());
+    ArrayView<Scalar> tmp(buffer.data(), src.shape());
+    call_assignment_no_alias(tmp, src);
+    call_assignment_no_alias(dst, tmp, true);
+}
+
+/** \internal Evaluates \a src into \a dst through a temporary */
+template<typename Dst, typename Src>
+NC_STRONG_INLINE void call_assignment_through_temporary(Dst& dst, const Src& src)
+{
+    call_assignment_through_scratch(dst, src);
+}
+
+/** \internal An Array which is reallocated anyway evaluates \a src into its new buffer, then takes it */
+template<typename Scalar, typename Src>
+inline void call_assignment_through_temporary(Array<Scalar>& dst, const Src& src)
+{
+    if (dst.size() != src.size())
+    {
+        Array<Scalar> tmp(src);
+        dst.swap(tmp);
+    }
+    else
+    {
+        call_assignment_through_scratch(dst, src);
+    }
+}
+
+/** \internal Evaluates \a src into \a dst, resized to the shape of \a src when it is an Array.
+  *
+  * The leaves of \a src are first compared to the buffer of \a dst, see source_aliasing. The source is evaluated
+  * in place when it reads each coefficient of the destination, if at all, at the position it writes it to. It
+  * goes through a scratch temporary otherwise, e.g. for a transpose, an overlapping slice or a broadcast of the
+  * destination. A source reading no coefficient of the destination lets large destinations be written with
+  * non-temporal stores. NoAlias skips this check, but for a destination larger than NC_STREAMING_THRESHOLD.
+  */
+template<typename Dst, typename Src>
+NC_STRONG_INLINE void call_assignment(Dst& dst, const Src& src)
+{
+    const int aliasing = assignment_aliasing(dst, src);
+    if (aliasing == UnsafeAliasing)
+    {
+        call_assignment_through_temporary(dst, src);
+    }
+    else
+    {
+        call_assignment_no_alias(dst, src, aliasing == NoAliasing);
+    }
+}
+
+
+NS_INTERNAL_END
+
+#endif
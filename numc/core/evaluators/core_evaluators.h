@@ -0,0 +1,715 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CORE_EVALUATORS_H__
+#define __NC_CORE_EVALUATORS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class evaluator
+  *
+  * \brief Read (and possibly write) access to the coefficients of an expression
+  *
+  * An evaluator is built once per assignment from an expression and exposes:
+  *  - \c CoeffReturnType coeff(Index) const, the coefficient at a linear row-major index,
+  *  - \c Scalar& coeffRef(Index) for lvalue expressions,
+  *  - \c PacketType packet<LoadMode,PacketType>(Index) const and writePacket<StoreMode>(Index, const PacketType&)
+  *    when \c Flags has PacketAccessBit, LoadMode/StoreMode being the alignment (AlignmentType) guaranteed
+  *    by the caller at that index,
+  *  - the same accessors taking an (outer, inner) pair of indices, \c inner running along the last
+  *    dimension and \c outer over the leading ones, for the traversals which do not linearize,
+  *  - \c bool innerContiguous() const, telling whether packets may actually be read along the last dimension,
+  *    which for strided views is only known at run-time,
+  *  - \c bool broadcasting() const, telling whether an operand is broadcast somewhere in the expression, in which
+  *    case only the (outer, inner) accessors are valid,
+  *  - \c Flags, the subset of the expression flags the evaluator honors,
+  *  - \c Alignment, the alignment of the first coefficient for direct access evaluators,
+  *  - \c CoeffReadCost, the estimated cost of one call to coeff(), in the unit of the NumTraits costs.
+  *
+  * Expression nodes are evaluators of their children, so a whole expression tree collapses into
+  * one nested call per coefficient, which the compiler inlines into the assignment loop.
+  */
+
+// evaluator<const T> is the same as evaluator<T>
+template<typename T>
+struct evaluator<const T> : evaluator<T>
+{
+    NC_DEVICE_FUNC
+    explicit evaluator(const T& xpr) : evaluator<T>(xpr) {}
+};
+
+// Generic evaluator base class, forbids copies so that expressions nested in a kernel are never
+// duplicated by accident.
+template<typename ExpressionType>
+struct evaluator_base : public noncopyable
+{
+    typedef traits<ExpressionType> ExpressionTraits;
+};
+
+
+// -------------------- Array --------------------
+
+template<typename Scalar>
+struct evaluator< Array<Scalar> > : evaluator_base< Array<Scalar> >
+{
+    typedef Array<Scalar> XprType;
+    typedef const Scalar& CoeffReturnType;
+
+    enum {
+        CoeffReadCost = NumTraits<Scalar>::ReadCost,
+        Flags = traits<XprType>::Flags,
+        Alignment = traits<XprType>::Alignment
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& a) : _data(a.data()), _outerStride(inner_size(a.shape())) {}
+
+    /** \internal Reads the row-major array of inner size \a outerStride starting at \a data, see Map */
+    NC_DEVICE_FUNC
+    evaluator(const Scalar* data, Index outerStride) : _data(data), _outerStride(outerStride) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return _data[index];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _data[outer * _outerStride + inner];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index index)
+    {
+        return const_cast<Scalar*>(_data)[index];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index outer, Index inner)
+    {
+        return const_cast<Scalar*>(_data)[outer * _outerStride + inner];
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const
+    {
+        return ploadt<PacketType, LoadMode>(_data + index);
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return ploadt<PacketType, LoadMode>(_data + outer * _outerStride + inner);
+    }
+
+    template<int StoreMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    void writePacket(Index index, const PacketType& x)
+    {
+        return pstoret<Scalar, PacketType, StoreMode>(const_cast<Scalar*>(_data) + index, x);
+    }
+
+    template<int StoreMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    void writePacket(Index outer, Index inner, const PacketType& x)
+    {
+        return pstoret<Scalar, PacketType, StoreMode>(const_cast<Scalar*>(_data) + outer * _outerStride + inner, x);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return true; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return false; }
+
+protected:
+    const Scalar* _data;
+    Index _outerStride;
+};
+
+
+// -------------------- FixedArray --------------------
+
+template<typename Scalar, Index... Dims>
+struct evaluator< FixedArray<Scalar, Dims...> > : evaluator_base< FixedArray<Scalar, Dims...> >
+{
+    typedef FixedArray<Scalar, Dims...> XprType;
+    typedef const Scalar& CoeffReturnType;
+
+    enum {
+        CoeffReadCost = NumTraits<Scalar>::ReadCost,
+        Flags = traits<XprType>::Flags,
+        Alignment = traits<XprType>::Alignment,
+        OuterStride = traits<XprType>::InnerSizeAtCompileTime
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& a) : _data(a.data()) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return _data[index];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _data[outer * OuterStride + inner];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index index)
+    {
+        return const_cast<Scalar*>(_data)[index];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index outer, Index inner)
+    {
+        return const_cast<Scalar*>(_data)[outer * OuterStride + inner];
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const
+    {
+        return ploadt<PacketType, LoadMode>(_data + index);
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return ploadt<PacketType, LoadMode>(_data + outer * OuterStride + inner);
+    }
+
+    template<int StoreMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    void writePacket(Index index, const PacketType& x)
+    {
+        return pstoret<Scalar, PacketType, StoreMode>(const_cast<Scalar*>(_data) + index, x);
+    }
+
+    template<int StoreMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    void writePacket(Index outer, Index inner, const PacketType& x)
+    {
+        return pstoret<Scalar, PacketType, StoreMode>(const_cast<Scalar*>(_data) + outer * OuterStride + inner, x);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return true; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return false; }
+
+protected:
+    const Scalar* _data;
+};
+
+
+// -------------------- Map --------------------
+
+// A Map is read as an Array, with the alignment of its MapOptions
+template<typename PlainObjectType, int MapOptions>
+struct evaluator< Map<PlainObjectType, MapOptions> >
+  : evaluator< Array<typename traits< Map<PlainObjectType, MapOptions> >::Scalar> >
+{
+    typedef Map<PlainObjectType, MapOptions> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef evaluator< Array<Scalar> > Base;
+
+    enum {
+        Flags = traits<XprType>::Flags,
+        Alignment = traits<XprType>::Alignment
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& m) : Base(m.data(), inner_size(m.shape())) {}
+};
+
+
+// -------------------- ArrayView --------------------
+
+template<typename _Scalar>
+struct evaluator< ArrayView<_Scalar> > : evaluator_base< ArrayView<_Scalar> >
+{
+    typedef ArrayView<_Scalar> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef const Scalar& CoeffReturnType;
+
+    enum {
+        CoeffReadCost = NumTraits<Scalar>::ReadCost,
+        Flags = traits<XprType>::Flags,
+        Alignment = traits<XprType>::Alignment
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& v)
+    : _data(const_cast<Scalar*>(v.data())), _shape(v.shape()), _strides(v.strides()),
+      _innerSize(inner_size(v.shape())), _innerStride(v.dims() == 0 ? 0 : v.strides()[v.dims()-1])
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return coeff(index / _innerSize, index % _innerSize);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _data[outerOffset(outer) + inner * _innerStride];
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index index)
+    {
+        return coeffRef(index / _innerSize, index % _innerSize);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    Scalar& coeffRef(Index outer, Index inner)
+    {
+        return _data[outerOffset(outer) + inner * _innerStride];
+    }
+
+    // packets are only read along the last dimension, and only when innerContiguous() holds
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return ploadt<PacketType, LoadMode>(_data + outerOffset(outer) + inner);
+    }
+
+    template<int StoreMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    void writePacket(Index outer, Index inner, const PacketType& x)
+    {
+        return pstoret<Scalar, PacketType, StoreMode>(_data + outerOffset(outer) + inner, x);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return _innerStride == 1; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return false; }
+
+protected:
+    /** \internal \returns the offset of the first coefficient of the slice \a outer, the leading dimensions
+      * being unraveled from the last one. It only depends on \a outer, so inside a slice loop it is hoisted. */
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index outerOffset(Index outer) const
+    {
+        return unravel_offset(outer, _shape.data(), _strides.data(), numext::maxi(_shape.dims()-1, Index(0)));
+    }
+
+protected:
+    Scalar* _data;
+    Shape _shape;
+    Strides _strides;
+    Index _innerSize;
+    Index _innerStride;
+};
+
+
+// -------------------- CwiseNullaryOp --------------------
+
+template<typename NullaryOp, typename PlainObjectType>
+struct evaluator< CwiseNullaryOp<NullaryOp, PlainObjectType> > : evaluator_base< CwiseNullaryOp<NullaryOp, PlainObjectType> >
+{
+    typedef CwiseNullaryOp<NullaryOp, PlainObjectType> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef Scalar CoeffReturnType;
+
+    enum {
+        CoeffReadCost = functor_traits<NullaryOp>::Cost,
+        Flags = LinearAccessBit | (functor_traits<NullaryOp>::PacketAccess ? PacketAccessBit : 0),
+        // nothing is read from memory
+        Alignment = AlignedMax
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& xpr) : _functor(xpr.functor()) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index) const
+    {
+        return _functor();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index, Index) const
+    {
+        return _functor();
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index) const
+    {
+        return _functor.template packetOp<PacketType>();
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index, Index) const
+    {
+        return _functor.template packetOp<PacketType>();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return true; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return false; }
+
+protected:
+    const NullaryOp _functor;
+};
+
+
+// -------------------- CwiseUnaryOp --------------------
+
+template<typename UnaryOp, typename ArgType>
+struct evaluator< CwiseUnaryOp<UnaryOp, ArgType> > : evaluator_base< CwiseUnaryOp<UnaryOp, ArgType> >
+{
+    typedef CwiseUnaryOp<UnaryOp, ArgType> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef Scalar CoeffReturnType;
+
+    enum {
+        CoeffReadCost = int(evaluator<ArgType>::CoeffReadCost) + int(functor_traits<UnaryOp>::Cost),
+        Flags = (evaluator<ArgType>::Flags & LinearAccessBit)
+              | ( (evaluator<ArgType>::Flags & PacketAccessBit) && functor_traits<UnaryOp>::PacketAccess ? PacketAccessBit : 0),
+        Alignment = evaluator<ArgType>::Alignment
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& xpr) : _functor(xpr.functor()), _argImpl(xpr.nestedExpression()) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return _functor(_argImpl.coeff(index));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _functor(_argImpl.coeff(outer, inner));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const
+    {
+        return _functor.packetOp(_argImpl.template packet<LoadMode,PacketType>(index));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return _functor.packetOp(_argImpl.template packet<LoadMode,PacketType>(outer, inner));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const { return _argImpl.innerContiguous(); }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _argImpl.broadcasting(); }
+
+protected:
+    const UnaryOp _functor;
+    evaluator<ArgType> _argImpl;
+};
+
+
+// -------------------- CwiseBinaryOp --------------------
+
+/** \internal
+  * \class broadcast_operand
+  *
+  * \brief Evaluator of an operand of a coefficient-wise node, read through the broadcast_mapper of its indices
+  *
+  * The linear accessors read the operand as is, they are only used when nothing is broadcast. The (outer, inner)
+  * ones map the indices of the result back to the operand: a column or a scalar broadcast along the last
+  * dimension is splat into a packet, and the slice of a broadcast row is read unaligned since it does not start
+  * where the slice of the result does.
+  *
+  * A broadcast operand is read several times per coefficient, once per slice of the result it is repeated
+  * along. When nested_eval says that computing it that many times costs more than reading it back from a
+  * temporary, as for \c a \c + \c b.exp().erf() with a matrix \c a and a vector \c b, it is evaluated once
+  * into a plain array when the evaluator is built, see the specialization below.
+  */
+template<typename ArgType,
+         bool EvaluateBroadcast = int(traits<ArgType>::SizeAtCompileTime) == Dynamic
+                               && bool(nested_eval<ArgType, Dynamic>::Evaluate)>
+class broadcast_operand
+{
+public:
+    typedef evaluator<ArgType> ArgEvaluator;
+    typedef typename ArgEvaluator::CoeffReturnType CoeffReturnType;
+
+    /** \internal Evaluates \a arg, broadcast to \a target when \a mayBroadcast, i.e. for dynamic size nodes */
+    NC_DEVICE_FUNC
+    broadcast_operand(const ArgType& arg, const Shape& target, bool mayBroadcast)
+    : _impl(arg), _mapper(mayBroadcast ? broadcast_mapper(arg.shape(), target) : broadcast_mapper())
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const { return _impl.coeff(index); }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        if(!_mapper.active())
+            return _impl.coeff(outer, inner);
+        return _impl.coeff(_mapper.outer(outer), _mapper.inner(inner));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const { return _impl.template packet<LoadMode,PacketType>(index); }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        if(!_mapper.active())
+            return _impl.template packet<LoadMode,PacketType>(outer, inner);
+        if(_mapper.innerBroadcast())
+            return pset1<PacketType>(_impl.coeff(_mapper.outer(outer), 0));
+        return _impl.template packet<Unaligned,PacketType>(_mapper.outer(outer), inner);
+    }
+
+    /** \internal \returns whether packets may be read along the last dimension, an operand broadcast along it
+      * being read as a single coefficient */
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const
+    {
+        return _mapper.innerBroadcast() || _impl.innerContiguous();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _mapper.active() || _impl.broadcasting(); }
+
+protected:
+    ArgEvaluator _impl;
+    broadcast_mapper _mapper;
+};
+
+// An expensive operand which is actually broadcast is read from its evaluation into _plain. The expression is
+// still evaluated on the fly when it is not broadcast, through the linear accessors and an inactive mapper.
+template<typename ArgType>
+class broadcast_operand<ArgType, true>
+{
+public:
+    typedef evaluator<ArgType> ArgEvaluator;
+    typedef typename nested_eval<ArgType, Dynamic>::type PlainObject;
+    typedef typename traits<ArgType>::Scalar Scalar;
+    typedef Scalar CoeffReturnType;
+
+    NC_DEVICE_FUNC
+    broadcast_operand(const ArgType& arg, const Shape& target, bool mayBroadcast)
+    : _impl(arg), _mapper(mayBroadcast ? broadcast_mapper(arg.shape(), target) : broadcast_mapper()),
+      _plain(_mapper.active() ? PlainObject(arg) : PlainObject()), _plainImpl(_plain)
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const { return _impl.coeff(index); }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        if(!_mapper.active())
+            return _impl.coeff(outer, inner);
+        return _plainImpl.coeff(_mapper.outer(outer), _mapper.inner(inner));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const { return _impl.template packet<LoadMode,PacketType>(index); }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        if(!_mapper.active())
+            return _impl.template packet<LoadMode,PacketType>(outer, inner);
+        if(_mapper.innerBroadcast())
+            return pset1<PacketType>(_plainImpl.coeff(_mapper.outer(outer), 0));
+        return _plainImpl.template packet<Unaligned,PacketType>(_mapper.outer(outer), inner);
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const
+    {
+        return _mapper.active() || _impl.innerContiguous();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _mapper.active() || _impl.broadcasting(); }
+
+protected:
+    ArgEvaluator _impl;
+    broadcast_mapper _mapper;
+    PlainObject _plain;
+    evaluator<PlainObject> _plainImpl;
+};
+
+template<typename BinaryOp, typename Lhs, typename Rhs>
+struct evaluator< CwiseBinaryOp<BinaryOp, Lhs, Rhs> > : evaluator_base< CwiseBinaryOp<BinaryOp, Lhs, Rhs> >
+{
+    typedef CwiseBinaryOp<BinaryOp, Lhs, Rhs> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef Scalar CoeffReturnType;
+
+    enum {
+        CoeffReadCost = int(evaluator<Lhs>::CoeffReadCost) + int(evaluator<Rhs>::CoeffReadCost) + int(functor_traits<BinaryOp>::Cost),
+
+        LhsFlags = evaluator<Lhs>::Flags,
+        RhsFlags = evaluator<Rhs>::Flags,
+        SameType = is_same<typename Lhs::Scalar,typename Rhs::Scalar>::value,
+        Flags = (LhsFlags & RhsFlags & LinearAccessBit)
+              | ( (LhsFlags & RhsFlags & PacketAccessBit) && functor_traits<BinaryOp>::PacketAccess && SameType ? PacketAccessBit : 0),
+        Alignment = NC_PLAIN_ENUM_MIN(evaluator<Lhs>::Alignment,evaluator<Rhs>::Alignment),
+
+        // shapes are only looked at when the operands may be broadcast, i.e. not for fixed size ones
+        MayBroadcast = int(traits<XprType>::SizeAtCompileTime) == Dynamic
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& xpr)
+    : _functor(xpr.functor()),
+      _lhsImpl(xpr.lhs(), xpr.shape(), MayBroadcast),
+      _rhsImpl(xpr.rhs(), xpr.shape(), MayBroadcast),
+      _broadcasting(_lhsImpl.broadcasting() || _rhsImpl.broadcasting())
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return _functor(_lhsImpl.coeff(index), _rhsImpl.coeff(index));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _functor(_lhsImpl.coeff(outer, inner), _rhsImpl.coeff(outer, inner));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const
+    {
+        return _functor.packetOp(_lhsImpl.template packet<LoadMode,PacketType>(index),
+                                 _rhsImpl.template packet<LoadMode,PacketType>(index));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return _functor.packetOp(_lhsImpl.template packet<LoadMode,PacketType>(outer, inner),
+                                 _rhsImpl.template packet<LoadMode,PacketType>(outer, inner));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const
+    {
+        return _lhsImpl.innerContiguous() && _rhsImpl.innerContiguous();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _broadcasting; }
+
+protected:
+    const BinaryOp _functor;
+    broadcast_operand<Lhs> _lhsImpl;
+    broadcast_operand<Rhs> _rhsImpl;
+    bool _broadcasting;
+};
+
+
+// -------------------- CwiseTernaryOp --------------------
+
+template<typename TernaryOp, typename Arg1, typename Arg2, typename Arg3>
+struct evaluator< CwiseTernaryOp<TernaryOp, Arg1, Arg2, Arg3> > : evaluator_base< CwiseTernaryOp<TernaryOp, Arg1, Arg2, Arg3> >
+{
+    typedef CwiseTernaryOp<TernaryOp, Arg1, Arg2, Arg3> XprType;
+    typedef typename XprType::Scalar Scalar;
+    typedef Scalar CoeffReturnType;
+
+    enum {
+        CoeffReadCost = int(evaluator<Arg1>::CoeffReadCost) + int(evaluator<Arg2>::CoeffReadCost)
+                      + int(evaluator<Arg3>::CoeffReadCost) + int(functor_traits<TernaryOp>::Cost),
+
+        Arg1Flags = evaluator<Arg1>::Flags,
+        Arg2Flags = evaluator<Arg2>::Flags,
+        Arg3Flags = evaluator<Arg3>::Flags,
+        SameType = is_same<typename Arg1::Scalar,typename Arg2::Scalar>::value
+                && is_same<typename Arg1::Scalar,typename Arg3::Scalar>::value,
+        Flags = (Arg1Flags & Arg2Flags & Arg3Flags & LinearAccessBit)
+              | ( (Arg1Flags & Arg2Flags & Arg3Flags & PacketAccessBit) && functor_traits<TernaryOp>::PacketAccess && SameType ? PacketAccessBit : 0),
+        Alignment = NC_PLAIN_ENUM_MIN(NC_PLAIN_ENUM_MIN(evaluator<Arg1>::Alignment, evaluator<Arg2>::Alignment),
+                                      evaluator<Arg3>::Alignment),
+
+        MayBroadcast = int(traits<XprType>::SizeAtCompileTime) == Dynamic
+    };
+
+    NC_DEVICE_FUNC
+    explicit evaluator(const XprType& xpr)
+    : _functor(xpr.functor()),
+      _arg1Impl(xpr.arg1(), xpr.shape(), MayBroadcast),
+      _arg2Impl(xpr.arg2(), xpr.shape(), MayBroadcast),
+      _arg3Impl(xpr.arg3(), xpr.shape(), MayBroadcast),
+      _broadcasting(_arg1Impl.broadcasting() || _arg2Impl.broadcasting() || _arg3Impl.broadcasting())
+    {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index index) const
+    {
+        return _functor(_arg1Impl.coeff(index), _arg2Impl.coeff(index), _arg3Impl.coeff(index));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    CoeffReturnType coeff(Index outer, Index inner) const
+    {
+        return _functor(_arg1Impl.coeff(outer, inner), _arg2Impl.coeff(outer, inner), _arg3Impl.coeff(outer, inner));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index index) const
+    {
+        return _functor.packetOp(_arg1Impl.template packet<LoadMode,PacketType>(index),
+                                 _arg2Impl.template packet<LoadMode,PacketType>(index),
+                                 _arg3Impl.template packet<LoadMode,PacketType>(index));
+    }
+
+    template<int LoadMode, typename PacketType>
+    NC_DEVICE_FUNC NC_STRONG_INLINE
+    PacketType packet(Index outer, Index inner) const
+    {
+        return _functor.packetOp(_arg1Impl.template packet<LoadMode,PacketType>(outer, inner),
+                                 _arg2Impl.template packet<LoadMode,PacketType>(outer, inner),
+                                 _arg3Impl.template packet<LoadMode,PacketType>(outer, inner));
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool innerContiguous() const
+    {
+        return _arg1Impl.innerContiguous() && _arg2Impl.innerContiguous() && _arg3Impl.innerContiguous();
+    }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE bool broadcasting() const { return _broadcasting; }
+
+protected:
+    const TernaryOp _functor;
+    broadcast_operand<Arg1> _arg1Impl;
+    broadcast_operand<Arg2> _arg2Impl;
+    broadcast_operand<Arg3> _arg3Impl;
+    bool _broadcasting;
+};
+
+
+NS_INTERNAL_END
+
+#endif
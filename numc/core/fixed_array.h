@@ -0,0 +1,201 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_FIXED_ARRAY_H__
+#define __NC_FIXED_ARRAY_H__
+
+
+NS_INTERNAL_BEGIN
+
+template<Index... Dims> struct fixed_product { enum { value = 1 }; };
+
+template<Index D0, Index... Dims> struct fixed_product<D0, Dims...>
+{
+    enum { value = int(D0) * int(fixed_product<Dims...>::value) };
+};
+
+template<Index... Dims> struct fixed_last { enum { value = 1 }; };
+
+template<Index D0> struct fixed_last<D0> { enum { value = int(D0) }; };
+
+template<Index D0, Index D1, Index... Dims> struct fixed_last<D0, D1, Dims...> : fixed_last<D1, Dims...> {};
+
+
+template<typename _Scalar, Index... _Dims>
+struct traits< FixedArray<_Scalar, _Dims...> >
+{
+    typedef _Scalar Scalar;
+
+    enum {
+        SizeAtCompileTime = fixed_product<_Dims...>::value,
+        InnerSizeAtCompileTime = fixed_last<_Dims...>::value,
+        Flags = LinearAccessBit | DirectAccessBit | NestByRefBit
+              | (packet_traits<_Scalar>::Vectorizable ? PacketAccessBit : 0),
+        Alignment = compute_fixed_alignment<SizeAtCompileTime * int(sizeof(_Scalar))>::value
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class FixedShape
+  * \ingroup Core_Module
+  *
+  * \brief Shape whose extents are known at compile-time
+  *
+  * The number of dimensions, the size, the extents and the row-major strides are all constant expressions.
+  * shape() and strides() give the equivalent run-time Shape and Strides, built once.
+  */
+template<Index... _Dims>
+struct FixedShape
+{
+    enum {
+        Dims = sizeof...(_Dims),
+        Size = internal::fixed_product<_Dims...>::value,
+        InnerSize = internal::fixed_last<_Dims...>::value
+    };
+
+    static constexpr Index dims() { return Dims; }
+
+    static constexpr Index size() { return Size; }
+
+    /** \returns the extent of the dimension \a i */
+    static constexpr Index extent(Index i) { return _extents[i]; }
+
+    /** \returns the row-major stride of the dimension \a i, in coefficients */
+    static constexpr Index stride(Index i) { return i >= Index(Dims)-1 ? 1 : extent(i+1) * stride(i+1); }
+
+    static const Shape& shape()
+    {
+        static const Shape s(_Dims...);
+        return s;
+    }
+
+    static const Strides& strides()
+    {
+        static const Strides s(shape());
+        return s;
+    }
+
+private:
+    static constexpr Index _extents[sizeof...(_Dims)] = {_Dims...};
+};
+
+template<Index... _Dims>
+constexpr Index FixedShape<_Dims...>::_extents[sizeof...(_Dims)];
+
+
+/** \class FixedArray
+  * \ingroup Core_Module
+  *
+  * \brief n-dimension array whose shape is known at compile-time
+  *
+  * \tparam Scalar the type of the coefficients
+  * \tparam Dims the extents of the dimensions
+  *
+  * The coefficients live inside the object (on the stack for a local variable), aligned on the largest packet
+  * boundary dividing their total size. No shape is stored: the size of the assignment loop is a constant,
+  * so assignments of small arrays are completely unrolled into straight packet operations:
+  * \code
+  * FixedArray<float, 4, 4> a, b, c;
+  * c = a * b + c;      // 1 to 4 packet multiply-adds depending on the ISA, no loop
+  * \endcode
+  * A FixedArray mixes with dynamic expressions like any Array, but it is never resized: the shape of an
+  * assigned expression must be the one of the FixedArray.
+  */
+template<typename _Scalar, Index... _Dims>
+class FixedArray : public ArrayOp< FixedArray<_Scalar, _Dims...> >
+{
+public:
+    typedef _Scalar Scalar;
+    typedef FixedShape<_Dims...> FixedShapeType;
+
+    enum {
+        Size = FixedShapeType::Size
+    };
+
+    NC_STATIC_ASSERT(sizeof...(_Dims) > 0 && int(Size) > 0, "A FixedArray must have at least one dimension and one coefficient")
+
+public:
+    /** Constructs a FixedArray with uninitialized coefficients */
+    NC_STRONG_INLINE FixedArray() {}
+
+    /** Constructs a FixedArray from its coefficients in row-major order */
+    NC_STRONG_INLINE FixedArray(std::initializer_list<Scalar> coeffs)
+    {
+        nc_assert(Index(coeffs.size()) == Index(Size));
+        internal::smart_copy(coeffs.begin(), coeffs.end(), data());
+    }
+
+    NC_STRONG_INLINE FixedArray(const FixedArray& other) : _storage(other._storage) {}
+
+    /** Constructs a FixedArray holding the evaluation of the expression \a other */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE FixedArray(const ArrayOp<OtherDerived>& other)
+    {
+        internal::call_assignment_no_alias(*this, other.derived());
+    }
+
+    NC_STRONG_INLINE FixedArray& operator=(const FixedArray& other)
+    {
+        _storage = other._storage;
+        return *this;
+    }
+
+    /** Evaluates the expression \a other into *this, which must have the shape of *this. As for Array, a source
+      * reading *this through another layout is evaluated into a temporary first, see noalias(). */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE FixedArray& operator=(const ArrayOp<OtherDerived>& other)
+    {
+        internal::call_assignment(*this, other.derived());
+        return *this;
+    }
+
+    static inline const Shape& shape() { return FixedShapeType::shape(); }
+
+    static inline const Strides& strides() { return FixedShapeType::strides(); }
+
+    static constexpr Index size() { return Size; }
+
+    static constexpr Index dims() { return FixedShapeType::Dims; }
+
+    inline const Scalar* data() const { return _storage.array; }
+
+    inline Scalar* data() { return _storage.array; }
+
+    /** \returns the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar& coeff(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _storage.array[index];
+    }
+
+    /** \returns a reference to the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE Scalar& coeffRef(Index index)
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _storage.array[index];
+    }
+
+    /** \returns a view of all the coefficients of *this, see ArrayView */
+    inline ArrayView<Scalar> view() { return ArrayView<Scalar>(data(), shape()); }
+
+    inline ArrayView<const Scalar> view() const { return ArrayView<const Scalar>(data(), shape()); }
+
+protected:
+    internal::plain_array<Scalar, Size> _storage;
+};
+
+
+NS_END
+
+#endif
@@ -0,0 +1,46 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_ASSIGNMENT_FUNCTORS_H__
+#define __NC_ASSIGNMENT_FUNCTORS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \brief Template functor for scalar/packet assignment
+  *
+  * \sa call_assignment
+  */
+template<typename DstScalar,typename SrcScalar>
+struct assign_op
+{
+    NC_EMPTY_STRUCT_CTOR(assign_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignCoeff(DstScalar& a, const SrcScalar& b) const { a = b; }
+
+    template<int Alignment, typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignPacket(DstScalar* a, const Packet& b) const
+    { internal::pstoret<DstScalar,Packet,Alignment>(a,b); }
+
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE void assignPacketStreaming(DstScalar* a, const Packet& b) const
+    { internal::pstream(a,b); }
+};
+template<typename DstScalar,typename SrcScalar>
+struct functor_traits<assign_op<DstScalar,SrcScalar> > {
+    enum {
+        Cost = NumTraits<DstScalar>::ReadCost,
+        PacketAccess = is_same<DstScalar,SrcScalar>::value && packet_traits<DstScalar>::Vectorizable
+    };
+};
+
+
+NS_INTERNAL_END
+
+#endif
@@ -40,17 +40,163 @@ struct scalar_sum_op : binary_op_base<LhsScalar,RhsScalar>
   }
 #endif
     NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return a + b; }
-    /*
     template<typename Packet>
     NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
     { return internal::padd(a,b); }
     template<typename Packet>
     NC_DEVICE_FUNC NC_STRONG_INLINE const result_type predux(const Packet& a) const
     { return internal::predux(a); }
-     */
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_sum_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = (NumTraits<LhsScalar>::AddCost+NumTraits<RhsScalar>::AddCost)/2, // rough estimate!
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasAdd && packet_traits<RhsScalar>::HasAdd
+    };
+};
 
+/** \internal
+  * \brief Template functor to compute the difference of two scalars
+  *
+  * \sa class CwiseBinaryOp, ArrayOp::operator-
+  */
+template<typename LhsScalar,typename RhsScalar>
+struct scalar_difference_op : binary_op_base<LhsScalar,RhsScalar>
+{
+    typedef typename ScalarBinaryOpTraits<LhsScalar,RhsScalar,scalar_difference_op>::ReturnType result_type;
+#ifndef NC_SCALAR_BINARY_OP_PLUGIN
+    NC_EMPTY_STRUCT_CTOR(scalar_difference_op)
+#else
+    scalar_difference_op() {
+    NC_SCALAR_BINARY_OP_PLUGIN
+  }
+#endif
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return a - b; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
+    { return internal::psub(a,b); }
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_difference_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = (NumTraits<LhsScalar>::AddCost+NumTraits<RhsScalar>::AddCost)/2, // rough estimate!
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasSub && packet_traits<RhsScalar>::HasSub
+    };
 };
 
+/** \internal
+  * \brief Template functor to compute the coefficient-wise product of two scalars
+  *
+  * \sa class CwiseBinaryOp, ArrayOp::operator*
+  */
+template<typename LhsScalar,typename RhsScalar>
+struct scalar_product_op : binary_op_base<LhsScalar,RhsScalar>
+{
+    typedef typename ScalarBinaryOpTraits<LhsScalar,RhsScalar,scalar_product_op>::ReturnType result_type;
+#ifndef NC_SCALAR_BINARY_OP_PLUGIN
+    NC_EMPTY_STRUCT_CTOR(scalar_product_op)
+#else
+    scalar_product_op() {
+    NC_SCALAR_BINARY_OP_PLUGIN
+  }
+#endif
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return a * b; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
+    { return internal::pmul(a,b); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type predux(const Packet& a) const
+    { return internal::predux_mul(a); }
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_product_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = (NumTraits<LhsScalar>::MulCost+NumTraits<RhsScalar>::MulCost)/2, // rough estimate!
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasMul && packet_traits<RhsScalar>::HasMul
+    };
+};
+
+/** \internal
+  * \brief Template functor to compute the quotient of two scalars
+  *
+  * \sa class CwiseBinaryOp, ArrayOp::operator/
+  */
+template<typename LhsScalar,typename RhsScalar>
+struct scalar_quotient_op : binary_op_base<LhsScalar,RhsScalar>
+{
+    typedef typename ScalarBinaryOpTraits<LhsScalar,RhsScalar,scalar_quotient_op>::ReturnType result_type;
+#ifndef NC_SCALAR_BINARY_OP_PLUGIN
+    NC_EMPTY_STRUCT_CTOR(scalar_quotient_op)
+#else
+    scalar_quotient_op() {
+    NC_SCALAR_BINARY_OP_PLUGIN
+  }
+#endif
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return a / b; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
+    { return internal::pdiv(a,b); }
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_quotient_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = NumTraits<LhsScalar>::MulCost + 5 * NumTraits<RhsScalar>::MulCost, // divisions are several times slower than products
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasDiv && packet_traits<RhsScalar>::HasDiv
+    };
+};
+
+
+/** \internal
+  * \brief Template functor to compute the min of two scalars
+  *
+  * \sa ArrayOp::min()
+  */
+template<typename LhsScalar,typename RhsScalar>
+struct scalar_min_op : binary_op_base<LhsScalar,RhsScalar>
+{
+    typedef typename ScalarBinaryOpTraits<LhsScalar,RhsScalar,scalar_min_op>::ReturnType result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_min_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return numext::mini(a, b); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
+    { return internal::pmin(a,b); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type predux(const Packet& a) const
+    { return internal::predux_min(a); }
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_min_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = (NumTraits<LhsScalar>::AddCost+NumTraits<RhsScalar>::AddCost)/2,
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasMin
+    };
+};
+
+/** \internal
+  * \brief Template functor to compute the max of two scalars
+  *
+  * \sa ArrayOp::max()
+  */
+template<typename LhsScalar,typename RhsScalar>
+struct scalar_max_op : binary_op_base<LhsScalar,RhsScalar>
+{
+    typedef typename ScalarBinaryOpTraits<LhsScalar,RhsScalar,scalar_max_op>::ReturnType result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_max_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const LhsScalar& a, const RhsScalar& b) const { return numext::maxi(a, b); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b) const
+    { return internal::pmax(a,b); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type predux(const Packet& a) const
+    { return internal::predux_max(a); }
+};
+template<typename LhsScalar,typename RhsScalar>
+struct functor_traits<scalar_max_op<LhsScalar,RhsScalar> > {
+    enum {
+        Cost = (NumTraits<LhsScalar>::AddCost+NumTraits<RhsScalar>::AddCost)/2,
+        PacketAccess = is_same<LhsScalar,RhsScalar>::value && packet_traits<LhsScalar>::HasMax
+    };
+};
 
 
 NS_INTERNAL_END
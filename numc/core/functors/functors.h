@@ -12,7 +12,11 @@
 #define __NC_FUNCTORS_H__
 
 
+#include "nullary_functors.h"
+#include "unary_functors.h"
 #include "binary_functors.h"
+#include "ternary_functors.h"
+#include "assignment_functors.h"
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,44 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_NULLARY_FUNCTORS_H__
+#define __NC_NULLARY_FUNCTORS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \brief Template functor returning the same scalar for every coefficient
+  *
+  * \sa class CwiseNullaryOp, ArrayOp::operator*(const Scalar&)
+  */
+template<typename Scalar>
+struct scalar_constant_op
+{
+    typedef Scalar result_type;
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE scalar_constant_op(const Scalar& other) : _other(other) {}
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() () const { return _other; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp() const { return internal::pset1<Packet>(_other); }
+
+    const Scalar _other;
+};
+template<typename Scalar>
+struct functor_traits<scalar_constant_op<Scalar> > {
+    enum {
+        Cost = 0,
+        PacketAccess = packet_traits<Scalar>::Vectorizable
+    };
+};
+
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,47 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_TERNARY_FUNCTORS_H__
+#define __NC_TERNARY_FUNCTORS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \brief Template functor to compute a * b + c
+  *
+  * The packets go through pmadd, a single fused multiply-add rounding once on NC_VECTORIZE_FMA targets, and so
+  * do the scalars through numext::fma(): the peeled and the non-vectorized coefficients round as the others.
+  * This is the functor of the sums of a product built by ArrayOp::operator+, see cwise_sum_return_type.
+  *
+  * \sa class CwiseTernaryOp, ArrayOp::operator+
+  */
+template<typename Scalar>
+struct scalar_muladd_op
+{
+    typedef Scalar result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_muladd_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a, const Scalar& b, const Scalar& c) const
+    { return numext::fma(a, b, c); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a, const Packet& b, const Packet& c) const
+    { return internal::pmadd(a, b, c); }
+};
+template<typename Scalar>
+struct functor_traits<scalar_muladd_op<Scalar> > {
+    enum {
+        Cost = NumTraits<Scalar>::MulCost + NumTraits<Scalar>::AddCost,
+        PacketAccess = packet_traits<Scalar>::HasMul && packet_traits<Scalar>::HasAdd
+    };
+};
+
+
+NS_INTERNAL_END
+
+#endif
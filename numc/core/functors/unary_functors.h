@@ -0,0 +1,281 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_UNARY_FUNCTORS_H__
+#define __NC_UNARY_FUNCTORS_H__
+
+NS_INTERNAL_BEGIN
+
+// Defines the functor NAME applying the scalar function FUNC and the packet function internal::PFUNC, which
+// is vectorized when packet_traits<Scalar>::HASOP is set, COST being counted in multiplications.
+#define NC_MAKE_UNARY_FUNCTOR(NAME, FUNC, PFUNC, HASOP, COST)                                                    \
+template<typename Scalar>                                                                                       \
+struct NAME                                                                                                     \
+{                                                                                                               \
+    typedef Scalar result_type;                                                                                 \
+    NC_EMPTY_STRUCT_CTOR(NAME)                                                                                  \
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const                             \
+    { using std::FUNC; return Scalar(FUNC(a)); }                                                                \
+    template<typename Packet>                                                                                   \
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const                                \
+    { return internal::PFUNC(a); }                                                                              \
+};                                                                                                              \
+template<typename Scalar>                                                                                       \
+struct functor_traits<NAME<Scalar> > {                                                                          \
+    enum {                                                                                                      \
+        Cost = COST * NumTraits<Scalar>::MulCost,                                                               \
+        PacketAccess = packet_traits<Scalar>::HASOP                                                             \
+    };                                                                                                          \
+};
+
+// The errors of the vectorized functions are listed in arch/generic_packet_math_functions.h, the scalar
+// ones are those of the C library.
+
+/** \internal
+  * \brief Template functor to compute the absolute value of a scalar
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::abs()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_abs_op, abs, pabs, HasAbs, 1)
+
+/** \internal
+  * \brief Template functor to compute the squared absolute value of a scalar, i.e. the real |x|^2 of a complex one
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::abs2()
+  */
+template<typename Scalar, bool IsComplex = NumTraits<Scalar>::IsComplex>
+struct scalar_abs2_op
+{
+    typedef Scalar result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_abs2_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const { return a * a; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const
+    { return internal::pmul(a, a); }
+};
+template<typename Scalar>
+struct scalar_abs2_op<Scalar, true>
+{
+    typedef typename NumTraits<Scalar>::Real result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_abs2_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const result_type operator() (const Scalar& a) const
+    { return a.real() * a.real() + a.imag() * a.imag(); }
+};
+template<typename Scalar, bool IsComplex>
+struct functor_traits<scalar_abs2_op<Scalar, IsComplex> > {
+    enum {
+        Cost = NumTraits<Scalar>::MulCost,
+        PacketAccess = !IsComplex && packet_traits<Scalar>::HasMul
+    };
+};
+
+/** \internal
+  * \brief Template functor to compute the square root of a scalar, correctly rounded
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::sqrt()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_sqrt_op, sqrt, psqrt, HasSqrt, 5)
+
+/** \internal
+  * \brief Template functor to compute the exponential of a scalar, within 1.8 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::exp()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_exp_op, exp, pexp, HasExp, 10)
+
+/** \internal
+  * \brief Template functor to compute the natural logarithm of a scalar, within 0.95 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::log()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_log_op, log, plog, HasLog, 12)
+
+/** \internal
+  * \brief Template functor to compute log(1 + x), within 2.5 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::log1p()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_log1p_op, log1p, plog1p, HasLog1p, 15)
+
+/** \internal
+  * \brief Template functor to compute exp(x) - 1, within 2.9 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::expm1()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_expm1_op, expm1, pexpm1, HasExpm1, 25)
+
+/** \internal
+  * \brief Template functor to compute the sine of a scalar, within 1.6 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::sin()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_sin_op, sin, psin, HasSin, 15)
+
+/** \internal
+  * \brief Template functor to compute the cosine of a scalar, within 1.6 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::cos()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_cos_op, cos, pcos, HasCos, 15)
+
+/** \internal
+  * \brief Template functor to compute the hyperbolic tangent of a scalar, within 1.45 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::tanh()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_tanh_op, tanh, ptanh, HasTanh, 12)
+
+/** \internal
+  * \brief Template functor to compute the error function of a scalar, within 1.5 ULP when vectorized
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::erf()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_erf_op, erf, perf, HasErf, 15)
+
+/** \internal
+  * \brief Template functor to round a scalar downwards
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::floor()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_floor_op, floor, pfloor, HasFloor, 1)
+
+/** \internal
+  * \brief Template functor to round a scalar upwards
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::ceil()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_ceil_op, ceil, pceil, HasCeil, 1)
+
+/** \internal
+  * \brief Template functor to round a scalar to the nearest integer, halfway cases away from zero
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::round()
+  */
+NC_MAKE_UNARY_FUNCTOR(scalar_round_op, round, pround, HasRound, 2)
+
+#undef NC_MAKE_UNARY_FUNCTOR
+
+/** \internal
+  * \brief Template functor to compute the opposite of a scalar
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::operator-
+  */
+template<typename Scalar>
+struct scalar_opposite_op
+{
+    typedef Scalar result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_opposite_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const { return -a; }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const
+    { return internal::pnegate(a); }
+};
+template<typename Scalar>
+struct functor_traits<scalar_opposite_op<Scalar> > {
+    enum {
+        Cost = NumTraits<Scalar>::AddCost,
+        PacketAccess = packet_traits<Scalar>::HasNegate
+    };
+};
+
+/** \internal
+  * \brief Template functor to compute the inverse square root of a scalar, within 1.5 ULP
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::rsqrt()
+  */
+template<typename Scalar>
+struct scalar_rsqrt_op
+{
+    typedef Scalar result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_rsqrt_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const
+    { using std::sqrt; return Scalar(1) / sqrt(a); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const
+    { return internal::prsqrt(a); }
+};
+template<typename Scalar>
+struct functor_traits<scalar_rsqrt_op<Scalar> > {
+    enum {
+        Cost = 10 * NumTraits<Scalar>::MulCost,
+        PacketAccess = packet_traits<Scalar>::HasRsqrt
+    };
+};
+
+/** \internal
+  * \brief Template functor to compute the logistic sigmoid 1 / (1 + exp(-x)) of a scalar
+  *
+  * It is computed from e = exp(-|x|), as 1 / (1 + e) for a positive x and e / (1 + e) for a negative one, which
+  * never overflows and keeps the denormal results. The vectorized one is within 3 ULP.
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::sigmoid()
+  */
+template<typename Scalar>
+struct scalar_sigmoid_op
+{
+    typedef Scalar result_type;
+    NC_EMPTY_STRUCT_CTOR(scalar_sigmoid_op)
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const
+    {
+        using std::exp; using std::abs;
+        const Scalar e = exp(-abs(a)), r = Scalar(1) / (Scalar(1) + e);
+        return a < Scalar(0) ? e * r : r;
+    }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const
+    {
+        const Packet one = internal::pset1<Packet>(Scalar(1));
+        const Packet e = internal::pexp(internal::pnegate(internal::pabs(a)));
+        const Packet r = internal::pdiv(one, internal::padd(one, e));
+        return internal::pselect(internal::pcmp_lt(a, internal::pset1<Packet>(Scalar(0))), internal::pmul(e, r), r);
+    }
+};
+template<typename Scalar>
+struct functor_traits<scalar_sigmoid_op<Scalar> > {
+    enum {
+        Cost = 15 * NumTraits<Scalar>::MulCost,
+        PacketAccess = packet_traits<Scalar>::HasExp && packet_traits<Scalar>::HasDiv
+    };
+};
+
+/** \internal
+  * \brief Template functor to raise a scalar to a given power
+  *
+  * Floats are vectorized within 0.51 ULP, the product y log(x) being computed in double. Doubles call the C
+  * library for each coefficient, an exp(y log(x)) in double being off by up to |y log(x)| ULP.
+  *
+  * \sa class CwiseUnaryOp, ArrayOp::pow()
+  */
+template<typename Scalar>
+struct scalar_pow_op
+{
+    typedef Scalar result_type;
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE scalar_pow_op(const Scalar& exponent) : _exponent(exponent) {}
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar operator() (const Scalar& a) const
+    { using std::pow; return Scalar(pow(a, _exponent)); }
+    template<typename Packet>
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Packet packetOp(const Packet& a) const
+    { return internal::ppow(a, internal::pset1<Packet>(_exponent)); }
+
+    const Scalar _exponent;
+};
+template<typename Scalar>
+struct functor_traits<scalar_pow_op<Scalar> > {
+    enum {
+        Cost = 30 * NumTraits<Scalar>::MulCost,
+        PacketAccess = packet_traits<Scalar>::HasPow
+    };
+};
+
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,153 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_MAP_H__
+#define __NC_MAP_H__
+
+
+NS_INTERNAL_BEGIN
+
+template<typename PlainObjectType, int MapOptions>
+struct traits< Map<PlainObjectType, MapOptions> >
+{
+    typedef typename traits<typename remove_const<PlainObjectType>::type>::Scalar Scalar;
+
+    // Laid out as an Array, so linearizable, but only as aligned as MapOptions promises
+    enum {
+        Flags = LinearAccessBit | DirectAccessBit
+              | (packet_traits<Scalar>::Vectorizable ? PacketAccessBit : 0),
+        Alignment = MapOptions,
+        SizeAtCompileTime = Dynamic,
+        InnerSizeAtCompileTime = Dynamic
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class Map
+  * \ingroup Core_Module
+  *
+  * \brief An Array over existing memory, which it neither owns nor copies
+  *
+  * \tparam PlainObjectType \c Array<Scalar>, or \c const \c Array<Scalar> for a read-only map
+  * \tparam MapOptions the alignment (AlignmentType) of the first coefficient, Unaligned by default
+  *
+  * A Map reads and writes a contiguous row-major buffer in place, with the layout of an Array: unlike an
+  * ArrayView, whose strides are only known at run-time, it is traversed as a single linear range of packets.
+  * It is the way to work on memory from elsewhere without copying it, e.g. a protobuf payload, a shared
+  * memory segment or the buffer of another library. Like an ArrayView, it must not outlive the buffer, it
+  * is copied cheaply, and assigning to it writes into the buffer, which is never resized.
+  *
+  * Packets are loaded from it without alignment requirement, which costs nothing on recent cpus when the
+  * buffer happens to be aligned anyway. A buffer known to be aligned may say so with \a MapOptions, which is
+  * checked by an assertion; isAligned() checks it at run-time. To hand the ownership of an aligned buffer to
+  * numc, use Array::from_buffer() instead.
+  * \code
+  * const float* payload = request.tensor().data();
+  * Map<const Array<float> > x(payload, Shape(32, 512));         // no copy
+  * Array<float> y = (x * w).tanh();
+  * Map<Array<float>, Aligned64>(out, Shape(32, 512)) = y + b;  // written in place
+  * \endcode
+  *
+  * \sa Array::from_buffer(), ArrayView
+  */
+template<typename PlainObjectType, int MapOptions>
+class Map : public ArrayOp< Map<PlainObjectType, MapOptions> >
+{
+public:
+    typedef typename internal::traits<Map>::Scalar Scalar;
+    typedef typename internal::conditional<internal::is_const<PlainObjectType>::value,
+                                           const Scalar, Scalar>::type ViewScalar;
+    typedef ViewScalar* PointerType;
+
+public:
+    /** Maps the contiguous row-major array of shape \a shape starting at \a data */
+    NC_STRONG_INLINE Map(PointerType data, const Shape& shape) : _data(data), _shape(shape)
+    {
+        nc_assert(internal::is_aligned<MapOptions>(data) && "data is not aligned as promised by MapOptions");
+    }
+
+    NC_STRONG_INLINE Map(const Map& other) : _data(other._data), _shape(other._shape) {}
+
+    /** Copies the coefficients of \a other into the mapped buffer, both must have the same shape */
+    NC_STRONG_INLINE Map& operator=(const Map& other)
+    {
+        NC_STATIC_ASSERT(!internal::is_const<PlainObjectType>::value, "Cannot assign to a read-only Map")
+        internal::call_assignment(*this, other);
+        return *this;
+    }
+
+    /** Evaluates the expression \a other into the mapped buffer, which is never resized: \a other must have
+      * the shape of *this. An \a other reading the buffer through another layout is evaluated into a
+      * temporary first, see Array::operator=(). */
+    template<typename OtherDerived>
+    NC_STRONG_INLINE Map& operator=(const ArrayOp<OtherDerived>& other)
+    {
+        NC_STATIC_ASSERT(!internal::is_const<PlainObjectType>::value, "Cannot assign to a read-only Map")
+        internal::call_assignment(*this, other.derived());
+        return *this;
+    }
+
+    inline const Shape& shape() const { return _shape; }
+
+    inline Index size() const { return _shape.size(); }
+
+    inline Index dims() const { return _shape.dims(); }
+
+    /** \returns the address of the first coefficient */
+    inline PointerType data() const { return _data; }
+
+    /** \returns the row-major contiguous strides of *this */
+    inline Strides strides() const { return Strides(_shape); }
+
+    /** \returns whether the first coefficient is aligned on NC_MAX_ALIGN_BYTES, as the buffer of an Array */
+    inline bool isAligned() const { return internal::is_aligned<NC_MAX_ALIGN_BYTES>(_data); }
+
+    /** \returns the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Scalar& coeff(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _data[index];
+    }
+
+    /** \returns a reference to the coefficient at the linear (row-major) \a index */
+    NC_DEVICE_FUNC NC_STRONG_INLINE ViewScalar& coeffRef(Index index) const
+    {
+        nc_internal_assert(index >= 0 && index < size());
+        return _data[index];
+    }
+
+    /** \returns a view of all the coefficients of *this, see ArrayView */
+    inline ArrayView<ViewScalar> view() const { return ArrayView<ViewScalar>(_data, _shape); }
+
+    /** \returns a view of the coefficients selected by \a slices, see ArrayView::slice() */
+    inline ArrayView<ViewScalar> slice(std::initializer_list<Slice> slices) const { return view().slice(slices); }
+
+    /** \returns a view with the dimensions in reverse order, see ArrayView::transpose() */
+    inline ArrayView<ViewScalar> transpose() const { return view().transpose(); }
+
+    /** \returns a view with the dimensions permuted by \a axes, see ArrayView::transpose() */
+    inline ArrayView<ViewScalar> transpose(std::initializer_list<Index> axes) const { return view().transpose(axes); }
+
+    /** \returns a view of the coefficients with shape \a shape, see ArrayView::reshape() */
+    inline ArrayView<ViewScalar> reshape(const Shape& shape) const { return view().reshape(shape); }
+
+protected:
+    PointerType _data;
+    Shape _shape;
+};
+
+
+NS_END
+
+#endif
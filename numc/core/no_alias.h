@@ -0,0 +1,65 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_NO_ALIAS_H__
+#define __NC_NO_ALIAS_H__
+
+NS_BEGIN
+
+/** \class NoAlias
+  * \ingroup Core_Module
+  *
+  * \brief Pseudo expression assigning to an array without checking whether the source reads it
+  *
+  * \tparam ExpressionType the type of the destination, an Array, a FixedArray or a writable ArrayView
+  *
+  * This is the type returned by ArrayOp::noalias(). Its operator= evaluates the source straight into the
+  * destination, never through a temporary, skipping the alias analysis of Array::operator=(). Only a
+  * destination larger than NC_STREAMING_THRESHOLD, which may be written with non-temporal stores, has the
+  * leaves of the source compared to its buffer: it is streamed when none reads it, while an in-place update
+  * keeps the regular stores, whose cache lines it has just read.
+  * \code
+  * Array<float> y(256, 1024), x(256, 1024), b(1024);
+  * y.noalias() = x * 0.5f + b;     // no check below NC_STREAMING_THRESHOLD, no temporary
+  * \endcode
+  *
+  * The source must not read the destination through another layout: \c a.noalias() = \c a.transpose() silently
+  * produces garbage. An in-place update as \c a.noalias() = \c a * 2.f remains correct.
+  *
+  * \sa ArrayOp::noalias(), internal::source_aliasing
+  */
+template<typename ExpressionType>
+class NoAlias
+{
+public:
+    typedef typename ExpressionType::Scalar Scalar;
+
+    NC_DEVICE_FUNC explicit NoAlias(ExpressionType& expression) : _expression(expression) {}
+
+    /** Evaluates \a other into the destination, resized to the shape of \a other when it is an Array */
+    template<typename OtherDerived>
+    NC_DEVICE_FUNC NC_STRONG_INLINE ExpressionType& operator=(const ArrayOp<OtherDerived>& other)
+    {
+        const bool streamable = double(other.derived().size()) * double(sizeof(Scalar)) > NC_STREAMING_THRESHOLD;
+        const bool unreadDst = streamable
+                            && internal::assignment_aliasing(_expression, other.derived()) == internal::NoAliasing;
+        internal::call_assignment_no_alias(_expression, other.derived(), unreadDst);
+        return _expression;
+    }
+
+    NC_DEVICE_FUNC ExpressionType& expression() const { return _expression; }
+
+protected:
+    ExpressionType& _expression;
+};
+
+NS_END
+
+#endif
@@ -22,6 +22,16 @@ struct traits<CwiseBinaryOp<BinaryOp, Lhs, Rhs> >
                     const typename Rhs::Scalar&
             )
     >::type Scalar;
+
+    enum {
+        Flags = traits<Lhs>::Flags & traits<Rhs>::Flags & LinearAccessBit,
+        // an operand may be broadcast to the shape of the other one, so the size is only known at compile-time
+        // when both operands agree on it
+        SizeAtCompileTime = int(traits<Lhs>::SizeAtCompileTime) == int(traits<Rhs>::SizeAtCompileTime)
+                          ? int(traits<Lhs>::SizeAtCompileTime) : int(Dynamic),
+        InnerSizeAtCompileTime = int(traits<Lhs>::InnerSizeAtCompileTime) == int(traits<Rhs>::InnerSizeAtCompileTime)
+                               ? int(traits<Lhs>::InnerSizeAtCompileTime) : int(Dynamic)
+    };
 };
 
 
@@ -49,6 +59,13 @@ class CwiseBinaryOpImpl;
   * both the left-hand side and the right-hand side are Eigen expressions.
   * For example, the return type of matrix1+matrix2 is a CwiseBinaryOp.
   *
+  * The operands are broadcast to a common shape following the numpy rules, which are resolved when the
+  * expression is built. A broadcast operand is never expanded in memory, see internal::broadcast_mapper:
+  * \code
+  * Array<float> m(128, 64), row(64), col(128, 1);
+  * Array<float> r = m + row - col;     // shape (128, 64)
+  * \endcode
+  *
   * Most of the time, this is the only way that it is used, so you typically don't have to name
   * CwiseBinaryOp types explicitly.
   *
@@ -62,17 +79,41 @@ class CwiseBinaryOp : public CwiseBinaryOpImpl<BinaryOp, LhsType, RhsType>
     typedef typename internal::remove_all<RhsType>::type Rhs;
 
 public:
+    typedef typename internal::traits<CwiseBinaryOp>::Scalar Scalar;
+
     NC_DEVICE_FUNC
     NC_STRONG_INLINE CwiseBinaryOp(const Lhs& lhs, const Rhs& rhs, const BinaryOp& func = BinaryOp())
-    : _lhs(lhs), _rhs(rhs), _functor(func)
+    : _lhs(lhs), _rhs(rhs), _functor(func), _shape(lhs.shape())
     {
-        //nc_assert(lhs.size() == rhs.size());
+        // operands of the same compile-time size cannot be broadcast
+        nc_assert(int(internal::traits<CwiseBinaryOp>::SizeAtCompileTime) == Dynamic || lhs.shape() == rhs.shape());
+        if(int(internal::traits<CwiseBinaryOp>::SizeAtCompileTime) == Dynamic && lhs.shape() != rhs.shape())
+        {
+            const bool compatible = internal::broadcast_shapes(lhs.shape(), rhs.shape(), _shape);
+            nc_assert(compatible && "operands could not be broadcast together");
+            NC_UNUSED_VARIABLE(compatible);
+        }
     }
 
+    /** \returns the shape both operands are broadcast to */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Shape& shape() const { return _shape; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index size() const { return _shape.size(); }
+
+    /** \returns the left hand side nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Lhs& lhs() const { return _lhs; }
+
+    /** \returns the right hand side nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Rhs& rhs() const { return _rhs; }
+
+    /** \returns the functor representing the binary operation */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const BinaryOp& functor() const { return _functor; }
+
 protected:
-    LhsType const& _lhs;
-    RhsType const& _rhs;
+    typename internal::nested<LhsType>::type _lhs;
+    typename internal::nested<RhsType>::type _rhs;
     const BinaryOp _functor;
+    Shape _shape;
 };
 
 
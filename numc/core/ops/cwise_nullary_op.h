@@ -0,0 +1,74 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CWISE_NULLARY_OP_H__
+#define __NC_CWISE_NULLARY_OP_H__
+
+NS_INTERNAL_BEGIN
+
+template<typename NullaryOp, typename PlainObjectType>
+struct traits<CwiseNullaryOp<NullaryOp, PlainObjectType> >
+{
+    typedef typename traits<PlainObjectType>::Scalar Scalar;
+
+    enum {
+        Flags = LinearAccessBit,
+        SizeAtCompileTime = Dynamic,
+        InnerSizeAtCompileTime = Dynamic
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class CwiseNullaryOp
+  * \ingroup Core_Module
+  *
+  * \brief Generic expression of a given shape whose coefficients are computed by a functor without operand
+  *
+  * \tparam NullaryOp template functor implementing the operator
+  * \tparam PlainObjectType the array type of the coefficients
+  *
+  * It is the type of the constant a scalar operand of a binary operator is turned into, with the shape of
+  * the other operand: nothing is stored, and the scalar is splat into a register once per packet.
+  * \code
+  * Array<float> x(1024), y(1024);
+  * y = 2.f * x + y;                    // a single pass over x and y
+  * \endcode
+  *
+  * \sa class CwiseBinaryOp
+  */
+template<typename NullaryOp, typename PlainObjectType>
+class CwiseNullaryOp : public ArrayOp< CwiseNullaryOp<NullaryOp, PlainObjectType> >
+{
+public:
+    typedef typename internal::traits<CwiseNullaryOp>::Scalar Scalar;
+
+    NC_DEVICE_FUNC
+    NC_STRONG_INLINE CwiseNullaryOp(const Shape& shape, const NullaryOp& func = NullaryOp())
+    : _shape(shape), _functor(func) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Shape& shape() const { return _shape; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index size() const { return _shape.size(); }
+
+    /** \returns the functor representing the nullary operation */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const NullaryOp& functor() const { return _functor; }
+
+protected:
+    const Shape _shape;
+    const NullaryOp _functor;
+};
+
+NS_END
+
+#endif
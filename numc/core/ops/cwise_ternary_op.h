@@ -0,0 +1,118 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CWISE_TERNARY_OP_H__
+#define __NC_CWISE_TERNARY_OP_H__
+
+NS_INTERNAL_BEGIN
+
+template<typename TernaryOp, typename Arg1, typename Arg2, typename Arg3>
+struct traits<CwiseTernaryOp<TernaryOp, Arg1, Arg2, Arg3> >
+{
+    typedef typename result_of<
+            TernaryOp(
+                    const typename Arg1::Scalar&,
+                    const typename Arg2::Scalar&,
+                    const typename Arg3::Scalar&
+            )
+    >::type Scalar;
+
+    enum {
+        Flags = traits<Arg1>::Flags & traits<Arg2>::Flags & traits<Arg3>::Flags & LinearAccessBit,
+        // like CwiseBinaryOp, the size is only known at compile-time when all the arguments agree on it
+        SizeAtCompileTime = int(traits<Arg1>::SizeAtCompileTime) == int(traits<Arg2>::SizeAtCompileTime)
+                         && int(traits<Arg1>::SizeAtCompileTime) == int(traits<Arg3>::SizeAtCompileTime)
+                          ? int(traits<Arg1>::SizeAtCompileTime) : int(Dynamic),
+        InnerSizeAtCompileTime = int(traits<Arg1>::InnerSizeAtCompileTime) == int(traits<Arg2>::InnerSizeAtCompileTime)
+                              && int(traits<Arg1>::InnerSizeAtCompileTime) == int(traits<Arg3>::InnerSizeAtCompileTime)
+                               ? int(traits<Arg1>::InnerSizeAtCompileTime) : int(Dynamic)
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class CwiseTernaryOp
+  * \ingroup Core_Module
+  *
+  * \brief Generic expression where a coefficient-wise ternary operator is applied to three expressions
+  *
+  * \tparam TernaryOp template functor implementing the operator
+  * \tparam Arg1Type the type of the first argument
+  * \tparam Arg2Type the type of the second argument
+  * \tparam Arg3Type the type of the third argument
+  *
+  * The arguments are broadcast to a common shape following the numpy rules, as the operands of a
+  * CwiseBinaryOp are. It is the type of a sum where one side is a coefficient-wise product, which is fused
+  * into a single multiply-add, see internal::cwise_sum_return_type:
+  * \code
+  * Array<float> x(128, 64), w(64), b(64);
+  * Array<float> y = x * w + b;     // CwiseTernaryOp<scalar_muladd_op<float>, ...>, one pmadd per packet
+  * \endcode
+  *
+  * \sa class CwiseBinaryOp, class CwiseUnaryOp
+  */
+template<typename TernaryOp, typename Arg1Type, typename Arg2Type, typename Arg3Type>
+class CwiseTernaryOp : public ArrayOp< CwiseTernaryOp<TernaryOp, Arg1Type, Arg2Type, Arg3Type> >
+{
+    typedef typename internal::remove_all<Arg1Type>::type Arg1;
+    typedef typename internal::remove_all<Arg2Type>::type Arg2;
+    typedef typename internal::remove_all<Arg3Type>::type Arg3;
+
+public:
+    typedef typename internal::traits<CwiseTernaryOp>::Scalar Scalar;
+
+    NC_DEVICE_FUNC
+    NC_STRONG_INLINE CwiseTernaryOp(const Arg1& a1, const Arg2& a2, const Arg3& a3, const TernaryOp& func = TernaryOp())
+    : _arg1(a1), _arg2(a2), _arg3(a3), _functor(func), _shape(a1.shape())
+    {
+        nc_assert(int(internal::traits<CwiseTernaryOp>::SizeAtCompileTime) == Dynamic
+                  || (a1.shape() == a2.shape() && a1.shape() == a3.shape()));
+        if(int(internal::traits<CwiseTernaryOp>::SizeAtCompileTime) == Dynamic
+           && (a1.shape() != a2.shape() || a1.shape() != a3.shape()))
+        {
+            Shape shape12;
+            const bool compatible = internal::broadcast_shapes(a1.shape(), a2.shape(), shape12)
+                                 && internal::broadcast_shapes(shape12, a3.shape(), _shape);
+            nc_assert(compatible && "operands could not be broadcast together");
+            NC_UNUSED_VARIABLE(compatible);
+        }
+    }
+
+    /** \returns the shape the three arguments are broadcast to */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Shape& shape() const { return _shape; }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index size() const { return _shape.size(); }
+
+    /** \returns the first argument nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Arg1& arg1() const { return _arg1; }
+
+    /** \returns the second argument nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Arg2& arg2() const { return _arg2; }
+
+    /** \returns the third argument nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Arg3& arg3() const { return _arg3; }
+
+    /** \returns the functor representing the ternary operation */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const TernaryOp& functor() const { return _functor; }
+
+protected:
+    typename internal::nested<Arg1Type>::type _arg1;
+    typename internal::nested<Arg2Type>::type _arg2;
+    typename internal::nested<Arg3Type>::type _arg3;
+    const TernaryOp _functor;
+    Shape _shape;
+};
+
+NS_END
+
+#endif
@@ -0,0 +1,79 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CWISE_UNARY_OP_H__
+#define __NC_CWISE_UNARY_OP_H__
+
+NS_INTERNAL_BEGIN
+
+template<typename UnaryOp, typename XprType>
+struct traits<CwiseUnaryOp<UnaryOp, XprType> >
+{
+    typedef typename result_of<UnaryOp(const typename XprType::Scalar&)>::type Scalar;
+
+    enum {
+        Flags = traits<XprType>::Flags & LinearAccessBit,
+        SizeAtCompileTime = traits<XprType>::SizeAtCompileTime,
+        InnerSizeAtCompileTime = traits<XprType>::InnerSizeAtCompileTime
+    };
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class CwiseUnaryOp
+  * \ingroup Core_Module
+  *
+  * \brief Generic expression where a coefficient-wise unary operator is applied to an expression
+  *
+  * \tparam UnaryOp template functor implementing the operator
+  * \tparam XprType the type of the expression to which the operator is applied
+  *
+  * It is the return type of the unary operator- and of the math functions of ArrayOp, e.g. abs(), exp() or
+  * pow(). It has the shape of its operand, and is evaluated in the single loop of the enclosing expression:
+  * \code
+  * Array<float> x(1024), b(1024);
+  * Array<float> y = (x * 0.5f + b).tanh();    // one pass, the vectorized tanh
+  * \endcode
+  *
+  * \sa class CwiseBinaryOp, class CwiseNullaryOp
+  */
+template<typename UnaryOp, typename XprType>
+class CwiseUnaryOp : public ArrayOp< CwiseUnaryOp<UnaryOp, XprType> >
+{
+    typedef typename internal::remove_all<XprType>::type NestedExpression;
+
+public:
+    typedef typename internal::traits<CwiseUnaryOp>::Scalar Scalar;
+
+    NC_DEVICE_FUNC
+    NC_STRONG_INLINE explicit CwiseUnaryOp(const NestedExpression& xpr, const UnaryOp& func = UnaryOp())
+    : _xpr(xpr), _functor(func) {}
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE const Shape& shape() const { return _xpr.shape(); }
+
+    NC_DEVICE_FUNC NC_STRONG_INLINE Index size() const { return _xpr.size(); }
+
+    /** \returns the nested expression */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const NestedExpression& nestedExpression() const { return _xpr; }
+
+    /** \returns the functor representing the unary operation */
+    NC_DEVICE_FUNC NC_STRONG_INLINE const UnaryOp& functor() const { return _functor; }
+
+protected:
+    typename internal::nested<XprType>::type _xpr;
+    const UnaryOp _functor;
+};
+
+NS_END
+
+#endif
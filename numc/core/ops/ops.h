@@ -12,6 +12,9 @@
 #define __NC_OPS_H__
 
 
+#include "cwise_nullary_op.h"
+#include "cwise_unary_op.h"
 #include "cwise_binary_op.h"
+#include "cwise_ternary_op.h"
 
 #endif
\ No newline at end of file
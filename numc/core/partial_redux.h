@@ -0,0 +1,402 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PARTIAL_REDUX_H__
+#define __NC_PARTIAL_REDUX_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class redux_axes
+  *
+  * \brief Axes of a partial reduction, and the mapping of the slices of the reduced expression to the result
+  *
+  * The result has the shape of the expression without the reduced axes. Like the expression, it is seen as
+  * slices along its last dimension: the slice \a outer of the expression (see inner_size()) is reduced into
+  * the row row(outer) of the result, which is a single coefficient when the last axis is reduced.
+  */
+class redux_axes
+{
+public:
+    redux_axes(const Shape& shape, const Index* axes, Index count) : _dims(shape.dims()), _count(1)
+    {
+        for(Index i=0; i<_dims; ++i)
+            _reduced[i] = false;
+        for(Index k=0; k<count; ++k)
+        {
+            const Index axis = axes[k] < 0 ? axes[k] + _dims : axes[k];
+            nc_assert(axis >= 0 && axis < _dims && "reduction axis out of range");
+            nc_assert(!_reduced[axis] && "reduction axis repeated");
+            _reduced[axis] = true;
+        }
+
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index resultDims = 0;
+        for(Index i=0; i<_dims; ++i)
+        {
+            _extents[i] = shape[i];
+            _keptExtents[i] = _reduced[i] ? 1 : shape[i];
+            if(_reduced[i]) _count *= shape[i];
+            else extents[resultDims++] = shape[i];
+        }
+        _resultShape = Shape(extents, resultDims);
+
+        // strides of the leading dimensions in rows of the result, and in slices reduced into the same row
+        Index rowStride = 1, indexStride = 1;
+        _leadingReduced = false;
+        for(Index i=_dims-2; i>=0; --i)
+        {
+            _rowStrides[i] = _reduced[i] ? 0 : rowStride;
+            _indexStrides[i] = _reduced[i] ? indexStride : 0;
+            if(_reduced[i]) indexStride *= shape[i];
+            else rowStride *= shape[i];
+            _leadingReduced = _leadingReduced || _reduced[i];
+        }
+    }
+
+    /** \returns whether the last axis is reduced */
+    bool innerReduced() const { return _dims > 0 && _reduced[_dims-1]; }
+
+    /** \returns whether an axis other than the last one is reduced, i.e. several slices go to the same row */
+    bool leadingReduced() const { return _leadingReduced; }
+
+    bool allReduced() const { return _resultShape.dims() == 0; }
+
+    /** \returns the number of coefficients reduced into each coefficient of the result */
+    Index count() const { return _count; }
+
+    const Shape& resultShape() const { return _resultShape; }
+
+    /** \returns the shape of the result keeping the reduced axes with an extent of 1, which broadcasts
+      * the result back against the expression */
+    Shape keptShape() const { return Shape(_keptExtents, _dims); }
+
+    /** \returns the row of the result the slice \a outer is reduced into, and in \a index the position of
+      * the slice among the ones reduced into that row (row-major over the reduced leading axes) */
+    NC_STRONG_INLINE Index row(Index outer, Index& index) const
+    {
+        Index r = 0;
+        index = 0;
+        for(Index i=_dims-2; i>=0; --i)
+        {
+            const Index e = _extents[i];
+            const Index j = outer % e;
+            outer /= e;
+            r += j * _rowStrides[i];
+            index += j * _indexStrides[i];
+        }
+        return r;
+    }
+
+protected:
+    Index _dims;
+    Index _count;
+    bool _leadingReduced;
+    bool _reduced[MAX_ARRAY_DIMENSIONS];
+    Index _extents[MAX_ARRAY_DIMENSIONS];
+    Index _keptExtents[MAX_ARRAY_DIMENSIONS];
+    Index _rowStrides[MAX_ARRAY_DIMENSIONS];
+    Index _indexStrides[MAX_ARRAY_DIMENSIONS];
+    Shape _resultShape;
+};
+
+
+/** \internal
+  * \class partial_redux_impl
+  *
+  * \brief Reduces an expression along some axes into an Array
+  *
+  * The loop order depends on whether the last axis is reduced:
+  *  \li it is: each slice along the last dimension is reduced like a full reduction (pairwise, several
+  *      accumulators, vectorized when contiguous) into one coefficient of the result. The slices are split
+  *      over threads when each one has its own result coefficient.
+  *  \li it is not: each slice is combined coefficient-wise into a row of the result, reading the expression
+  *      in storage order. The rows are processed by blocks of columns small enough for the result block to
+  *      stay in the L1 cache across all the slices, and the columns are split over threads.
+  *
+  * The first slice reduced into a row initializes it, so that no identity element is needed.
+  */
+template<typename Func, typename Derived>
+struct partial_redux_impl
+{
+    typedef redux_traits<Func, Derived> Traits;
+    typedef typename Traits::Scalar Scalar;
+    typedef typename Traits::Evaluator Evaluator;
+    typedef typename Traits::PacketType PacketType;
+    typedef redux_slice_reader<Evaluator, Scalar> SliceReader;
+
+    enum {
+        PacketSize = Traits::PacketSize,
+        ColumnBlock = 2048      // result coefficients per block of columns
+    };
+
+    struct inner_reduced_range
+    {
+        const Evaluator& eval;
+        const redux_axes& axes;
+        const Func& func;
+        Scalar* result;
+        Index inner;
+        bool vectorize;
+
+        void operator()(Index begin, Index end) const
+        {
+            Index index;
+            for(Index o=begin; o<end; ++o)
+            {
+                const Index k = axes.row(o, index);
+                const Scalar r = vectorize
+                               ? redux_run<Func, Scalar, Traits::MayVectorize>::run(func, SliceReader(eval, o), inner)
+                               : redux_run<Func, Scalar, false>::run(func, SliceReader(eval, o), inner);
+                result[k] = index == 0 ? r : func(result[k], r);
+            }
+        }
+    };
+
+    struct inner_kept_range
+    {
+        const Evaluator& eval;
+        const redux_axes& axes;
+        const Func& func;
+        Scalar* result;
+        Index outer;
+        Index inner;
+        bool vectorize;
+
+        void operator()(Index begin, Index end) const
+        {
+            for(Index blockBegin=begin; blockBegin<end; blockBegin+=ColumnBlock)
+            {
+                const Index blockEnd = numext::mini(blockBegin + Index(ColumnBlock), end);
+                Index index;
+                for(Index o=0; o<outer; ++o)
+                {
+                    Scalar* row = result + axes.row(o, index) * inner;
+                    if(vectorize)
+                        accumulate(row, o, blockBegin, blockEnd, index == 0, typename conditional<Traits::MayVectorize, true_type, false_type>::type());
+                    else
+                        accumulate(row, o, blockBegin, blockEnd, index == 0, false_type());
+                }
+            }
+        }
+
+        NC_STRONG_INLINE void accumulate(Scalar* row, Index o, Index begin, Index end, bool first, true_type) const
+        {
+            Index j = begin;
+            const Index packetEnd = begin + ((end - begin) / PacketSize) * PacketSize;
+            if(first)
+                for(; j<packetEnd; j+=PacketSize)
+                    pstoreu(row + j, eval.template packet<Unaligned,PacketType>(o, j));
+            else
+                for(; j<packetEnd; j+=PacketSize)
+                    pstoreu(row + j, func.packetOp(ploadu<PacketType>(row + j), eval.template packet<Unaligned,PacketType>(o, j)));
+            accumulate(row, o, j, end, first, false_type());
+        }
+
+        NC_STRONG_INLINE void accumulate(Scalar* row, Index o, Index begin, Index end, bool first, false_type) const
+        {
+            if(first)
+                for(Index j=begin; j<end; ++j)
+                    row[j] = eval.coeff(o, j);
+            else
+                for(Index j=begin; j<end; ++j)
+                    row[j] = func(row[j], eval.coeff(o, j));
+        }
+    };
+
+    static Array<Scalar> run(const Derived& xpr, std::initializer_list<Index> axisList, const Func& func)
+    {
+        const redux_axes axes(xpr.shape(), axisList.begin(), Index(axisList.size()));
+        Array<Scalar> result(axes.resultShape());
+        if(result.size() == 0)
+            return result;
+        nc_assert(axes.count() > 0 && "reducing an empty axis");
+
+        if(axes.allReduced())
+        {
+            result.coeffRef(0) = redux_impl<Func, Derived>::run(xpr, func);
+            return result;
+        }
+
+        const Evaluator eval(xpr);
+        const Index outer = outer_size(xpr.shape()), inner = inner_size(xpr.shape());
+        const bool vectorize = Traits::MayVectorize && eval.innerContiguous();
+        const int threads = Traits::threads(xpr.size(), vectorize);
+        if(axes.innerReduced())
+        {
+            const inner_reduced_range range = { eval, axes, func, result.data(), inner, vectorize };
+            parallel_for(outer, Index(1), axes.leadingReduced() ? 1 : threads, range);
+        }
+        else
+        {
+            const inner_kept_range range = { eval, axes, func, result.data(), outer, inner, vectorize };
+            parallel_for(inner, Index(PacketSize), threads, range);
+        }
+        return result;
+    }
+};
+
+
+/** \internal
+  * \returns the indices along \a axis of the first minimum (\a IsMax false) or maximum (\a IsMax true)
+  * coefficients of \a xpr, in an array of the shape of \a xpr without \a axis
+  */
+template<bool IsMax, typename Derived>
+Array<Index> partial_redux_arg(const Derived& xpr, Index axis)
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    const redux_axes axes(xpr.shape(), &axis, 1);
+    Array<Index> result(axes.resultShape());
+    if(result.size() == 0)
+        return result;
+    nc_assert(axes.count() > 0 && "reducing an empty axis");
+
+    const evaluator<Derived> eval(xpr);
+    const Index outer = outer_size(xpr.shape()), inner = inner_size(xpr.shape());
+    Index index;
+    if(axes.innerReduced())
+    {
+        for(Index o=0; o<outer; ++o)
+        {
+            const Index k = axes.row(o, index);
+            Scalar best = eval.coeff(o, 0);
+            Index arg = 0;
+            for(Index i=1; i<inner; ++i)
+            {
+                const Scalar x = eval.coeff(o, i);
+                if(IsMax ? best < x : x < best)
+                {
+                    best = x;
+                    arg = i;
+                }
+            }
+            result.coeffRef(k) = arg;
+        }
+        return result;
+    }
+
+    // the slices along the axis are walked in storage order, the best values so far kept next to the result
+    Array<Scalar> best(axes.resultShape());
+    for(Index o=0; o<outer; ++o)
+    {
+        const Index k = axes.row(o, index) * inner;
+        for(Index i=0; i<inner; ++i)
+        {
+            const Scalar x = eval.coeff(o, i);
+            if(index == 0 || (IsMax ? best.coeff(k+i) < x : x < best.coeff(k+i)))
+            {
+                best.coeffRef(k+i) = x;
+                result.coeffRef(k+i) = index;
+            }
+        }
+    }
+    return result;
+}
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns the sums of the coefficients of *this along \a axes, in an array of the shape of *this without
+  * \a axes (numpy's \c sum(axis=axes)). Negative axes count from the last one.
+  * \code
+  * Array<float> a(4, 5, 6);
+  * Array<float> b = a.sum({0, 2});      // shape (5)
+  * \endcode
+  * The reduction reads *this in storage order whichever axes are reduced.
+  */
+template<typename Derived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::sum(std::initializer_list<Index> axes) const
+{
+    return internal::partial_redux_impl<internal::scalar_sum_op<Scalar, Scalar>, Derived>::run(derived(), axes, internal::scalar_sum_op<Scalar, Scalar>());
+}
+
+/** \returns the products of the coefficients of *this along \a axes, see sum(std::initializer_list<Index>) */
+template<typename Derived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::prod(std::initializer_list<Index> axes) const
+{
+    return internal::partial_redux_impl<internal::scalar_product_op<Scalar, Scalar>, Derived>::run(derived(), axes, internal::scalar_product_op<Scalar, Scalar>());
+}
+
+/** \returns the minima of the coefficients of *this along \a axes, see sum(std::initializer_list<Index>) */
+template<typename Derived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::min(std::initializer_list<Index> axes) const
+{
+    return internal::partial_redux_impl<internal::scalar_min_op<Scalar, Scalar>, Derived>::run(derived(), axes, internal::scalar_min_op<Scalar, Scalar>());
+}
+
+/** \returns the maxima of the coefficients of *this along \a axes, see sum(std::initializer_list<Index>) */
+template<typename Derived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::max(std::initializer_list<Index> axes) const
+{
+    return internal::partial_redux_impl<internal::scalar_max_op<Scalar, Scalar>, Derived>::run(derived(), axes, internal::scalar_max_op<Scalar, Scalar>());
+}
+
+/** \returns the means of the coefficients of *this along \a axes, see sum(std::initializer_list<Index>) and mean() */
+template<typename Derived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::mean(std::initializer_list<Index> axes) const
+{
+    Array<Scalar> result = sum(axes);
+    if(result.size() == 0) return result;
+    const Scalar count = Scalar(size() / result.size());
+    for(Index i=0; i<result.size(); ++i)
+        result.coeffRef(i) /= count;
+    return result;
+}
+
+/** \returns the variances of the coefficients of *this along \a axes, see sum(std::initializer_list<Index>) and var() */
+template<typename Derived>
+Array<typename ArrayOp<Derived>::RealScalar> ArrayOp<Derived>::var(std::initializer_list<Index> axes) const
+{
+    const internal::redux_axes parsed(shape(), axes.begin(), Index(axes.size()));
+    const Array<Scalar> m = mean(axes);
+    if(m.size() == 0) return Array<RealScalar>(m.shape());
+
+    // the means broadcast back along the reduced axes
+    const ArrayView<const Scalar> mv = m.reshape(parsed.keptShape());
+    Array<RealScalar> result = (derived() - mv).abs2().sum(axes);
+    const RealScalar count = RealScalar(parsed.count());
+    for(Index i=0; i<result.size(); ++i)
+        result.coeffRef(i) /= count;
+    return result;
+}
+
+/** \returns the euclidean norms of *this along \a axes, see sum(std::initializer_list<Index>) and norm() */
+template<typename Derived>
+Array<typename ArrayOp<Derived>::RealScalar> ArrayOp<Derived>::norm(std::initializer_list<Index> axes) const
+{
+    using std::sqrt;
+    Array<RealScalar> result = abs2().sum(axes);
+    for(Index i=0; i<result.size(); ++i)
+        result.coeffRef(i) = RealScalar(sqrt(result.coeff(i)));
+    return result;
+}
+
+/** \returns the indices along \a axis of the first minima of *this, in an array of the shape of *this
+  * without \a axis (numpy's \c argmin(axis=axis)). A negative axis counts from the last one.
+  */
+template<typename Derived>
+Array<Index> ArrayOp<Derived>::argmin(Index axis) const
+{
+    return internal::partial_redux_arg<false>(derived(), axis);
+}
+
+/** \returns the indices along \a axis of the first maxima of *this, see argmin(Index) */
+template<typename Derived>
+Array<Index> ArrayOp<Derived>::argmax(Index axis) const
+{
+    return internal::partial_redux_arg<true>(derived(), axis);
+}
+
+NS_END
+
+#endif
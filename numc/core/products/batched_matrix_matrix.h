@@ -0,0 +1,324 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_BATCHED_MATRIX_MATRIX_H__
+#define __NC_BATCHED_MATRIX_MATRIX_H__
+
+// Largest rows x cols x depth product computed by the small matrix kernel rather than the blocked one
+#ifndef NC_SMALL_PRODUCT_THRESHOLD
+#define NC_SMALL_PRODUCT_THRESHOLD (48*48*48)
+#endif
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class small_matrix_product
+  *
+  * \brief Unblocked product of a small lhs by a small rhs whose rows are contiguous
+  *
+  * Nothing is packed: the result is computed by blocks of RowBlock rows and ColPackets packets accumulated
+  * in registers, the lhs coefficients being broadcast from their place and the rhs rows, which all stay in
+  * the L1 cache, being read with unaligned loads. The blocks are unrolled at compile-time, with a block of
+  * one packet and scalar columns for the borders. Matrices narrower than a packet use half packets
+  * (e.g. SSE packets for 4 x 4 floats on AVX). This is cheaper than the setup of the blocked product as
+  * long as the rhs fits in the L1 cache.
+  */
+template<typename Scalar, typename PacketType = typename gemm_traits<Scalar>::PacketType>
+struct small_matrix_product
+{
+    typedef typename unpacket_traits<PacketType>::half HalfPacket;
+    enum {
+        PacketSize = unpacket_traits<PacketType>::size,
+        HasHalfPacket = int(unpacket_traits<HalfPacket>::size) < int(PacketSize),
+        RowBlock = 4,
+        ColPackets = 2
+    };
+
+    static void run(Index rows, Index cols, Index depth, const gemm_matrix<Scalar>& lhs, const Scalar* rhs,
+                    Index rhsStride, Scalar* res, Index resStride)
+    {
+        if(HasHalfPacket && cols < PacketSize)
+        {
+            small_matrix_product<Scalar, HalfPacket>::run(rows, cols, depth, lhs, rhs, rhsStride, res, resStride);
+            return;
+        }
+
+        Index i = 0;
+        for(; i+RowBlock<=rows; i+=RowBlock)
+            run_rows<RowBlock>(i, cols, depth, lhs, rhs, rhsStride, res, resStride);
+        for(; i<rows; ++i)
+            run_rows<1>(i, cols, depth, lhs, rhs, rhsStride, res, resStride);
+    }
+
+private:
+    template<int Rows>
+    static NC_STRONG_INLINE void run_rows(Index i, Index cols, Index depth, const gemm_matrix<Scalar>& lhs,
+                                          const Scalar* rhs, Index rhsStride, Scalar* res, Index resStride)
+    {
+        Index j = 0;
+        for(; j+ColPackets*PacketSize<=cols; j+=ColPackets*PacketSize)
+            run_block<Rows, ColPackets>(i, j, depth, lhs, rhs, rhsStride, res, resStride);
+        for(; j+PacketSize<=cols; j+=PacketSize)
+            run_block<Rows, 1>(i, j, depth, lhs, rhs, rhsStride, res, resStride);
+        for(; j<cols; ++j)
+            gemm_unroll<0, Rows>::run([&](int r) {
+                Scalar sum = Scalar(0);
+                for(Index k=0; k<depth; ++k)
+                    sum += lhs(i + r, k) * rhs[k * rhsStride + j];
+                res[(i + r) * resStride + j] = sum;
+            });
+    }
+
+    template<int Rows, int Packets>
+    static NC_STRONG_INLINE void run_block(Index i, Index j, Index depth, const gemm_matrix<Scalar>& lhs,
+                                           const Scalar* rhs, Index rhsStride, Scalar* res, Index resStride)
+    {
+        PacketType acc[Rows][Packets];
+        gemm_unroll<0, Rows*Packets>::run([&](int t) { acc[t / Packets][t % Packets] = pset1<PacketType>(Scalar(0)); });
+
+        for(Index k=0; k<depth; ++k)
+        {
+            const Scalar* src = rhs + k * rhsStride + j;
+            PacketType b[Packets];
+            gemm_unroll<0, Packets>::run([&](int p) { b[p] = ploadu<PacketType>(src + p * PacketSize); });
+            gemm_unroll<0, Rows>::run([&](int r) {
+                const PacketType a = pset1<PacketType>(lhs(i + r, k));
+                gemm_unroll<0, Packets>::run([&](int p) { acc[r][p] = pmadd(a, b[p], acc[r][p]); });
+            });
+        }
+
+        gemm_unroll<0, Rows*Packets>::run([&](int t) {
+            pstoreu(res + (i + t / Packets) * resStride + j + (t % Packets) * PacketSize, acc[t / Packets][t % Packets]);
+        });
+    }
+};
+
+
+/** \internal
+  * \class batch_layout
+  *
+  * \brief Batch dimensions of a batched product, with the strides of both operands along them
+  *
+  * An operand broadcast along a batch dimension (missing, or of extent 1) has a stride of 0 along it. The
+  * result is contiguous, the matrix of batch index \a b starting at b * rows * cols.
+  */
+struct batch_layout
+{
+    Index dims;
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    Index lhsStrides[MAX_ARRAY_DIMENSIONS];
+    Index rhsStrides[MAX_ARRAY_DIMENSIONS];
+
+    /** \returns the number of matrices in the batch */
+    Index count() const
+    {
+        Index n = 1;
+        for(Index d=0; d<dims; ++d) n *= extents[d];
+        return n;
+    }
+
+    /** Computes the offsets of the operands of the matrix of batch index \a b */
+    void offsets(Index b, Index& lhsOffset, Index& rhsOffset) const
+    {
+        lhsOffset = 0;
+        rhsOffset = 0;
+        for(Index d=dims-1; d>=0; --d)
+        {
+            const Index i = b % extents[d];
+            b /= extents[d];
+            lhsOffset += i * lhsStrides[d];
+            rhsOffset += i * rhsStrides[d];
+        }
+    }
+
+    /** \returns true when the rhs is the same matrix for the whole batch */
+    bool sharedRhs() const
+    {
+        for(Index d=0; d<dims; ++d)
+            if(rhsStrides[d] != 0 && extents[d] != 1) return false;
+        return true;
+    }
+
+    /** \returns true when the lhs matrices of the batch, stacked, are a single matrix of rows with a stride of
+      * \a rowStride, i.e. the batch dimensions of the lhs continue its rows */
+    bool stackedLhs(Index rows, Index rowStride) const
+    {
+        Index stride = rows * rowStride;
+        for(Index d=dims-1; d>=0; --d)
+        {
+            if(extents[d] == 1) continue;
+            if(lhsStrides[d] != stride) return false;
+            stride *= extents[d];
+        }
+        return true;
+    }
+};
+
+
+/** \internal
+  * \class batched_matrix_matrix_product
+  *
+  * \brief Product of the matrices of a batch, with the operands broadcast along the batch dimensions
+  *
+  * The strategy depends on the size of the matrices rather than on the size of the batch:
+  *  \li a single matrix, or a batched lhs by a shared rhs when the lhs matrices stack into one (e.g. a
+  *      contiguous (b, m, k) lhs by a (k, n) rhs), is computed as a single 2-dimension product;
+  *  \li small matrices are computed by the unblocked small_matrix_product, the threads splitting the batch.
+  *      An rhs whose rows are not contiguous is packed once when it is shared by the batch, otherwise once
+  *      per matrix into the workspace of the thread;
+  *  \li large matrices are computed by general_matrix_matrix_product, the threads splitting the batch when
+  *      it has enough matrices to feed them, the product of each matrix otherwise.
+  * In every case, each coefficient of the result is accumulated over the depth in the same order whatever
+  * the number of threads.
+  */
+template<typename Scalar>
+struct batched_matrix_matrix_product
+{
+    typedef gemm_traits<Scalar> Traits;
+
+    struct context
+    {
+        const batch_layout* layout;
+        Index rows, cols, depth;
+        const gemm_matrix<Scalar>* lhs;
+        const gemm_matrix<Scalar>* rhs;
+        const Scalar* sharedRhs;
+        Index sharedRhsStride;
+        Scalar* res;
+    };
+
+    struct small_range
+    {
+        const context& ctx;
+
+        void operator()(Index begin, Index end) const
+        {
+            const Index depth = ctx.depth, cols = ctx.cols;
+            for(Index b=begin; b<end; ++b)
+            {
+                Index lhsOffset, rhsOffset;
+                ctx.layout->offsets(b, lhsOffset, rhsOffset);
+                const gemm_matrix<Scalar> lhs(ctx.lhs->data + lhsOffset, ctx.lhs->rowStride, ctx.lhs->colStride);
+
+                const Scalar* rhs = ctx.sharedRhs;
+                Index rhsStride = ctx.sharedRhsStride;
+                if(!rhs)
+                {
+                    const gemm_matrix<Scalar> src(ctx.rhs->data + rhsOffset, ctx.rhs->rowStride, ctx.rhs->colStride);
+                    if(src.colStride == 1)
+                    {
+                        rhs = src.data;
+                        rhsStride = src.rowStride;
+                    }
+                    else
+                    {
+                        Scalar* packed = gemm_workspace<Scalar>::local().reserve(depth * cols);
+                        pack(packed, src, depth, cols);
+                        rhs = packed;
+                        rhsStride = cols;
+                    }
+                }
+                small_matrix_product<Scalar>::run(ctx.rows, cols, depth, lhs, rhs, rhsStride,
+                                                  ctx.res + b * ctx.rows * cols, cols);
+            }
+        }
+    };
+
+    struct large_range
+    {
+        const context& ctx;
+
+        void operator()(Index begin, Index end) const
+        {
+            for(Index b=begin; b<end; ++b)
+            {
+                Index lhsOffset, rhsOffset;
+                ctx.layout->offsets(b, lhsOffset, rhsOffset);
+                const gemm_matrix<Scalar> lhs(ctx.lhs->data + lhsOffset, ctx.lhs->rowStride, ctx.lhs->colStride);
+                const gemm_matrix<Scalar> rhs(ctx.rhs->data + rhsOffset, ctx.rhs->rowStride, ctx.rhs->colStride);
+                general_matrix_matrix_product<Scalar>::run(ctx.rows, ctx.cols, ctx.depth, lhs, rhs,
+                                                           ctx.res + b * ctx.rows * ctx.cols, ctx.cols);
+            }
+        }
+    };
+
+    static void run(const batch_layout& layout, Index rows, Index cols, Index depth,
+                    const gemm_matrix<Scalar>& lhs, const gemm_matrix<Scalar>& rhs, Scalar* res)
+    {
+        const Index count = layout.count();
+        if(count == 0 || rows == 0 || cols == 0) return;
+
+        const bool sharedRhs = layout.sharedRhs();
+        if(count == 1 || (sharedRhs && layout.stackedLhs(rows, lhs.rowStride)))
+        {
+            general_matrix_matrix_product<Scalar>::run(count * rows, cols, depth, lhs, rhs, res, cols);
+            return;
+        }
+
+        context ctx;
+        ctx.layout = &layout;
+        ctx.rows = rows;
+        ctx.cols = cols;
+        ctx.depth = depth;
+        ctx.lhs = &lhs;
+        ctx.rhs = &rhs;
+        ctx.sharedRhs = 0;
+        ctx.sharedRhsStride = 0;
+        ctx.res = res;
+
+        const double cost = double(count) * double(rows) * double(cols) * double(depth)
+                          * (NumTraits<Scalar>::MulCost + NumTraits<Scalar>::AddCost) / Traits::PacketSize;
+        const int threads = parallel_threads(cost);
+
+        const bool small = double(rows) * double(cols) * double(depth) <= double(NC_SMALL_PRODUCT_THRESHOLD)
+                        && depth * cols * Index(sizeof(Scalar)) <= cache_sizes::get().l1 / 2;
+        if(small)
+        {
+            scratch_buffer<Scalar> packed;
+            if(sharedRhs)
+            {
+                if(rhs.colStride == 1)
+                {
+                    ctx.sharedRhs = rhs.data;
+                    ctx.sharedRhsStride = rhs.rowStride;
+                }
+                else
+                {
+                    packed.allocate(std::size_t(depth * cols));
+                    pack(packed.data(), rhs, depth, cols);
+                    ctx.sharedRhs = packed.data();
+                    ctx.sharedRhsStride = cols;
+                }
+            }
+            const small_range range = { ctx };
+            parallel_for(count, Index(1), threads, range);
+            return;
+        }
+
+        // the batch is split when each thread gets a matrix, the product of each matrix is split otherwise
+        const large_range range = { ctx };
+        if(count >= Index(threads))
+            parallel_for(count, Index(1), threads, range);
+        else
+            range(0, count);
+    }
+
+    /** \internal Copies the \a depth x \a cols matrix \a src into \a dst, row-major */
+    static void pack(Scalar* dst, const gemm_matrix<Scalar>& src, Index depth, Index cols)
+    {
+        for(Index k=0; k<depth; ++k)
+            for(Index j=0; j<cols; ++j)
+                dst[k * cols + j] = src(k, j);
+    }
+};
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,248 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_BLAS_H__
+#define __NC_BLAS_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns a view writing into the coefficients of the output argument \a dst of a BLAS function */
+template<typename Scalar>
+ArrayView<Scalar> writable_view(Array<Scalar>& dst) { return dst.view(); }
+
+template<typename Scalar>
+ArrayView<Scalar> writable_view(const ArrayView<Scalar>& dst) { return dst; }
+
+template<typename Scalar, Index... Dims>
+ArrayView<Scalar> writable_view(FixedArray<Scalar, Dims...>& dst) { return dst.view(); }
+
+template<typename Scalar, int MapOptions>
+ArrayView<Scalar> writable_view(const Map<Array<Scalar>, MapOptions>& dst) { return dst.view(); }
+
+#ifdef NC_USE_BLAS
+
+/** \internal
+  * Hands dot(\a x, \a y) to the external CBLAS, \returns false when it cannot take it: the operands must be
+  * arrays or views, either vectors or contiguous. Other expressions are not evaluated for it.
+  */
+template<typename X, typename Y, bool Direct = (traits<X>::Flags & traits<Y>::Flags & DirectAccessBit) != 0>
+struct blas_dot
+{
+    static bool run(const X&, const Y&, typename traits<X>::Scalar&) { return false; }
+};
+
+template<typename X, typename Y>
+struct blas_dot<X, Y, true>
+{
+    typedef typename traits<X>::Scalar Scalar;
+
+    static bool run(const X& x, const Y& y, Scalar& result)
+    {
+        const gemm_operand<X> xOperand(x);
+        const gemm_operand<Y> yOperand(y);
+        const ArrayView<const Scalar>& u = xOperand.view();
+        const ArrayView<const Scalar>& v = yOperand.view();
+        if(u.dims() == 1)
+            return blas_backend<Scalar>::dot(u.size(), u.data(), u.strides()[0], v.data(), v.strides()[0], result);
+        return u.is_contiguous() && v.is_contiguous() && blas_backend<Scalar>::dot(u.size(), u.data(), 1, v.data(), 1, result);
+    }
+};
+
+/** \internal Hands nrm2(\a x) to the external CBLAS, \returns false when it cannot take it, see blas_dot */
+template<typename X, bool Direct = (traits<X>::Flags & DirectAccessBit) != 0>
+struct blas_nrm2
+{
+    static bool run(const X&, typename NumTraits<typename traits<X>::Scalar>::Real&) { return false; }
+};
+
+template<typename X>
+struct blas_nrm2<X, true>
+{
+    typedef typename traits<X>::Scalar Scalar;
+
+    static bool run(const X& x, typename NumTraits<Scalar>::Real& result)
+    {
+        const gemm_operand<X> operand(x);
+        const ArrayView<const Scalar>& u = operand.view();
+        if(u.dims() == 1)
+            return blas_backend<Scalar>::nrm2(u.size(), u.data(), u.strides()[0], result);
+        return u.is_contiguous() && blas_backend<Scalar>::nrm2(u.size(), u.data(), 1, result);
+    }
+};
+
+#endif
+
+/** \internal
+  * \returns the euclidean norm of the coefficients of \a v, walked in place with its strides and accumulated
+  * as scale^2 * ssq where scale is the largest |x| met so far, as the reference BLAS does: no square overflows
+  * nor underflows. An infinite or NaN coefficient is returned as is.
+  */
+template<typename Scalar>
+typename NumTraits<Scalar>::Real scaled_nrm2(const ArrayView<const Scalar>& v)
+{
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+    using std::abs; using std::sqrt;
+    RealScalar scale(0), ssq(1);
+    // the last dimension is walked by the inner loop, the others by an odometer of the rows
+    const Index dims = v.dims();
+    const Index inner = dims == 0 ? 1 : v.shape()[dims - 1], innerStride = dims == 0 ? 1 : v.strides()[dims - 1];
+    const Index rows = inner == 0 ? 0 : v.size() / inner;
+    Index row[MAX_ARRAY_DIMENSIONS] = { 0 };
+    const Scalar* data = v.data();
+    for(Index r=0; r<rows; ++r)
+    {
+        for(Index i=0; i<inner; ++i)
+        {
+            const RealScalar a = RealScalar(abs(data[i * innerStride]));
+            if(!(a <= NumTraits<RealScalar>::highest())) return a;
+            if(a == RealScalar(0)) continue;
+            if(scale < a)
+            {
+                ssq = RealScalar(1) + ssq * (scale / a) * (scale / a);
+                scale = a;
+            }
+            else
+                ssq += (a / scale) * (a / scale);
+        }
+        for(Index d=dims-2; d>=0; --d)
+        {
+            data += v.strides()[d];
+            if(++row[d] < v.shape()[d]) break;
+            data -= row[d] * v.strides()[d];
+            row[d] = 0;
+        }
+    }
+    return scale * sqrt(ssq);
+}
+
+/** \internal \returns whether all the coefficients of \a x are 0, which their squares summing to 0 does not
+  * tell: the squares of tiny ones underflow to 0 as well */
+template<typename X, bool IsComplex = NumTraits<typename traits<X>::Scalar>::IsComplex>
+struct nrm2_all_zero
+{
+    static bool run(const X& x) { return x.size() == 0 || x.abs().max() == typename traits<X>::Scalar(0); }
+};
+
+/** \internal Complex coefficients have no maximum, they are left to the second pass */
+template<typename X>
+struct nrm2_all_zero<X, true>
+{
+    static bool run(const X& x) { return x.size() == 0; }
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns the sum of the products of the coefficients of \a x and \a y, which must have the same shape.
+  *
+  * This is the BLAS \c dot, computed in a single pass like (x * y).sum(), see redux(). With NC_USE_BLAS,
+  * it is handed to the external CBLAS when the operands are arrays or views it can read.
+  */
+template<typename X, typename Y>
+typename internal::traits<X>::Scalar dot(const ArrayOp<X>& x, const ArrayOp<Y>& y)
+{
+    nc_assert(x.shape() == y.shape() && "dot: the operands must have the same shape");
+#ifdef NC_USE_BLAS
+    typename internal::traits<X>::Scalar result;
+    if(internal::blas_dot<X, Y>::run(x.derived(), y.derived(), result)) return result;
+#endif
+    return (x * y).sum();
+}
+
+/** \returns the euclidean norm of \a x, the BLAS \c nrm2.
+  *
+  * Unlike ArrayOp::norm(), which sums the squares |x|^2 as they come, it does not overflow nor underflow when
+  * the squares do, e.g. for floats beyond 1e19 or below 1e-19. The squares are summed in a single vectorized
+  * pass first, and only when their sum is not finite or too small to be accurate are the coefficients scaled
+  * by the largest |x| in a second pass, see internal::scaled_nrm2(), which reads arrays and views in place.
+  * With NC_USE_BLAS, the norm is handed to the external CBLAS when \a x is an array or a view it can read.
+  */
+template<typename X>
+typename NumTraits<typename internal::traits<X>::Scalar>::Real nrm2(const ArrayOp<X>& x)
+{
+    typedef typename internal::traits<X>::Scalar Scalar;
+    typedef typename NumTraits<Scalar>::Real RealScalar;
+#ifdef NC_USE_BLAS
+    RealScalar result;
+    if(internal::blas_nrm2<X>::run(x.derived(), result)) return result;
+#endif
+    using std::sqrt;
+    const RealScalar ssq = x.abs2().sum();
+    if(ssq <= NumTraits<RealScalar>::highest()
+       && ssq >= std::numeric_limits<RealScalar>::min() / NumTraits<RealScalar>::epsilon())
+        return sqrt(ssq);
+    if(ssq == RealScalar(0) && internal::nrm2_all_zero<X>::run(x.derived()))
+        return RealScalar(0);
+    const internal::gemm_operand<X> operand(x.derived());
+    return internal::scaled_nrm2(operand.view());
+}
+
+/** Computes \a y = \a alpha * \a x + \a y, the BLAS \c axpy.
+  *
+  * \a y is an Array or a (mutable) view of the shape of \a x. This is the same single pass as the expression
+  * \code
+  * y = alpha * x + y;
+  * \endcode
+  */
+template<typename X, typename Y>
+void axpy(const typename internal::traits<X>::Scalar& alpha, const ArrayOp<X>& x, const ArrayOp<Y>& y)
+{
+    nc_assert(x.shape() == y.shape() && "axpy: the operands must have the same shape");
+    Y& dst = const_cast<Y&>(y.derived());
+    dst = alpha * x + dst;
+}
+
+/** Computes \a x = \a alpha * \a x, the BLAS \c scal. \a x is an Array or a (mutable) view. */
+template<typename X>
+void scal(const typename internal::traits<X>::Scalar& alpha, const ArrayOp<X>& x)
+{
+    X& dst = const_cast<X&>(x.derived());
+    dst = alpha * dst;
+}
+
+/** Computes \a y = \a alpha * \a a * \a x + \a beta * \a y, the BLAS \c gemv.
+  *
+  * \a a is a 2-dimension matrix, \a x and \a y are vectors, \a y being an Array or a (mutable) view which
+  * must not overlap \a a or \a x. When \a beta is 0, \a y is not read. The layout of \a a picks the kernel,
+  * and the transposed product is the product by a transposed view:
+  * \code
+  * Array<float> a(512, 256), x(256), y(512), z(256);
+  * gemv(1.f, a, x, 0.f, y);                // y = a * x, a read row by row
+  * gemv(2.f, a.transpose(), y, 1.f, z);    // z = 2 * a^T * y + z, a read column by column
+  * \endcode
+  * See internal::general_matrix_vector_product for the kernels.
+  */
+template<typename Lhs, typename Rhs, typename Dst>
+void gemv(const typename internal::traits<Lhs>::Scalar& alpha, const ArrayOp<Lhs>& a, const ArrayOp<Rhs>& x,
+          const typename internal::traits<Lhs>::Scalar& beta, const ArrayOp<Dst>& y)
+{
+    typedef typename internal::traits<Lhs>::Scalar Scalar;
+    NC_STATIC_ASSERT((internal::is_same<Scalar, typename internal::traits<Rhs>::Scalar>::value
+                      && internal::is_same<Scalar, typename internal::traits<Dst>::Scalar>::value),
+                     "The operands of a matrix-vector product must have the same scalar type")
+    nc_assert(a.dims() == 2 && x.dims() == 1 && y.dims() == 1);
+    nc_assert(a.shape()[1] == x.shape()[0] && a.shape()[0] == y.shape()[0] && "gemv: the shapes do not match");
+
+    const internal::gemm_operand<Lhs> lhsOperand(a.derived());
+    const internal::gemm_operand<Rhs> rhsOperand(x.derived());
+    const ArrayView<const Scalar>& m = lhsOperand.view();
+    const ArrayView<const Scalar>& v = rhsOperand.view();
+    const ArrayView<Scalar> out = internal::writable_view(const_cast<Dst&>(y.derived()));
+
+    const internal::gemm_matrix<Scalar> matrix(m.data(), m.strides()[0], m.strides()[1]);
+    internal::general_matrix_vector_product<Scalar>::run(m.shape()[0], m.shape()[1], matrix, v.data(), v.strides()[0],
+                                                         out.data(), out.strides()[0], alpha, beta);
+}
+
+NS_END
+
+#endif
@@ -0,0 +1,177 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_BLAS_BACKEND_H__
+#define __NC_BLAS_BACKEND_H__
+
+#ifdef NC_USE_BLAS
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class blas_backend
+  *
+  * \brief Hands the products of \a Scalar to the external CBLAS selected by NC_USE_BLAS
+  *
+  * Each function \returns false when the library cannot take the product, the caller then running the numc
+  * kernel: only float and double are supported, and the sizes must fit in the \c int of the CBLAS interface.
+  * The operands are given with the strides of the numc kernels and are passed in place whenever CBLAS can
+  * read them, see blas_matrix and blas_vector, or are packed otherwise.
+  *
+  * The library runs its own threads, which may add up to the numc ones when a batch of products is split
+  * over the numc thread pool (see batched_matrix_matrix_product): limit the library to one thread, e.g. with
+  * OPENBLAS_NUM_THREADS=1, when products are batched.
+  */
+template<typename Scalar>
+struct blas_backend
+{
+    static bool gemm(Index, Index, Index, const gemm_matrix<Scalar>&, const gemm_matrix<Scalar>&, Scalar*, Index)
+    { return false; }
+
+    static bool gemv(Index, Index, const gemm_matrix<Scalar>&, const Scalar*, Index, Scalar*, Index,
+                     const Scalar&, const Scalar&)
+    { return false; }
+
+    static bool dot(Index, const Scalar*, Index, const Scalar*, Index, Scalar&) { return false; }
+
+    static bool nrm2(Index, const Scalar*, Index, typename NumTraits<Scalar>::Real&) { return false; }
+};
+
+/** \internal \returns whether \a size fits in the \c int sizes and strides of the CBLAS interface */
+inline bool blas_fits(Index size) { return size >= -Index(INT_MAX) && size <= Index(INT_MAX); }
+
+/** \internal
+  * \class blas_matrix
+  *
+  * \brief A rows x cols operand of a product as CBLAS reads it: a row-major matrix of leading dimension \a ld,
+  * transposed when \a trans is CblasTrans
+  *
+  * A matrix with unit column stride is read in place, and so is one with unit row stride (e.g. the transpose
+  * of a row-major one) as the transpose of a row-major matrix. Other strides are packed into a row-major copy.
+  */
+template<typename Scalar>
+struct blas_matrix
+{
+    blas_matrix(const gemm_matrix<Scalar>& m, Index rows, Index cols)
+    {
+        if(m.colStride == 1 && (rows == 1 || m.rowStride >= numext::maxi(cols, Index(1))))
+        {
+            trans = CblasNoTrans;
+            ld = rows == 1 ? numext::maxi(cols, Index(1)) : m.rowStride;
+            data = m.data;
+        }
+        else if(m.rowStride == 1 && (cols == 1 || m.colStride >= numext::maxi(rows, Index(1))))
+        {
+            trans = CblasTrans;
+            ld = cols == 1 ? numext::maxi(rows, Index(1)) : m.colStride;
+            data = m.data;
+        }
+        else
+        {
+            packed.allocate(std::size_t(rows * cols));
+            for(Index i=0; i<rows; ++i)
+                for(Index j=0; j<cols; ++j)
+                    packed.data()[i * cols + j] = m(i, j);
+            trans = CblasNoTrans;
+            ld = numext::maxi(cols, Index(1));
+            data = packed.data();
+        }
+    }
+
+    CBLAS_TRANSPOSE trans;
+    Index ld;
+    const Scalar* data;
+    scratch_buffer<Scalar> packed;
+};
+
+/** \internal
+  * \returns the pointer CBLAS expects for the vector of \a size coefficients starting at \a data with the
+  * stride \a stride: a negative stride walks the vector backwards from its last coefficient in memory.
+  */
+template<typename Scalar>
+Scalar* blas_vector(Scalar* data, Index size, Index stride)
+{
+    return stride < 0 && size > 0 ? data + (size - 1) * stride : data;
+}
+
+#define NC_MAKE_BLAS_BACKEND(SCALAR, PREFIX)                                                                    \
+template<>                                                                                                      \
+struct blas_backend<SCALAR>                                                                                     \
+{                                                                                                               \
+    static bool gemm(Index rows, Index cols, Index depth, const gemm_matrix<SCALAR>& lhs,                       \
+                     const gemm_matrix<SCALAR>& rhs, SCALAR* res, Index resStride)                              \
+    {                                                                                                           \
+        const Index ldc = rows == 1 ? numext::maxi(cols, Index(1)) : resStride;                                 \
+        if(ldc < cols || !blas_fits(rows) || !blas_fits(cols) || !blas_fits(depth) || !blas_fits(ldc))          \
+            return false;                                                                                       \
+        const blas_matrix<SCALAR> a(lhs, rows, depth), b(rhs, depth, cols);                                     \
+        if(!blas_fits(a.ld) || !blas_fits(b.ld)) return false;                                                  \
+        cblas_##PREFIX##gemm(CblasRowMajor, a.trans, b.trans, int(rows), int(cols), int(depth), SCALAR(1),      \
+                             a.data, int(a.ld), b.data, int(b.ld), SCALAR(0), res, int(ldc));                   \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    static bool gemv(Index rows, Index depth, const gemm_matrix<SCALAR>& lhs, const SCALAR* rhs,                \
+                     Index rhsStride, SCALAR* res, Index resStride, const SCALAR& alpha, const SCALAR& beta)    \
+    {                                                                                                           \
+        /* an empty depth quick-returns in CBLAS, which would not scale the result by beta */                  \
+        if(depth == 0 || resStride == 0 || !blas_fits(rows) || !blas_fits(depth) || !blas_fits(resStride)       \
+           || !blas_fits(rhsStride))                                                                            \
+            return false;                                                                                       \
+        const blas_matrix<SCALAR> a(lhs, rows, depth);                                                          \
+        if(!blas_fits(a.ld)) return false;                                                                      \
+        /* a broadcast vector is copied, CBLAS requiring non-zero increments */                                 \
+        scratch_buffer<SCALAR> contiguousRhs;                                                                   \
+        if(rhsStride == 0 && depth > 0)                                                                         \
+        {                                                                                                       \
+            contiguousRhs.allocate(std::size_t(depth));                                                         \
+            for(Index k=0; k<depth; ++k) contiguousRhs.data()[k] = rhs[0];                                      \
+            rhs = contiguousRhs.data();                                                                         \
+            rhsStride = 1;                                                                                      \
+        }                                                                                                       \
+        /* the result is not read when beta is 0, whatever the library does of a NaN times 0 */                \
+        if(beta == SCALAR(0))                                                                                   \
+            for(Index i=0; i<rows; ++i) res[i * resStride] = SCALAR(0);                                         \
+        const bool notrans = a.trans == CblasNoTrans;                                                           \
+        cblas_##PREFIX##gemv(CblasRowMajor, a.trans, int(notrans ? rows : depth), int(notrans ? depth : rows),  \
+                             alpha, a.data, int(a.ld), blas_vector(rhs, depth, rhsStride), int(rhsStride),      \
+                             beta, blas_vector(res, rows, resStride), int(resStride));                          \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    static bool dot(Index size, const SCALAR* x, Index xStride, const SCALAR* y, Index yStride, SCALAR& result) \
+    {                                                                                                           \
+        if(xStride == 0 || yStride == 0 || !blas_fits(size) || !blas_fits(xStride) || !blas_fits(yStride))      \
+            return false;                                                                                       \
+        result = cblas_##PREFIX##dot(int(size), blas_vector(x, size, xStride), int(xStride),                    \
+                                     blas_vector(y, size, yStride), int(yStride));                              \
+        return true;                                                                                            \
+    }                                                                                                           \
+                                                                                                                \
+    static bool nrm2(Index size, const SCALAR* x, Index stride, SCALAR& result)                                 \
+    {                                                                                                           \
+        if(stride == 0 || !blas_fits(size) || !blas_fits(stride))                                               \
+            return false;                                                                                       \
+        /* CBLAS returns 0 for a negative increment, the norm does not depend on the order anyway */           \
+        result = cblas_##PREFIX##nrm2(int(size), blas_vector(x, size, stride), int(stride < 0 ? -stride : stride)); \
+        return true;                                                                                            \
+    }                                                                                                           \
+};
+
+NC_MAKE_BLAS_BACKEND(float, s)
+NC_MAKE_BLAS_BACKEND(double, d)
+
+#undef NC_MAKE_BLAS_BACKEND
+
+NS_INTERNAL_END
+
+#endif // NC_USE_BLAS
+
+#endif
@@ -0,0 +1,107 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GEMM_BLOCKING_H__
+#define __NC_GEMM_BLOCKING_H__
+
+
+// Number of vector registers the micro-kernels may use
+#ifndef NC_ARCH_DEFAULT_NUMBER_OF_REGISTERS
+  #if defined(NC_VECTORIZE_AVX512) || NC_ARCH_ARM64
+    #define NC_ARCH_DEFAULT_NUMBER_OF_REGISTERS 32
+  #else
+    #define NC_ARCH_DEFAULT_NUMBER_OF_REGISTERS 16
+  #endif
+#endif
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class gemm_traits
+  *
+  * \brief Shape of the register micro-kernel of the matrix product for \a Scalar
+  *
+  * The micro-kernel computes a Mr x Nr tile of the result in registers, Nr being NrPackets packets along
+  * the rows of the (row-major) result. Each step of the depth loop reads NrPackets packets of the rhs and
+  * broadcasts Mr coefficients of the lhs, so the tile is as large as the register file allows:
+  *  \li 32 registers (AVX512, NEON on ARM64): 12 x 2 packets, 24 accumulators,
+  *  \li 16 registers (SSE, AVX, AVX2 with or without FMA): 6 x 2 packets, 12 accumulators,
+  *  \li scalars, when \a Scalar is not vectorized: 4 x 4.
+  * The remaining registers hold the rhs packets, the broadcast lhs coefficient and, without FMA, the product.
+  */
+template<typename Scalar>
+struct gemm_traits
+{
+    enum {
+        Vectorized = packet_traits<Scalar>::Vectorizable && packet_traits<Scalar>::HasMul && packet_traits<Scalar>::HasAdd
+    };
+
+    typedef typename conditional<Vectorized, typename packet_traits<Scalar>::type, Scalar>::type PacketType;
+
+    enum {
+        PacketSize = unpacket_traits<PacketType>::size,
+        NrPackets = Vectorized ? 2 : 4,
+        Nr = NrPackets * PacketSize,
+        Mr = !Vectorized ? 4 : NC_ARCH_DEFAULT_NUMBER_OF_REGISTERS >= 32 ? 12 : 6
+    };
+};
+
+
+/** \internal
+  * \class gemm_blocking
+  *
+  * \brief Sizes of the blocks of a product of a rows x depth lhs by a depth x cols rhs
+  *
+  * In the Goto algorithm, a kc x nc block of the rhs is packed to stay in the L3 cache, a mc x kc block of
+  * the lhs to stay in the L2 cache, and each kc x Nr sliver of the packed rhs stays in the L1 cache while
+  * it is multiplied by all the Mr x kc slivers of the packed lhs. Half of each cache is budgeted, the other
+  * half being left to the slivers streamed through it and to the result tile.
+  *
+  * The L3 cache is shared by the \a threads threads, each of them packing its own rhs block. The sizes are
+  * then balanced such that the blocks of a dimension have the same size up to a register tile.
+  */
+template<typename Scalar>
+struct gemm_blocking
+{
+    typedef gemm_traits<Scalar> Traits;
+
+    gemm_blocking(Index rows, Index cols, Index depth, int threads)
+    {
+        const cache_sizes& caches = cache_sizes::get();
+        const Index size = Index(sizeof(Scalar));
+
+        kc = numext::maxi(Index(8), (caches.l1 / 2) / (Index(Traits::Nr) * size) / 8 * 8);
+        kc = balance(depth, kc, 8);
+
+        mc = numext::maxi(Index(Traits::Mr), (caches.l2 / 2) / (kc * size) / Traits::Mr * Traits::Mr);
+        mc = balance(rows, mc, Traits::Mr);
+
+        nc = numext::maxi(Index(Traits::Nr), (caches.l3 / 2 / threads) / (kc * size) / Traits::Nr * Traits::Nr);
+        nc = balance(cols, nc, Traits::Nr);
+    }
+
+    /** \returns the size of the blocks splitting \a size in as few blocks of at most \a block as possible,
+      * rounded up to a multiple of \a multiple */
+    static Index balance(Index size, Index block, Index multiple)
+    {
+        if(size <= block) return numext::maxi(Index(1), (size + multiple - 1) / multiple * multiple);
+        const Index count = (size + block - 1) / block;
+        return ((size + count - 1) / count + multiple - 1) / multiple * multiple;
+    }
+
+    Index kc;
+    Index mc;
+    Index nc;
+};
+
+NS_INTERNAL_END
+
+#endif
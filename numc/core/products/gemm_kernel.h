@@ -0,0 +1,246 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GEMM_KERNEL_H__
+#define __NC_GEMM_KERNEL_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class gemm_matrix
+  *
+  * \brief Strided read-only access to the coefficients of a 2-dimension operand of a product
+  */
+template<typename Scalar>
+struct gemm_matrix
+{
+    gemm_matrix(const Scalar* data, Index rowStride, Index colStride)
+    : data(data), rowStride(rowStride), colStride(colStride) {}
+
+    NC_STRONG_INLINE const Scalar& operator()(Index i, Index j) const { return data[i * rowStride + j * colStride]; }
+
+    NC_STRONG_INLINE const Scalar* ptr(Index i, Index j) const { return data + i * rowStride + j * colStride; }
+
+    const Scalar* data;
+    Index rowStride;
+    Index colStride;
+};
+
+
+/** \internal
+  * \class gemm_workspace
+  *
+  * \brief Per-thread buffer receiving the packed blocks and the temporaries of the products run by the thread
+  *
+  * It only grows, so that the products after the first one of a given size never allocate.
+  */
+template<typename Scalar>
+class gemm_workspace
+{
+public:
+    static gemm_workspace& local()
+    {
+        static thread_local gemm_workspace workspace;
+        return workspace;
+    }
+
+    ~gemm_workspace() { aligned_free(_data); }
+
+    /** \returns a buffer of at least \a size coefficients, aligned on NC_DEFAULT_ALIGN_BYTES */
+    Scalar* reserve(Index size)
+    {
+        if(size > _size)
+        {
+            aligned_free(_data);
+            _data = 0;
+            _size = 0;
+            _data = static_cast<Scalar*>(aligned_malloc(std::size_t(size) * sizeof(Scalar)));
+            _size = size;
+        }
+        return _data;
+    }
+
+private:
+    gemm_workspace() : _data(0), _size(0) {}
+    gemm_workspace(const gemm_workspace&);
+    gemm_workspace& operator=(const gemm_workspace&);
+
+    Scalar* _data;
+    Index _size;
+};
+
+
+/** \internal
+  * Packs the \a rows x \a depth block of \a lhs starting at (\a row, \a k) into \a dst, as slivers of Mr rows
+  * stored depth-major: the Mr coefficients the micro-kernel broadcasts at a step are contiguous. The last
+  * sliver is padded with zeros.
+  */
+template<typename Scalar>
+void gemm_pack_lhs(Scalar* dst, const gemm_matrix<Scalar>& lhs, Index row, Index k, Index rows, Index depth)
+{
+    enum { Mr = gemm_traits<Scalar>::Mr };
+    for(Index i=0; i<rows; i+=Mr, dst+=Mr*depth)
+    {
+        const Index count = numext::mini(Index(Mr), rows - i);
+        for(Index r=0; r<count; ++r)
+        {
+            const Scalar* src = lhs.ptr(row + i + r, k);
+            for(Index d=0; d<depth; ++d)
+                dst[d * Mr + r] = src[d * lhs.colStride];
+        }
+        for(Index r=count; r<Mr; ++r)
+            for(Index d=0; d<depth; ++d)
+                dst[d * Mr + r] = Scalar(0);
+    }
+}
+
+/** \internal
+  * Packs the \a depth x \a cols block of \a rhs starting at (\a k, \a col) into \a dst, as slivers of Nr
+  * columns stored depth-major: the NrPackets packets the micro-kernel reads at a step are contiguous and
+  * aligned. The last sliver is padded with zeros.
+  */
+template<typename Scalar>
+void gemm_pack_rhs(Scalar* dst, const gemm_matrix<Scalar>& rhs, Index k, Index col, Index depth, Index cols)
+{
+    typedef gemm_traits<Scalar> Traits;
+    typedef typename Traits::PacketType PacketType;
+    enum { Nr = Traits::Nr, PacketSize = Traits::PacketSize, NrPackets = Traits::NrPackets };
+
+    for(Index j=0; j<cols; j+=Nr, dst+=Nr*depth)
+    {
+        const Index count = numext::mini(Index(Nr), cols - j);
+        if(count == Nr && rhs.colStride == 1)
+        {
+            // rows of a row-major rhs are copied packet-wise
+            for(Index d=0; d<depth; ++d)
+            {
+                const Scalar* src = rhs.ptr(k + d, col + j);
+                for(Index p=0; p<NrPackets; ++p)
+                    pstore(dst + d * Nr + p * PacketSize, ploadu<PacketType>(src + p * PacketSize));
+            }
+            continue;
+        }
+        for(Index d=0; d<depth; ++d)
+        {
+            const Scalar* src = rhs.ptr(k + d, col + j);
+            for(Index c=0; c<count; ++c)
+                dst[d * Nr + c] = src[c * rhs.colStride];
+            for(Index c=count; c<Nr; ++c)
+                dst[d * Nr + c] = Scalar(0);
+        }
+    }
+}
+
+
+/** \internal calls \a func(i) for i in [Begin, End), the loop being unrolled at compile-time */
+template<int Begin, int End>
+struct gemm_unroll
+{
+    template<typename Func>
+    static NC_STRONG_INLINE void run(const Func& func)
+    {
+        func(Begin);
+        gemm_unroll<Begin+1, End>::run(func);
+    }
+};
+
+template<int End>
+struct gemm_unroll<End, End>
+{
+    template<typename Func>
+    static NC_STRONG_INLINE void run(const Func&) {}
+};
+
+
+/** \internal
+  * \class gemm_micro_kernel
+  *
+  * \brief Register kernel computing a Mr x Nr tile of the result from a packed lhs sliver and a packed rhs sliver
+  *
+  * The tile is accumulated in Mr x NrPackets packets with one (fused on FMA targets) multiply-add per packet
+  * and per step of the depth loop. The loops over the tile, and DepthUnroll steps of the depth loop, are
+  * unrolled at compile-time, which is what lets the compiler keep the accumulators in registers. The tile is then added to the result, or written when
+  * \a accumulate is false, only its \a rows x \a cols top-left part being stored for the slivers at the borders.
+  */
+template<typename Scalar>
+struct gemm_micro_kernel
+{
+    typedef gemm_traits<Scalar> Traits;
+    typedef typename Traits::PacketType PacketType;
+    enum { Mr = Traits::Mr, Nr = Traits::Nr, PacketSize = Traits::PacketSize, NrPackets = Traits::NrPackets, DepthUnroll = 4 };
+
+    static NC_STRONG_INLINE void run(Scalar* res, Index resStride, const Scalar* lhs, const Scalar* rhs, Index depth,
+                                     Index rows, Index cols, bool accumulate)
+    {
+        PacketType acc[Mr][NrPackets];
+        gemm_unroll<0, Mr*NrPackets>::run([&](int t) { acc[t / NrPackets][t % NrPackets] = pset1<PacketType>(Scalar(0)); });
+
+        // one step of the depth loop
+        const auto step = [&](const Scalar* lhs, const Scalar* rhs) {
+            PacketType b[NrPackets];
+            gemm_unroll<0, NrPackets>::run([&](int p) { b[p] = pload<PacketType>(rhs + p * PacketSize); });
+            gemm_unroll<0, Mr>::run([&](int i) {
+                const PacketType a = pset1<PacketType>(lhs[i]);
+                gemm_unroll<0, NrPackets>::run([&](int p) { acc[i][p] = pmadd(a, b[p], acc[i][p]); });
+            });
+        };
+
+        Index d = 0;
+        for(; d+DepthUnroll<=depth; d+=DepthUnroll, lhs+=DepthUnroll*Mr, rhs+=DepthUnroll*Nr)
+            gemm_unroll<0, DepthUnroll>::run([&](int u) { step(lhs + u * Mr, rhs + u * Nr); });
+        for(; d<depth; ++d, lhs+=Mr, rhs+=Nr)
+            step(lhs, rhs);
+
+        if(rows == Mr && cols == Nr)
+        {
+            if(accumulate)
+                gemm_unroll<0, Mr*NrPackets>::run([&](int t) {
+                    Scalar* dst = res + (t / NrPackets) * resStride + (t % NrPackets) * PacketSize;
+                    pstoreu(dst, padd(ploadu<PacketType>(dst), acc[t / NrPackets][t % NrPackets]));
+                });
+            else
+                gemm_unroll<0, Mr*NrPackets>::run([&](int t) {
+                    pstoreu(res + (t / NrPackets) * resStride + (t % NrPackets) * PacketSize, acc[t / NrPackets][t % NrPackets]);
+                });
+            return;
+        }
+
+        Scalar tile[Mr * Nr];
+        gemm_unroll<0, Mr*NrPackets>::run([&](int t) {
+            pstoreu(tile + (t / NrPackets) * Nr + (t % NrPackets) * PacketSize, acc[t / NrPackets][t % NrPackets]);
+        });
+        for(Index i=0; i<rows; ++i)
+            for(Index j=0; j<cols; ++j)
+                res[i * resStride + j] = accumulate ? res[i * resStride + j] + tile[i * Nr + j] : tile[i * Nr + j];
+    }
+};
+
+/** \internal
+  * Multiplies a packed \a rows x \a depth block of the lhs by a packed \a depth x \a cols block of the rhs
+  * into \a res. Each rhs sliver stays in the L1 cache while it meets all the lhs slivers.
+  */
+template<typename Scalar>
+void gemm_block_panel(Scalar* res, Index resStride, const Scalar* packedLhs, const Scalar* packedRhs,
+                      Index rows, Index cols, Index depth, bool accumulate)
+{
+    enum { Mr = gemm_traits<Scalar>::Mr, Nr = gemm_traits<Scalar>::Nr };
+    for(Index j=0; j<cols; j+=Nr)
+    {
+        const Scalar* rhs = packedRhs + j * depth;
+        const Index tileCols = numext::mini(Index(Nr), cols - j);
+        for(Index i=0; i<rows; i+=Mr)
+            gemm_micro_kernel<Scalar>::run(res + i * resStride + j, resStride, packedLhs + i * depth, rhs, depth,
+                                           numext::mini(Index(Mr), rows - i), tileCols, accumulate);
+    }
+}
+
+NS_INTERNAL_END
+
+#endif
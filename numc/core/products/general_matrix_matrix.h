@@ -0,0 +1,258 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GENERAL_MATRIX_MATRIX_H__
+#define __NC_GENERAL_MATRIX_MATRIX_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class general_matrix_matrix_product
+  *
+  * \brief Blocked product of a rows x depth lhs by a depth x cols rhs into a row-major result
+  *
+  * The product follows the Goto algorithm: for each nc wide block of columns and each kc deep slice of the
+  * depth, the kc x nc block of the rhs is packed once, then for each mc high block of rows the mc x kc
+  * block of the lhs is packed and multiplied by the packed rhs block (gemm_block_panel()), the register
+  * micro-kernel reading both operands contiguously. See gemm_blocking for the block sizes.
+  *
+  * On several threads, the result is split into a grid of tiles, the larger dimension first, and each tile
+  * is computed by the algorithm above on a single thread with its own packed blocks. A tile then never
+  * waits for another one, and the result only depends on the operands: each coefficient is accumulated
+  * over the depth in the same order whatever the number of threads.
+  *
+  * With NC_USE_BLAS, the product is handed to the external CBLAS instead, see blas_backend. With
+  * NC_RUNTIME_DISPATCH, the tiles are computed by the run_block() of the highest instruction set level the cpu
+  * supports, see product_dispatch.h.
+  */
+template<typename Scalar>
+struct general_matrix_matrix_product
+{
+    typedef gemm_traits<Scalar> Traits;
+    enum { Mr = Traits::Mr, Nr = Traits::Nr, PacketSize = Traits::PacketSize };
+
+    struct context
+    {
+        const gemm_matrix<Scalar>* lhs;
+        const gemm_matrix<Scalar>* rhs;
+        Scalar* res;
+        Index resStride;
+        Index rows, cols, depth;
+        Index tileRows, tileCols, colTiles;
+        int threads;
+    };
+
+    struct tile_range
+    {
+        const context& ctx;
+
+        void operator()(Index begin, Index end) const
+        {
+            for(Index t=begin; t<end; ++t)
+            {
+                const Index row = (t / ctx.colTiles) * ctx.tileRows;
+                const Index col = (t % ctx.colTiles) * ctx.tileCols;
+                run_tile(ctx, row, numext::mini(row + ctx.tileRows, ctx.rows), col, numext::mini(col + ctx.tileCols, ctx.cols));
+            }
+        }
+    };
+
+    static void run(Index rows, Index cols, Index depth, const gemm_matrix<Scalar>& lhs, const gemm_matrix<Scalar>& rhs,
+                    Scalar* res, Index resStride)
+    {
+        if(rows == 0 || cols == 0) return;
+
+        // a single column or a single row of result is a matrix-vector product, bound by the memory bandwidth
+        if(cols == 1)
+            return general_matrix_vector_product<Scalar>::run(rows, depth, lhs, rhs.data, rhs.rowStride, res, resStride,
+                                                              Scalar(1), Scalar(0));
+        if(rows == 1)
+            return general_matrix_vector_product<Scalar>::run(cols, depth, gemm_matrix<Scalar>(rhs.data, rhs.colStride, rhs.rowStride),
+                                                              lhs.data, lhs.colStride, res, 1, Scalar(1), Scalar(0));
+
+        if(depth == 0)
+        {
+            for(Index i=0; i<rows; ++i)
+                for(Index j=0; j<cols; ++j)
+                    res[i * resStride + j] = Scalar(0);
+            return;
+        }
+
+#ifdef NC_USE_BLAS
+        if(blas_backend<Scalar>::gemm(rows, cols, depth, lhs, rhs, res, resStride)) return;
+#endif
+
+        const double cost = double(rows) * double(cols) * double(depth)
+                          * (NumTraits<Scalar>::MulCost + NumTraits<Scalar>::AddCost) / PacketSize;
+        const int threads = parallel_threads(cost);
+
+        // grid of about 2 tiles per thread, for the work stealing to even out the threads
+        Index rowParts = 1, colParts = 1;
+        while(rowParts * colParts < 2 * Index(threads))
+        {
+            const Index tileRows = rows / rowParts, tileCols = cols / colParts;
+            if(tileRows >= 2 * Mr && (tileRows >= tileCols || tileCols < 2 * Nr)) ++rowParts;
+            else if(tileCols >= 2 * Nr) ++colParts;
+            else break;
+        }
+
+        context ctx;
+        ctx.lhs = &lhs;
+        ctx.rhs = &rhs;
+        ctx.res = res;
+        ctx.resStride = resStride;
+        ctx.rows = rows;
+        ctx.cols = cols;
+        ctx.depth = depth;
+        ctx.tileRows = gemm_blocking<Scalar>::balance(rows, (rows + rowParts - 1) / rowParts, Mr);
+        ctx.tileCols = gemm_blocking<Scalar>::balance(cols, (cols + colParts - 1) / colParts, Nr);
+        ctx.colTiles = (cols + ctx.tileCols - 1) / ctx.tileCols;
+        ctx.threads = threads;
+
+        const Index tiles = ((rows + ctx.tileRows - 1) / ctx.tileRows) * ctx.colTiles;
+        const tile_range range = { ctx };
+        parallel_for(tiles, Index(1), threads, range);
+    }
+
+    /** \internal single-threaded product, the entry point of the kernels of the runtime dispatch */
+    static void run_block(Index rows, Index cols, Index depth, const Scalar* lhs, Index lhsRowStride,
+                          Index lhsColStride, const Scalar* rhs, Index rhsRowStride, Index rhsColStride,
+                          Scalar* res, Index resStride, int threads)
+    {
+        const gemm_matrix<Scalar> lhsMatrix(lhs, lhsRowStride, lhsColStride);
+        const gemm_matrix<Scalar> rhsMatrix(rhs, rhsRowStride, rhsColStride);
+        context ctx;
+        ctx.lhs = &lhsMatrix;
+        ctx.rhs = &rhsMatrix;
+        ctx.res = res;
+        ctx.resStride = resStride;
+        ctx.rows = rows;
+        ctx.cols = cols;
+        ctx.depth = depth;
+        ctx.threads = threads;
+        run_tile(ctx, 0, rows, 0, cols);
+    }
+
+    static void run_tile(const context& ctx, Index rowBegin, Index rowEnd, Index colBegin, Index colEnd)
+    {
+#ifdef NC_RUNTIME_DISPATCH
+        if(const dispatch::product_kernels<Scalar>* kernels = dispatched_product_kernels<Scalar>())
+            return kernels->gemm(rowEnd - rowBegin, colEnd - colBegin, ctx.depth, ctx.lhs->ptr(rowBegin, 0),
+                                 ctx.lhs->rowStride, ctx.lhs->colStride, ctx.rhs->ptr(0, colBegin), ctx.rhs->rowStride,
+                                 ctx.rhs->colStride, ctx.res + rowBegin * ctx.resStride + colBegin, ctx.resStride,
+                                 ctx.threads);
+#endif
+
+        const gemm_blocking<Scalar> blocking(rowEnd - rowBegin, colEnd - colBegin, ctx.depth, ctx.threads);
+        const Index kc = blocking.kc, mc = blocking.mc, nc = blocking.nc;
+
+        // the packed rhs block starts on a packet boundary
+        const Index lhsSize = (mc * kc + Nr - 1) / Nr * Nr;
+        Scalar* packedLhs = gemm_workspace<Scalar>::local().reserve(lhsSize + kc * nc);
+        Scalar* packedRhs = packedLhs + lhsSize;
+
+        for(Index col=colBegin; col<colEnd; col+=nc)
+        {
+            const Index cols = numext::mini(nc, colEnd - col);
+            for(Index k=0; k<ctx.depth; k+=kc)
+            {
+                const Index depth = numext::mini(kc, ctx.depth - k);
+                gemm_pack_rhs(packedRhs, *ctx.rhs, k, col, depth, cols);
+                for(Index row=rowBegin; row<rowEnd; row+=mc)
+                {
+                    const Index rows = numext::mini(mc, rowEnd - row);
+                    gemm_pack_lhs(packedLhs, *ctx.lhs, row, k, rows, depth);
+                    gemm_block_panel(ctx.res + row * ctx.resStride + col, ctx.resStride, packedLhs, packedRhs,
+                                     rows, cols, depth, k > 0);
+                }
+            }
+        }
+    }
+};
+
+
+/** \internal
+  * \class gemm_operand
+  *
+  * \brief Strided view of an operand of a product
+  *
+  * Arrays, views, fixed arrays and maps are read in place whatever their strides, since the packing of the
+  * blocks copies them anyway. Other expressions are evaluated once into a scratch_buffer, given back when the
+  * product is done.
+  */
+template<typename Derived>
+struct gemm_operand
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    explicit gemm_operand(const Derived& xpr) : _plain(xpr.size()), _view(_plain.data(), xpr.shape())
+    {
+        ArrayView<Scalar> plain(_plain.data(), xpr.shape());
+        call_assignment_no_alias(plain, xpr);
+    }
+
+    const ArrayView<const Scalar>& view() const { return _view; }
+
+protected:
+    scratch_buffer<Scalar> _plain;
+    ArrayView<const Scalar> _view;
+};
+
+template<typename Scalar>
+struct gemm_operand< Array<Scalar> >
+{
+    explicit gemm_operand(const Array<Scalar>& a) : _view(a.view()) {}
+
+    const ArrayView<const Scalar>& view() const { return _view; }
+
+protected:
+    ArrayView<const Scalar> _view;
+};
+
+template<typename _Scalar>
+struct gemm_operand< ArrayView<_Scalar> >
+{
+    typedef typename traits< ArrayView<_Scalar> >::Scalar Scalar;
+
+    explicit gemm_operand(const ArrayView<_Scalar>& v) : _view(v) {}
+
+    const ArrayView<const Scalar>& view() const { return _view; }
+
+protected:
+    ArrayView<const Scalar> _view;
+};
+
+template<typename Scalar, Index... Dims>
+struct gemm_operand< FixedArray<Scalar, Dims...> >
+{
+    explicit gemm_operand(const FixedArray<Scalar, Dims...>& a) : _view(a.view()) {}
+
+    const ArrayView<const Scalar>& view() const { return _view; }
+
+protected:
+    ArrayView<const Scalar> _view;
+};
+
+template<typename PlainObjectType, int MapOptions>
+struct gemm_operand< Map<PlainObjectType, MapOptions> >
+{
+    typedef typename traits< Map<PlainObjectType, MapOptions> >::Scalar Scalar;
+
+    explicit gemm_operand(const Map<PlainObjectType, MapOptions>& m) : _view(m.view()) {}
+
+    const ArrayView<const Scalar>& view() const { return _view; }
+
+protected:
+    ArrayView<const Scalar> _view;
+};
+
+NS_INTERNAL_END
+
+#endif
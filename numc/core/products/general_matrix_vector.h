@@ -0,0 +1,247 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_GENERAL_MATRIX_VECTOR_H__
+#define __NC_GENERAL_MATRIX_VECTOR_H__
+
+// Distance in bytes at which the matrix streams of a matrix-vector product are prefetched
+#ifndef NC_GEMV_PREFETCH_DISTANCE
+#define NC_GEMV_PREFETCH_DISTANCE 512
+#endif
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class general_matrix_vector_product
+  *
+  * \brief Product of a rows x depth matrix by a vector, res = alpha * lhs * rhs + beta * res
+  *
+  * Each coefficient of the matrix is used once, so the product is bound by the memory bandwidth and the
+  * kernels are written to read the matrix once, contiguously, whatever its layout:
+  *  \li a row-major matrix is read by blocks of RowBlock rows, each row being multiplied by the vector into
+  *      its own packet accumulator, reduced at the end of the rows,
+  *  \li a column-major matrix (e.g. the transpose of a row-major one) is read by blocks of ColBlock
+  *      columns, each column being scaled by its coefficient of the vector and added to the result,
+  *  \li other strides fall back to scalar dot products.
+  * The matrix is read as RowBlock (or ColBlock) streams, each of them being prefetched
+  * NC_GEMV_PREFETCH_DISTANCE bytes ahead once per cache line.
+  *
+  * On several threads, the rows are split among them. A coefficient of the result is then always accumulated
+  * in the same order, whatever the number of threads. When \a beta is 0, the result is not read.
+  *
+  * With NC_USE_BLAS, the product is handed to the external CBLAS instead, see blas_backend. With
+  * NC_RUNTIME_DISPATCH, the rows are computed by the run_block() of the highest instruction set level the cpu
+  * supports, see product_dispatch.h.
+  */
+template<typename Scalar>
+struct general_matrix_vector_product
+{
+    typedef gemm_traits<Scalar> Traits;
+    typedef typename Traits::PacketType PacketType;
+    enum {
+        PacketSize = Traits::PacketSize,
+        RowBlock = 4,
+        ColBlock = 4,
+        // packets per cache line, a stream being prefetched once per line
+        LinePackets = PacketSize * int(sizeof(Scalar)) >= 64 ? 1 : 64 / (PacketSize * int(sizeof(Scalar))),
+        PrefetchDistance = NC_GEMV_PREFETCH_DISTANCE / int(sizeof(Scalar))
+    };
+
+    struct context
+    {
+        Index rows, depth;
+        const gemm_matrix<Scalar>* lhs;
+        const Scalar* rhs;
+        Scalar* res;
+        Index resStride;
+        Scalar alpha, beta;
+    };
+
+    struct range
+    {
+        const context& ctx;
+        void operator()(Index begin, Index end) const { run_range(ctx, begin, end); }
+    };
+
+    static void run(Index rows, Index depth, const gemm_matrix<Scalar>& lhs, const Scalar* rhs, Index rhsStride,
+                    Scalar* res, Index resStride, const Scalar& alpha, const Scalar& beta)
+    {
+        if(rows == 0) return;
+
+#ifdef NC_USE_BLAS
+        if(blas_backend<Scalar>::gemv(rows, depth, lhs, rhs, rhsStride, res, resStride, alpha, beta)) return;
+#endif
+
+        // the vector is read once per block of the matrix, it is made contiguous first
+        scratch_buffer<Scalar> contiguousRhs;
+        if(rhsStride != 1 && depth > 0)
+        {
+            contiguousRhs.allocate(std::size_t(depth));
+            for(Index k=0; k<depth; ++k)
+                contiguousRhs.data()[k] = rhs[k * rhsStride];
+            rhs = contiguousRhs.data();
+        }
+
+        context ctx = { rows, depth, &lhs, rhs, res, resStride, alpha, beta };
+        const double cost = double(rows) * double(depth)
+                          * (NumTraits<Scalar>::ReadCost + NumTraits<Scalar>::MulCost + NumTraits<Scalar>::AddCost) / PacketSize;
+        const int threads = parallel_threads(cost);
+
+        const range r = { ctx };
+        parallel_for(rows, by_rows(ctx) ? Index(RowBlock) : Index(PacketSize), threads, r);
+    }
+
+    /** \internal single-threaded product, the entry point of the kernels of the runtime dispatch */
+    static void run_block(Index rows, Index depth, const Scalar* lhs, Index lhsRowStride, Index lhsColStride,
+                          const Scalar* rhs, Scalar* res, Index resStride, Scalar alpha, Scalar beta)
+    {
+        const gemm_matrix<Scalar> matrix(lhs, lhsRowStride, lhsColStride);
+        const context ctx = { rows, depth, &matrix, rhs, res, resStride, alpha, beta };
+        run_kernel(ctx, 0, rows);
+    }
+
+    /** \internal \returns whether the matrix is read by rows, or else by columns */
+    static bool by_rows(const context& ctx)
+    {
+        return ctx.lhs->colStride == 1 || ctx.lhs->rowStride != 1 || ctx.depth == 0;
+    }
+
+    static void run_range(const context& ctx, Index begin, Index end)
+    {
+#ifdef NC_RUNTIME_DISPATCH
+        if(const dispatch::product_kernels<Scalar>* kernels = dispatched_product_kernels<Scalar>())
+            return kernels->gemv(end - begin, ctx.depth, ctx.lhs->ptr(begin, 0), ctx.lhs->rowStride, ctx.lhs->colStride,
+                                 ctx.rhs, ctx.res + begin * ctx.resStride, ctx.resStride, ctx.alpha, ctx.beta);
+#endif
+        run_kernel(ctx, begin, end);
+    }
+
+    static void run_kernel(const context& ctx, Index begin, Index end)
+    {
+        if(by_rows(ctx)) run_rows(ctx, begin, end);
+        else run_cols(ctx, begin, end);
+    }
+
+    /** \internal row-major kernel over the rows [\a begin, \a end) */
+    static void run_rows(const context& ctx, Index begin, Index end)
+    {
+        Index i = begin;
+        if(ctx.lhs->colStride == 1)
+            for(; i+RowBlock<=end; i+=RowBlock)
+                row_block<RowBlock>(ctx, i);
+        for(; i<end; ++i)
+        {
+            if(ctx.lhs->colStride == 1)
+                row_block<1>(ctx, i);
+            else
+            {
+                Scalar sum = Scalar(0);
+                for(Index k=0; k<ctx.depth; ++k)
+                    sum += (*ctx.lhs)(i, k) * ctx.rhs[k];
+                store(ctx, i, sum);
+            }
+        }
+    }
+
+    template<int Rows>
+    static NC_STRONG_INLINE void row_block(const context& ctx, Index i)
+    {
+        const Index depth = ctx.depth;
+        const Scalar* rhs = ctx.rhs;
+        const Scalar* rows[Rows];
+        PacketType acc[Rows];
+        gemm_unroll<0, Rows>::run([&](int r) {
+            rows[r] = ctx.lhs->ptr(i + r, 0);
+            acc[r] = pset1<PacketType>(Scalar(0));
+        });
+
+        const auto step = [&](Index k) {
+            const PacketType x = ploadu<PacketType>(rhs + k);
+            gemm_unroll<0, Rows>::run([&](int r) { acc[r] = pmadd(ploadu<PacketType>(rows[r] + k), x, acc[r]); });
+        };
+
+        Index k = 0;
+        for(; k+LinePackets*PacketSize<=depth; k+=LinePackets*PacketSize)
+        {
+            gemm_unroll<0, Rows>::run([&](int r) { prefetch(rows[r] + k + PrefetchDistance); });
+            gemm_unroll<0, LinePackets>::run([&](int p) { step(k + p * PacketSize); });
+        }
+        for(; k+PacketSize<=depth; k+=PacketSize)
+            step(k);
+
+        gemm_unroll<0, Rows>::run([&](int r) {
+            Scalar sum = predux(acc[r]);
+            for(Index t=k; t<depth; ++t)
+                sum += rows[r][t] * rhs[t];
+            store(ctx, i + r, sum);
+        });
+    }
+
+    /** \internal column-major kernel over the rows [\a begin, \a end), accumulating the columns in the result,
+      * or in a contiguous buffer of the thread when the result is strided */
+    static void run_cols(const context& ctx, Index begin, Index end)
+    {
+        const Index rows = end - begin;
+        const bool direct = ctx.resStride == 1;
+        Scalar* acc = direct ? ctx.res + begin : gemm_workspace<Scalar>::local().reserve(rows);
+        for(Index i=0; i<rows; ++i)
+            acc[i] = ctx.beta == Scalar(0) ? Scalar(0) : ctx.beta * ctx.res[(begin + i) * ctx.resStride];
+
+        Index j = 0;
+        for(; j+ColBlock<=ctx.depth; j+=ColBlock)
+            col_block<ColBlock>(ctx, acc, begin, rows, j);
+        for(; j<ctx.depth; ++j)
+            col_block<1>(ctx, acc, begin, rows, j);
+
+        if(!direct)
+            for(Index i=0; i<rows; ++i)
+                ctx.res[(begin + i) * ctx.resStride] = acc[i];
+    }
+
+    template<int Cols>
+    static NC_STRONG_INLINE void col_block(const context& ctx, Scalar* acc, Index begin, Index rows, Index j)
+    {
+        const Scalar* cols[Cols];
+        Scalar a[Cols];
+        PacketType pa[Cols];
+        gemm_unroll<0, Cols>::run([&](int c) {
+            cols[c] = ctx.lhs->ptr(begin, j + c);
+            a[c] = ctx.alpha * ctx.rhs[j + c];
+            pa[c] = pset1<PacketType>(a[c]);
+        });
+
+        const auto step = [&](Index i) {
+            PacketType y = ploadu<PacketType>(acc + i);
+            gemm_unroll<0, Cols>::run([&](int c) { y = pmadd(ploadu<PacketType>(cols[c] + i), pa[c], y); });
+            pstoreu(acc + i, y);
+        };
+
+        Index i = 0;
+        for(; i+LinePackets*PacketSize<=rows; i+=LinePackets*PacketSize)
+        {
+            gemm_unroll<0, Cols>::run([&](int c) { prefetch(cols[c] + i + PrefetchDistance); });
+            gemm_unroll<0, LinePackets>::run([&](int p) { step(i + p * PacketSize); });
+        }
+        for(; i+PacketSize<=rows; i+=PacketSize)
+            step(i);
+        for(; i<rows; ++i)
+            gemm_unroll<0, Cols>::run([&](int c) { acc[i] += cols[c][i] * a[c]; });
+    }
+
+    static NC_STRONG_INLINE void store(const context& ctx, Index i, const Scalar& sum)
+    {
+        Scalar& dst = ctx.res[i * ctx.resStride];
+        dst = ctx.beta == Scalar(0) ? ctx.alpha * sum : ctx.alpha * sum + ctx.beta * dst;
+    }
+};
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,95 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_MATMUL_H__
+#define __NC_MATMUL_H__
+
+NS_BEGIN
+
+/** \returns the matrix product of \a lhs and \a rhs, like numpy's \c matmul.
+  *
+  * The last 2 dimensions of an operand are a matrix, and the leading ones are batch dimensions which are
+  * broadcast against each other with the numpy rules. A 1-dimension lhs is a row vector and a 1-dimension
+  * rhs a column vector, whose dimension is removed from the result:
+  * \code
+  * Array<float> a(64, 128), b(128, 32), x(128), s(1000, 16, 16), t(16, 16);
+  * Array<float> c = matmul(a, b);      // shape (64, 32)
+  * Array<float> y = matmul(a, x);      // shape (64)
+  * Array<float> u = matmul(s, t);      // shape (1000, 16, 16), t is multiplied by each matrix of s
+  * \endcode
+  * The operands may be views with any strides, e.g. transposed, they are read in place. The product is
+  * computed by a cache blocked kernel, or by an unblocked one for a batch of small matrices, and is split
+  * over threads when large enough (see internal::batched_matrix_matrix_product).
+  */
+template<typename Lhs, typename Rhs>
+Array<typename internal::traits<Lhs>::Scalar> matmul(const ArrayOp<Lhs>& lhs, const ArrayOp<Rhs>& rhs)
+{
+    typedef typename internal::traits<Lhs>::Scalar Scalar;
+    NC_STATIC_ASSERT((internal::is_same<Scalar, typename internal::traits<Rhs>::Scalar>::value),
+                     "The operands of a matrix product must have the same scalar type")
+    nc_assert(lhs.dims() >= 1 && rhs.dims() >= 1);
+
+    const internal::gemm_operand<Lhs> lhsOperand(lhs.derived());
+    const internal::gemm_operand<Rhs> rhsOperand(rhs.derived());
+    const ArrayView<const Scalar>& a = lhsOperand.view();
+    const ArrayView<const Scalar>& b = rhsOperand.view();
+
+    const bool lhsMatrix = a.dims() >= 2, rhsMatrix = b.dims() >= 2;
+    const Index lhsBatchDims = lhsMatrix ? a.dims() - 2 : 0;
+    const Index rhsBatchDims = rhsMatrix ? b.dims() - 2 : 0;
+    const Index rows = lhsMatrix ? a.shape()[a.dims()-2] : 1;
+    const Index depth = a.shape()[a.dims()-1];
+    const Index cols = rhsMatrix ? b.shape()[b.dims()-1] : 1;
+    nc_assert(b.shape()[rhsMatrix ? b.dims()-2 : 0] == depth
+              && "matmul: the last dimension of lhs must match the second to last one of rhs");
+
+    Shape batch;
+    const bool compatible = internal::broadcast_shapes(Shape(a.shape().data(), lhsBatchDims),
+                                                       Shape(b.shape().data(), rhsBatchDims), batch);
+    nc_assert(compatible && "matmul: the batch dimensions of the operands cannot be broadcast together");
+    NC_UNUSED_VARIABLE(compatible);
+
+    internal::batch_layout layout;
+    layout.dims = batch.dims();
+    for(Index d=0; d<batch.dims(); ++d)
+    {
+        const Index da = d - (batch.dims() - lhsBatchDims);
+        const Index db = d - (batch.dims() - rhsBatchDims);
+        layout.extents[d] = batch[d];
+        layout.lhsStrides[d] = da >= 0 && a.shape()[da] != 1 ? a.strides()[da] : 0;
+        layout.rhsStrides[d] = db >= 0 && b.shape()[db] != 1 ? b.strides()[db] : 0;
+    }
+
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    Index dims = 0;
+    for(Index d=0; d<batch.dims(); ++d) extents[dims++] = batch[d];
+    if(lhsMatrix) extents[dims++] = rows;
+    if(rhsMatrix) extents[dims++] = cols;
+    Array<Scalar> result(Shape(extents, dims));
+
+    const internal::gemm_matrix<Scalar> lhsMatrixMap(a.data(), lhsMatrix ? a.strides()[a.dims()-2] : 0, a.strides()[a.dims()-1]);
+    const internal::gemm_matrix<Scalar> rhsMatrixMap(b.data(), b.strides()[rhsMatrix ? b.dims()-2 : 0],
+                                                     rhsMatrix ? b.strides()[b.dims()-1] : 0);
+    internal::batched_matrix_matrix_product<Scalar>::run(layout, rows, cols, depth, lhsMatrixMap, rhsMatrixMap,
+                                                         result.data());
+    return result;
+}
+
+/** \returns the matrix product of *this and \a other, see matmul() */
+template<typename Derived>
+template<typename OtherDerived>
+Array<typename internal::traits<Derived>::Scalar> ArrayOp<Derived>::matmul(const ArrayOp<OtherDerived>& other) const
+{
+    return numc::matmul(*this, other);
+}
+
+NS_END
+
+#endif
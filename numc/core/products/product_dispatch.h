@@ -0,0 +1,88 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PRODUCT_DISPATCH_H__
+#define __NC_PRODUCT_DISPATCH_H__
+
+#ifdef NC_RUNTIME_DISPATCH
+
+// The table is declared out of the instruction set namespace, it is shared by the code of all the levels
+namespace numc { namespace dispatch {
+
+/** \internal
+  * \class product_kernels
+  *
+  * \brief Single-threaded product kernels of \a Scalar, compiled for the instruction set level \a level
+  *
+  * \a selected holds the kernels of the highest level the cpu supports among those linked in, and is set once
+  * at startup, see register_product_kernels(). The signatures only use fundamental types, which are the same
+  * for all the levels.
+  */
+template<typename Scalar>
+struct product_kernels
+{
+    /** res = lhs * rhs, for a rows x depth lhs and a depth x cols rhs, \a threads sharing the caches */
+    typedef void (*gemm_kernel)(Index rows, Index cols, Index depth, const Scalar* lhs, Index lhsRowStride,
+                                Index lhsColStride, const Scalar* rhs, Index rhsRowStride, Index rhsColStride,
+                                Scalar* res, Index resStride, int threads);
+    /** res = alpha * lhs * rhs + beta * res, for a rows x depth lhs and a contiguous rhs */
+    typedef void (*gemv_kernel)(Index rows, Index depth, const Scalar* lhs, Index lhsRowStride, Index lhsColStride,
+                                const Scalar* rhs, Scalar* res, Index resStride, Scalar alpha, Scalar beta);
+
+    int level;
+    gemm_kernel gemm;
+    gemv_kernel gemv;
+
+    static product_kernels selected;
+};
+
+template<typename Scalar>
+product_kernels<Scalar> product_kernels<Scalar>::selected;
+
+}}
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \returns the kernels to run in place of the ones compiled in this translation unit, i.e. those of a higher
+  * instruction set level, or 0. This costs a load and a comparison.
+  */
+template<typename Scalar>
+NC_STRONG_INLINE const dispatch::product_kernels<Scalar>* dispatched_product_kernels()
+{
+    const dispatch::product_kernels<Scalar>& kernels = dispatch::product_kernels<Scalar>::selected;
+    return kernels.level > NC_DISPATCH_LEVEL ? &kernels : 0;
+}
+
+/** \internal
+  * Registers the kernels \a gemm and \a gemv compiled in this translation unit, if the cpu supports its
+  * instruction set level and no higher level was registered. This is called by the translation units of
+  * numc/dispatch while the program starts, and \returns true.
+  */
+template<typename Scalar>
+bool register_product_kernels(typename dispatch::product_kernels<Scalar>::gemm_kernel gemm,
+                              typename dispatch::product_kernels<Scalar>::gemv_kernel gemv)
+{
+    dispatch::product_kernels<Scalar>& kernels = dispatch::product_kernels<Scalar>::selected;
+    if(NC_DISPATCH_LEVEL <= cpu_features::get().level() && NC_DISPATCH_LEVEL > kernels.level)
+    {
+        kernels.level = NC_DISPATCH_LEVEL;
+        kernels.gemm = gemm;
+        kernels.gemv = gemv;
+    }
+    return true;
+}
+
+NS_INTERNAL_END
+
+#endif // NC_RUNTIME_DISPATCH
+
+#endif
@@ -0,0 +1,26 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PRODUCTS_H__
+#define __NC_PRODUCTS_H__
+
+
+#include "gemm_blocking.h"
+#include "gemm_kernel.h"
+#include "blas_backend.h"
+#include "product_dispatch.h"
+#include "general_matrix_vector.h"
+#include "general_matrix_matrix.h"
+#include "batched_matrix_matrix.h"
+#include "matmul.h"
+#include "blas.h"
+
+
+#endif
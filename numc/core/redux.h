@@ -0,0 +1,437 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_REDUX_H__
+#define __NC_REDUX_H__
+
+NS_INTERNAL_BEGIN
+
+/***************************************************************************
+* Part 1 : readers of a contiguous run of coefficients
+***************************************************************************/
+
+// A run starts at a linear index, and is only read this way when the expression is linearizable.
+template<typename Evaluator, typename Scalar>
+struct redux_linear_reader
+{
+    redux_linear_reader(const Evaluator& eval, Index start) : eval(eval), start(start) {}
+
+    NC_STRONG_INLINE Scalar coeff(Index i) const { return eval.coeff(start + i); }
+
+    template<typename PacketType>
+    NC_STRONG_INLINE PacketType packet(Index i) const { return eval.template packet<Unaligned,PacketType>(start + i); }
+
+    const Evaluator& eval;
+    Index start;
+};
+
+// A run is (part of) the slice \a outer along the last dimension.
+template<typename Evaluator, typename Scalar>
+struct redux_slice_reader
+{
+    redux_slice_reader(const Evaluator& eval, Index outer) : eval(eval), outer(outer) {}
+
+    NC_STRONG_INLINE Scalar coeff(Index i) const { return eval.coeff(outer, i); }
+
+    template<typename PacketType>
+    NC_STRONG_INLINE PacketType packet(Index i) const { return eval.template packet<Unaligned,PacketType>(outer, i); }
+
+    const Evaluator& eval;
+    Index outer;
+};
+
+
+/***************************************************************************
+* Part 2 : reduction of a run
+***************************************************************************/
+
+/** \internal
+  * \class redux_run
+  *
+  * \brief Reduces the coefficients [0, size) of a run by \a Func
+  *
+  * The run is split in halves down to blocks of RunBlock coefficients (pairwise summation: the rounding error
+  * of a sum grows with the logarithm of its size instead of linearly), and each block is reduced into 4
+  * independent accumulators, which keeps 4 additions in flight instead of waiting for the latency of the
+  * previous one. With \a Vectorize, the accumulators are packets, reduced horizontally by \c Func::predux()
+  * once at the end, and the coefficients past the last full packet are reduced as scalars.
+  */
+template<typename Func, typename Scalar, bool Vectorize>
+struct redux_run
+{
+    enum { RunBlock = 128 };
+
+    template<typename Reader>
+    static Scalar run(const Func& func, const Reader& reader, Index size)
+    {
+        return reduce(func, reader, 0, size);
+    }
+
+    template<typename Reader>
+    static Scalar reduce(const Func& func, const Reader& reader, Index begin, Index end)
+    {
+        if(end - begin > RunBlock)
+        {
+            const Index mid = begin + (end - begin) / 2;
+            return func(reduce(func, reader, begin, mid), reduce(func, reader, mid, end));
+        }
+
+        Scalar r0 = reader.coeff(begin);
+        if(end - begin < 4)
+        {
+            for(Index i=begin+1; i<end; ++i)
+                r0 = func(r0, reader.coeff(i));
+            return r0;
+        }
+
+        Scalar r1 = reader.coeff(begin+1), r2 = reader.coeff(begin+2), r3 = reader.coeff(begin+3);
+        Index i = begin + 4;
+        for(; i+4<=end; i+=4)
+        {
+            r0 = func(r0, reader.coeff(i));
+            r1 = func(r1, reader.coeff(i+1));
+            r2 = func(r2, reader.coeff(i+2));
+            r3 = func(r3, reader.coeff(i+3));
+        }
+        for(; i<end; ++i)
+            r0 = func(r0, reader.coeff(i));
+        return func(func(r0, r1), func(r2, r3));
+    }
+};
+
+template<typename Func, typename Scalar>
+struct redux_run<Func, Scalar, true>
+{
+    typedef typename find_best_packet<Scalar, Dynamic>::type PacketType;
+
+    enum {
+        PacketSize = unpacket_traits<PacketType>::size,
+        RunBlock = 32       // in packets
+    };
+
+    template<typename Reader>
+    static Scalar run(const Func& func, const Reader& reader, Index size)
+    {
+        const Index packets = size / PacketSize;
+        if(packets == 0)
+            return redux_run<Func, Scalar, false>::run(func, reader, size);
+
+        Scalar r = func.predux(reduce(func, reader, 0, packets));
+        if(packets * PacketSize < size)
+            r = func(r, redux_run<Func, Scalar, false>::reduce(func, reader, packets * PacketSize, size));
+        return r;
+    }
+
+    // reduces the packets [begin, end)
+    template<typename Reader>
+    static PacketType reduce(const Func& func, const Reader& reader, Index begin, Index end)
+    {
+        if(end - begin > RunBlock)
+        {
+            const Index mid = begin + (end - begin) / 2;
+            return func.packetOp(reduce(func, reader, begin, mid), reduce(func, reader, mid, end));
+        }
+
+        PacketType p0 = reader.template packet<PacketType>(begin * PacketSize);
+        if(end - begin < 4)
+        {
+            for(Index i=begin+1; i<end; ++i)
+                p0 = func.packetOp(p0, reader.template packet<PacketType>(i * PacketSize));
+            return p0;
+        }
+
+        PacketType p1 = reader.template packet<PacketType>((begin+1) * PacketSize);
+        PacketType p2 = reader.template packet<PacketType>((begin+2) * PacketSize);
+        PacketType p3 = reader.template packet<PacketType>((begin+3) * PacketSize);
+        Index i = begin + 4;
+        for(; i+4<=end; i+=4)
+        {
+            p0 = func.packetOp(p0, reader.template packet<PacketType>(i * PacketSize));
+            p1 = func.packetOp(p1, reader.template packet<PacketType>((i+1) * PacketSize));
+            p2 = func.packetOp(p2, reader.template packet<PacketType>((i+2) * PacketSize));
+            p3 = func.packetOp(p3, reader.template packet<PacketType>((i+3) * PacketSize));
+        }
+        for(; i<end; ++i)
+            p0 = func.packetOp(p0, reader.template packet<PacketType>(i * PacketSize));
+        return func.packetOp(func.packetOp(p0, p1), func.packetOp(p2, p3));
+    }
+};
+
+
+/***************************************************************************
+* Part 3 : reduction of a whole expression
+***************************************************************************/
+
+/** \internal
+  * \class redux_traits
+  *
+  * \brief Decides at compile-time how the expression \a Derived may be reduced by \a Func
+  */
+template<typename Func, typename Derived>
+struct redux_traits
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+    typedef evaluator<Derived> Evaluator;
+    typedef typename find_best_packet<Scalar, Dynamic>::type PacketType;
+
+    enum {
+        PacketSize = unpacket_traits<PacketType>::size,
+        MayLinearize = (int(Evaluator::Flags) & LinearAccessBit) != 0,
+        MayVectorize = (int(Evaluator::Flags) & PacketAccessBit) && functor_traits<Func>::PacketAccess
+                    && PacketSize > 1,
+        Cost = int(Evaluator::CoeffReadCost) + int(functor_traits<Func>::Cost)
+    };
+
+    /** \returns the number of threads worth reducing \a size coefficients on */
+    static int threads(Index size, bool vectorized)
+    {
+        return parallel_threads(double(size) * Cost / (vectorized ? PacketSize : 1));
+    }
+};
+
+/** \internal
+  * \class redux_impl
+  *
+  * \brief Reduces all the coefficients of an expression
+  *
+  * A linearizable expression is reduced as a single run. Otherwise (views, broadcasting), the slices along
+  * the last dimension are reduced one by one, vectorized when they are contiguous, and the results are
+  * combined pairwise. The work is split over threads by parallel_reduce(), along the linear range or along
+  * the slices, or along the single slice of a one-dimension expression.
+  */
+template<typename Func, typename Derived>
+struct redux_impl
+{
+    typedef redux_traits<Func, Derived> Traits;
+    typedef typename Traits::Scalar Scalar;
+    typedef typename Traits::Evaluator Evaluator;
+    typedef redux_linear_reader<Evaluator, Scalar> LinearReader;
+    typedef redux_slice_reader<Evaluator, Scalar> SliceReader;
+
+    struct linear_range
+    {
+        const Evaluator& eval;
+        const Func& func;
+
+        Scalar operator()(Index begin, Index end) const
+        {
+            return redux_run<Func, Scalar, Traits::MayVectorize>::run(func, LinearReader(eval, begin), end - begin);
+        }
+    };
+
+    struct slice_range
+    {
+        const Evaluator& eval;
+        const Func& func;
+        Index inner;
+        bool vectorize;
+
+        Scalar operator()(Index begin, Index end) const
+        {
+            if(end - begin > 1)
+            {
+                const Index mid = begin + (end - begin) / 2;
+                return func((*this)(begin, mid), (*this)(mid, end));
+            }
+            return slice(begin);
+        }
+
+        Scalar slice(Index outer) const
+        {
+            if(vectorize)
+                return redux_run<Func, Scalar, Traits::MayVectorize>::run(func, SliceReader(eval, outer), inner);
+            return redux_run<Func, Scalar, false>::run(func, SliceReader(eval, outer), inner);
+        }
+    };
+
+    // a run starting at an offset of the slice \a outer, to split a single long slice
+    struct inner_range
+    {
+        const Evaluator& eval;
+        const Func& func;
+        Index outer;
+        bool vectorize;
+
+        Scalar operator()(Index begin, Index end) const
+        {
+            const offset_reader reader = { SliceReader(eval, outer), begin };
+            if(vectorize)
+                return redux_run<Func, Scalar, Traits::MayVectorize>::run(func, reader, end - begin);
+            return redux_run<Func, Scalar, false>::run(func, reader, end - begin);
+        }
+    };
+
+    struct offset_reader
+    {
+        SliceReader reader;
+        Index offset;
+
+        NC_STRONG_INLINE Scalar coeff(Index i) const { return reader.coeff(offset + i); }
+
+        template<typename PacketType>
+        NC_STRONG_INLINE PacketType packet(Index i) const { return reader.template packet<PacketType>(offset + i); }
+    };
+
+    static Scalar run(const Derived& xpr, const Func& func)
+    {
+        nc_assert(xpr.size() > 0 && "you are using an empty array");
+        Evaluator eval(xpr);
+        return run(eval, xpr.shape(), func, typename conditional<Traits::MayLinearize, true_type, false_type>::type());
+    }
+
+    static Scalar run(const Evaluator& eval, const Shape& shape, const Func& func, true_type)
+    {
+        if(eval.broadcasting())
+            return run(eval, shape, func, false_type());
+        const linear_range range = { eval, func };
+        return parallel_reduce<Scalar>(shape.size(), Index(Traits::PacketSize), Traits::threads(shape.size(), Traits::MayVectorize),
+                                       range, func);
+    }
+
+    static Scalar run(const Evaluator& eval, const Shape& shape, const Func& func, false_type)
+    {
+        const Index outer = outer_size(shape), inner = inner_size(shape);
+        const bool vectorize = Traits::MayVectorize && eval.innerContiguous();
+        const int threads = Traits::threads(shape.size(), vectorize);
+        if(outer == 1)
+        {
+            const inner_range range = { eval, func, 0, vectorize };
+            return parallel_reduce<Scalar>(inner, Index(Traits::PacketSize), threads, range, func);
+        }
+        const slice_range range = { eval, func, inner, vectorize };
+        return parallel_reduce<Scalar>(outer, Index(1), threads, range, func);
+    }
+};
+
+
+/** \internal
+  * \returns the linear row-major index of the first minimum (\a IsMax false) or maximum (\a IsMax true)
+  * coefficient of \a xpr
+  */
+template<bool IsMax, typename Derived>
+Index redux_arg(const Derived& xpr)
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+    nc_assert(xpr.size() > 0 && "you are using an empty array");
+
+    const evaluator<Derived> eval(xpr);
+    const Index outer = outer_size(xpr.shape()), inner = inner_size(xpr.shape());
+    Scalar best = eval.coeff(0, 0);
+    Index index = 0;
+    for(Index o=0; o<outer; ++o)
+        for(Index i=0; i<inner; ++i)
+        {
+            const Scalar x = eval.coeff(o, i);
+            if(IsMax ? best < x : x < best)
+            {
+                best = x;
+                index = o * inner + i;
+            }
+        }
+    return index;
+}
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns the result of a full reduction of *this by \a func, which must be associative and commutative.
+  *
+  * \a func is a binary functor like internal::scalar_sum_op. It is applied to packets through \c packetOp(),
+  * and a packet is reduced to a scalar through \c predux(), when the functor supports them. The order in
+  * which the coefficients are combined is not specified.
+  *
+  * \sa sum(), prod(), min(), max()
+  */
+template<typename Derived>
+template<typename Func>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::redux(const Func& func) const
+{
+    return internal::redux_impl<Func, Derived>::run(derived(), func);
+}
+
+/** \returns the sum of all the coefficients of *this, 0 for an empty array.
+  *
+  * Floating point sums are accumulated pairwise, the rounding error grows like O(log n) instead of O(n).
+  */
+template<typename Derived>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::sum() const
+{
+    if(size() == 0) return Scalar(0);
+    return redux(internal::scalar_sum_op<Scalar, Scalar>());
+}
+
+/** \returns the product of all the coefficients of *this, 1 for an empty array */
+template<typename Derived>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::prod() const
+{
+    if(size() == 0) return Scalar(1);
+    return redux(internal::scalar_product_op<Scalar, Scalar>());
+}
+
+/** \returns the minimum of all the coefficients of *this, which must not be empty */
+template<typename Derived>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::min() const
+{
+    return redux(internal::scalar_min_op<Scalar, Scalar>());
+}
+
+/** \returns the maximum of all the coefficients of *this, which must not be empty */
+template<typename Derived>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::max() const
+{
+    return redux(internal::scalar_max_op<Scalar, Scalar>());
+}
+
+/** \returns the mean of all the coefficients of *this, computed in \c Scalar (hence truncated for integers) */
+template<typename Derived>
+typename internal::traits<Derived>::Scalar ArrayOp<Derived>::mean() const
+{
+    return sum() / Scalar(size());
+}
+
+/** \returns the (biased) variance of all the coefficients of *this, i.e. the mean of the squared deviations
+  * |x - mean()|^2 from the mean, real for complex coefficients. It takes two passes over *this, which is far
+  * more accurate than the mean of the squares minus the squared mean.
+  */
+template<typename Derived>
+typename ArrayOp<Derived>::RealScalar ArrayOp<Derived>::var() const
+{
+    const ConstantReturnType m = constant(mean());
+    return (derived() - m).abs2().sum() / RealScalar(size());
+}
+
+/** \returns the euclidean norm of *this, the square root of the sum of the squared absolute values |x|^2 of
+  * the coefficients */
+template<typename Derived>
+typename ArrayOp<Derived>::RealScalar ArrayOp<Derived>::norm() const
+{
+    using std::sqrt;
+    return RealScalar(sqrt(abs2().sum()));
+}
+
+/** \returns the linear row-major index of the first minimum coefficient of *this, which must not be empty */
+template<typename Derived>
+Index ArrayOp<Derived>::argmin() const
+{
+    return internal::redux_arg<false>(derived());
+}
+
+/** \returns the linear row-major index of the first maximum coefficient of *this, which must not be empty */
+template<typename Derived>
+Index ArrayOp<Derived>::argmax() const
+{
+    return internal::redux_arg<true>(derived());
+}
+
+NS_END
+
+#endif
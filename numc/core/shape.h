@@ -11,17 +11,134 @@
 #ifndef __NC_SHAPE_H__
 #define __NC_SHAPE_H__
 
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class small_index_array
+  *
+  * \brief Array of Index stored inline up to \a InlineSize entries, and on the heap beyond
+  *
+  * Shape and Strides are copied into arrays, views, expression nodes and evaluators, while most arrays
+  * have few dimensions. Keeping the common ranks inline makes these objects a few words large and their
+  * copies allocation free, only ranks above \a InlineSize pay for a heap buffer.
+  */
+template<int InlineSize>
+class small_index_array
+{
+public:
+    small_index_array() : _size(0) {}
+
+    explicit small_index_array(Index size) : _size(size)
+    {
+        nc_assert(size >= 0 && size <= Index(MAX_ARRAY_DIMENSIONS));
+        if(onHeap()) _heap = allocate(size);
+    }
+
+    small_index_array(const small_index_array& other) : _size(other._size)
+    {
+        if(onHeap()) _heap = allocate(_size);
+        copy(other);
+    }
+
+#if NC_HAS_RVALUE_REFERENCES
+    small_index_array(small_index_array&& other) NC_NOEXCEPT : _size(other._size)
+    {
+        if(onHeap()) _heap = other._heap;
+        else copy(other);
+        other._size = 0;
+    }
+
+    small_index_array& operator=(small_index_array&& other) NC_NOEXCEPT
+    {
+        if(this != &other)
+        {
+            release();
+            _size = other._size;
+            if(onHeap()) _heap = other._heap;
+            else copy(other);
+            other._size = 0;
+        }
+        return *this;
+    }
+#endif
+
+    small_index_array& operator=(const small_index_array& other)
+    {
+        if(this != &other)
+        {
+            if(_size != other._size)
+            {
+                release();
+                _size = other._size;
+                if(onHeap()) _heap = allocate(_size);
+            }
+            copy(other);
+        }
+        return *this;
+    }
+
+    ~small_index_array() { release(); }
+
+    NC_STRONG_INLINE Index size() const { return _size; }
+
+    NC_STRONG_INLINE const Index* data() const { return onHeap() ? _heap : _inline; }
+
+    NC_STRONG_INLINE Index* data() { return onHeap() ? _heap : _inline; }
+
+    NC_STRONG_INLINE Index operator[](Index i) const { return data()[i]; }
+
+    NC_STRONG_INLINE Index& operator[](Index i) { return data()[i]; }
+
+private:
+    NC_STRONG_INLINE bool onHeap() const { return _size > Index(InlineSize); }
+
+    static Index* allocate(Index size)
+    {
+        return static_cast<Index*>(conditional_aligned_malloc<false>(std::size_t(size) * sizeof(Index)));
+    }
+
+    void release()
+    {
+        if(onHeap()) conditional_aligned_free<false>(_heap);
+    }
+
+    void copy(const small_index_array& other)
+    {
+        smart_copy(other.data(), other.data() + _size, data());
+    }
+
+private:
+    union
+    {
+        Index _inline[InlineSize];
+        Index* _heap;
+    };
+    Index _size;
+};
+
+/** \internal number of dimensions a Shape or a Strides stores inline, covering scalars to 4-d tensors */
+const int SmallRank = 4;
+
+NS_INTERNAL_END
+
+
 NS_BEGIN
 
+/** \class Shape
+  * \ingroup Core_Module
+  *
+  * \brief Extents of the dimensions of an n-dimension array, together with their product
+  *
+  * Up to 4 dimensions are stored inside the object, higher ranks (up to MAX_ARRAY_DIMENSIONS) spill to
+  * the heap. Copying the shape of a small array is then a copy of a few words.
+  */
 class Shape
 {
 public:
-    Shape(std::initializer_list<Index> ds) : _dims(ds.size())
+    Shape(std::initializer_list<Index> ds) : _data(Index(ds.size())), _size(1)
     {
         Index i=0;
-        auto it = ds.begin();
-        _size = 1;
-        for (; it != ds.end(); ++it, ++i)
+        for (auto it = ds.begin(); it != ds.end(); ++it, ++i)
         {
             _data[i] = *it;
             _size *= *it;
@@ -29,25 +146,53 @@ public:
     }
 
 
-    template <typename... T>
-    Shape(T... ds)
+    Shape() : _size(1) {}
+
+    template <typename T0, typename... T,
+              typename internal::enable_if<internal::is_integral<T0>::value, int>::type = 0>
+    Shape(T0 d0, T... ds) : _data(Index(sizeof...(ds) + 1)), _size(1)
     {
-        _dims = sizeof...(ds);
-        _size = 1;
-        _shape_ctor(ds...);
+        _shape_ctor(d0, ds...);
+    }
+
+    /** Constructs a shape of \a dims dimensions whose extents are read from \a extents */
+    Shape(const Index* extents, Index dims) : _data(dims), _size(1)
+    {
+        for(Index i=0; i<dims; ++i)
+        {
+            _data[i] = extents[i];
+            _size *= extents[i];
+        }
     }
 
 
     inline Index size() const { return _size; }
 
-    inline Index dims() const { return _dims; }
+    inline Index dims() const { return _data.size(); }
 
     inline Index operator[](Index i) const
     {
-        nc_assert(i < MAX_ARRAY_DIMENSIONS);
+        nc_internal_assert(i >= 0 && i < dims());
         return _data[i];
     }
 
+    /** \returns the extents as an array of dims() values */
+    inline const Index* data() const { return _data.data(); }
+
+    inline bool operator==(const Shape& other) const
+    {
+        if(dims() != other.dims()) return false;
+        const Index* a = data();
+        const Index* b = other.data();
+        for(Index i=0; i<dims(); ++i)
+        {
+            if(a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    inline bool operator!=(const Shape& other) const { return !(*this == other); }
+
     friend std::ostream &operator << (std::ostream &s, const Shape& shape)
     {
         s << "(";
@@ -64,10 +209,10 @@ public:
 private:
 
     template <typename T0, typename... T1>
-    inline typename internal::enable_if< internal::is_same<int, T0>::value, void >::type
+    inline typename internal::enable_if< internal::is_integral<T0>::value, void >::type
     _shape_ctor(T0 d0, T1... ds)
     {
-        _data[_dims - sizeof...(ds) - 1] = d0;
+        _data[dims() - Index(sizeof...(ds)) - 1] = Index(d0);
         _size *= d0;
         _shape_ctor(ds...);
     }
@@ -77,12 +222,31 @@ private:
 
 
 private:
-    Index _data[MAX_ARRAY_DIMENSIONS];
-    Index _dims;
+    internal::small_index_array<internal::SmallRank> _data;
     Index _size;
 };
 
 
 NS_END
 
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns the number of coefficients along the last dimension of \a shape,
+  * which is the inner dimension of the row-major storage order (1 for a 0-dimension shape) */
+inline Index inner_size(const Shape& shape)
+{
+    return shape.dims() == 0 ? 1 : shape[shape.dims()-1];
+}
+
+/** \internal \returns the number of slices along the last dimension of \a shape,
+  * i.e. the product of all the leading dimensions */
+inline Index outer_size(const Shape& shape)
+{
+    const Index inner = inner_size(shape);
+    return inner == 0 ? 0 : shape.size() / inner;
+}
+
+NS_INTERNAL_END
+
 #endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_STRIDES_H__
+#define __NC_STRIDES_H__
+
+NS_BEGIN
+
+/** \class Strides
+  * \ingroup Core_Module
+  *
+  * \brief Distance, in coefficients, between two consecutive coefficients along each dimension
+  *
+  * Strides is the companion of Shape describing how an n-dimension array is laid out in memory:
+  * the coefficient at the multi-index (i0, i1, ..., in) lives at \c data + i0*strides[0] + ... + in*strides[n].
+  * Strides are counted in coefficients (not in bytes) and may be negative (reversed slices) or zero
+  * (broadcasted dimensions).
+  *
+  * An Array always has the row-major contiguous strides returned by Strides(const Shape&),
+  * an ArrayView may have any. Like Shape, up to 4 strides are stored inline.
+  */
+class Strides
+{
+public:
+    Strides() {}
+
+    Strides(std::initializer_list<Index> ss) : _data(Index(ss.size()))
+    {
+        Index i=0;
+        for (auto it = ss.begin(); it != ss.end(); ++it, ++i)
+            _data[i] = *it;
+    }
+
+    /** Constructs the strides of \a dims dimensions read from \a strides */
+    Strides(const Index* strides, Index dims) : _data(dims)
+    {
+        for(Index i=0; i<dims; ++i)
+            _data[i] = strides[i];
+    }
+
+    /** Constructs the strides of a contiguous row-major array of shape \a shape,
+      * i.e. the last dimension has a stride of 1 and every other one the product of the following extents */
+    explicit Strides(const Shape& shape) : _data(shape.dims())
+    {
+        Index stride = 1;
+        for(Index i=dims()-1; i>=0; --i)
+        {
+            _data[i] = stride;
+            stride *= shape[i];
+        }
+    }
+
+    inline Index dims() const { return _data.size(); }
+
+    inline Index operator[](Index i) const
+    {
+        nc_internal_assert(i >= 0 && i < dims());
+        return _data[i];
+    }
+
+    /** \returns the strides as an array of dims() values */
+    inline const Index* data() const { return _data.data(); }
+
+    inline bool operator==(const Strides& other) const
+    {
+        if(dims() != other.dims()) return false;
+        const Index* a = data();
+        const Index* b = other.data();
+        for(Index i=0; i<dims(); ++i)
+        {
+            if(a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    inline bool operator!=(const Strides& other) const { return !(*this == other); }
+
+    friend std::ostream &operator << (std::ostream &s, const Strides& strides)
+    {
+        s << "(";
+        for(Index i=0; i<strides.dims(); ++i)
+        {
+            s << strides[i];
+            if(i != strides.dims()-1) s << ", ";
+        }
+        s << ")";
+        return s;
+    }
+
+private:
+    internal::small_index_array<internal::SmallRank> _data;
+};
+
+
+NS_END
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns the offset, from the first coefficient, of the coefficient at the row-major \a index
+  * of an array of \a dims dimensions of extents \a extents laid out with \a strides.
+  *
+  * The index is unraveled from the last dimension. Ranks up to 4 are unrolled, which removes the loop
+  * and lets the compiler keep the extents and strides in registers when this is hoisted out of a slice loop.
+  */
+NC_STRONG_INLINE Index unravel_offset(Index index, const Index* extents, const Index* strides, Index dims)
+{
+    switch(dims)
+    {
+    case 0:
+        return 0;
+    case 1:
+        return index * strides[0];
+    case 2:
+        return (index % extents[1]) * strides[1] + (index / extents[1]) * strides[0];
+    case 3:
+    {
+        const Index i2 = index % extents[2];
+        index /= extents[2];
+        return i2 * strides[2] + (index % extents[1]) * strides[1] + (index / extents[1]) * strides[0];
+    }
+    case 4:
+    {
+        const Index i3 = index % extents[3];
+        index /= extents[3];
+        const Index i2 = index % extents[2];
+        index /= extents[2];
+        return i3 * strides[3] + i2 * strides[2] + (index % extents[1]) * strides[1] + (index / extents[1]) * strides[0];
+    }
+    default:
+    {
+        Index offset = 0;
+        for(Index i=dims-1; i>=0; --i)
+        {
+            offset += (index % extents[i]) * strides[i];
+            index /= extents[i];
+        }
+        return offset;
+    }
+    }
+}
+
+NS_INTERNAL_END
+
+#endif
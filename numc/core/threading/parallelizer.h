@@ -0,0 +1,235 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_PARALLELIZER_H__
+#define __NC_PARALLELIZER_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns the process wide number of threads, 0 standing for the number of hardware threads */
+inline std::atomic<int>& global_num_threads()
+{
+    static std::atomic<int> n(0);
+    return n;
+}
+
+/** \internal \returns the number of threads set by a ScopedNumThreads for the calling thread, 0 if none */
+inline int& scoped_num_threads()
+{
+    static thread_local int n = 0;
+    return n;
+}
+
+inline int hardware_num_threads()
+{
+#ifdef NC_PARALLELIZE
+    static const int n = numext::maxi(int(std::thread::hardware_concurrency()), 1);
+    return n;
+#else
+    return 1;
+#endif
+}
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns the maximum number of threads numc uses for a single operation, the calling thread included.
+  *
+  * It is the count of the innermost ScopedNumThreads of the calling thread if any, else the one given to
+  * set_num_threads(), else the number of hardware threads. It is always 1 when numc is compiled with
+  * NC_DONT_PARALLELIZE.
+  */
+inline int get_num_threads()
+{
+#ifdef NC_PARALLELIZE
+    int n = internal::scoped_num_threads();
+    if(n <= 0) n = internal::global_num_threads().load(std::memory_order_relaxed);
+    if(n <= 0) n = internal::hardware_num_threads();
+    return numext::mini(n, int(NC_MAX_THREADS));
+#else
+    return 1;
+#endif
+}
+
+/** Sets the maximum number of threads numc uses for a single operation, for all the threads of the program.
+  * \a n <= 0 restores the default, i.e. the number of hardware threads, and 1 makes numc single-threaded.
+  *
+  * The worker threads are started when first needed and are shared by all the threads of the program,
+  * at most one operation running on them at any time (the others run on their calling thread).
+  */
+inline void set_num_threads(int n)
+{
+    internal::global_num_threads().store(n, std::memory_order_relaxed);
+}
+
+/** \class ScopedNumThreads
+  * \ingroup Core_Module
+  *
+  * \brief Overrides the number of threads numc uses, for the calling thread and for the lifetime of the object
+  *
+  * This keeps numc on a budget of cores next to other worker threads, without affecting the other threads
+  * of the program:
+  * \code
+  * {
+  *     ScopedNumThreads scope(2);
+  *     c = a * b + c;       // runs on at most 2 threads
+  * }
+  * \endcode
+  * Scopes nest, the innermost one wins.
+  */
+class ScopedNumThreads
+{
+public:
+    explicit ScopedNumThreads(int n) : _previous(internal::scoped_num_threads())
+    {
+        internal::scoped_num_threads() = numext::maxi(n, 1);
+    }
+
+    ~ScopedNumThreads() { internal::scoped_num_threads() = _previous; }
+
+private:
+    ScopedNumThreads(const ScopedNumThreads&);
+    ScopedNumThreads& operator=(const ScopedNumThreads&);
+
+    int _previous;
+};
+
+NS_END
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal \returns the number of threads worth running a job of estimated \a cost (in NumTraits units) on */
+inline int parallel_threads(double cost)
+{
+#ifdef NC_PARALLELIZE
+    const int maxThreads = get_num_threads();
+    if(maxThreads <= 1 || cost < 2.0 * NC_PARALLEL_COST_THRESHOLD || in_parallel_region()) return 1;
+    return int(numext::mini(double(maxThreads), cost / NC_PARALLEL_COST_THRESHOLD));
+#else
+    NC_UNUSED_VARIABLE(cost);
+    return 1;
+#endif
+}
+
+/** \internal
+  * Splits [0, size) into chunks starting at multiples of \a grain (e.g. a packet size, so that every chunk but
+  * the last stays aligned like the whole range), a few per thread for the work stealing to balance uneven threads.
+  */
+struct parallel_partition
+{
+    enum { ChunksPerThread = 4 };
+
+    parallel_partition(Index size, Index grain, int threads) : size(size)
+    {
+        const Index grains = (size + grain - 1) / grain;
+        const Index maxChunks = numext::mini(grains, Index(threads) * ChunksPerThread);
+        chunkSize = ((grains + maxChunks - 1) / maxChunks) * grain;
+        chunks = (size + chunkSize - 1) / chunkSize;
+    }
+
+    Index begin(Index chunk) const { return chunk * chunkSize; }
+    Index end(Index chunk) const { return numext::mini(begin(chunk) + chunkSize, size); }
+
+    Index size;
+    Index chunkSize;
+    Index chunks;
+};
+
+template<typename Func>
+struct parallel_for_context
+{
+    const Func* func;
+    const parallel_partition* partition;
+
+    static void run(void* context, Index chunk)
+    {
+        const parallel_for_context& self = *static_cast<const parallel_for_context*>(context);
+        (*self.func)(self.partition->begin(chunk), self.partition->end(chunk));
+    }
+};
+
+/** \internal
+  * Calls \a func(begin, end) over sub-ranges covering [0, \a size), on up to \a threads threads, see parallel_partition.
+  * With a single thread, or when the pool is busy, \a func(0, \a size) runs on the caller.
+  */
+template<typename Func>
+void parallel_for(Index size, Index grain, int threads, const Func& func)
+{
+#ifdef NC_PARALLELIZE
+    if(threads > 1 && size > grain)
+    {
+        const parallel_partition partition(size, grain, threads);
+        parallel_for_context<Func> context = { &func, &partition };
+        if(thread_pool::instance().run(partition.chunks, threads, &parallel_for_context<Func>::run, &context))
+            return;
+    }
+#else
+    NC_UNUSED_VARIABLE(grain);
+    NC_UNUSED_VARIABLE(threads);
+#endif
+    func(Index(0), size);
+}
+
+template<typename Scalar, typename Func>
+struct parallel_reduce_context
+{
+    const Func* func;
+    const parallel_partition* partition;
+    Scalar* partials;
+
+    static void run(void* context, Index chunk)
+    {
+        const parallel_reduce_context& self = *static_cast<const parallel_reduce_context*>(context);
+        self.partials[chunk] = (*self.func)(self.partition->begin(chunk), self.partition->end(chunk));
+    }
+};
+
+/** \internal \returns the combination by \a combine of \a partials[begin, end), pairwise */
+template<typename Scalar, typename Combine>
+Scalar combine_pairwise(const Scalar* partials, Index begin, Index end, const Combine& combine)
+{
+    if(end - begin == 1) return partials[begin];
+    const Index mid = begin + (end - begin) / 2;
+    return combine(combine_pairwise(partials, begin, mid, combine), combine_pairwise(partials, mid, end, combine));
+}
+
+/** \internal
+  * \returns the reduction of [0, \a size), \a func(begin, end) reducing a sub-range and \a combine(a, b) two
+  * partial results, on up to \a threads threads.
+  *
+  * The partial results are combined in the order of the sub-ranges whichever thread computed them, so the
+  * result only depends on the number of threads, and pairwise, which keeps sums accurate.
+  */
+template<typename Scalar, typename Func, typename Combine>
+Scalar parallel_reduce(Index size, Index grain, int threads, const Func& func, const Combine& combine)
+{
+#ifdef NC_PARALLELIZE
+    if(threads > 1 && size > grain)
+    {
+        const parallel_partition partition(size, grain, threads);
+        std::vector<Scalar> partials(partition.chunks);
+        parallel_reduce_context<Scalar, Func> context = { &func, &partition, partials.data() };
+        if(thread_pool::instance().run(partition.chunks, threads, &parallel_reduce_context<Scalar, Func>::run, &context))
+            return combine_pairwise(partials.data(), 0, partition.chunks, combine);
+    }
+#else
+    NC_UNUSED_VARIABLE(grain);
+    NC_UNUSED_VARIABLE(threads);
+    NC_UNUSED_VARIABLE(combine);
+#endif
+    return func(Index(0), size);
+}
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,286 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_THREAD_POOL_H__
+#define __NC_THREAD_POOL_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal hints the processor that the calling thread is spinning */
+NC_STRONG_INLINE void cpu_relax()
+{
+#if NC_COMP_GNUC && NC_ARCH_i386_OR_x86_64
+    __builtin_ia32_pause();
+#elif NC_COMP_GNUC && NC_ARCH_ARM64
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/** \internal \returns a reference to the flag telling whether the calling thread runs a job of the pool */
+inline bool& in_parallel_region()
+{
+    static thread_local bool flag = false;
+    return flag;
+}
+
+
+/** \internal
+  * \class work_range
+  *
+  * \brief Range of chunk indices owned by a thread, which other threads can steal from without lock
+  *
+  * [begin, end) is packed into a single 64 bits atomic word. The owner pops chunks at the front and a thief
+  * steals the back half, both with one compare-and-swap, so a chunk is handed out exactly once. The range of
+  * a thread only ever shrinks during a job, or is refilled by its owner once empty with chunks no other range
+  * holds, such that a stale compare-and-swap always fails.
+  *
+  * The object fills a whole cache line, the ranges of different threads then never share one.
+  */
+class work_range
+{
+public:
+    work_range() : _range(0) {}
+
+    /** Replaces the range, only by its owner and when no other thread can steal from it (empty range) */
+    NC_STRONG_INLINE void reset(uint32_t begin, uint32_t end)
+    {
+        _range.store(pack(begin, end), std::memory_order_release);
+    }
+
+    /** Takes the first chunk of the range into \a chunk, \returns false if the range is empty */
+    NC_STRONG_INLINE bool pop(uint32_t& chunk)
+    {
+        uint64_t r = _range.load(std::memory_order_acquire);
+        while(first(r) < last(r))
+        {
+            if(_range.compare_exchange_weak(r, pack(first(r)+1, last(r)), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                chunk = first(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Takes the back half of the range (at least one chunk) into [\a begin, \a end), \returns false if the range is empty */
+    NC_STRONG_INLINE bool steal(uint32_t& begin, uint32_t& end)
+    {
+        uint64_t r = _range.load(std::memory_order_acquire);
+        while(first(r) < last(r))
+        {
+            const uint32_t mid = first(r) + (last(r) - first(r)) / 2;
+            if(_range.compare_exchange_weak(r, pack(first(r), mid), std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                begin = mid;
+                end = last(r);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static NC_STRONG_INLINE uint64_t pack(uint32_t begin, uint32_t end) { return (uint64_t(begin) << 32) | uint64_t(end); }
+    static NC_STRONG_INLINE uint32_t first(uint64_t r) { return uint32_t(r >> 32); }
+    static NC_STRONG_INLINE uint32_t last(uint64_t r) { return uint32_t(r); }
+
+private:
+    std::atomic<uint64_t> _range;
+    char _padding[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+
+/** \internal
+  * \class thread_pool
+  *
+  * \brief Persistent pool of worker threads running data-parallel jobs by work stealing
+  *
+  * A job is a number of chunks and a function called once per chunk. Each participating thread, the
+  * calling one being the first, starts with a contiguous share of the chunks, which keeps the memory a
+  * thread touches together, and steals half of the remaining share of another thread when it runs out.
+  * Handing out chunks is lock free (see work_range): a slow or late thread only delays the chunks it
+  * actually took.
+  *
+  * The workers are started on demand and live until the end of the program. Between jobs they spin for a
+  * short while, so that back to back assignments do not pay a wake up, then sleep on a condition variable.
+  *
+  * The pool runs one job at a time. A job submitted while another one runs, or from inside a job (e.g. an
+  * assignment in a chunk function), is refused and the caller runs it alone, which never deadlocks.
+  */
+class thread_pool
+{
+public:
+    typedef void (*ChunkFunc)(void* context, Index chunk);
+
+    enum {
+        MaxThreads = NC_MAX_THREADS,
+        SpinCount = 1 << 14
+    };
+
+    /** \returns the process wide pool */
+    static thread_pool& instance()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _stop.store(true, std::memory_order_release);
+        }
+        _wake.notify_all();
+        for(size_t i=0; i<_workers.size(); ++i)
+            _workers[i].join();
+    }
+
+    /** Calls \a func(\a context, c) for every chunk c in [0, \a chunks), over at most \a threads threads including
+      * the calling one, and returns once all the chunks are done.
+      * \returns false without calling anything if the pool is busy, the caller then has to run the chunks itself */
+    bool run(Index chunks, int threads, ChunkFunc func, void* context)
+    {
+        if(in_parallel_region() || !_submitMutex.try_lock())
+            return false;
+        std::lock_guard<std::mutex> submitLock(_submitMutex, std::adopt_lock);
+
+        threads = int(numext::mini(numext::mini(Index(threads), chunks), Index(MaxThreads)));
+        startWorkers(threads - 1);
+
+        for(int i=0; i<threads; ++i)
+            _ranges[i].reset(uint32_t(chunks * i / threads), uint32_t(chunks * (i+1) / threads));
+        _func = func;
+        _context = context;
+        _participants = threads;
+        _remaining.store(chunks, std::memory_order_relaxed);
+        // publishes the job to the workers checking in from now on
+        _closed.store(false, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+            _generation.fetch_add(1, std::memory_order_release);
+        }
+        _wake.notify_all();
+
+        in_parallel_region() = true;
+        work(0);
+        in_parallel_region() = false;
+
+        // all the chunks are done once _remaining reaches 0 (acquire: their writes are visible), then the
+        // job is closed and the workers still looking at it are waited for before it can be replaced
+        for(int spin=0; _remaining.load(std::memory_order_acquire) != 0; spin += spin < SpinCount)
+            backoff(spin);
+        _closed.store(true, std::memory_order_seq_cst);
+        for(int spin=0; _active.load(std::memory_order_seq_cst) != 0; spin += spin < SpinCount)
+            backoff(spin);
+        return true;
+    }
+
+    /** \returns the number of started worker threads */
+    int workers() const { return int(_workers.size()); }
+
+private:
+    thread_pool()
+    : _func(0), _context(0), _participants(0), _remaining(0), _generation(0), _active(0), _closed(true), _stop(false)
+    {}
+
+    thread_pool(const thread_pool&);
+    thread_pool& operator=(const thread_pool&);
+
+    // spins first, then gives the core away in case the awaited thread is not running (more threads than cores)
+    static NC_STRONG_INLINE void backoff(int spin)
+    {
+        if(spin < SpinCount) cpu_relax();
+        else std::this_thread::yield();
+    }
+
+    void startWorkers(int count)
+    {
+        while(int(_workers.size()) < count)
+            _workers.push_back(std::thread(&thread_pool::workerLoop, this, int(_workers.size()) + 1));
+    }
+
+    void work(int id)
+    {
+        uint32_t chunk, begin, end;
+        for(;;)
+        {
+            while(_ranges[id].pop(chunk))
+            {
+                _func(_context, Index(chunk));
+                _remaining.fetch_sub(1, std::memory_order_acq_rel);
+            }
+
+            // the own range is empty: steal from the others, starting with the next thread
+            bool stolen = false;
+            for(int k=1; k<_participants && !stolen; ++k)
+                stolen = _ranges[(id + k) % _participants].steal(begin, end);
+            if(!stolen) return;
+
+            _ranges[id].reset(begin + 1, end);
+            _func(_context, Index(begin));
+            _remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void workerLoop(int id)
+    {
+        in_parallel_region() = true;
+        uint64_t seen = 0;
+        for(;;)
+        {
+            uint64_t generation = _generation.load(std::memory_order_acquire);
+            for(int spin=0; generation == seen && spin < SpinCount && !_stop.load(std::memory_order_relaxed); ++spin)
+            {
+                cpu_relax();
+                generation = _generation.load(std::memory_order_acquire);
+            }
+            if(generation == seen)
+            {
+                std::unique_lock<std::mutex> lock(_sleepMutex);
+                while(_generation.load(std::memory_order_acquire) == seen && !_stop.load(std::memory_order_acquire))
+                    _wake.wait(lock);
+                generation = _generation.load(std::memory_order_acquire);
+            }
+            if(_stop.load(std::memory_order_acquire)) return;
+            seen = generation;
+
+            // checking in before looking at the job, see run()
+            _active.fetch_add(1, std::memory_order_seq_cst);
+            if(!_closed.load(std::memory_order_seq_cst) && id < _participants)
+                work(id);
+            _active.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+private:
+    work_range _ranges[MaxThreads];
+    std::vector<std::thread> _workers;
+
+    // the current job, written by run() before the job is opened
+    ChunkFunc _func;
+    void* _context;
+    int _participants;
+    std::atomic<Index> _remaining;
+
+    std::atomic<uint64_t> _generation;
+    std::atomic<int> _active;
+    std::atomic<bool> _closed;
+    std::atomic<bool> _stop;
+
+    std::mutex _submitMutex;
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+};
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,386 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_BUFFER_POOL_H__
+#define __NC_BUFFER_POOL_H__
+
+// Only included when NC_USE_BUFFER_POOL is defined, the buffers of the arrays being then recycled, see BufferPool.
+
+// buffers larger than this are always returned to the system
+#ifndef NC_BUFFER_POOL_MAX_BYTES
+#define NC_BUFFER_POOL_MAX_BYTES (std::size_t(1) << 30)
+#endif
+
+// bytes of free buffers each thread keeps for itself, before handing them to the shared pool
+#ifndef NC_BUFFER_POOL_THREAD_BYTES
+#define NC_BUFFER_POOL_THREAD_BYTES (std::size_t(64) << 20)
+#endif
+
+// bytes of free buffers kept by the shared pool, before returning them to the system
+#ifndef NC_BUFFER_POOL_SHARED_BYTES
+#define NC_BUFFER_POOL_SHARED_BYTES (std::size_t(256) << 20)
+#endif
+
+
+NS_BEGIN
+
+/** \class BufferPoolStats
+  * \ingroup Core_Module
+  *
+  * \brief Counters of the buffer pool since the start of the program, or the last BufferPool::reset_stats()
+  */
+struct BufferPoolStats
+{
+    /** number of buffers requested to the pool */
+    std::size_t allocations;
+    /** number of them recycled from a free list, the others being allocated from the system */
+    std::size_t hits;
+    /** bytes of the free buffers held by the pool, in the thread caches and in the shared pool */
+    std::size_t residentBytes;
+    /** bytes of the buffers of the pool currently used by arrays */
+    std::size_t liveBytes;
+
+    /** \returns the ratio of the requests served without the system allocator */
+    double hitRate() const { return allocations ? double(hits) / double(allocations) : 0.; }
+};
+
+NS_END
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class buffer_pool
+  *
+  * \brief Size class free lists recycling the buffers of the arrays
+  *
+  * A request is rounded up to its size class: 64 bytes, then 4 classes per power of two (80, 96, 112, 128,
+  * 160, ...), which wastes at most 25% of a buffer. The free buffers of each class are linked through their
+  * first bytes. A freed buffer goes to the free list of its class in the cache of the calling thread, to the
+  * shared pool once the thread keeps NC_BUFFER_POOL_THREAD_BYTES, and back to the system once the shared pool
+  * keeps NC_BUFFER_POOL_SHARED_BYTES. A request is served in the same order, the thread cache needing no lock.
+  * The buffers come from aligned_malloc, hence they are aligned on NC_MAX_ALIGN_BYTES.
+  *
+  * Recycled buffers keep their pages mapped: allocating a multi-megabyte array of a recurring shape neither
+  * calls mmap nor page faults again.
+  */
+class buffer_pool
+{
+public:
+    enum {
+        MinClassBytesLog2 = 6,
+        SubClasses = 4,
+        MaxClasses = (64 - MinClassBytesLog2) * SubClasses + 1
+    };
+
+    /** \internal \returns the size class of a buffer of \a bytes bytes */
+    static inline int size_class(std::size_t bytes)
+    {
+        if(bytes <= (std::size_t(1) << MinClassBytesLog2))
+            return 0;
+        int e = MinClassBytesLog2;
+        while((std::size_t(2) << e) < bytes) ++e;
+        const std::size_t step = std::size_t(1) << (e - 2);
+        const std::size_t q = (bytes - (std::size_t(1) << e) + step - 1) / step;
+        return (e - MinClassBytesLog2) * SubClasses + int(q);
+    }
+
+    /** \internal \returns the bytes of the buffers of the size class \a c */
+    static inline std::size_t class_bytes(int c)
+    {
+        if(c == 0)
+            return std::size_t(1) << MinClassBytesLog2;
+        const int e = MinClassBytesLog2 + (c - 1) / SubClasses;
+        const std::size_t q = std::size_t((c - 1) % SubClasses + 1);
+        return (std::size_t(1) << e) + q * (std::size_t(1) << (e - 2));
+    }
+
+    /** \internal \returns the process-wide pool. It is never destructed, so that arrays with static storage
+      * can still give their buffers back while the program exits. */
+    static buffer_pool& shared()
+    {
+        static buffer_pool* pool = new buffer_pool;
+        return *pool;
+    }
+
+    /** \internal \returns a buffer of at least \a bytes bytes */
+    void* allocate(std::size_t bytes)
+    {
+        if(bytes == 0) return 0;
+        _allocations.fetch_add(1, std::memory_order_relaxed);
+        if(bytes > NC_BUFFER_POOL_MAX_BYTES)
+            return system_allocate(bytes);
+
+        const int c = size_class(bytes);
+        const std::size_t size = class_bytes(c);
+        thread_cache* cache = thread_cache::local();
+        void* block = cache ? pop(cache->free[c]) : 0;
+        if(block)
+            cache->bytes -= size;
+        else
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if((block = pop(_free[c])) != 0)
+                _sharedBytes -= size;
+        }
+        if(!block)
+            return system_allocate(size);
+
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        _residentBytes.fetch_sub(size, std::memory_order_relaxed);
+        _liveBytes.fetch_add(size, std::memory_order_relaxed);
+        return block;
+    }
+
+    /** \internal Gives back the buffer \a block of \a bytes bytes returned by allocate() */
+    void deallocate(void* block, std::size_t bytes)
+    {
+        if(!block) return;
+        if(bytes > NC_BUFFER_POOL_MAX_BYTES)
+            return system_free(block, bytes);
+
+        const int c = size_class(bytes);
+        const std::size_t size = class_bytes(c);
+        thread_cache* cache = thread_cache::local();
+        if(cache && cache->bytes + size <= NC_BUFFER_POOL_THREAD_BYTES)
+        {
+            push(cache->free[c], block);
+            cache->bytes += size;
+        }
+        else if(!push_shared(c, block))
+            return system_free(block, size);
+
+        _liveBytes.fetch_sub(size, std::memory_order_relaxed);
+        _residentBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    /** \internal Returns the free buffers of the calling thread and of the shared pool to the system */
+    void release()
+    {
+        std::size_t freed = 0;
+        if(thread_cache* cache = thread_cache::local())
+        {
+            for(int c = 0; c < MaxClasses; ++c)
+                freed += free_list(cache->free[c], c);
+            cache->bytes = 0;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for(int c = 0; c < MaxClasses; ++c)
+                freed += free_list(_free[c], c);
+            _sharedBytes = 0;
+        }
+        _residentBytes.fetch_sub(freed, std::memory_order_relaxed);
+    }
+
+    BufferPoolStats stats() const
+    {
+        BufferPoolStats s;
+        s.allocations = _allocations.load(std::memory_order_relaxed);
+        s.hits = _hits.load(std::memory_order_relaxed);
+        s.residentBytes = _residentBytes.load(std::memory_order_relaxed);
+        s.liveBytes = _liveBytes.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset_stats()
+    {
+        _allocations.store(0, std::memory_order_relaxed);
+        _hits.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    /** \internal The free lists of a thread, handed to the shared pool when the thread exits */
+    struct thread_cache
+    {
+        void* free[MaxClasses];
+        std::size_t bytes;
+
+        thread_cache() : bytes(0)
+        {
+            for(int c = 0; c < MaxClasses; ++c)
+                free[c] = 0;
+        }
+
+        ~thread_cache()
+        {
+            exited() = true;
+            buffer_pool& pool = shared();
+            std::size_t freed = 0;
+            for(int c = 0; c < MaxClasses; ++c)
+            {
+                while(void* block = pop(free[c]))
+                {
+                    if(!pool.push_shared(c, block))
+                    {
+                        aligned_free(block);
+                        freed += class_bytes(c);
+                    }
+                }
+            }
+            pool._residentBytes.fetch_sub(freed, std::memory_order_relaxed);
+        }
+
+        /** \internal \returns the cache of the calling thread, null once it is destructed */
+        static thread_cache* local()
+        {
+            if(exited()) return 0;
+            static thread_local thread_cache cache;
+            return &cache;
+        }
+
+        static bool& exited()
+        {
+            static thread_local bool value = false;
+            return value;
+        }
+    };
+
+    buffer_pool() : _sharedBytes(0), _allocations(0), _hits(0), _residentBytes(0), _liveBytes(0)
+    {
+        for(int c = 0; c < MaxClasses; ++c)
+            _free[c] = 0;
+    }
+    buffer_pool(const buffer_pool&);
+    buffer_pool& operator=(const buffer_pool&);
+
+    static void*& next(void* block) { return *static_cast<void**>(block); }
+
+    static void push(void*& head, void* block)
+    {
+        next(block) = head;
+        head = block;
+    }
+
+    static void* pop(void*& head)
+    {
+        void* block = head;
+        if(block) head = next(block);
+        return block;
+    }
+
+    /** \internal Frees the buffers of the free list \a head of the size class \a c, \returns their bytes */
+    static std::size_t free_list(void*& head, int c)
+    {
+        std::size_t bytes = 0;
+        while(void* block = pop(head))
+        {
+            aligned_free(block);
+            bytes += class_bytes(c);
+        }
+        return bytes;
+    }
+
+    /** \internal Adds the free buffer \a block of the size class \a c to the shared pool, unless it is full */
+    bool push_shared(int c, void* block)
+    {
+        const std::size_t size = class_bytes(c);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_sharedBytes + size > NC_BUFFER_POOL_SHARED_BYTES)
+            return false;
+        push(_free[c], block);
+        _sharedBytes += size;
+        return true;
+    }
+
+    void* system_allocate(std::size_t bytes)
+    {
+        void* block = aligned_malloc(bytes);
+        _liveBytes.fetch_add(bytes, std::memory_order_relaxed);
+        return block;
+    }
+
+    void system_free(void* block, std::size_t bytes)
+    {
+        _liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        aligned_free(block);
+    }
+
+    std::mutex _mutex;
+    void* _free[MaxClasses];
+    std::size_t _sharedBytes;
+    std::atomic<std::size_t> _allocations;
+    std::atomic<std::size_t> _hits;
+    std::atomic<std::size_t> _residentBytes;
+    std::atomic<std::size_t> _liveBytes;
+};
+
+/** \internal Same as conditional_aligned_new_auto<T,true>, the buffer coming from the buffer_pool */
+template<typename T> inline T* pooled_new_auto(std::size_t size)
+{
+    if(size == 0)
+        return 0;
+    check_size_for_overflow<T>(size);
+    T* result = static_cast<T*>(buffer_pool::shared().allocate(sizeof(T) * size));
+    if(NumTraits<T>::RequireInitialization)
+    {
+        NC_TRY
+        {
+            construct_elements_of_array(result, size);
+        }
+        NC_CATCH(...)
+        {
+            buffer_pool::shared().deallocate(result, sizeof(T) * size);
+            NC_THROW;
+        }
+    }
+    return result;
+}
+
+template<typename T> inline void pooled_delete_auto(T* ptr, std::size_t size)
+{
+    if(!ptr) return;
+    if(NumTraits<T>::RequireInitialization)
+        destruct_elements_of_array<T>(ptr, size);
+    buffer_pool::shared().deallocate(ptr, sizeof(T) * size);
+}
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class BufferPool
+  * \ingroup Core_Module
+  *
+  * \brief Entry points of the pool recycling the buffers of the arrays, when NC_USE_BUFFER_POOL is defined
+  *
+  * With NC_USE_BUFFER_POOL, an Array gives its buffer back to a pool of free buffers sorted by size class
+  * instead of freeing it, and a new Array of a similar size takes it from there, see internal::buffer_pool.
+  * A loop allocating arrays of a few recurring shapes then stops calling the system allocator:
+  * \code
+  * #define NC_USE_BUFFER_POOL
+  * #include <numc.h>
+  *
+  * for(const Request& r : requests)
+  * {
+  *     Array<float> h = (matmul(r.x, w) + b).tanh();   // recycled buffers after the first request
+  *     ...
+  * }
+  * BufferPoolStats s = BufferPool::stats();            // s.hitRate(), s.residentBytes...
+  * \endcode
+  */
+class BufferPool
+{
+public:
+    /** \returns the counters of the pool */
+    static BufferPoolStats stats() { return internal::buffer_pool::shared().stats(); }
+
+    /** Sets the request and hit counters back to 0 */
+    static void reset_stats() { internal::buffer_pool::shared().reset_stats(); }
+
+    /** Returns the free buffers of the calling thread and of the shared pool to the system. The free buffers
+      * cached by the other threads stay there. */
+    static void release() { internal::buffer_pool::shared().release(); }
+};
+
+NS_END
+
+#endif
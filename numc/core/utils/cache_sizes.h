@@ -0,0 +1,70 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CACHE_SIZES_H__
+#define __NC_CACHE_SIZES_H__
+
+// Cache sizes in bytes, used when they cannot be queried from the system
+#ifndef NC_DEFAULT_L1_CACHE_SIZE
+#define NC_DEFAULT_L1_CACHE_SIZE (32*1024)
+#endif
+
+#ifndef NC_DEFAULT_L2_CACHE_SIZE
+#define NC_DEFAULT_L2_CACHE_SIZE (512*1024)
+#endif
+
+#ifndef NC_DEFAULT_L3_CACHE_SIZE
+#define NC_DEFAULT_L3_CACHE_SIZE (4*1024*1024)
+#endif
+
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class cache_sizes
+  *
+  * \brief Sizes in bytes of the data caches, queried once from the system
+  *
+  * Missing or unknown levels fall back to NC_DEFAULT_L1_CACHE_SIZE, NC_DEFAULT_L2_CACHE_SIZE and
+  * NC_DEFAULT_L3_CACHE_SIZE. A level smaller than the previous one (e.g. no L3) is raised to it.
+  */
+struct cache_sizes
+{
+    Index l1;
+    Index l2;
+    Index l3;
+
+    static const cache_sizes& get()
+    {
+        static const cache_sizes sizes = query();
+        return sizes;
+    }
+
+private:
+    static cache_sizes query()
+    {
+        cache_sizes s = { NC_DEFAULT_L1_CACHE_SIZE, NC_DEFAULT_L2_CACHE_SIZE, NC_DEFAULT_L3_CACHE_SIZE };
+#if NC_OS_LINUX && defined(_SC_LEVEL1_DCACHE_SIZE)
+        const long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+        const long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        const long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        if(l1 > 0) s.l1 = l1;
+        if(l2 > 0) s.l2 = l2;
+        if(l3 > 0) s.l3 = l3;
+#endif
+        s.l2 = numext::maxi(s.l2, s.l1);
+        s.l3 = numext::maxi(s.l3, s.l2);
+        return s;
+    }
+};
+
+NS_INTERNAL_END
+
+#endif
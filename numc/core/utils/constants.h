@@ -15,6 +15,94 @@ NS_BEGIN
 
 const unsigned int MAX_ARRAY_DIMENSIONS = 32;
 
+/** This value means that a size (or a number of accesses) is not known at compile-time.
+  * \sa internal::traits::SizeAtCompileTime */
+const int Dynamic = -1;
+
+/** This value means that the cost to evaluate an expression coefficient is either very expensive or
+  * cannot be known at compile time.
+  *
+  * This value has to be positive to (1) simplify cost computation, and (2) allow to distinguish between
+  * expensive and very expensive expressions. It thus must also be large enough to make sure unrolling
+  * won't happen and that sub expressions will be evaluated, but not too large to avoid overflow.
+  */
+const int HugeCost = 10000;
+
+
+/** \defgroup flags Flags
+  * \ingroup Core_Module
+  *
+  * These are the possible bits which can be OR'ed to constitute the flags of an expression,
+  * as returned by internal::traits<Derived>::Flags and internal::evaluator<Derived>::Flags.
+  */
+
+/** \ingroup flags
+  *
+  * Means the expression can be evaluated coefficient by coefficient through a single linear index,
+  * in the row-major order of its shape. This is what allows the assignment loop to run over a flat
+  * range without any index computation.
+  */
+const unsigned int LinearAccessBit = 0x10;
+
+/** \ingroup flags
+  *
+  * Means the expression has a coeff() method (and writePacket() for lvalues) working on packets,
+  * i.e. several coefficients at once as given by internal::packet_traits. An expression only has
+  * it when all its operands and its functor do.
+  */
+const unsigned int PacketAccessBit = 0x8;
+
+/** \ingroup flags
+  *
+  * Means that the underlying array of coefficients can be directly accessed as a plain strided array,
+  * i.e. the expression has a data() member returning the address of its first coefficient.
+  */
+const unsigned int DirectAccessBit = 0x40;
+
+/** \ingroup flags
+  *
+  * Means the expression owns its coefficients and is held by reference by the expressions using it as an
+  * operand, see internal::nested. Expressions without it, i.e. the nodes built by the operators and the views,
+  * are held by value.
+  */
+const unsigned int NestByRefBit = 0x100;
+
+
+/** \ingroup enums
+  * Enum for indicating whether a buffer is aligned or not, and on which boundary (in bytes). */
+enum AlignmentType {
+    Unaligned=0,        /**< Data pointer has no specific alignment. */
+    Aligned8=8,         /**< Data pointer is aligned on a 8 bytes boundary. */
+    Aligned16=16,       /**< Data pointer is aligned on a 16 bytes boundary. */
+    Aligned32=32,       /**< Data pointer is aligned on a 32 bytes boundary. */
+    Aligned64=64,       /**< Data pointer is aligned on a 64 bytes boundary. */
+    Aligned128=128,     /**< Data pointer is aligned on a 128 bytes boundary. */
+    AlignedMax = NC_MAX_ALIGN_BYTES /**< Data pointer has the alignment of heap allocated Array buffers */
+};
+
+
+/** \internal The kind of loop the assignment kernel runs, see internal::dense_assignment_loop */
+enum TraversalType {
+    /** \internal Coefficient by coefficient through an outer index over the leading dimensions and an inner
+      * index over the last one */
+    DefaultTraversal,
+    /** \internal Coefficient by coefficient through a single linear index */
+    LinearTraversal,
+    /** \internal Packet by packet through a single linear index, with scalar loops for the unaligned head and the tail */
+    LinearVectorizedTraversal,
+    /** \internal Packet by packet along the last dimension, one slice (outer index) at a time, for expressions
+      * whose coefficients are contiguous along the last dimension only */
+    SliceVectorizedTraversal
+};
+
+/** \internal How much the assignment loop is unrolled at compile-time, see internal::dense_assignment_loop */
+enum UnrollingType {
+    /** \internal The loop is a run-time loop */
+    NoUnrolling,
+    /** \internal The loop is completely unrolled, which requires the size to be known at compile-time */
+    CompleteUnrolling
+};
+
 
 NS_END
 
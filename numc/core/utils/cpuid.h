@@ -0,0 +1,97 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CPUID_H__
+#define __NC_CPUID_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \class cpu_features
+  *
+  * \brief Instruction sets supported by the cpu, and whose registers are saved by the operating system
+  *
+  * The cpu is probed once with cpuid, and xgetbv for the AVX and AVX-512 states. Other architectures have none.
+  */
+struct cpu_features
+{
+    bool sse2, avx, avx2, fma, avx512;
+
+    static const cpu_features& get()
+    {
+        static const cpu_features features = probe();
+        return features;
+    }
+
+    /** \returns the highest NC_DISPATCH_LEVEL_* whose code the cpu runs */
+    int level() const
+    {
+        if(avx512 && avx2 && fma) return NC_DISPATCH_LEVEL_AVX512;
+        if(avx2 && fma) return NC_DISPATCH_LEVEL_AVX2;
+        if(avx) return NC_DISPATCH_LEVEL_AVX;
+        if(sse2) return NC_DISPATCH_LEVEL_SSE2;
+        return NC_DISPATCH_LEVEL_GENERIC;
+    }
+
+private:
+    static cpu_features probe()
+    {
+        cpu_features f = { false, false, false, false, false };
+#if NC_ARCH_i386_OR_x86_64
+        unsigned int leaf0[4], leaf1[4], leaf7[4] = { 0, 0, 0, 0 };
+        cpuid(0, leaf0);
+        cpuid(1, leaf1);
+        if(leaf0[0] >= 7) cpuid(7, leaf7);
+
+        // the AVX registers (XMM, YMM) and the AVX-512 ones (opmask, ZMM) must be enabled in XCR0
+        const bool osxsave = (leaf1[2] >> 27) & 1;
+        const unsigned int xcr0 = osxsave ? xgetbv() : 0;
+        const bool ymm = (xcr0 & 0x06) == 0x06;
+        const bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+        f.sse2 = (leaf1[3] >> 26) & 1;
+        f.avx = ymm && ((leaf1[2] >> 28) & 1);
+        f.fma = ymm && ((leaf1[2] >> 12) & 1);
+        f.avx2 = ymm && ((leaf7[1] >> 5) & 1);
+        // the AVX-512 of Skylake-X: F, DQ, CD, BW and VL
+        const unsigned int avx512 = (1u << 16) | (1u << 17) | (1u << 28) | (1u << 30) | (1u << 31);
+        f.avx512 = zmm && (leaf7[1] & avx512) == avx512;
+#endif
+        return f;
+    }
+
+#if NC_ARCH_i386_OR_x86_64
+    static void cpuid(unsigned int leaf, unsigned int regs[4])
+    {
+#if NC_COMP_MSVC
+        int r[4];
+        __cpuidex(r, int(leaf), 0);
+        for(int i=0; i<4; ++i) regs[i] = static_cast<unsigned int>(r[i]);
+#else
+        __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    static unsigned int xgetbv()
+    {
+#if NC_COMP_MSVC
+        return static_cast<unsigned int>(_xgetbv(0));
+#else
+        unsigned int eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return eax;
+#endif
+    }
+#endif
+};
+
+NS_INTERNAL_END
+
+#endif
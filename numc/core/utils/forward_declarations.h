@@ -22,6 +22,24 @@ template<typename T> struct traits;
 //              traits<const Map<T> > == traits<Map<T> >
 template<typename T> struct traits<const T> : traits<T> {};
 
+template<typename T> struct evaluator;
+
+template<typename T> struct packet_traits;
+template<typename T> struct unpacket_traits;
+
+template<typename Scalar> struct scalar_constant_op;
+
+template<typename LhsScalar, typename RhsScalar> struct scalar_sum_op;
+template<typename LhsScalar, typename RhsScalar> struct scalar_difference_op;
+template<typename LhsScalar, typename RhsScalar> struct scalar_product_op;
+template<typename LhsScalar, typename RhsScalar> struct scalar_quotient_op;
+template<typename LhsScalar, typename RhsScalar> struct scalar_min_op;
+template<typename LhsScalar, typename RhsScalar> struct scalar_max_op;
+
+template<typename Scalar> struct scalar_muladd_op;
+
+template<typename DstScalar, typename SrcScalar> struct assign_op;
+
 NS_INTERNAL_END
 
 
@@ -32,10 +50,26 @@ NS_BEGIN
 template<typename T> struct NumTraits;
 
 
+template<typename NullaryOp, typename PlainObjectType> class CwiseNullaryOp;
+
+template<typename UnaryOp, typename XprType> class CwiseUnaryOp;
+
 template<typename BinaryOp, typename LhsType, typename RhsType> class CwiseBinaryOp;
 
+template<typename TernaryOp, typename Arg1Type, typename Arg2Type, typename Arg3Type> class CwiseTernaryOp;
+
+template<typename T> class DenseStorage;
+
 template<typename Scalar> class Array;
 
+template<typename Scalar> class ArrayView;
+
+template<typename Scalar, Index... Dims> class FixedArray;
+
+template<typename PlainObjectType, int MapOptions = Unaligned> class Map;
+
+template<typename ExpressionType> class NoAlias;
+
 
 NS_END
 
@@ -16,8 +16,11 @@
 #include "macros_os.h"
 #include "macros_cxx.h"
 #include "macros_aligned.h"
+#include "macros_dispatch.h"
 #include "macros_utils.h"
 #include "macros_vectorize.h"
+#include "macros_parallel.h"
+#include "macros_blas.h"
 
 
 #endif
\ No newline at end of file
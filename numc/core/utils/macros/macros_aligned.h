@@ -47,8 +47,9 @@
 // If the user explicitly disable vectorization, then we also disable alignment
 #if defined(NC_DONT_VECTORIZE)
 #define NC_IDEAL_MAX_ALIGN_BYTES 0
-#elif defined(NC_VECTORIZE_AVX512)
+#elif defined(NC_VECTORIZE_AVX512) || defined(__AVX512F__)
 // 64 bytes static alignment is preferred only if really required
+// (macros_vectorize.h is included after this file, so also test the compiler's own macro)
   #define NC_IDEAL_MAX_ALIGN_BYTES 64
 #elif defined(__AVX__)
 // 32 bytes static alignment is preferred only if really required
@@ -0,0 +1,26 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __NC_MACROS_BLAS_H__
+#define __NC_MACROS_BLAS_H__
+
+
+// The float and double products are handed to an external CBLAS (OpenBLAS, BLIS, the reference one...) when
+// NC_USE_BLAS is defined, the program being linked against it. Device code always runs the numc kernels.
+#if defined(NC_USE_BLAS) && defined(__CUDA_ARCH__)
+#undef NC_USE_BLAS
+#endif
+
+// Header declaring the CBLAS interface, e.g. <openblas/cblas.h> or <blis/cblas.h>
+#ifndef NC_BLAS_HEADER
+#define NC_BLAS_HEADER <cblas.h>
+#endif
+
+
+#endif
@@ -0,0 +1,61 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __NC_MACROS_DISPATCH_H__
+#define __NC_MACROS_DISPATCH_H__
+
+
+// x86 instruction set levels, in increasing order
+#define NC_DISPATCH_LEVEL_GENERIC 0
+#define NC_DISPATCH_LEVEL_SSE2 1
+#define NC_DISPATCH_LEVEL_AVX 2
+#define NC_DISPATCH_LEVEL_AVX2 3
+#define NC_DISPATCH_LEVEL_AVX512 4
+
+// Level of the instruction sets the compiler is allowed to emit in this translation unit, whether by the packet
+// math or by its own vectorization. AVX2 and AVX-512 are only counted with FMA, which all their cpus have, and a cpu
+// runs the AVX-512 level when it has the AVX-512 of Skylake-X (see internal::cpu_features).
+#if NC_ARCH_i386_OR_x86_64 && !defined(NC_DONT_VECTORIZE)
+  #if defined(__AVX512F__) && defined(__FMA__)
+    #define NC_DISPATCH_LEVEL NC_DISPATCH_LEVEL_AVX512
+    #define NC_ISA_NAMESPACE avx512
+  #elif defined(__AVX2__) && defined(__FMA__)
+    #define NC_DISPATCH_LEVEL NC_DISPATCH_LEVEL_AVX2
+    #define NC_ISA_NAMESPACE avx2
+  #elif defined(__AVX__)
+    #define NC_DISPATCH_LEVEL NC_DISPATCH_LEVEL_AVX
+    #define NC_ISA_NAMESPACE avx
+  #elif defined(__SSE2__) || NC_ARCH_x86_64 || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define NC_DISPATCH_LEVEL NC_DISPATCH_LEVEL_SSE2
+    #define NC_ISA_NAMESPACE sse2
+  #endif
+#endif
+#ifndef NC_DISPATCH_LEVEL
+  #define NC_DISPATCH_LEVEL NC_DISPATCH_LEVEL_GENERIC
+  #define NC_ISA_NAMESPACE generic
+#endif
+
+// With NC_RUNTIME_DISPATCH, the products are also compiled for higher instruction set levels by the translation
+// units of numc/dispatch, and the highest one the cpu supports is picked at startup, see products/product_dispatch.h.
+// numc is then declared in an inline namespace named after the level, so that the instantiations of a template
+// compiled for a level never replace, at link time, the ones compiled for another.
+#if defined(NC_RUNTIME_DISPATCH) && defined(__CUDA_ARCH__)
+#undef NC_RUNTIME_DISPATCH
+#endif
+
+#ifdef NC_RUNTIME_DISPATCH
+  #define NC_ISA_NAMESPACE_BEGIN inline namespace NC_ISA_NAMESPACE {
+  #define NC_ISA_NAMESPACE_END }
+#else
+  #define NC_ISA_NAMESPACE_BEGIN
+  #define NC_ISA_NAMESPACE_END
+#endif
+
+
+#endif
@@ -0,0 +1,32 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef __NC_MACROS_PARALLEL_H__
+#define __NC_MACROS_PARALLEL_H__
+
+
+// Large assignments are split over the numc thread pool, unless NC_DONT_PARALLELIZE is defined.
+// Device code never spawns threads.
+#if !defined(NC_DONT_PARALLELIZE) && !defined(__CUDA_ARCH__)
+#define NC_PARALLELIZE
+#endif
+
+// Estimated cost, in NumTraits cost units, under which a job is not worth waking another thread for.
+// A job of cost C is split over at most C / NC_PARALLEL_COST_THRESHOLD threads.
+#ifndef NC_PARALLEL_COST_THRESHOLD
+#define NC_PARALLEL_COST_THRESHOLD 65536
+#endif
+
+// Upper bound on the number of threads taking part in a job, the calling one included
+#ifndef NC_MAX_THREADS
+#define NC_MAX_THREADS 256
+#endif
+
+
+#endif
@@ -13,11 +13,11 @@
 
 // Define name space
 
-#define NS_BEGIN namespace numc {
-#define NS_END }
+#define NS_BEGIN namespace numc { NC_ISA_NAMESPACE_BEGIN
+#define NS_END NC_ISA_NAMESPACE_END }
 
 #define NS_INTERNAL_BEGIN NS_BEGIN namespace internal {
-#define NS_INTERNAL_END }}
+#define NS_INTERNAL_END } NS_END
 
 
 
@@ -32,6 +32,14 @@
 #define NC_FAST_MATH 1
 #endif
 
+/** Defines the maximal loop size (roughly in number of cycles, as given by the NumTraits costs)
+  * for which the assignment loop of an expression of compile-time size is completely unrolled.
+  * The limit is multiplied by the packet size when the loop is vectorized.
+  */
+#ifndef NC_UNROLLING_LIMIT
+#define NC_UNROLLING_LIMIT 110
+#endif
+
 #define NC_DEBUG_VAR(x) std::cerr << #x << " = " << x << std::endl;
 
 // concatenate two tokens
@@ -94,7 +102,7 @@
 
 // NC_plain_assert is where we implement the workaround for the assert() bug in GCC <= 4.3, see bug 89
 #ifdef NC_NO_DEBUG
-#define NC_plain_assert(x)
+#define nc_plain_assert(x)
 #else
 #if NC_SAFE_TO_USE_STANDARD_ASSERT_MACRO
 NS_INTERNAL_BEGIN
@@ -165,7 +173,7 @@ NS_INTERNAL_END
 NS_INTERNAL_BEGIN
     template<typename T> NC_DEVICE_FUNC void ignore_unused_variable(const T&) {}
 NS_INTERNAL_END
-#define NC_UNUSED_VARIABLE(var) Eigen::internal::ignore_unused_variable(var);
+#define NC_UNUSED_VARIABLE(var) numc::internal::ignore_unused_variable(var);
 
 #if !defined(NC_ASM_COMMENT)
 #if NC_COMP_GNUC && (NC_ARCH_i386_OR_x86_64 || NC_ARCH_ARM_OR_ARM64)
@@ -176,6 +184,15 @@ NS_INTERNAL_END
 #endif
 
 
+// Compile-time min/max of two enum values, works around compilers complaining about
+// comparisons between different enumeration types
+#define NC_PLAIN_ENUM_MIN(a,b) (((int)a <= (int)b) ? (int)a : (int)b)
+#define NC_PLAIN_ENUM_MAX(a,b) (((int)a >= (int)b) ? (int)a : (int)b)
+
+// Compile-time assertion, MSG is a string literal explaining the failed condition
+#define NC_STATIC_ASSERT(X,MSG) static_assert(X, MSG);
+
+
 #if NC_COMP_MSVC
 // NOTE MSVC often gives C4127 warnings with compiletime if statements. See bug 1362.
   // This workaround is ugly, but it does the job.
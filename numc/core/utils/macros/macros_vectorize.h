@@ -129,7 +129,17 @@
         #include <nmmintrin.h>
         #endif
         #if defined(NC_VECTORIZE_AVX) || defined(NC_VECTORIZE_AVX512)
-        #include <immintrin.h>
+          // gcc 12 reports the _mm512_undefined_*() of the AVX-512 intrinsics as uninitialized once inlined,
+          // a false positive, see https://gcc.gnu.org/bugzilla/show_bug.cgi?id=105593
+          #if NC_COMP_GNUC >= 120 && !NC_COMP_CLANG
+            #pragma GCC diagnostic push
+            #pragma GCC diagnostic ignored "-Wuninitialized"
+            #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+            #include <immintrin.h>
+            #pragma GCC diagnostic pop
+          #else
+            #include <immintrin.h>
+          #endif
         #endif
       #endif
     } // end extern "C"
@@ -12,4 +12,681 @@
 #define __NC_MEMORY_H__
 
 
-#endif
\ No newline at end of file
+// On 64-bit systems, glibc's malloc returns 16-byte-aligned pointers, see:
+//   http://www.gnu.org/s/libc/manual/html_node/Aligned-Memory-Blocks.html
+// This is true at least since glibc 2.8.
+// This leaves the question how to detect 64-bit. According to this document,
+//   http://gcc.fyxm.net/summit/2003/Porting%20to%2064%20bit.pdf
+// page 114, "[The] LP64 model [...] is used by all 64-bit UNIX ports" so it's indeed
+// quite safe, at least within the context of glibc, to equate 64-bit with LP64.
+#if defined(__GLIBC__) && ((__GLIBC__>=2 && __GLIBC_MINOR__ >= 8) || __GLIBC__>2) \
+ && defined(__LP64__) && ! defined( __SANITIZE_ADDRESS__ ) && (NC_DEFAULT_ALIGN_BYTES == 16)
+#define NC_GLIBC_MALLOC_ALREADY_ALIGNED 1
+#else
+#define NC_GLIBC_MALLOC_ALREADY_ALIGNED 0
+#endif
+
+// FreeBSD 6 seems to have 16-byte aligned malloc
+// See http://svn.freebsd.org/viewvc/base/stable/6/lib/libc/stdlib/malloc.c?view=markup
+#if defined(__FreeBSD__) && !(NC_ARCH_ARM || NC_ARCH_MIPS) && (NC_DEFAULT_ALIGN_BYTES == 16)
+#define NC_FREEBSD_MALLOC_ALREADY_ALIGNED 1
+#else
+#define NC_FREEBSD_MALLOC_ALREADY_ALIGNED 0
+#endif
+
+#if (NC_OS_MAC && (NC_DEFAULT_ALIGN_BYTES == 16))     \
+ || (NC_OS_WIN64 && (NC_DEFAULT_ALIGN_BYTES == 16))   \
+ || NC_GLIBC_MALLOC_ALREADY_ALIGNED              \
+ || NC_FREEBSD_MALLOC_ALREADY_ALIGNED
+#define NC_MALLOC_ALREADY_ALIGNED 1
+#else
+#define NC_MALLOC_ALREADY_ALIGNED 0
+#endif
+
+// posix_memalign is the preferred way to get over-aligned blocks on POSIX systems,
+// it is the only choice that can go beyond the 16 bytes guaranteed by most mallocs
+// without the bookkeeping overhead of the handmade version.
+#ifndef NC_HAS_POSIX_MEMALIGN
+#if NC_OS_UNIX && !NC_OS_ANDROID && !NC_OS_QNX && defined(_POSIX_VERSION) || NC_OS_GNULINUX || NC_OS_MAC
+#define NC_HAS_POSIX_MEMALIGN 1
+#else
+#define NC_HAS_POSIX_MEMALIGN 0
+#endif
+#endif
+
+
+NS_INTERNAL_BEGIN
+
+NC_DEVICE_FUNC
+inline void throw_std_bad_alloc()
+{
+#ifdef NC_EXCEPTIONS
+    throw std::bad_alloc();
+#else
+    std::size_t huge = static_cast<std::size_t>(-1);
+    ::operator new(huge);
+#endif
+}
+
+/*****************************************************************************
+*** Implementation of handmade aligned functions                           ***
+*****************************************************************************/
+
+/** \internal Like malloc, but the returned pointer is guaranteed to be \a alignment-byte aligned.
+  * Fast, but wastes \a alignment additional bytes of memory. Does not throw any exception.
+  *
+  * The offset to the block returned by std::malloc is stored in the byte right before the
+  * aligned pointer, which is why \a alignment must be a power of two in [1, 256].
+  */
+inline void* handmade_aligned_malloc(std::size_t size, std::size_t alignment = NC_DEFAULT_ALIGN_BYTES)
+{
+    nc_assert(alignment >= sizeof(void*) && (alignment & (alignment-1)) == 0 && "Alignment must be at least sizeof(void*) and a power of 2");
+    nc_assert(alignment <= 256 && "Alignment must fit in the offset byte");
+
+    void *original = std::malloc(size+alignment);
+    if (original == 0) return 0;
+    void *aligned = reinterpret_cast<void*>((reinterpret_cast<std::size_t>(original) & ~(std::size_t(alignment-1))) + alignment);
+    *(reinterpret_cast<unsigned char*>(aligned) - 1) = static_cast<unsigned char>(reinterpret_cast<std::size_t>(aligned) - reinterpret_cast<std::size_t>(original) - 1);
+    return aligned;
+}
+
+/** \internal Frees memory allocated with handmade_aligned_malloc */
+inline void handmade_aligned_free(void *ptr)
+{
+    if (ptr)
+    {
+        std::size_t offset = std::size_t(*(reinterpret_cast<unsigned char*>(ptr) - 1)) + 1;
+        std::free(reinterpret_cast<unsigned char*>(ptr) - offset);
+    }
+}
+
+/** \internal
+  * \brief Reallocates aligned memory.
+  * Since we know that our handmade version is based on std::malloc
+  * we can use std::realloc to implement efficient reallocation.
+  */
+inline void* handmade_aligned_realloc(void* ptr, std::size_t size, std::size_t old_size, std::size_t alignment = NC_DEFAULT_ALIGN_BYTES)
+{
+    if (ptr == 0) return handmade_aligned_malloc(size, alignment);
+    std::size_t old_offset = std::size_t(*(reinterpret_cast<unsigned char*>(ptr) - 1)) + 1;
+    void *original = reinterpret_cast<unsigned char*>(ptr) - old_offset;
+    original = std::realloc(original, size+alignment);
+    if (original == 0) return 0;
+    void *aligned = reinterpret_cast<void*>((reinterpret_cast<std::size_t>(original) & ~(std::size_t(alignment-1))) + alignment);
+    std::size_t new_offset = reinterpret_cast<std::size_t>(aligned) - reinterpret_cast<std::size_t>(original);
+    // the payload moves with the block start, realign it if the offset changed
+    if (new_offset != old_offset)
+        std::memmove(aligned, reinterpret_cast<unsigned char*>(original) + old_offset, (std::min)(size, old_size));
+    *(reinterpret_cast<unsigned char*>(aligned) - 1) = static_cast<unsigned char>(new_offset - 1);
+    return aligned;
+}
+
+/*****************************************************************************
+*** Implementation of portable aligned versions of malloc/free/realloc     ***
+*****************************************************************************/
+
+#ifdef NC_NO_MALLOC
+NC_DEVICE_FUNC inline void check_that_malloc_is_allowed()
+{
+    nc_assert(false && "heap allocation is forbidden (NC_NO_MALLOC is defined)");
+}
+#elif defined NC_RUNTIME_NO_MALLOC
+NC_DEVICE_FUNC inline bool is_malloc_allowed_impl(bool update, bool new_value = false)
+{
+    static bool value = true;
+    if (update == 1)
+        value = new_value;
+    return value;
+}
+NC_DEVICE_FUNC inline bool is_malloc_allowed() { return is_malloc_allowed_impl(false); }
+NC_DEVICE_FUNC inline bool set_is_malloc_allowed(bool new_value) { return is_malloc_allowed_impl(true, new_value); }
+NC_DEVICE_FUNC inline void check_that_malloc_is_allowed()
+{
+    nc_assert(is_malloc_allowed() && "heap allocation is forbidden (NC_RUNTIME_NO_MALLOC is defined and g_is_malloc_allowed is false)");
+}
+#else
+NC_DEVICE_FUNC inline void check_that_malloc_is_allowed()
+{}
+#endif
+
+/** \internal Allocates \a size bytes. The returned pointer is guaranteed to have NC_MAX_ALIGN_BYTES alignment.
+  * On allocation error, the returned pointer is null, and std::bad_alloc is thrown.
+  */
+NC_DEVICE_FUNC inline void* aligned_malloc(std::size_t size)
+{
+    check_that_malloc_is_allowed();
+
+    void *result;
+#if NC_MAX_ALIGN_BYTES==0
+    result = std::malloc(size);
+#elif NC_MALLOC_ALREADY_ALIGNED
+    result = std::malloc(size);
+#elif NC_HAS_POSIX_MEMALIGN
+    if(posix_memalign(&result, NC_DEFAULT_ALIGN_BYTES, size)) result = 0;
+#elif NC_OS_WIN_STRICT
+    result = _aligned_malloc(size, NC_DEFAULT_ALIGN_BYTES);
+#else
+    result = handmade_aligned_malloc(size);
+#endif
+
+    if(!result && size)
+        throw_std_bad_alloc();
+
+    return result;
+}
+
+/** \internal Frees memory allocated with aligned_malloc. */
+NC_DEVICE_FUNC inline void aligned_free(void *ptr)
+{
+#if NC_MAX_ALIGN_BYTES==0
+    std::free(ptr);
+#elif NC_MALLOC_ALREADY_ALIGNED
+    std::free(ptr);
+#elif NC_HAS_POSIX_MEMALIGN
+    std::free(ptr);
+#elif NC_OS_WIN_STRICT
+    _aligned_free(ptr);
+#else
+    handmade_aligned_free(ptr);
+#endif
+}
+
+/**
+  * \internal
+  * \brief Reallocates an aligned block of memory.
+  * \throws std::bad_alloc on allocation failure
+  */
+inline void* aligned_realloc(void *ptr, std::size_t new_size, std::size_t old_size)
+{
+    NC_UNUSED_VARIABLE(old_size);
+
+    void *result;
+#if NC_MAX_ALIGN_BYTES==0 || NC_MALLOC_ALREADY_ALIGNED
+    result = std::realloc(ptr,new_size);
+#elif NC_HAS_POSIX_MEMALIGN
+    // posix_memalign has no realloc counterpart, copy by hand
+    result = aligned_malloc(new_size);
+    if (ptr)
+    {
+        std::memcpy(result, ptr, (std::min)(new_size, old_size));
+        aligned_free(ptr);
+    }
+#elif NC_OS_WIN_STRICT
+    result = _aligned_realloc(ptr,new_size,NC_DEFAULT_ALIGN_BYTES);
+#else
+    result = handmade_aligned_realloc(ptr,new_size,old_size);
+#endif
+
+    if (!result && new_size)
+        throw_std_bad_alloc();
+
+    return result;
+}
+
+/*****************************************************************************
+*** Implementation of conditionally aligned functions                      ***
+*****************************************************************************/
+
+/** \internal Allocates \a size bytes. If Align is true, then the returned ptr is NC_MAX_ALIGN_BYTES-aligned.
+  * On allocation error, the returned pointer is null, and a std::bad_alloc is thrown.
+  */
+template<bool Align> NC_DEVICE_FUNC inline void* conditional_aligned_malloc(std::size_t size)
+{
+    return aligned_malloc(size);
+}
+
+template<> NC_DEVICE_FUNC inline void* conditional_aligned_malloc<false>(std::size_t size)
+{
+    check_that_malloc_is_allowed();
+
+    void *result = std::malloc(size);
+    if(!result && size)
+        throw_std_bad_alloc();
+    return result;
+}
+
+/** \internal Frees memory allocated with conditional_aligned_malloc */
+template<bool Align> NC_DEVICE_FUNC inline void conditional_aligned_free(void *ptr)
+{
+    aligned_free(ptr);
+}
+
+template<> NC_DEVICE_FUNC inline void conditional_aligned_free<false>(void *ptr)
+{
+    std::free(ptr);
+}
+
+/*****************************************************************************
+*** Construction/destruction of array elements                             ***
+*****************************************************************************/
+
+/** \internal Destructs the elements of an array.
+  * The \a size parameters tells on how many objects to call the destructor of T.
+  */
+template<typename T> NC_DEVICE_FUNC inline void destruct_elements_of_array(T *ptr, std::size_t size)
+{
+    // always destruct an array starting from the end.
+    if(ptr)
+        while(size) ptr[--size].~T();
+}
+
+/** \internal Constructs the elements of an array.
+  * The \a size parameter tells on how many objects to call the constructor of T.
+  */
+template<typename T> NC_DEVICE_FUNC inline T* construct_elements_of_array(T *ptr, std::size_t size)
+{
+    std::size_t i;
+    NC_TRY
+    {
+        for (i = 0; i < size; ++i) ::new (ptr + i) T;
+        return ptr;
+    }
+    NC_CATCH(...)
+    {
+        destruct_elements_of_array(ptr, i);
+        NC_THROW;
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+*** Implementation of aligned new/delete-like functions                    ***
+*****************************************************************************/
+
+template<typename T>
+NC_DEVICE_FUNC NC_ALWAYS_INLINE void check_size_for_overflow(std::size_t size)
+{
+    if(size > std::size_t(-1) / sizeof(T))
+        throw_std_bad_alloc();
+}
+
+/** \internal Allocates \a size objects of type T. The returned pointer is guaranteed to have NC_MAX_ALIGN_BYTES alignment.
+  * On allocation error, the returned pointer is undefined, but a std::bad_alloc is thrown.
+  * The default constructor of T is called.
+  */
+template<typename T> NC_DEVICE_FUNC inline T* aligned_new(std::size_t size)
+{
+    check_size_for_overflow<T>(size);
+    T *result = reinterpret_cast<T*>(aligned_malloc(sizeof(T)*size));
+    NC_TRY
+    {
+        return construct_elements_of_array(result, size);
+    }
+    NC_CATCH(...)
+    {
+        aligned_free(result);
+        NC_THROW;
+    }
+    return result;
+}
+
+/** \internal Deletes objects constructed with aligned_new
+  * The \a size parameters tells on how many objects to call the destructor of T.
+  */
+template<typename T> NC_DEVICE_FUNC inline void aligned_delete(T *ptr, std::size_t size)
+{
+    destruct_elements_of_array<T>(ptr, size);
+    aligned_free(ptr);
+}
+
+/** \internal Same as aligned_new, but the elements are only constructed (and later destructed) when
+  * NumTraits<T>::RequireInitialization is set. Plain arithmetic scalars are left uninitialized,
+  * which avoids touching every page of a freshly allocated buffer twice.
+  */
+template<typename T, bool Align> NC_DEVICE_FUNC inline T* conditional_aligned_new_auto(std::size_t size)
+{
+    if(size==0)
+        return 0; // short-cut. Also fixes Bug 884
+    check_size_for_overflow<T>(size);
+    T *result = reinterpret_cast<T*>(conditional_aligned_malloc<Align>(sizeof(T)*size));
+    if(NumTraits<T>::RequireInitialization)
+    {
+        NC_TRY
+        {
+            construct_elements_of_array(result, size);
+        }
+        NC_CATCH(...)
+        {
+            conditional_aligned_free<Align>(result);
+            NC_THROW;
+        }
+    }
+    return result;
+}
+
+template<typename T, bool Align> NC_DEVICE_FUNC inline void conditional_aligned_delete_auto(T *ptr, std::size_t size)
+{
+    if(NumTraits<T>::RequireInitialization)
+        destruct_elements_of_array<T>(ptr, size);
+    conditional_aligned_free<Align>(ptr);
+}
+
+/*****************************************************************************
+*** Alignment queries                                                      ***
+*****************************************************************************/
+
+/** \internal Returns true if \a ptr is aligned on an \a Alignment-byte boundary. */
+template<int Alignment>
+NC_DEVICE_FUNC NC_STRONG_INLINE bool is_aligned(const void* ptr)
+{
+    return Alignment <= 1 || (reinterpret_cast<UIntPtr>(ptr) & (Alignment-1)) == 0;
+}
+
+/** \internal Returns the index of the first element of the array that is well aligned with respect to the requested \a Alignment.
+  *
+  * \tparam Alignment requested alignment in Bytes.
+  * \param array the address of the start of the array
+  * \param size the size of the array
+  *
+  * \note If no element of the array is well aligned or the requested alignment is not a multiple of a scalar,
+  * the size of the array is returned. For example with SSE, the requested alignment is typically 16-bytes. If
+  * packet size for the given scalar type is 1, then everything is considered well-aligned.
+  */
+template<int Alignment, typename Scalar>
+NC_DEVICE_FUNC inline Index first_aligned(const Scalar* array, Index size)
+{
+    const Index ScalarSize = sizeof(Scalar);
+    const Index AlignmentSize = Alignment / ScalarSize;
+    const Index AlignmentMask = AlignmentSize-1;
+
+    if(AlignmentSize<=1)
+    {
+        // Either the requested alignment if smaller than a scalar, or it exactly match a 1 scalar
+        // so that all elements of the array have the same alignment.
+        return 0;
+    }
+    else if( (UIntPtr(array) & (sizeof(Scalar)-1)) || (Alignment%ScalarSize)!=0)
+    {
+        // The array is not aligned to the size of a single scalar, or the requested alignment is not a multiple of the scalar size.
+        // Consequently, no element of the array is well aligned.
+        return size;
+    }
+    else
+    {
+        Index first = (AlignmentSize - (Index((UIntPtr(array)/sizeof(Scalar))) & AlignmentMask)) & AlignmentMask;
+        return (first < size) ? first : size;
+    }
+}
+
+/** \internal \returns the smallest integer multiple of \a base and greater or equal to \a size
+  */
+template<typename Index>
+inline Index first_multiple(Index size, Index base)
+{
+    return ((size+base-1)/base)*base;
+}
+
+/** \internal Copies the range [\a start, \a end) to \a target, using memcpy for types that do not
+  * require initialization and element-wise assignment otherwise.
+  */
+template<typename T, bool UseMemcpy = !NumTraits<T>::RequireInitialization> struct smart_copy_helper;
+
+template<typename T> NC_DEVICE_FUNC void smart_copy(const T* start, const T* end, T* target)
+{
+    smart_copy_helper<T,!NumTraits<T>::RequireInitialization>::run(start, end, target);
+}
+
+template<typename T> struct smart_copy_helper<T,true> {
+    NC_DEVICE_FUNC static inline void run(const T* start, const T* end, T* target)
+    {
+        IntPtr size = IntPtr(end)-IntPtr(start);
+        if(size==0) return;
+        nc_internal_assert(start!=0 && end!=0 && target!=0);
+        std::memcpy(target, start, size);
+    }
+};
+
+template<typename T> struct smart_copy_helper<T,false> {
+    NC_DEVICE_FUNC static inline void run(const T* start, const T* end, T* target)
+    { std::copy(start, end, target); }
+};
+
+/*****************************************************************************
+*** Scratch memory of the evaluations                                      ***
+*****************************************************************************/
+
+// the size of the first chunk of a scratch_arena, the following ones doubling
+#ifndef NC_SCRATCH_CHUNK_BYTES
+#define NC_SCRATCH_CHUNK_BYTES (64 * 1024)
+#endif
+
+/** \internal
+  * \class scratch_arena
+  *
+  * \brief Per-thread bump allocator of the temporaries of the evaluations
+  *
+  * Allocating is moving a pointer forward in the current chunk, and releasing is moving it back to a marker
+  * taken before, in LIFO order: see scratch_buffer. A chunk too small for a request is followed by a new one,
+  * twice as large. Each allocation is aligned on a cache line.
+  *
+  * Once the arena is rewound to empty, its chunks are freed, unless a ScratchScope is alive on the thread:
+  * they are then kept, and serve the following evaluations without any heap allocation.
+  */
+class scratch_arena : noncopyable
+{
+    struct chunk
+    {
+        chunk* next;
+        char* data;
+        std::size_t capacity;
+    };
+
+public:
+    enum { Alignment = 64 };
+
+    struct marker
+    {
+        chunk* current;
+        std::size_t used;
+    };
+
+    /** \returns the arena of the calling thread */
+    static scratch_arena& local()
+    {
+        static thread_local scratch_arena arena;
+        return arena;
+    }
+
+    ~scratch_arena() { free_chunks(); }
+
+    /** \returns \a size bytes aligned on Alignment, valid until the arena is released to a marker taken before */
+    void* allocate(std::size_t size)
+    {
+        if(size == 0) return 0;
+        size = first_multiple<std::size_t>(size, Alignment);
+        if(!_current || _used + size > _current->capacity)
+        {
+            chunk* next = _current ? _current->next : 0;
+            if(!next || next->capacity < size)
+                next = new_chunk(size, next);
+            _current = next;
+            _used = 0;
+        }
+        void* result = _current->data + _used;
+        _used += size;
+        return result;
+    }
+
+    /** \returns the current position of the arena, null when it is empty */
+    marker mark() const
+    {
+        marker m = { empty() ? 0 : _current, empty() ? 0 : _used };
+        return m;
+    }
+
+    /** Frees everything allocated since \a m was taken */
+    void release(const marker& m)
+    {
+        rewind(m);
+        if(empty() && _scopes == 0)
+            free_chunks();
+    }
+
+    /** Makes sure the next \a size bytes are allocated without touching the heap */
+    void reserve(std::size_t size)
+    {
+        const marker m = mark();
+        allocate(size);
+        rewind(m);
+    }
+
+    /** \returns the number of bytes held by the arena */
+    std::size_t capacity() const
+    {
+        std::size_t total = 0;
+        for(chunk* c = _first; c; c = c->next)
+            total += c->capacity;
+        return total;
+    }
+
+    void enter_scope() { ++_scopes; }
+
+    void leave_scope(const marker& m)
+    {
+        --_scopes;
+        release(m);
+    }
+
+private:
+    scratch_arena() : _first(0), _current(0), _used(0), _scopes(0) {}
+
+    bool empty() const { return _current == _first && _used == 0; }
+
+    void rewind(const marker& m)
+    {
+        _current = m.current ? m.current : _first;
+        _used = m.current ? m.used : 0;
+    }
+
+    /** \internal Inserts after the current chunk a new one of at least \a size bytes, followed by \a next */
+    chunk* new_chunk(std::size_t size, chunk* next)
+    {
+        std::size_t capacity = numext::maxi(size, std::size_t(NC_SCRATCH_CHUNK_BYTES));
+        if(_current)
+            capacity = numext::maxi(capacity, 2 * _current->capacity);
+        void* raw = aligned_malloc(sizeof(chunk) + capacity + Alignment);
+        chunk* c = static_cast<chunk*>(raw);
+        c->next = next;
+        c->data = reinterpret_cast<char*>(first_multiple<UIntPtr>(UIntPtr(c + 1), Alignment));
+        c->capacity = capacity;
+        if(_current) _current->next = c;
+        else _first = c;
+        return c;
+    }
+
+    void free_chunks()
+    {
+        while(_first)
+        {
+            chunk* next = _first->next;
+            aligned_free(_first);
+            _first = next;
+        }
+        _current = 0;
+        _used = 0;
+    }
+
+    chunk* _first;
+    chunk* _current;
+    std::size_t _used;
+    int _scopes;
+};
+
+/** \internal
+  * \class scratch_buffer
+  *
+  * \brief Buffer of \a T taken from the scratch_arena of the calling thread, and given back when it is destructed
+  *
+  * A scratch_buffer is a local variable or a member of one, so that the buffers are released in the reverse
+  * order of their constructions. It marks the arena when it is constructed: the memory allocated later, by
+  * allocate() or by any other scratch_buffer, is released with it.
+  */
+template<typename T>
+class scratch_buffer : noncopyable
+{
+public:
+    explicit scratch_buffer(std::size_t size = 0)
+    : _arena(scratch_arena::local()), _mark(_arena.mark()), _data(0), _size(0)
+    {
+        allocate(size);
+    }
+
+    ~scratch_buffer()
+    {
+        if(NumTraits<T>::RequireInitialization)
+            destruct_elements_of_array<T>(_data, _size);
+        _arena.release(_mark);
+    }
+
+    /** Allocates the \a size elements of the buffer, if it was constructed empty */
+    T* allocate(std::size_t size)
+    {
+        nc_internal_assert(_size == 0);
+        if(size == 0) return _data;
+        check_size_for_overflow<T>(size);
+        _data = static_cast<T*>(_arena.allocate(size * sizeof(T)));
+        if(NumTraits<T>::RequireInitialization)
+            construct_elements_of_array(_data, size);
+        _size = size;
+        return _data;
+    }
+
+    T* data() const { return _data; }
+
+    std::size_t size() const { return _size; }
+
+private:
+    scratch_arena& _arena;
+    const scratch_arena::marker _mark;
+    T* _data;
+    std::size_t _size;
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \class ScratchScope
+  * \ingroup Core_Module
+  *
+  * \brief Keeps the scratch memory of the evaluations of the calling thread from one evaluation to the next
+  *
+  * The temporaries of an evaluation, e.g. an operand of a product which is an expression, or the source of an
+  * assignment reading its destination through another layout, are taken from a per-thread arena and given back
+  * once the evaluation is done. Out of any ScratchScope the arena is then freed, each evaluation allocating
+  * its temporaries again. In a ScratchScope it is kept, so that repeating the same evaluations no longer
+  * touches the heap:
+  * \code
+  * ScratchScope scratch(1 << 20);               // optional: reserves 1MB upfront
+  * for(const Request& r : requests)
+  *     out = matmul(r.x * scale, w) + bias;    // the evaluation of r.x * scale reuses the same memory
+  * \endcode
+  *
+  * Scopes nest, the arena is kept until the outermost one is destructed. A ScratchScope only applies to the
+  * thread it was constructed on, and must be destructed on it.
+  */
+class ScratchScope : internal::noncopyable
+{
+public:
+    /** Opens a scope, in which the next \a reserve bytes of scratch memory are allocated upfront */
+    explicit ScratchScope(std::size_t reserve = 0) : _arena(internal::scratch_arena::local()), _mark(_arena.mark())
+    {
+        _arena.enter_scope();
+        if(reserve) _arena.reserve(reserve);
+    }
+
+    ~ScratchScope() { _arena.leave_scope(_mark); }
+
+    /** \returns the number of bytes of scratch memory held by the calling thread */
+    static std::size_t capacity() { return internal::scratch_arena::local().capacity(); }
+
+private:
+    internal::scratch_arena& _arena;
+    const internal::scratch_arena::marker _mark;
+};
+
+NS_END
+
+
+#endif
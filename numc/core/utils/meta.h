@@ -543,6 +543,34 @@ NS_BEGIN
             return (a+b-1) / b;
         }
 
+        template<typename T>
+        NC_DEVICE_FUNC NC_ALWAYS_INLINE T mini(const T& x, const T& y)
+        {
+            return y < x ? y : x;
+        }
+
+        template<typename T>
+        NC_DEVICE_FUNC NC_ALWAYS_INLINE T maxi(const T& x, const T& y)
+        {
+            return x < y ? y : x;
+        }
+
+// a * b + c, rounded once when the packets go through a fused multiply-add, see pmadd, so that the coefficients
+// computed one at a time round as the vectorized ones
+        template<typename T>
+        NC_DEVICE_FUNC NC_STRONG_INLINE T fma(const T& a, const T& b, const T& c)
+        {
+            return a * b + c;
+        }
+
+#if defined(NC_VECTORIZE_FMA) && !defined(NC_CUDA_ARCH)
+        template<> NC_STRONG_INLINE
+        float fma(const float& a, const float& b, const float& c) { return std::fma(a, b, c); }
+
+        template<> NC_STRONG_INLINE
+        double fma(const double& a, const double& b, const double& c) { return std::fma(a, b, c); }
+#endif
+
 // The aim of the following functions is to bypass -Wfloat-equal warnings
 // when we really want a strict equality comparison on floating points.
         template<typename X, typename Y> NC_STRONG_INLINE
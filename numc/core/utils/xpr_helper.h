@@ -24,6 +24,165 @@
 #endif
 
 
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \brief Cost and vectorization capabilities of a functor
+  *
+  * \li \c Cost is a rough estimate of the number of cycles needed to apply the functor to one coefficient,
+  *     in the same unit as NumTraits<T>::ReadCost, AddCost and MulCost,
+  * \li \c PacketAccess tells whether the functor provides a packetOp() for packet_traits<Scalar>::type.
+  */
+template<typename T> struct functor_traits
+{
+    enum
+    {
+        Cost = 10,
+        PacketAccess = false
+    };
+};
+
+/** \internal
+  * \brief Finds the widest packet type of \a T dividing \a Size, going down the half packets
+  *
+  * A fixed size of 8 floats is then processed with one AVX packet on an AVX512 target rather than with
+  * scalars. When no packet divides \a Size the smallest packet is returned and the tail is done with scalars.
+  */
+template<int Size, typename PacketType,
+         bool Stop = Size==Dynamic || (Size%unpacket_traits<PacketType>::size)==0
+                  || is_same<PacketType,typename unpacket_traits<PacketType>::half>::value>
+struct find_best_packet_helper;
+
+template<int Size, typename PacketType>
+struct find_best_packet_helper<Size, PacketType, true>
+{
+    typedef PacketType type;
+};
+
+template<int Size, typename PacketType>
+struct find_best_packet_helper<Size, PacketType, false>
+{
+    typedef typename find_best_packet_helper<Size, typename unpacket_traits<PacketType>::half>::type type;
+};
+
+template<typename T, int Size>
+struct find_best_packet
+{
+    typedef typename find_best_packet_helper<Size, typename packet_traits<T>::type>::type type;
+};
+
+/** \internal \returns in \c type the plain Array type able to store the evaluation of the expression \a T */
+template<typename T> struct plain_array_type
+{
+    typedef Array<typename traits<T>::Scalar> type;
+};
+
+/** \internal
+  * \brief Determines how a sub-expression \a T is nested in an expression reading each of its coefficients \a n times
+  *
+  * \c type is either the plain object \a PlainObject, meaning that \a T is evaluated once into a temporary before
+  * the enclosing expression is evaluated, or a reference to \a T, meaning that its coefficients are computed
+  * on the fly every time they are read.
+  *
+  * The temporary is chosen when its cost, i.e. evaluating each coefficient once, writing it and reading it
+  * back \a n times, is lower than computing the coefficient \a n times:
+  * \code (n+1) * ReadCost + CoeffReadCost < n * CoeffReadCost \endcode
+  * so a plain array or a cheap expression is never copied, while an expensive operand (complex products,
+  * transcendental functions) read several times is evaluated first. \a n may be Dynamic when the number
+  * of reads is only known at run-time, which is treated as a large number of reads: this is how the broadcast
+  * operands of a coefficient-wise node are nested, see broadcast_operand.
+  */
+template<typename T, int n, typename PlainObject = typename plain_array_type<T>::type> struct nested_eval
+{
+    enum {
+        ScalarReadCost = NumTraits<typename traits<T>::Scalar>::ReadCost,
+        CoeffReadCost = evaluator<T>::CoeffReadCost,
+        NAsInteger = n == Dynamic ? HugeCost : n,
+        CostEval   = (NAsInteger+1) * ScalarReadCost + CoeffReadCost,
+        CostNoEval = NAsInteger * CoeffReadCost,
+        Evaluate = int(CostEval) < int(CostNoEval)
+    };
+
+    typedef typename conditional<Evaluate, PlainObject, const T&>::type type;
+};
+
+/** \internal
+  * \brief Selects how an expression of type \a T is stored by the expressions using it as an operand: by
+  * reference when it has the NestByRefBit, i.e. for the arrays owning their coefficients, and by value otherwise
+  */
+template<typename T> struct ref_selector
+{
+    typedef typename conditional<bool(traits<T>::Flags & NestByRefBit), T const&, const T>::type type;
+};
+
+/** \internal
+  * \brief How an expression of type \a T is stored by the expressions using it as an operand, see ref_selector
+  *
+  * A node only refers to the arrays at the leaves of its tree, the nodes and views below it being copied into
+  * it. An expression can thus be stored, e.g. with auto or in a struct, and evaluated again as long as these
+  * arrays are alive, whatever the temporaries it was built from:
+  * \code
+  * auto op = a + b;                  // holds references to a and b
+  * auto op2 = (op * 0.5f + c).exp(); // holds copies of op and of the intermediate nodes
+  * \endcode
+  */
+template<typename T> struct nested
+{
+    typedef typename ref_selector<T>::type type;
+};
+
+/** \internal \returns in \c value whether the expression \a Xpr is a coefficient-wise product of \a Scalar's, which a
+  * sum fuses into a multiply-add */
+template<typename Xpr, typename Scalar> struct is_fusable_product
+{
+    enum { value = false };
+};
+
+template<typename Scalar, typename Lhs, typename Rhs>
+struct is_fusable_product<CwiseBinaryOp<scalar_product_op<Scalar, Scalar>, Lhs, Rhs>, Scalar>
+{
+    enum { value = true };
+};
+
+/** \internal
+  * \brief Expression of the sum of \a Lhs and \a Rhs, built by make()
+  *
+  * When a side is a coefficient-wise product of the scalar type of the other one, e.g. a * b + c, x * 0.5f + bias
+  * or a step c + x * p of a Horner scheme, the sum is a CwiseTernaryOp of scalar_muladd_op taking the factors and
+  * the addend, a single fused multiply-add on NC_VECTORIZE_FMA targets. The left product is fused when both sides
+  * are. Any other sum is a CwiseBinaryOp of scalar_sum_op.
+  */
+template<typename Lhs, typename Rhs,
+         int Fuse = is_fusable_product<Lhs, typename traits<Rhs>::Scalar>::value ? 1
+                  : is_fusable_product<Rhs, typename traits<Lhs>::Scalar>::value ? 2 : 0>
+struct cwise_sum_return_type
+{
+    typedef CwiseBinaryOp<scalar_sum_op<typename traits<Lhs>::Scalar, typename traits<Rhs>::Scalar>, Lhs, Rhs> type;
+
+    static NC_STRONG_INLINE type make(const Lhs& lhs, const Rhs& rhs) { return type(lhs, rhs); }
+};
+
+template<typename Scalar, typename A, typename B, typename Rhs>
+struct cwise_sum_return_type<CwiseBinaryOp<scalar_product_op<Scalar, Scalar>, A, B>, Rhs, 1>
+{
+    typedef CwiseTernaryOp<scalar_muladd_op<Scalar>, A, B, Rhs> type;
+
+    static NC_STRONG_INLINE type make(const CwiseBinaryOp<scalar_product_op<Scalar, Scalar>, A, B>& lhs, const Rhs& rhs)
+    { return type(lhs.lhs(), lhs.rhs(), rhs); }
+};
+
+template<typename Lhs, typename Scalar, typename A, typename B>
+struct cwise_sum_return_type<Lhs, CwiseBinaryOp<scalar_product_op<Scalar, Scalar>, A, B>, 2>
+{
+    typedef CwiseTernaryOp<scalar_muladd_op<Scalar>, A, B, Lhs> type;
+
+    static NC_STRONG_INLINE type make(const Lhs& lhs, const CwiseBinaryOp<scalar_product_op<Scalar, Scalar>, A, B>& rhs)
+    { return type(rhs.lhs(), rhs.rhs(), lhs); }
+};
+
+NS_INTERNAL_END
+
+
 NS_BEGIN
 
 /** \class ScalarBinaryOpTraits
@@ -64,8 +223,7 @@ NS_BEGIN
   */
 
 
-//template<typename ScalarA, typename ScalarB, typename BinaryOp=internal::scalar_product_op<ScalarA,ScalarB> >
-template<typename ScalarA, typename ScalarB, typename BinaryOp >
+template<typename ScalarA, typename ScalarB, typename BinaryOp=internal::scalar_product_op<ScalarA,ScalarB> >
 struct ScalarBinaryOpTraits
 #ifndef NC_PARSED_BY_DOXYGEN
     // for backward compatibility, use the hints given by the (deprecated) internal::scalar_product_traits class.
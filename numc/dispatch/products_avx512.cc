@@ -0,0 +1,32 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+// Products compiled for the AVX-512 of Skylake-X (F, CD, BW, DQ and VL), run on the cpus which support them (Skylake-X, Ice Lake, Zen 4...) when numc
+// is built with NC_RUNTIME_DISPATCH, see products/product_dispatch.h. numc.cmake sets the compiler flags of
+// this file. The kernels are registered for the level the file is actually compiled for.
+
+#include "numc.h"
+
+#ifdef NC_RUNTIME_DISPATCH
+
+NS_INTERNAL_BEGIN
+
+namespace {
+
+NC_UNUSED const bool products_registered =
+    register_product_kernels<float>(&general_matrix_matrix_product<float>::run_block,
+                                    &general_matrix_vector_product<float>::run_block)
+    && register_product_kernels<double>(&general_matrix_matrix_product<double>::run_block,
+                                        &general_matrix_vector_product<double>::run_block);
+
+}
+
+NS_INTERNAL_END
+
+#endif
@@ -0,0 +1,238 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_DLPACK_TENSOR_H__
+#define __NC_DLPACK_TENSOR_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal Reports a DLPack tensor which cannot be imported */
+inline void throw_dlpack_error(const char* what)
+{
+    NC_THROW_X(std::runtime_error(std::string("numc: DLPack tensor: ") + what));
+}
+
+/** \internal \returns the DLDataType of \a Scalar. A bool is exchanged as an 8 bits unsigned integer, which
+  * every version of DLPack knows. */
+template<typename Scalar>
+inline DLDataType dlpack_dtype()
+{
+    DLDataType dtype;
+    dtype.code = static_cast<uint8_t>(NumTraits<Scalar>::IsComplex ? kDLComplex
+                                    : !NumTraits<Scalar>::IsInteger ? kDLFloat
+                                    : NumTraits<Scalar>::IsSigned && !internal::is_same<Scalar, bool>::value ? kDLInt
+                                    : kDLUInt);
+    dtype.bits = static_cast<uint8_t>(sizeof(Scalar) * 8);
+    dtype.lanes = 1;
+    return dtype;
+}
+
+/** \internal
+  * \brief The DLManagedTensor handed out by to_dlpack(), together with what it refers to
+  *
+  * The shape and the strides of the tensor point into the context itself, which also holds the Array whose
+  * buffer the tensor exports, if any. The deleter of the tensor deletes the whole context.
+  */
+template<typename Scalar>
+struct dlpack_export
+{
+    DLManagedTensor managed;
+    Array<Scalar> owned;
+    int64_t shape[MAX_ARRAY_DIMENSIONS];
+    int64_t strides[MAX_ARRAY_DIMENSIONS];
+
+    static void release(DLManagedTensor* self)
+    {
+        delete static_cast<dlpack_export*>(self->manager_ctx);
+    }
+
+    /** \internal \returns a tensor over the coefficients of \a view, taking the buffer of \a owned when
+      * not null: it then lives as long as the tensor. */
+    static DLManagedTensor* create(const ArrayView<const Scalar>& view, Array<Scalar>* owned)
+    {
+        dlpack_export* context = new dlpack_export;
+        if(owned) context->owned.swap(*owned);
+        for(Index i=0; i<view.dims(); ++i)
+        {
+            context->shape[i] = static_cast<int64_t>(view.shape()[i]);
+            context->strides[i] = static_cast<int64_t>(view.strides()[i]);
+        }
+
+        DLTensor& tensor = context->managed.dl_tensor;
+        tensor.data = const_cast<Scalar*>(view.data());
+        tensor.device.device_type = kDLCPU;
+        tensor.device.device_id = 0;
+        tensor.ndim = static_cast<int32_t>(view.dims());
+        tensor.dtype = dlpack_dtype<Scalar>();
+        tensor.shape = context->shape;
+        tensor.strides = context->strides;
+        tensor.byte_offset = 0;
+        context->managed.manager_ctx = context;
+        context->managed.deleter = &release;
+        return &context->managed;
+    }
+};
+
+/** \internal \returns a view of the buffer of \a a, lent to a DLPack tensor. Only the expressions owning or
+  * referring to a buffer which outlives the call have an overload, so that no other type with direct access
+  * can lend the tensor a temporary. */
+template<typename Scalar>
+ArrayView<const Scalar> dlpack_buffer(const Array<Scalar>& a) { return a.view(); }
+
+template<typename Scalar>
+ArrayView<const Scalar> dlpack_buffer(const ArrayView<Scalar>& v) { return v; }
+
+template<typename Scalar, Index... Dims>
+ArrayView<const Scalar> dlpack_buffer(const FixedArray<Scalar, Dims...>& a) { return a.view(); }
+
+template<typename PlainObjectType, int MapOptions>
+ArrayView<const typename Map<PlainObjectType, MapOptions>::Scalar> dlpack_buffer(const Map<PlainObjectType, MapOptions>& m)
+{
+    return m.view();
+}
+
+/** \internal Exports an expression: arrays, views and maps lend their buffer, other expressions are evaluated
+  * into an Array owned by the tensor. */
+template<typename Derived, bool Direct = (int(traits<Derived>::Flags) & DirectAccessBit) != 0>
+struct dlpack_exporter
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    static DLManagedTensor* run(const Derived& xpr)
+    {
+        Array<Scalar> plain(xpr);
+        return dlpack_export<Scalar>::create(plain.view(), &plain);
+    }
+};
+
+template<typename Derived>
+struct dlpack_exporter<Derived, true>
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    static DLManagedTensor* run(const Derived& xpr)
+    {
+        return dlpack_export<Scalar>::create(dlpack_buffer(xpr), 0);
+    }
+};
+
+/** \internal Releases an imported DLManagedTensor when the Array adopting its buffer drops it */
+struct dlpack_deleter
+{
+    explicit dlpack_deleter(DLManagedTensor* managed) : managed(managed) {}
+
+    template<typename T> void operator()(T*) const
+    {
+        if(managed->deleter) managed->deleter(managed);
+    }
+
+    DLManagedTensor* managed;
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns a DLPack tensor over the coefficients of \a a, lent to the consumer without any copy.
+  *
+  * The shape and the strides of \a a, in coefficients as DLPack expects, and the DLDataType matching its
+  * scalar type describe the buffer of an Array, a FixedArray, an ArrayView or a Map, which must then outlive
+  * the tensor. Other expressions are evaluated into an Array owned by the tensor. Either way the consumer
+  * releases the tensor by calling its \c deleter:
+  * \code
+  * Array<float> x(32, 512);
+  * DLManagedTensor* t = to_dlpack(x.transpose());   // shape (512, 32), strides (1, 512), no copy
+  * other_runtime_consume(t);                        // calls t->deleter(t) when done
+  * \endcode
+  *
+  * \sa from_dlpack(), dlpack_view()
+  */
+template<typename Derived>
+DLManagedTensor* to_dlpack(const ArrayOp<Derived>& a)
+{
+    return internal::dlpack_exporter<Derived>::run(a.derived());
+}
+
+/** \returns a DLPack tensor owning the buffer of \a a, which is left empty. This is how to hand an Array
+  * over to a consumer which outlives it, still without copying its coefficients. */
+template<typename Scalar>
+DLManagedTensor* to_dlpack(Array<Scalar>&& a)
+{
+    Array<Scalar> owned(std::move(a));
+    return internal::dlpack_export<Scalar>::create(owned.view(), &owned);
+}
+
+/** \returns a view of the coefficients of the DLPack tensor \a tensor, which remains owned by its producer
+  * and must outlive the view.
+  *
+  * \tparam Scalar the type of the coefficients, which must match the DLDataType of \a tensor
+  *
+  * Any strides are viewed in place, null strides meaning a contiguous row-major tensor. A tensor which is
+  * not in host memory, or whose type is not \a Scalar, raises a std::runtime_error, or aborts when exceptions
+  * are disabled.
+  *
+  * \sa from_dlpack()
+  */
+template<typename Scalar>
+ArrayView<Scalar> dlpack_view(const DLTensor& tensor)
+{
+    if(tensor.device.device_type != kDLCPU)
+        internal::throw_dlpack_error("not in host memory");
+
+    // an 8 bits bool may also come as kDLBool, the code 6 of recent versions of DLPack
+    const DLDataType dtype = internal::dlpack_dtype<Scalar>();
+    const bool boolCode = internal::is_same<Scalar, bool>::value && tensor.dtype.code == 6;
+    if((tensor.dtype.code != dtype.code && !boolCode) || tensor.dtype.bits != dtype.bits || tensor.dtype.lanes != 1)
+        internal::throw_dlpack_error("the type of the coefficients does not match");
+    if(tensor.ndim < 0 || tensor.ndim > int32_t(MAX_ARRAY_DIMENSIONS))
+        internal::throw_dlpack_error("too many dimensions");
+
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    Index strides[MAX_ARRAY_DIMENSIONS];
+    Index stride = 1;
+    for(Index i=tensor.ndim-1; i>=0; --i)
+    {
+        extents[i] = static_cast<Index>(tensor.shape[i]);
+        strides[i] = tensor.strides ? static_cast<Index>(tensor.strides[i]) : stride;
+        stride *= extents[i];
+    }
+    Scalar* data = reinterpret_cast<Scalar*>(static_cast<char*>(tensor.data) + tensor.byte_offset);
+    return ArrayView<Scalar>(data, Shape(extents, tensor.ndim), Strides(strides, tensor.ndim));
+}
+
+/** \returns an Array taking the ownership of the DLPack tensor \a managed, whose deleter it calls when done.
+  *
+  * \tparam Scalar the type of the coefficients, which must match the DLDataType of \a managed
+  *
+  * Like Array::from_buffer(), the buffer of a contiguous row-major tensor aligned on NC_MAX_ALIGN_BYTES is
+  * adopted without any copy, and stays shared with the producer. Any other tensor is copied and released at
+  * once, so that writes through the Array no longer reach the producer: isExternal() on the result tells
+  * which way it went. Use dlpack_view() to share a tensor in place whatever its layout. A tensor which cannot
+  * be imported, see dlpack_view(), is left to the caller.
+  * \code
+  * DLManagedTensor* t = other_runtime_produce();
+  * Array<float> x = from_dlpack<float>(t);   // t is released with x
+  * if(!x.isExternal()) ...                   // t was copied, e.g. a strided slice
+  * \endcode
+  *
+  * \sa to_dlpack()
+  */
+template<typename Scalar>
+Array<Scalar> from_dlpack(DLManagedTensor* managed)
+{
+    nc_assert(managed != 0);
+    const ArrayView<Scalar> view = dlpack_view<Scalar>(managed->dl_tensor);
+    return Array<Scalar>::from_buffer(view.data(), view.shape(), view.strides(), internal::dlpack_deleter(managed));
+}
+
+NS_END
+
+#endif
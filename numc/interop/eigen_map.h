@@ -0,0 +1,164 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_EIGEN_MAP_H__
+#define __NC_EIGEN_MAP_H__
+
+NS_INTERNAL_BEGIN
+
+/** \internal
+  * \brief The Eigen::Map types over the coefficients of an ArrayView<ViewScalar>
+  *
+  * A matrix is mapped as a dynamic row-major Eigen::Matrix, whose outer stride is the stride of the rows
+  * and inner stride the stride of the columns, so that any view, e.g. a transposed one, maps as is. A
+  * vector is mapped as a dynamic column Eigen::Matrix with an inner stride. Read-only views map const
+  * matrices.
+  */
+template<typename ViewScalar>
+struct eigen_map_types
+{
+    typedef typename remove_const<ViewScalar>::type Scalar;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> PlainMatrix;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> PlainVector;
+    typedef typename conditional<is_const<ViewScalar>::value, const PlainMatrix, PlainMatrix>::type MatrixType;
+    typedef typename conditional<is_const<ViewScalar>::value, const PlainVector, PlainVector>::type VectorType;
+
+    typedef Eigen::Map<MatrixType, Eigen::Unaligned, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> > MatrixMap;
+    typedef Eigen::Map<VectorType, Eigen::Unaligned, Eigen::InnerStride<Eigen::Dynamic> > VectorMap;
+};
+
+/** \internal \returns the ArrayView over the coefficients of the Eigen object \a x, which has direct access */
+template<typename ViewScalar, typename Derived>
+ArrayView<ViewScalar> eigen_view(const Derived& x)
+{
+    NC_STATIC_ASSERT((int(Derived::Flags) & Eigen::DirectAccessBit) != 0,
+                     "Only the Eigen expressions with direct access, e.g. matrices, maps and blocks, can be viewed")
+    ViewScalar* data = const_cast<ViewScalar*>(x.data());
+    if(Derived::IsVectorAtCompileTime)
+    {
+        const Index extent = static_cast<Index>(x.size());
+        const Index stride = static_cast<Index>(x.innerStride());
+        return ArrayView<ViewScalar>(data, Shape(extent), Strides(&stride, 1));
+    }
+    const Index strides[2] = { static_cast<Index>(x.rowStride()), static_cast<Index>(x.colStride()) };
+    const Shape shape(static_cast<Index>(x.rows()), static_cast<Index>(x.cols()));
+    return ArrayView<ViewScalar>(data, shape, Strides(strides, 2));
+}
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns an Eigen::Map over the coefficients of the 1 or 2-dimension view \a v, without any copy.
+  *
+  * A matrix maps as a row-major Eigen matrix with the strides of \a v, a vector as a single column. The
+  * coefficients are shared, so writes through the map land in \a v, and \a v must outlive the map:
+  * \code
+  * Array<double> a(64, 64), b(64);
+  * auto lu = to_eigen(a).partialPivLu();          // Eigen's decompositions on numc data
+  * to_eigen_vector(b) = lu.solve(to_eigen_vector(b));
+  * auto at = to_eigen(a.transpose());             // strides translated, still no copy
+  * \endcode
+  *
+  * \sa to_eigen_vector(), from_eigen()
+  */
+template<typename _Scalar>
+typename internal::eigen_map_types<_Scalar>::MatrixMap to_eigen(const ArrayView<_Scalar>& v)
+{
+    typedef typename internal::eigen_map_types<_Scalar>::MatrixMap MatrixMap;
+    nc_assert((v.dims() == 1 || v.dims() == 2) && "to_eigen: only vectors and matrices map to Eigen");
+    const bool matrix = v.dims() == 2;
+    return MatrixMap(v.data(), v.shape()[0], matrix ? v.shape()[1] : 1,
+                     Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(v.strides()[0], matrix ? v.strides()[1] : 1));
+}
+
+/** \returns an Eigen::Map over the coefficients of \a a, an Array, a FixedArray or a Map,
+  * see to_eigen(const ArrayView&) */
+template<typename Derived>
+auto to_eigen(ArrayOp<Derived>& a) -> decltype(to_eigen(a.derived().view()))
+{
+    return to_eigen(a.derived().view());
+}
+
+template<typename Derived>
+auto to_eigen(const ArrayOp<Derived>& a) -> decltype(to_eigen(a.derived().view()))
+{
+    return to_eigen(a.derived().view());
+}
+
+/** \returns an Eigen::Map over the coefficients of the 1-dimension view \a v, as an Eigen column vector */
+template<typename _Scalar>
+typename internal::eigen_map_types<_Scalar>::VectorMap to_eigen_vector(const ArrayView<_Scalar>& v)
+{
+    typedef typename internal::eigen_map_types<_Scalar>::VectorMap VectorMap;
+    nc_assert(v.dims() == 1 && "to_eigen_vector: only a vector maps to an Eigen vector");
+    return VectorMap(v.data(), v.shape()[0], Eigen::InnerStride<Eigen::Dynamic>(v.strides()[0]));
+}
+
+template<typename Derived>
+auto to_eigen_vector(ArrayOp<Derived>& a) -> decltype(to_eigen_vector(a.derived().view()))
+{
+    return to_eigen_vector(a.derived().view());
+}
+
+template<typename Derived>
+auto to_eigen_vector(const ArrayOp<Derived>& a) -> decltype(to_eigen_vector(a.derived().view()))
+{
+    return to_eigen_vector(a.derived().view());
+}
+
+/** \returns an ArrayView over the coefficients of the Eigen object \a x, without any copy.
+  *
+  * \a x is any Eigen expression with direct access to its coefficients: a matrix or an array of any storage
+  * order, a map, a block of one of them... A vector is viewed as a 1-dimension array, anything else as a
+  * 2-dimension one of shape (rows, cols), with the strides of \a x. The view writes into \a x, unless \a x
+  * is read-only, and must not outlive it:
+  * \code
+  * Eigen::MatrixXf m(128, 64);                   // column-major
+  * ArrayView<float> v = from_eigen(m);           // shape (128, 64), strides (1, 128)
+  * Array<float> y = (v * 0.5f).tanh();
+  * from_eigen(m.col(0)) = y.slice({{}, {0, 1}}).squeeze(1);
+  * \endcode
+  *
+  * \sa to_eigen()
+  */
+template<typename Derived>
+ArrayView<typename internal::conditional<(int(Derived::Flags) & Eigen::LvalueBit) != 0,
+                                         typename Derived::Scalar, const typename Derived::Scalar>::type>
+from_eigen(Eigen::DenseBase<Derived>& x)
+{
+    typedef typename internal::conditional<(int(Derived::Flags) & Eigen::LvalueBit) != 0,
+                                           typename Derived::Scalar, const typename Derived::Scalar>::type ViewScalar;
+    return internal::eigen_view<ViewScalar>(x.derived());
+}
+
+/** \overload A temporary expression, such as \c m.col(0), is viewed as well, the object it refers to being
+  * the one which must outlive the view. A temporary matrix or array, which owns its coefficients, is rejected
+  * at compile-time: they would be destroyed before the view is used. */
+template<typename Derived>
+ArrayView<typename internal::conditional<(int(Derived::Flags) & Eigen::LvalueBit) != 0,
+                                         typename Derived::Scalar, const typename Derived::Scalar>::type>
+from_eigen(Eigen::DenseBase<Derived>&& x)
+{
+    NC_STATIC_ASSERT((!internal::is_same<typename Derived::PlainObject, Derived>::value),
+                     "from_eigen: a temporary Eigen matrix or array would be destroyed before its view is used")
+    return from_eigen(x);
+}
+
+template<typename Derived>
+ArrayView<const typename Derived::Scalar> from_eigen(const Eigen::DenseBase<Derived>& x)
+{
+    return internal::eigen_view<const typename Derived::Scalar>(x.derived());
+}
+
+NS_END
+
+#endif
@@ -0,0 +1,39 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_INTEROP_H__
+#define __NC_INTEROP_H__
+
+// DLPack tensors, exchanged with the other tensor runtimes of the process
+#ifdef NC_USE_DLPACK
+  // Header declaring DLManagedTensor, version 0.6 or later
+  #ifndef NC_DLPACK_HEADER
+  #define NC_DLPACK_HEADER <dlpack/dlpack.h>
+  #endif
+  #include <cstdint>
+  #include <stdexcept>
+  #include <string>
+  #include NC_DLPACK_HEADER
+  #include "dlpack_tensor.h"
+#endif
+
+// Eigen maps of numc arrays and numc views of Eigen objects
+#ifdef NC_USE_EIGEN
+  // Header of Eigen, unless it is already included
+  #ifndef NC_EIGEN_HEADER
+  #define NC_EIGEN_HEADER <Eigen/Core>
+  #endif
+  #ifndef EIGEN_WORLD_VERSION
+    #include NC_EIGEN_HEADER
+  #endif
+  #include "eigen_map.h"
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_IO_H__
+#define __NC_IO_H__
+
+// standard libaraies
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+// file mappings
+#if NC_OS_UNIX
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #define NC_HAS_MMAP 1
+#else
+  #define NC_HAS_MMAP 0
+#endif
+
+#include "npy.h"
+
+#endif
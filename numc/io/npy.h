@@ -0,0 +1,414 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_NPY_H__
+#define __NC_NPY_H__
+
+/** \internal Size of the blocks the coefficients of an .npy file are read and written by */
+#ifndef NC_NPY_IO_CHUNK_BYTES
+#define NC_NPY_IO_CHUNK_BYTES (64 * 1024 * 1024)
+#endif
+
+NS_INTERNAL_BEGIN
+
+/** \internal Reports an .npy file that cannot be read or written */
+inline void throw_npy_error(const std::string& path, const char* what)
+{
+    NC_THROW_X(std::runtime_error("numc: " + path + ": " + what));
+}
+
+inline bool npy_little_endian()
+{
+    const unsigned short one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+/** \internal \returns the numpy type string of \a Scalar in the native byte order, e.g. "<f4" for a float */
+template<typename Scalar>
+inline std::string npy_descr()
+{
+    const char kind = internal::is_same<Scalar, bool>::value ? 'b'
+                    : NumTraits<Scalar>::IsComplex ? 'c'
+                    : !NumTraits<Scalar>::IsInteger ? 'f'
+                    : NumTraits<Scalar>::IsSigned ? 'i' : 'u';
+    const char order = sizeof(Scalar) == 1 ? '|' : npy_little_endian() ? '<' : '>';
+    char descr[8];
+    std::snprintf(descr, sizeof(descr), "%c%c%d", order, kind, int(sizeof(Scalar)));
+    return descr;
+}
+
+/** \internal
+  * \brief The header of an .npy file
+  *
+  * \c descr is the numpy type string of the coefficients, \c dataOffset the position of the first one in the
+  * file, which numpy and save_npy() pad to a multiple of 64 bytes.
+  */
+struct npy_header
+{
+    std::string descr;
+    bool fortranOrder;
+    Shape shape;
+    std::size_t dataOffset;
+};
+
+/** \internal \returns the position of the value of \a key in the python dictionary \a dict, npos when missing */
+inline std::size_t npy_find_value(const std::string& dict, const char* key)
+{
+    std::size_t pos = dict.find(std::string("'") + key + "'");
+    if(pos == std::string::npos) pos = dict.find(std::string("\"") + key + "\"");
+    if(pos == std::string::npos) return pos;
+    pos = dict.find(':', pos);
+    if(pos == std::string::npos) return pos;
+    return dict.find_first_not_of(" \t", pos + 1);
+}
+
+/** \internal Parses the header of the .npy file \a file named \a path, leaving \a file at its end */
+inline npy_header read_npy_header(std::FILE* file, const std::string& path)
+{
+    unsigned char prefix[12];
+    if(std::fread(prefix, 1, 10, file) != 10 || std::memcmp(prefix, "\x93NUMPY", 6) != 0)
+        throw_npy_error(path, "not an .npy file");
+
+    // version 1.0 stores the length of the header on 2 bytes, versions 2.0 and 3.0 on 4 bytes
+    std::size_t length = std::size_t(prefix[8]) | (std::size_t(prefix[9]) << 8);
+    std::size_t prefixLength = 10;
+    if(prefix[6] >= 2)
+    {
+        if(std::fread(prefix + 10, 1, 2, file) != 2)
+            throw_npy_error(path, "truncated header");
+        length |= (std::size_t(prefix[10]) << 16) | (std::size_t(prefix[11]) << 24);
+        prefixLength = 12;
+    }
+    else if(prefix[6] != 1)
+        throw_npy_error(path, "unsupported format version");
+
+    std::string dict(length, '\0');
+    if(length == 0 || std::fread(&dict[0], 1, length, file) != length)
+        throw_npy_error(path, "truncated header");
+
+    npy_header header;
+    header.dataOffset = prefixLength + length;
+
+    std::size_t pos = npy_find_value(dict, "descr");
+    if(pos == std::string::npos || (dict[pos] != '\'' && dict[pos] != '"'))
+        throw_npy_error(path, "missing or structured 'descr' in the header");
+    const std::size_t end = dict.find(dict[pos], pos + 1);
+    if(end == std::string::npos)
+        throw_npy_error(path, "malformed 'descr' in the header");
+    header.descr = dict.substr(pos + 1, end - pos - 1);
+
+    pos = npy_find_value(dict, "fortran_order");
+    if(pos != std::string::npos && dict.compare(pos, 4, "True") == 0) header.fortranOrder = true;
+    else if(pos != std::string::npos && dict.compare(pos, 5, "False") == 0) header.fortranOrder = false;
+    else throw_npy_error(path, "missing 'fortran_order' in the header");
+
+    pos = npy_find_value(dict, "shape");
+    if(pos == std::string::npos || dict[pos] != '(')
+        throw_npy_error(path, "missing 'shape' in the header");
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    Index dims = 0;
+    const char* cursor = dict.c_str() + pos + 1;
+    for(;;)
+    {
+        while(*cursor == ' ' || *cursor == ',') ++cursor;
+        if(*cursor == ')') break;
+        char* next;
+        const long long extent = std::strtoll(cursor, &next, 10);
+        if(next == cursor || extent < 0 || dims == Index(MAX_ARRAY_DIMENSIONS))
+            throw_npy_error(path, "malformed 'shape' in the header");
+        extents[dims++] = Index(extent);
+        cursor = next;
+    }
+    header.shape = Shape(extents, dims);
+    return header;
+}
+
+/** \internal Writes the header of an .npy file of coefficients \a descr and shape \a shape to \a file.
+  * Like numpy, the header is padded with spaces so that the coefficients start on a multiple of 64 bytes,
+  * which lets load_npy() map them in place. */
+inline void write_npy_header(std::FILE* file, const std::string& path, const std::string& descr, const Shape& shape)
+{
+    std::string dict = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+    for(Index i=0; i<shape.dims(); ++i)
+    {
+        char extent[24];
+        std::snprintf(extent, sizeof(extent), "%lld", static_cast<long long>(shape[i]));
+        dict += extent;
+        if(i + 1 < shape.dims() || shape.dims() == 1) dict += ",";
+        if(i + 1 < shape.dims()) dict += " ";
+    }
+    dict += "), }";
+
+    const std::size_t prefixLength = dict.size() + 11 > 65535 ? 12 : 10;
+    const std::size_t total = (prefixLength + dict.size() + 1 + 63) / 64 * 64;
+    dict.append(total - prefixLength - dict.size() - 1, ' ');
+    dict += '\n';
+
+    const std::size_t length = dict.size();
+    const unsigned char prefix[12] = { 0x93, 'N', 'U', 'M', 'P', 'Y', (unsigned char)(prefixLength == 10 ? 1 : 2), 0,
+                                       (unsigned char)(length), (unsigned char)(length >> 8),
+                                       (unsigned char)(length >> 16), (unsigned char)(length >> 24) };
+    if(std::fwrite(prefix, 1, prefixLength, file) != prefixLength
+       || std::fwrite(dict.data(), 1, length, file) != length)
+        throw_npy_error(path, "write failed");
+}
+
+/** \internal Reads \a bytes bytes of \a file into \a data, by blocks of NC_NPY_IO_CHUNK_BYTES */
+inline void read_npy_data(std::FILE* file, const std::string& path, void* data, std::size_t bytes)
+{
+    char* cursor = static_cast<char*>(data);
+    while(bytes > 0)
+    {
+        const std::size_t chunk = numext::mini(bytes, std::size_t(NC_NPY_IO_CHUNK_BYTES));
+        if(std::fread(cursor, 1, chunk, file) != chunk)
+            throw_npy_error(path, "truncated data");
+        cursor += chunk;
+        bytes -= chunk;
+    }
+}
+
+inline void write_npy_data(std::FILE* file, const std::string& path, const void* data, std::size_t bytes)
+{
+    const char* cursor = static_cast<const char*>(data);
+    while(bytes > 0)
+    {
+        const std::size_t chunk = numext::mini(bytes, std::size_t(NC_NPY_IO_CHUNK_BYTES));
+        if(std::fwrite(cursor, 1, chunk, file) != chunk)
+            throw_npy_error(path, "write failed");
+        cursor += chunk;
+        bytes -= chunk;
+    }
+}
+
+/** \internal Reverses the bytes of each of the \a size coefficients of \a data */
+template<typename Scalar>
+inline void npy_byteswap(Scalar* data, Index size)
+{
+    // a complex is a pair of reals, each one swapped on its own
+    typedef typename NumTraits<Scalar>::Real Real;
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(data);
+    const Index count = size * Index(sizeof(Scalar) / sizeof(Real));
+    for(Index i=0; i<count; ++i, bytes += sizeof(Real))
+    {
+        for(std::size_t lo=0, hi=sizeof(Real)-1; lo<hi; ++lo, --hi)
+            numext::swap(bytes[lo], bytes[hi]);
+    }
+}
+
+/** \internal RAII closing of a std::FILE */
+struct npy_file
+{
+    npy_file(const std::string& path, const char* mode) : handle(std::fopen(path.c_str(), mode)) {}
+    ~npy_file() { if(handle) std::fclose(handle); }
+
+    std::FILE* handle;
+
+private:
+    npy_file(const npy_file&);
+    npy_file& operator=(const npy_file&);
+};
+
+#if NC_HAS_MMAP
+/** \internal A private mapping of a file, unmapped when the DenseStorage adopting it drops it */
+struct npy_mapping : public external_buffer
+{
+    npy_mapping(void* address, std::size_t length) : address(address), length(length) {}
+    ~npy_mapping() { ::munmap(address, length); }
+
+    void* address;
+    std::size_t length;
+};
+
+/** \internal Maps the .npy file \a path, whose coefficients are described by \a header, into a storage.
+  * \returns false, leaving \a storage untouched, when the coefficients are not suitably aligned in the file. */
+template<typename Scalar>
+inline bool map_npy_data(const std::string& path, const npy_header& header, DenseStorage<Scalar>& storage)
+{
+    const Index size = header.shape.size();
+    const std::size_t bytes = std::size_t(size) * sizeof(Scalar);
+    const std::size_t alignment = numext::maxi(std::size_t(NC_MAX_ALIGN_BYTES), sizeof(Scalar));
+    if(header.dataOffset % alignment != 0 || size == 0)
+        return false;
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw_npy_error(path, "cannot open");
+    struct stat status;
+    if(::fstat(fd, &status) != 0 || std::size_t(status.st_size) < header.dataOffset + bytes)
+    {
+        ::close(fd);
+        throw_npy_error(path, "truncated data");
+    }
+
+    // a private writable mapping: the pages are read on demand and shared with the other processes mapping
+    // the file, until they are written to, which copies them
+    const std::size_t length = header.dataOffset + bytes;
+    void* address = ::mmap(0, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(address == MAP_FAILED)
+        throw_npy_error(path, "mmap failed");
+
+    Scalar* data = reinterpret_cast<Scalar*>(static_cast<char*>(address) + header.dataOffset);
+    DenseStorage<Scalar> mapped(data, size, new npy_mapping(address, length));
+    storage.swap(mapped);
+    return true;
+}
+#endif
+
+/** \internal Writes the coefficients of an expression to an .npy file, straight from the buffer of an array
+  * stored contiguously, through a temporary otherwise. */
+template<typename Derived, bool Contiguous = (int(traits<Derived>::Flags) & (LinearAccessBit | DirectAccessBit))
+                                             == (LinearAccessBit | DirectAccessBit)>
+struct npy_writer
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    static void run(std::FILE* file, const std::string& path, const Derived& xpr)
+    {
+        const Array<Scalar> tmp(xpr);
+        npy_writer< Array<Scalar> >::run(file, path, tmp);
+    }
+};
+
+template<typename Derived>
+struct npy_writer<Derived, true>
+{
+    typedef typename traits<Derived>::Scalar Scalar;
+
+    static void run(std::FILE* file, const std::string& path, const Derived& xpr)
+    {
+        write_npy_header(file, path, npy_descr<Scalar>(), xpr.shape());
+        write_npy_data(file, path, xpr.data(), std::size_t(xpr.size()) * sizeof(Scalar));
+    }
+};
+
+template<typename _Scalar>
+struct npy_writer<ArrayView<_Scalar>, false>
+{
+    typedef typename traits< ArrayView<_Scalar> >::Scalar Scalar;
+
+    static void run(std::FILE* file, const std::string& path, const ArrayView<_Scalar>& xpr)
+    {
+        if(xpr.strides() == Strides(xpr.shape()))
+        {
+            write_npy_header(file, path, npy_descr<Scalar>(), xpr.shape());
+            write_npy_data(file, path, xpr.data(), std::size_t(xpr.size()) * sizeof(Scalar));
+        }
+        else
+        {
+            const Array<Scalar> tmp(xpr);
+            npy_writer< Array<Scalar> >::run(file, path, tmp);
+        }
+    }
+};
+
+NS_INTERNAL_END
+
+
+NS_BEGIN
+
+/** \returns the array stored in the numpy .npy file \a path.
+  *
+  * \tparam Scalar the type of the coefficients, which must be the dtype of the file
+  *
+  * The header gives the dtype, the shape and the order of the coefficients. A Fortran-ordered file is
+  * transposed into the row-major layout of Array, a file in the other byte order is swapped.
+  *
+  * With \a mmap, the coefficients are not read but mapped in place, privately: the pages are loaded from
+  * the file on first access and shared between all the processes mapping it, which keeps the start up of
+  * a process loading tens of gigabytes of weights instant and its resident memory low. Writing to the
+  * array copies the written pages, the file itself is never modified. The mapping is released with the
+  * buffer of the array. It falls back to reading the file when the coefficients cannot be mapped, i.e.
+  * when they are Fortran-ordered, swapped, not aligned on NC_MAX_ALIGN_BYTES in the file (numpy and
+  * save_npy() align them on 64 bytes), or on systems without mmap.
+  * \code
+  * save_npy("weights.npy", w);
+  * Array<float> w2 = load_npy<float>("weights.npy", true);   // no copy, no read
+  * \endcode
+  *
+  * A file that is not an .npy file, is truncated or stores another dtype raises a std::runtime_error, or
+  * aborts when exceptions are disabled.
+  *
+  * \sa save_npy()
+  */
+template<typename Scalar>
+Array<Scalar> load_npy(const std::string& path, bool mmap = false)
+{
+    internal::npy_file file(path, "rb");
+    if(!file.handle)
+        internal::throw_npy_error(path, "cannot open");
+    const internal::npy_header header = internal::read_npy_header(file.handle, path);
+
+    const std::string descr = internal::npy_descr<Scalar>();
+    bool swapped = false;
+    if(header.descr != descr)
+    {
+        swapped = sizeof(Scalar) > 1 && header.descr.size() == descr.size()
+               && header.descr.compare(1, std::string::npos, descr, 1, std::string::npos) == 0
+               && (header.descr[0] == '<' || header.descr[0] == '>');
+        if(!swapped)
+            internal::throw_npy_error(path, ("the file stores '" + header.descr + "' instead of '" + descr + "'").c_str());
+    }
+
+    // a Fortran-ordered array is the transposition of the row-major one with the dimensions in reverse order
+    Shape shape = header.shape;
+    if(header.fortranOrder)
+    {
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        for(Index i=0; i<shape.dims(); ++i) extents[i] = shape[shape.dims()-1-i];
+        shape = Shape(extents, shape.dims());
+    }
+
+    DenseStorage<Scalar> storage;
+#if NC_HAS_MMAP
+    if(mmap && !swapped && !header.fortranOrder)
+        internal::map_npy_data(path, header, storage);
+#else
+    NC_UNUSED_VARIABLE(mmap);
+#endif
+    if(storage.size() != shape.size())
+    {
+        DenseStorage<Scalar> buffer(shape.size());
+        internal::read_npy_data(file.handle, path, buffer.data(), std::size_t(shape.size()) * sizeof(Scalar));
+        if(swapped)
+            internal::npy_byteswap(buffer.data(), buffer.size());
+        storage.swap(buffer);
+    }
+
+    Array<Scalar> result(shape, std::move(storage));
+    if(header.fortranOrder)
+        return Array<Scalar>(result.transpose());
+    return result;
+}
+
+/** Writes \a a to the numpy .npy file \a path, in the native byte order and row-major order.
+  *
+  * The coefficients of an Array, a FixedArray or a contiguous ArrayView are streamed from their buffer, the
+  * other expressions are evaluated first. They start on a multiple of 64 bytes in the file, so that
+  * load_npy() can map it.
+  *
+  * A file that cannot be written raises a std::runtime_error, or aborts when exceptions are disabled.
+  *
+  * \sa load_npy()
+  */
+template<typename Derived>
+void save_npy(const std::string& path, const ArrayOp<Derived>& a)
+{
+    internal::npy_file file(path, "wb");
+    if(!file.handle)
+        internal::throw_npy_error(path, "cannot open");
+    internal::npy_writer<Derived>::run(file.handle, path, a.derived());
+    if(std::fflush(file.handle) != 0)
+        internal::throw_npy_error(path, "write failed");
+}
+
+NS_END
+
+#endif
@@ -1,9 +1,27 @@
 
 
-
 include_directories(${CMAKE_CURRENT_LIST_DIR})
 
 file(GLOB_RECURSE all_files ${CMAKE_CURRENT_LIST_DIR}/*.h ${CMAKE_CURRENT_LIST_DIR}/*.cc)
 
 
-set(SOURCES "${SOURCES};${all_files}")
\ No newline at end of file
+set(SOURCES "${SOURCES};${all_files}")
+
+
+# Runtime dispatch: the products are also compiled for AVX2 and AVX-512 by the sources of dispatch/, and the
+# highest instruction set the cpu supports is picked at startup. The rest of the program must then be compiled
+# for the oldest cpu it runs on, e.g. without -march=native.
+option(NC_RUNTIME_DISPATCH "Compile the products for several instruction sets and pick one at runtime" OFF)
+if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+    set(NC_DISPATCH_AVX2_FLAGS "-mavx2 -mfma")
+    set(NC_DISPATCH_AVX512_FLAGS "-mavx512f -mavx512cd -mavx512bw -mavx512dq -mavx512vl -mavx2 -mfma")
+endif()
+if(NC_RUNTIME_DISPATCH)
+    add_definitions(-DNC_RUNTIME_DISPATCH)
+    if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+        set_source_files_properties(${CMAKE_CURRENT_LIST_DIR}/dispatch/products_avx2.cc
+                                    PROPERTIES COMPILE_FLAGS "${NC_DISPATCH_AVX2_FLAGS}")
+        set_source_files_properties(${CMAKE_CURRENT_LIST_DIR}/dispatch/products_avx512.cc
+                                    PROPERTIES COMPILE_FLAGS "${NC_DISPATCH_AVX512_FLAGS}")
+    endif()
+endif()
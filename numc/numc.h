@@ -1 +1,3 @@
-#include "core/core.h"
\ No newline at end of file
+#include "core/core.h"
+#include "io/io.h"
+#include "interop/interop.h"
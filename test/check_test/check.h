@@ -0,0 +1,156 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#ifndef __NC_CHECK_H__
+#define __NC_CHECK_H__
+
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "numc.h"
+
+using namespace numc;
+
+/** The checks compare numc against naive loops over the raw buffers: the references below never go through
+  * an evaluator, they walk the coefficients of a view with its own strides. Each suite is run once per thread
+  * count by main(), and a failed CHECK only reports itself, so that a run lists all the failures. */
+
+/** \returns the number of failed checks so far */
+int& check_failures();
+
+/** \returns the number of threads the suites are currently run with */
+int& check_threads();
+
+#define CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            ++check_failures(); \
+            std::printf("%s:%d: CHECK(%s) failed with %d thread(s)\n", __FILE__, __LINE__, #cond, check_threads()); \
+        } \
+    } while(0)
+
+/** Calls \a func with each multi-index of \a shape, in row-major order */
+template<typename Func>
+void for_each_index(const Shape& shape, Func func)
+{
+    if(shape.size() == 0) return;
+    std::vector<Index> index(std::size_t(shape.dims()) + 1, 0);
+    for(;;)
+    {
+        func(index.data());
+        Index d = shape.dims() - 1;
+        while(d >= 0 && ++index[d] == shape[d]) index[d--] = 0;
+        if(d < 0) return;
+    }
+}
+
+/** \returns the coefficient of \a v at the multi-index \a index, read from its buffer and strides */
+template<typename Scalar>
+Scalar& raw_at(const ArrayView<Scalar>& v, const Index* index)
+{
+    Index offset = 0;
+    for(Index d=0; d<v.dims(); ++d) offset += index[d] * v.strides()[d];
+    return v.data()[offset];
+}
+
+/** \returns the coefficient of the 2-dimension view \a v at the row \a i and the column \a j */
+template<typename Scalar>
+Scalar& raw_at(const ArrayView<Scalar>& v, Index i, Index j)
+{
+    return v.data()[i * v.strides()[0] + j * v.strides()[1]];
+}
+
+/** \returns the coefficients of \a v in row-major order, walked with its strides */
+template<typename Scalar>
+std::vector<typename internal::remove_const<Scalar>::type> raw_values(const ArrayView<Scalar>& v)
+{
+    std::vector<typename internal::remove_const<Scalar>::type> values;
+    values.reserve(std::size_t(v.size()));
+    for_each_index(v.shape(), [&](const Index* index) { values.push_back(raw_at(v, index)); });
+    return values;
+}
+
+/** Fills \a v with small integers, so that sums and products of float coefficients are exact */
+template<typename Scalar>
+void fill_random(const ArrayView<Scalar>& v, unsigned seed, int range = 4)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(-range, range);
+    for_each_index(v.shape(), [&](const Index* index) { raw_at(v, index) = Scalar(dist(gen)); });
+}
+
+/** \returns a view of the coefficients of \a a, an Array, a FixedArray, a Map or a view */
+template<typename Scalar>
+ArrayView<const Scalar> as_view(const ArrayView<Scalar>& v) { return v; }
+
+template<typename Derived>
+auto as_view(const ArrayOp<Derived>& a) -> decltype(a.derived().view()) { return a.derived().view(); }
+
+/** \returns whether the views \a a and \a b have the same shape and coefficients, within \a tol relatively to
+  * the magnitude of \a b. The first mismatch is printed. */
+template<typename ScalarA, typename ScalarB>
+bool same_coeffs(const ArrayView<ScalarA>& a, const ArrayView<ScalarB>& b, double tol = 0)
+{
+    if(a.shape() != b.shape())
+    {
+        std::printf("  shapes differ: %ld dimensions vs %ld\n", long(a.dims()), long(b.dims()));
+        return false;
+    }
+    bool same = true;
+    for_each_index(a.shape(), [&](const Index* index) {
+        const double x = double(raw_at(a, index)), y = double(raw_at(b, index));
+        if(same && !(std::fabs(x - y) <= tol * (1 + std::fabs(y)) || (std::isnan(x) && std::isnan(y))))
+        {
+            std::printf("  coefficient %ld differs: %.17g vs %.17g\n", long(&raw_at(a, index) - a.data()), x, y);
+            same = false;
+        }
+    });
+    return same;
+}
+
+/** \returns whether \a a and \a b have the same shape and coefficients, see same_coeffs() */
+template<typename A, typename B>
+bool same_values(const A& a, const B& b, double tol = 0)
+{
+    return same_coeffs(as_view(a), as_view(b), tol);
+}
+
+/** \returns the naive matrix product of the 2-dimension views \a a and \a b, accumulated in double */
+template<typename Scalar>
+Array<Scalar> naive_matmul(const ArrayView<const Scalar>& a, const ArrayView<const Scalar>& b)
+{
+    const Index rows = a.shape()[0], depth = a.shape()[1], cols = b.shape()[1];
+    Array<Scalar> c(rows, cols);
+    for(Index i=0; i<rows; ++i)
+        for(Index j=0; j<cols; ++j)
+        {
+            double sum = 0;
+            for(Index k=0; k<depth; ++k)
+                sum += double(raw_at(a, i, k)) * double(raw_at(b, k, j));
+            c.data()[i*cols + j] = Scalar(sum);
+        }
+    return c;
+}
+
+void check_cwise();
+void check_views();
+void check_broadcasting();
+void check_redux();
+void check_products();
+void check_blas();
+void check_math();
+void check_aliasing();
+void check_io();
+void check_interop();
+void check_pool();
+
+#endif
@@ -0,0 +1,109 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+static void check_classification()
+{
+    Array<float> a(16, 16), b(16, 16);
+    ArrayView<float> top = a.slice({{0, 8}}), bottom = a.slice({{8, 16}}), shifted = a.slice({{1, 9}});
+
+    CHECK(internal::assignment_aliasing(a, b.exp()) == internal::NoAliasing);
+    CHECK(internal::assignment_aliasing(a, a * 2.f + b) == internal::InPlaceAliasing);
+    CHECK(internal::assignment_aliasing(a, a.transpose() + b) == internal::UnsafeAliasing);
+    CHECK(internal::assignment_aliasing(a, b + a.slice({{0, 1}})) == internal::UnsafeAliasing);
+    CHECK(internal::assignment_aliasing(top, bottom * 2.f) == internal::NoAliasing);
+    CHECK(internal::assignment_aliasing(top, shifted * 2.f) == internal::UnsafeAliasing);
+    CHECK(internal::assignment_aliasing(top, top.abs()) == internal::InPlaceAliasing);
+}
+
+/** Assigns \a src, an expression reading \a a, to \a dst and checks the result is the one of the expression
+  * evaluated before the assignment, as \a expected computed by naive loops */
+static void check_self_assignments(Index n)
+{
+    Array<float> a(n, n), b(n, n), before(n, n);
+    fill_random(a.view(), unsigned(n));
+    fill_random(b.view(), unsigned(n) + 1);
+    before = Array<float>(a);
+    Array<float> expected(n, n);
+
+    a = a.transpose();
+    for(Index i=0; i<n; ++i) for(Index j=0; j<n; ++j) expected.data()[i * n + j] = before.data()[j * n + i];
+    CHECK(same_values(a, expected));
+
+    a = before;
+    a = a + a.transpose() * b;
+    for(Index i=0; i<n; ++i)
+        for(Index j=0; j<n; ++j)
+            expected.data()[i * n + j] = before.data()[i * n + j] + before.data()[j * n + i] * b.data()[i * n + j];
+    CHECK(same_values(a, expected));
+
+    // a broadcast row of the destination itself
+    a = before;
+    a = a - a.slice({{n - 1, n}});
+    for(Index i=0; i<n; ++i)
+        for(Index j=0; j<n; ++j)
+            expected.data()[i * n + j] = before.data()[i * n + j] - before.data()[(n - 1) * n + j];
+    CHECK(same_values(a, expected));
+
+    // overlapping slices, shifted by a row either way
+    if(n < 2) return;
+    a = before;
+    a.slice({{0, n - 1}}) = a.slice({{1, n}}) * 2.f;
+    for(Index i=0; i<n; ++i)
+        for(Index j=0; j<n; ++j)
+            expected.data()[i * n + j] = i < n - 1 ? before.data()[(i + 1) * n + j] * 2.f : before.data()[i * n + j];
+    CHECK(same_values(a, expected));
+
+    a = before;
+    a.slice({{1, n}}) = a.slice({{0, n - 1}}) + 1.f;
+    for(Index i=0; i<n; ++i)
+        for(Index j=0; j<n; ++j)
+            expected.data()[i * n + j] = i > 0 ? before.data()[(i - 1) * n + j] + 1.f : before.data()[i * n + j];
+    CHECK(same_values(a, expected));
+
+    // a reversed view of the destination
+    a = before;
+    a = a.slice({{Slice::None, Slice::None, -1}, {}});
+    for(Index i=0; i<n; ++i) for(Index j=0; j<n; ++j) expected.data()[i * n + j] = before.data()[(n - 1 - i) * n + j];
+    CHECK(same_values(a, expected));
+}
+
+static void check_noalias(Index n)
+{
+    Array<float> a(n), b(n), c(n), d(n), expected(n);
+    fill_random(a.view(), 60);
+    fill_random(b.view(), 61);
+    fill_random(c.view(), 62);
+
+    d.noalias() = a * b + c;
+    for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] * b.data()[i] + c.data()[i];
+    CHECK(same_values(d, expected));
+
+    // the source reads the destination in place: it must still see the coefficients it has not written yet
+    d.noalias() = d * 2.f - c;
+    for(Index i=0; i<n; ++i) expected.data()[i] = expected.data()[i] * 2.f - c.data()[i];
+    CHECK(same_values(d, expected));
+
+    ArrayView<float> half = d.slice({{0, n / 2}});
+    half.noalias() = half + a.slice({{n - n / 2, n}});
+    for(Index i=0; i<n/2; ++i) expected.data()[i] += a.data()[n - n / 2 + i];
+    CHECK(same_values(d, expected));
+}
+
+void check_aliasing()
+{
+    check_classification();
+    const Index sizes[] = { 1, 2, 7, 16, 33, 300 };
+    for(Index n : sizes) check_self_assignments(n);
+    // large enough to be written with non-temporal stores when the source does not read the destination
+    const Index lengths[] = { 17, 1001, (Index(1) << 20) + 3 };
+    for(Index n : lengths) check_noalias(n);
+}
@@ -0,0 +1,152 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include <limits>
+#include "check.h"
+
+/** Checks gemv() with the matrix \a a, whatever its layout, against a naive loop */
+template<typename Scalar>
+static void check_gemv(const ArrayView<const Scalar>& a, Scalar alpha, Scalar beta, unsigned seed)
+{
+    const Index rows = a.shape()[0], cols = a.shape()[1];
+    Array<Scalar> x(cols), y(rows), expected(rows);
+    fill_random(x.view(), seed);
+    fill_random(y.view(), seed + 1);
+    for(Index i=0; i<rows; ++i)
+    {
+        double sum = 0;
+        for(Index j=0; j<cols; ++j) sum += double(raw_at(a, i, j)) * x.data()[j];
+        expected.data()[i] = Scalar(alpha * sum + (beta == Scalar(0) ? 0 : beta * y.data()[i]));
+    }
+    // y is not read when beta is 0, even its NaNs
+    if(beta == Scalar(0) && rows > 0) y.data()[rows / 2] = std::numeric_limits<Scalar>::quiet_NaN();
+    gemv(alpha, a, x, beta, y);
+    CHECK(same_values(y, expected));
+
+    // into a strided view of y, from a strided view of x
+    Array<Scalar> x2(2 * cols), y2(3 * rows);
+    y2 = y2.constant(Scalar(0));
+    ArrayView<Scalar> xs = x2.slice({{Slice::None, Slice::None, -2}}), ys = y2.slice({{1, Slice::None, 3}});
+    xs = x;
+    gemv(alpha, a, xs, Scalar(0), ys);
+    Array<Scalar> expectedNoBeta(rows);
+    for(Index i=0; i<rows; ++i)
+    {
+        double sum = 0;
+        for(Index j=0; j<cols; ++j) sum += double(raw_at(a, i, j)) * x.data()[j];
+        expectedNoBeta.data()[i] = Scalar(alpha * sum);
+    }
+    CHECK(same_coeffs(ys, expectedNoBeta.view()));
+    for(Index i=0; i<3*rows; ++i) if(i % 3 != 1) CHECK(y2.data()[i] == Scalar(0));
+}
+
+template<typename Scalar>
+static void check_blas_type()
+{
+    const Index sizes[][2] = { {1, 1}, {3, 7}, {17, 5}, {33, 64}, {130, 67}, {257, 300}, {0, 5}, {5, 0} };
+    unsigned seed = 600;
+    for(const auto& s : sizes)
+    {
+        Array<Scalar> a(s[0], s[1]), at(s[1], s[0]);
+        fill_random(a.view(), seed++);
+        fill_random(at.view(), seed++);
+        check_gemv<Scalar>(a.view(), Scalar(1), Scalar(0), seed++);
+        check_gemv<Scalar>(a.view(), Scalar(2), Scalar(-3), seed++);
+        check_gemv<Scalar>(at.transpose(), Scalar(-1), Scalar(1), seed++);
+        check_gemv<Scalar>(at.transpose(), Scalar(0.5), Scalar(0), seed++);
+        Array<Scalar> big(2 * s[0] + 1, 3 * s[1]);
+        fill_random(big.view(), seed++);
+        check_gemv<Scalar>(big.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -3}}), Scalar(1), Scalar(2), seed++);
+    }
+
+    const Index lengths[] = { 0, 1, 7, 31, 33, 1001, 70001 };
+    for(Index n : lengths)
+    {
+        Array<Scalar> x(n), y(n), y0(n);
+        fill_random(x.view(), seed++);
+        fill_random(y.view(), seed++);
+        y0 = y;
+
+        double dot = 0, squares = 0;
+        for(Index i=0; i<n; ++i)
+        {
+            dot += double(x.data()[i]) * y.data()[i];
+            squares += double(x.data()[i]) * x.data()[i];
+        }
+        CHECK(numc::dot(x, y) == Scalar(dot));
+        CHECK(std::fabs(nrm2(x) - std::sqrt(squares)) <= 1e-6 * std::sqrt(squares));
+
+        axpy(Scalar(3), x, y);
+        bool same = true;
+        for(Index i=0; i<n; ++i) same = same && y.data()[i] == Scalar(3) * x.data()[i] + y0.data()[i];
+        CHECK(same);
+        scal(Scalar(-2), y);
+        for(Index i=0; i<n; ++i) same = same && y.data()[i] == Scalar(-2) * (Scalar(3) * x.data()[i] + y0.data()[i]);
+        CHECK(same);
+
+        // through strided views
+        if(n < 2) continue;
+        ArrayView<const Scalar> xs = x.slice({{Slice::None, Slice::None, 2}}), ys = y0.slice({{1, Slice::None, 2}});
+        const Index m = numext::mini(xs.size(), ys.size());
+        ArrayView<const Scalar> xm = xs.slice({{0, m}}), ym = ys.slice({{0, m}});
+        double strided = 0;
+        for(Index i=0; i<m; ++i) strided += double(x.data()[2 * i]) * y0.data()[2 * i + 1];
+        CHECK(numc::dot(xm, ym) == Scalar(strided));
+        CHECK(numc::dot(x.slice({{Slice::None, Slice::None, -1}}), y0) == numc::dot(x, y0.slice({{Slice::None, Slice::None, -1}})));
+    }
+
+    // nrm2 neither overflows nor underflows where the sum of the squares would
+    const Scalar huge = std::numeric_limits<Scalar>::max() / Scalar(4), tiny = std::numeric_limits<Scalar>::min() * Scalar(4);
+    Array<Scalar> h(5);
+    h = h.constant(huge);
+    CHECK(std::fabs(nrm2(h) / (huge * std::sqrt(Scalar(5))) - 1) <= 1e-6);
+    h = h.constant(tiny);
+    CHECK(std::fabs(nrm2(h) / (tiny * std::sqrt(Scalar(5))) - 1) <= 1e-6);
+    h.data()[2] = std::numeric_limits<Scalar>::infinity();
+    CHECK(nrm2(h) == std::numeric_limits<Scalar>::infinity());
+    h = h.constant(Scalar(0));
+    CHECK(nrm2(h) == Scalar(0));
+
+    // the second pass reads strided and transposed views in place
+    Array<Scalar> m(9, 7);
+    for(const Scalar magnitude : { huge, tiny })
+    {
+        // the norm itself must remain finite
+        for(Index i=0; i<m.size(); ++i)
+            m.data()[i] = magnitude == huge ? huge / Scalar(4 * (1 + i % 5)) : tiny * Scalar(1 + i % 5);
+        const ArrayView<const Scalar> views[] = { m.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -3}}),
+                                                  m.transpose(), m.slice({{2, 3}}).squeeze(0) };
+        for(const ArrayView<const Scalar>& v : views)
+        {
+            long double squares = 0;
+            for(const Scalar x : raw_values(v)) squares += ((long double)x / magnitude) * ((long double)x / magnitude);
+            const long double expected = std::sqrt(squares) * magnitude;
+            CHECK(std::fabs(nrm2(v) / expected - 1) <= 1e-6);
+        }
+    }
+}
+
+void check_blas()
+{
+    check_blas_type<float>();
+    check_blas_type<double>();
+
+    // the norm of complex coefficients is the one of their magnitudes
+    typedef std::complex<float> Complex;
+    Array<Complex> z(9);
+    double squares = 0;
+    for(Index i=0; i<9; ++i)
+    {
+        z.data()[i] = Complex(float(i) - 4.f, float(i % 3));
+        squares += std::norm(z.data()[i]);
+    }
+    const float norm = nrm2(z);
+    CHECK(std::fabs(norm - std::sqrt(squares)) <= 1e-6 * std::sqrt(squares));
+}
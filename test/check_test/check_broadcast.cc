@@ -0,0 +1,77 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+/** \returns the coefficient of \a v read at the multi-index \a index of a broadcast result of \a dims
+  * dimensions, with the numpy rules: the dimensions are aligned on the right, extents of 1 are repeated */
+template<typename Scalar>
+static Scalar broadcast_at(const ArrayView<Scalar>& v, const Index* index, Index dims)
+{
+    Index offset = 0;
+    for(Index d=0; d<v.dims(); ++d)
+    {
+        const Index i = index[dims - v.dims() + d];
+        offset += (v.shape()[d] == 1 ? 0 : i) * v.strides()[d];
+    }
+    return v.data()[offset];
+}
+
+template<typename Scalar>
+static void check_broadcast(const Shape& lhsShape, const Shape& rhsShape, unsigned seed)
+{
+    Array<Scalar> lhs(lhsShape), rhs(rhsShape);
+    fill_random(lhs.view(), seed);
+    fill_random(rhs.view(), seed + 1);
+
+    Array<Scalar> sum = lhs + rhs;
+    Array<Scalar> fused = lhs * rhs + lhs;
+    const Index dims = sum.dims();
+    Array<Scalar> expectedSum(sum.shape()), expectedFused(sum.shape());
+    for_each_index(sum.shape(), [&](const Index* index) {
+        const Scalar l = broadcast_at(lhs.view(), index, dims), r = broadcast_at(rhs.view(), index, dims);
+        raw_at(expectedSum.view(), index) = l + r;
+        raw_at(expectedFused.view(), index) = l * r + l;
+    });
+    CHECK(same_values(sum, expectedSum));
+    CHECK(same_values(fused, expectedFused));
+
+    // a broadcast operand which is costly to evaluate is evaluated once into a temporary
+    Array<Scalar> nested = lhs + (rhs * Scalar(0.5)).tanh().exp();
+    Array<Scalar> expectedNested(sum.shape());
+    for_each_index(sum.shape(), [&](const Index* index) {
+        const Scalar r = broadcast_at(rhs.view(), index, dims);
+        raw_at(expectedNested.view(), index) = broadcast_at(lhs.view(), index, dims) + std::exp(std::tanh(r * Scalar(0.5)));
+    });
+    CHECK(same_values(nested, expectedNested, 1e-5));
+}
+
+void check_broadcasting()
+{
+    const Shape shapes[][2] = {
+        { Shape(7, 33), Shape(33) },              // a row
+        { Shape(7, 33), Shape(7, 1) },            // a column
+        { Shape(1, 33), Shape(7, 1) },            // outer sum
+        { Shape(5, 3, 17), Shape(3, 1) },
+        { Shape(5, 1, 17), Shape(1, 9, 17) },
+        { Shape(2, 3, 5, 7), Shape(5, 1) },
+        { Shape(13), Shape(1) },
+        { Shape(301, 257), Shape(257) },          // split over threads
+        { Shape(257, 301), Shape(257, 1) }
+    };
+    unsigned seed = 100;
+    for(const auto& s : shapes)
+    {
+        check_broadcast<float>(s[0], s[1], seed);
+        check_broadcast<float>(s[1], s[0], seed + 2);
+        check_broadcast<double>(s[0], s[1], seed + 4);
+        seed += 8;
+    }
+}
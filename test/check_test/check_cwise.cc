@@ -0,0 +1,106 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+template<typename Scalar>
+static void check_cwise_sizes()
+{
+    // odd sizes around the packet sizes, and one large enough to be split over threads
+    const Index sizes[] = { 0, 1, 3, 7, 15, 17, 31, 33, 67, 1001, 70001 };
+    unsigned seed = 1;
+    for(Index n : sizes)
+    {
+        Array<Scalar> a(n), b(n), c(n);
+        fill_random(a.view(), seed++);
+        fill_random(b.view(), seed++);
+        fill_random(c.view(), seed++);
+
+        Array<Scalar> sum = a + b, diff = a - b, prod = a * b, fused = a * b + c, scaled = Scalar(3) * a - Scalar(2);
+        Array<Scalar> neg = -a, abs = a.abs();
+        Array<Scalar> expected(n);
+        for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] + b.data()[i];
+        CHECK(same_values(sum, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] - b.data()[i];
+        CHECK(same_values(diff, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] * b.data()[i];
+        CHECK(same_values(prod, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] * b.data()[i] + c.data()[i];
+        CHECK(same_values(fused, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = Scalar(3) * a.data()[i] - Scalar(2);
+        CHECK(same_values(scaled, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = -a.data()[i];
+        CHECK(same_values(neg, expected));
+        for(Index i=0; i<n; ++i) expected.data()[i] = a.data()[i] < 0 ? -a.data()[i] : a.data()[i];
+        CHECK(same_values(abs, expected));
+
+        // in place, the destination being read at the position it is written to
+        c = c * a + b;
+        Array<Scalar> restored = c - b;
+        for(Index i=0; i<n; ++i) expected.data()[i] = (fused.data()[i] - a.data()[i] * b.data()[i]) * a.data()[i];
+        CHECK(same_values(restored, expected));
+    }
+}
+
+/** Checks a multiply-add rounds each coefficient the same way, whether it is computed in a packet, in the
+  * peeled head of an unaligned view or by the traversal of a strided one */
+template<typename Scalar>
+static void check_muladd_rounding()
+{
+    const Index n = 67;
+    Array<Scalar> tall(n, 3);
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<Scalar> dist(-1, 1);
+    for(Index i=0; i<tall.size(); ++i) tall.data()[i] = dist(gen);
+    // the columns of tall are strided, their copies contiguous
+    const ArrayView<const Scalar> as = tall.slice({{}, {0, 1}}).squeeze(1), bs = tall.slice({{}, {1, 2}}).squeeze(1);
+    const ArrayView<const Scalar> cs = tall.slice({{}, {2, 3}}).squeeze(1);
+    const Array<Scalar> a = as, b = bs, c = cs;
+
+    Array<Scalar> expected(n);
+    for(Index i=0; i<n; ++i)
+    {
+#ifdef NC_VECTORIZE_FMA
+        expected.data()[i] = std::fma(a.data()[i], b.data()[i], c.data()[i]);
+#else
+        expected.data()[i] = a.data()[i] * b.data()[i] + c.data()[i];
+#endif
+    }
+    CHECK(same_values(Array<Scalar>(a * b + c), expected));
+    CHECK(same_values(Array<Scalar>(a.slice({{1, n}}) * b.slice({{1, n}}) + c.slice({{1, n}})), expected.slice({{1, n}})));
+    CHECK(same_values(Array<Scalar>(as * bs + cs), expected));
+}
+
+/** Checks a fixed-size array, whose loops are unrolled */
+static void check_fixed()
+{
+    FixedArray<float, 4, 4> fa, fb, fc;
+    fill_random(fa.view(), 3);
+    fill_random(fb.view(), 4);
+    fill_random(fc.view(), 5);
+    FixedArray<float, 4, 4> fd = fa * fb + fc;
+    Array<float> expected(4, 4);
+    for(Index i=0; i<16; ++i) expected.data()[i] = fa.data()[i] * fb.data()[i] + fc.data()[i];
+    CHECK(same_values(fd, expected));
+    FixedArray<double, 3, 5> ga;
+    fill_random(ga.view(), 6);
+    Array<double> gb = ga - 1.0;
+    for(Index i=0; i<15; ++i) CHECK(gb.data()[i] == ga.data()[i] - 1.0);
+}
+
+void check_cwise()
+{
+    check_cwise_sizes<float>();
+    check_cwise_sizes<double>();
+    check_cwise_sizes<int>();
+    check_muladd_rounding<float>();
+    check_muladd_rounding<double>();
+    check_fixed();
+}
@@ -0,0 +1,183 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+// The interop is compiled when its header is found, see CMakeLists.txt
+
+#ifdef NC_USE_DLPACK
+
+/** \brief A tensor of another runtime, which counts its releases */
+struct foreign_tensor
+{
+    DLManagedTensor managed;
+    int64_t shape[2];
+    int64_t strides[2];
+    void* buffer;
+    int* released;
+
+    static void release(DLManagedTensor* self)
+    {
+        foreign_tensor* tensor = static_cast<foreign_tensor*>(self->manager_ctx);
+        internal::aligned_free(tensor->buffer);
+        ++*tensor->released;
+        delete tensor;
+    }
+
+    /** \returns a tensor of \a rows x \a cols floats i, at \a offset bytes from an aligned buffer, with the
+      * strides \a rowStride and \a colStride, or null strides when both are 0 */
+    static DLManagedTensor* create(Index rows, Index cols, Index rowStride, Index colStride, std::size_t offset, int* released)
+    {
+        foreign_tensor* tensor = new foreign_tensor;
+        const Index count = rowStride || colStride ? (rows - 1) * rowStride + (cols - 1) * colStride + 1 : rows * cols;
+        tensor->buffer = internal::aligned_malloc(std::size_t(count) * sizeof(float) + offset);
+        float* data = reinterpret_cast<float*>(static_cast<char*>(tensor->buffer) + offset);
+        for(Index i=0; i<count; ++i) data[i] = float(i);
+        tensor->shape[0] = rows;
+        tensor->shape[1] = cols;
+        tensor->strides[0] = rowStride;
+        tensor->strides[1] = colStride;
+        tensor->released = released;
+
+        DLTensor& t = tensor->managed.dl_tensor;
+        t.data = tensor->buffer;
+        t.byte_offset = offset;
+        t.device.device_type = kDLCPU;
+        t.device.device_id = 0;
+        t.ndim = 2;
+        t.dtype = internal::dlpack_dtype<float>();
+        t.shape = tensor->shape;
+        t.strides = rowStride || colStride ? tensor->strides : 0;
+        tensor->managed.manager_ctx = tensor;
+        tensor->managed.deleter = &release;
+        return &tensor->managed;
+    }
+};
+
+static void check_dlpack()
+{
+    Array<float> a(7, 5);
+    fill_random(a.view(), 900);
+
+    // arrays and views lend their buffer with their strides
+    DLManagedTensor* t = to_dlpack(a.transpose());
+    CHECK(t->dl_tensor.data == a.data() && t->dl_tensor.ndim == 2);
+    CHECK(t->dl_tensor.shape[0] == 5 && t->dl_tensor.shape[1] == 7);
+    CHECK(t->dl_tensor.strides[0] == 1 && t->dl_tensor.strides[1] == 5);
+    CHECK(same_values(dlpack_view<float>(t->dl_tensor), a.transpose()));
+    t->deleter(t);
+
+    ArrayView<const float> strided = a.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -2}});
+    t = to_dlpack(strided);
+    CHECK(same_values(dlpack_view<float>(t->dl_tensor), strided));
+    t->deleter(t);
+
+    // an expression is evaluated into a buffer owned by the tensor
+    t = to_dlpack(a * 2.f + 1.f);
+    CHECK(t->dl_tensor.data != a.data());
+    CHECK(same_values(dlpack_view<float>(t->dl_tensor), Array<float>(a * 2.f + 1.f)));
+    t->deleter(t);
+
+    // an Array handed over, then taken back
+    Array<double> d(33);
+    fill_random(d.view(), 901);
+    const Array<double> values = d;
+    const double* buffer = d.data();
+    t = to_dlpack(std::move(d));
+    CHECK(d.size() == 0 && t->dl_tensor.data == buffer);
+    Array<double> back = from_dlpack<double>(t);
+    CHECK(back.isExternal() && back.data() == buffer && same_values(back, values));
+
+    int released = 0;
+    {
+        // a contiguous aligned tensor is adopted
+        Array<float> x = from_dlpack<float>(foreign_tensor::create(4, 16, 0, 0, 0, &released));
+        CHECK(x.isExternal() && released == 0 && x.shape() == Shape(4, 16) && x.data()[17] == 17.f);
+    }
+    CHECK(released == 1);
+    {
+        // a transposed one is copied and released at once
+        Array<float> x = from_dlpack<float>(foreign_tensor::create(16, 4, 1, 16, 0, &released));
+        CHECK(!x.isExternal() && released == 2 && x.data()[1] == 16.f && x.data()[4] == 1.f);
+    }
+    {
+        // a misaligned one is viewed in place
+        DLManagedTensor* m = foreign_tensor::create(3, 8, 0, 0, 4, &released);
+        ArrayView<float> v = dlpack_view<float>(m->dl_tensor);
+        CHECK(v.shape() == Shape(3, 8) && v.data()[9] == 9.f && float(v.sum()) == 276.f);
+        m->deleter(m);
+    }
+    CHECK(released == 3);
+
+#ifdef NC_EXCEPTIONS
+    DLManagedTensor* m = foreign_tensor::create(2, 2, 0, 0, 0, &released);
+    bool thrown = false;
+    try { dlpack_view<double>(m->dl_tensor); }
+    catch(const std::runtime_error&) { thrown = true; }
+    CHECK(thrown);
+    m->deleter(m);
+#endif
+}
+
+#else
+
+static void check_dlpack() {}
+
+#endif
+
+
+#ifdef NC_USE_EIGEN
+
+static void check_eigen()
+{
+    Array<double> a(9, 7), b(7, 5);
+    fill_random(a.view(), 950);
+    fill_random(b.view(), 951);
+
+    // numc arrays seen by Eigen, whatever their strides
+    const Eigen::MatrixXd product = to_eigen(a) * to_eigen(b);
+    CHECK(same_values(from_eigen(product), naive_matmul<double>(a.view(), b.view())));
+    const Eigen::MatrixXd transposed = to_eigen(a.transpose());
+    CHECK(transposed.rows() == 7 && transposed.cols() == 9);
+    CHECK(same_values(from_eigen(transposed), a.transpose()));
+    ArrayView<double> strided = a.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -3}});
+    const Eigen::MatrixXd s = to_eigen(strided);
+    CHECK(same_values(from_eigen(s), strided));
+
+    // writes through the map land in the array
+    to_eigen(b).setConstant(2.0);
+    for(Index i=0; i<b.size(); ++i) CHECK(b.data()[i] == 2.0);
+    Array<double> x(7);
+    fill_random(x.view(), 952);
+    const Eigen::VectorXd ax = to_eigen(a) * to_eigen_vector(x);
+    CHECK(same_values(from_eigen(ax), naive_matmul<double>(a.view(), x.reshape(Shape(7, 1))).reshape(Shape(9))));
+
+    // Eigen objects seen by numc, column-major ones included
+    Eigen::MatrixXf m(6, 4);
+    for(int j=0; j<4; ++j) for(int i=0; i<6; ++i) m(i, j) = float(i * 10 + j);
+    ArrayView<float> v = from_eigen(m);
+    CHECK(v.shape() == Shape(6, 4) && v.strides()[0] == 1 && v.strides()[1] == 6);
+    const Array<float> doubled = v * 2.f;
+    for(Index i=0; i<6; ++i) for(Index j=0; j<4; ++j) CHECK(doubled.data()[i * 4 + j] == 2.f * float(i * 10 + j));
+    from_eigen(m.col(1)) = from_eigen(m.col(2)) + 1.f;
+    for(int i=0; i<6; ++i) CHECK(m(i, 1) == float(i * 10 + 3));
+}
+
+#else
+
+static void check_eigen() {}
+
+#endif
+
+void check_interop()
+{
+    check_dlpack();
+    check_eigen();
+}
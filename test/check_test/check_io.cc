@@ -0,0 +1,135 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include <cstdlib>
+#include <string>
+#include "check.h"
+
+/** Saves \a a to an .npy file and checks it is loaded back as is, read and mapped */
+template<typename Scalar, typename Derived>
+static void check_npy_round_trip(const ArrayOp<Derived>& a, const std::string& path)
+{
+    const Array<Scalar> expected(a);
+    save_npy(path, a);
+    const Array<Scalar> read = load_npy<Scalar>(path);
+    CHECK(same_values(read, expected));
+    {
+        Array<Scalar> mapped = load_npy<Scalar>(path, true);
+        CHECK(same_values(mapped, expected));
+        // a mapping is private: writing to it does not change the file
+        if(mapped.size() > 0) mapped.data()[0] = mapped.data()[0] + Scalar(1);
+    }
+    CHECK(same_values(load_npy<Scalar>(path, true), expected));
+    std::remove(path.c_str());
+}
+
+static void check_npy()
+{
+    const std::string path = "check_test_" + std::to_string(check_threads()) + ".npy";
+    const Shape shapes[] = { Shape(), Shape(0), Shape(1), Shape(17), Shape(3, 5), Shape(33, 7, 2), Shape(2, 1, 3, 1, 5) };
+    unsigned seed = 800;
+    for(const Shape& shape : shapes)
+    {
+        Array<float> f(shape);
+        Array<double> d(shape);
+        Array<int> k(shape);
+        fill_random(f.view(), seed++, 1000);
+        fill_random(d.view(), seed++, 1000);
+        fill_random(k.view(), seed++, 1000);
+        check_npy_round_trip<float>(f, path);
+        check_npy_round_trip<double>(d, path);
+        check_npy_round_trip<int>(k, path);
+    }
+
+    // views which are not contiguous, and an expression, are evaluated before being written
+    Array<float> a(13, 9);
+    fill_random(a.view(), 810, 1000);
+    check_npy_round_trip<float>(a.transpose(), path);
+    check_npy_round_trip<float>(a.slice({{1, Slice::None, 3}, {Slice::None, Slice::None, -2}}), path);
+    check_npy_round_trip<float>(a * 2.f + 1.f, path);
+    check_npy_round_trip<float>(a.slice({{2, 7}}), path);
+
+    // a file storing another type is rejected
+#ifdef NC_EXCEPTIONS
+    save_npy(path, a);
+    bool thrown = false;
+    try { load_npy<double>(path); }
+    catch(const std::runtime_error&) { thrown = true; }
+    CHECK(thrown);
+    std::remove(path.c_str());
+#endif
+}
+
+struct counting_deleter
+{
+    explicit counting_deleter(int* count) : count(count) {}
+    void operator()(float* p) const
+    {
+        internal::aligned_free(p);
+        ++*count;
+    }
+    int* count;
+};
+
+static void check_from_buffer()
+{
+    const Index n = 37;
+    int released = 0;
+
+    // an aligned contiguous buffer is adopted, and released with the Array
+    {
+        float* p = static_cast<float*>(internal::aligned_malloc(n * sizeof(float)));
+        for(Index i=0; i<n; ++i) p[i] = float(i);
+        Array<float> a = Array<float>::from_buffer(p, Shape(n), counting_deleter(&released));
+        CHECK(a.isExternal() && a.data() == p && released == 0);
+        Array<float> b = a * 2.f;
+        for(Index i=0; i<n; ++i) CHECK(b.data()[i] == 2.f * float(i));
+    }
+    CHECK(released == 1);
+
+    // a strided buffer is copied, and released at once
+    {
+        float* p = static_cast<float*>(internal::aligned_malloc(2 * n * sizeof(float)));
+        for(Index i=0; i<2*n; ++i) p[i] = float(i);
+        const Index stride = 2;
+        Array<float> a = Array<float>::from_buffer(p, Shape(n), Strides(&stride, 1), counting_deleter(&released));
+        CHECK(!a.isExternal() && released == 2);
+        for(Index i=0; i<n; ++i) CHECK(a.data()[i] == float(2 * i));
+    }
+
+    // a buffer owned by the caller is shared, never released
+    {
+        float* p = static_cast<float*>(internal::aligned_malloc(n * sizeof(float)));
+        CHECK(Array<float>::can_adopt(p, Shape(n), Strides(Shape(n))));
+        // without vectorization no alignment is required
+        CHECK(Array<float>::can_adopt(p + 1, Shape(n - 1), Strides(Shape(n - 1))) == (NC_MAX_ALIGN_BYTES <= 4));
+        {
+            Array<float> a = Array<float>::from_buffer(p, Shape(n));
+            a = a.constant(3.f);
+        }
+        for(Index i=0; i<n; ++i) CHECK(p[i] == 3.f);
+#ifdef NC_EXCEPTIONS
+        // one which cannot be adopted is rejected, whether asserts are enabled or not
+        const Index stride = 2;
+        bool thrown = false;
+        try { Array<float>::from_buffer(p, Shape(n / 2), Strides(&stride, 1)); }
+        catch(const std::invalid_argument&) { thrown = true; }
+        CHECK(thrown);
+#endif
+        internal::aligned_free(p);
+    }
+    CHECK(released == 2);
+}
+
+void check_io()
+{
+    check_npy();
+    check_from_buffer();
+}
@@ -0,0 +1,102 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+// the cpu features, which numc only probes for the runtime dispatch
+#ifndef NC_RUNTIME_DISPATCH
+  #if NC_ARCH_i386_OR_x86_64 && NC_COMP_MSVC
+    #include <intrin.h>
+  #elif NC_ARCH_i386_OR_x86_64
+    #include <cpuid.h>
+  #endif
+  #include "core/utils/cpuid.h"
+#endif
+
+// the exit code of a binary compiled for an instruction set the cpu lacks, see CMakeLists.txt
+#define CHECK_SKIPPED 77
+
+int& check_failures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+int& check_threads()
+{
+    static int threads = 1;
+    return threads;
+}
+
+static const char* instruction_set()
+{
+#if defined(NC_VECTORIZE_AVX512)
+    return "AVX-512";
+#elif defined(NC_VECTORIZE_AVX2)
+    return "AVX2";
+#elif defined(NC_VECTORIZE_AVX)
+    return "AVX";
+#elif defined(NC_VECTORIZE_SSE2)
+    return "SSE2";
+#elif defined(NC_VECTORIZE)
+    return "vectorized";
+#else
+    return "not vectorized";
+#endif
+}
+
+#ifdef NC_RUNTIME_DISPATCH
+/** Checks the products run the kernels of the highest level of the cpu, only the AVX2 and AVX-512 ones being
+  * compiled apart by numc/dispatch */
+static void check_dispatch()
+{
+    const int level = internal::cpu_features::get().level();
+    const int expected = level >= NC_DISPATCH_LEVEL_AVX2 ? level : NC_DISPATCH_LEVEL_GENERIC;
+    CHECK(dispatch::product_kernels<float>::selected.level == expected);
+    CHECK(dispatch::product_kernels<double>::selected.level == expected);
+}
+#endif
+
+int main()
+{
+    if(NC_DISPATCH_LEVEL > internal::cpu_features::get().level())
+    {
+        std::printf("skipped: compiled for an instruction set this cpu does not support\n");
+        return CHECK_SKIPPED;
+    }
+
+#ifdef NC_RUNTIME_DISPATCH
+    check_dispatch();
+#endif
+
+    // the single-threaded run is the reference the others must agree with, a split over more threads than
+    // cores still exercises the partitioning
+    const int threadCounts[] = { 1, 4 };
+    for(int threads : threadCounts)
+    {
+        ScopedNumThreads scope(threads);
+        check_threads() = threads;
+        check_cwise();
+        check_views();
+        check_broadcasting();
+        check_redux();
+        check_products();
+        check_blas();
+        check_math();
+        check_aliasing();
+        check_io();
+        check_interop();
+        check_pool();
+    }
+
+    std::printf("%s: %d failed check(s), %s\n", check_failures() ? "FAILED" : "passed", check_failures(),
+                instruction_set());
+    return check_failures() ? 1 : 0;
+}
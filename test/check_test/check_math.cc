@@ -0,0 +1,200 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include <cstring>
+#include <limits>
+#include "check.h"
+
+/** The maximum error of the coefficient-wise functions computed by the C library, which the scalar paths call.
+  * The ULP bounds of the vectorized ones are the claims of generic_packet_math_functions.h. */
+#define CHECK_LIBM_ULP 2.5
+
+/** \returns the distance in ULP of \a Scalar between \a x and the exact value \a ref */
+template<typename Scalar>
+static long double ulp_error(Scalar x, long double ref)
+{
+    if(std::isnan(x) || std::isnan(ref)) return std::isnan(x) && std::isnan(ref) ? 0 : HUGE_VALL;
+    // beyond the range of Scalar, the result must be the rounded reference, e.g. an infinity
+    const Scalar rounded = Scalar(ref);
+    if(std::isinf(rounded) || std::isinf(x)) return x == rounded ? 0 : HUGE_VALL;
+
+    const int digits = std::numeric_limits<Scalar>::digits;
+    const long double magnitude = std::fabs(ref);
+    const long double ulp = magnitude < std::numeric_limits<Scalar>::min()
+                          ? std::ldexp(1.0L, std::numeric_limits<Scalar>::min_exponent - digits)
+                          : std::ldexp(1.0L, std::ilogb(magnitude) - (digits - 1));
+    return std::fabs((long double)x - ref) / ulp;
+}
+
+/** Checks \a xpr(x), computed by the functor \a Op, is within \a bound ULP of \a ref(x) when \a Op is
+  * vectorized, and within CHECK_LIBM_ULP when it calls the C library */
+template<typename Op, typename Scalar, typename Xpr, typename Ref>
+static void check_ulp(const char* name, const Array<Scalar>& x, Xpr xpr, Ref ref, double bound)
+{
+#ifdef NC_VECTORIZE
+    const bool vectorized = internal::packet_traits<Scalar>::Vectorizable && internal::functor_traits<Op>::PacketAccess;
+#else
+    const bool vectorized = false;
+#endif
+    if(!vectorized) bound = numext::maxi(bound, CHECK_LIBM_ULP);
+
+    const Array<Scalar> y = xpr(x);
+    long double worst = 0;
+    Index at = 0;
+    for(Index i=0; i<x.size(); ++i)
+    {
+        const long double e = ulp_error(y.data()[i], ref((long double)x.data()[i]));
+        if(e > worst)
+        {
+            worst = e;
+            at = i;
+        }
+    }
+    if(worst > bound)
+    {
+        std::printf("  %s(%.9g) of %s is %.3Lf ULP off, above %g\n", name, double(x.data()[at]),
+                    sizeof(Scalar) == 4 ? "float" : "double", worst, bound);
+    }
+    CHECK(worst <= bound);
+}
+
+/** \returns every \a step-th float in [\a lo, \a hi], by bit pattern so that all the exponents are covered */
+static Array<float> float_range(float lo, float hi, unsigned step)
+{
+    std::vector<float> values;
+    for(unsigned long long bits=0; bits<(1ULL << 32); bits+=step)
+    {
+        const unsigned int u = static_cast<unsigned int>(bits);
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        if(f >= lo && f <= hi) values.push_back(f);
+    }
+    Array<float> a(Index(values.size()));
+    std::copy(values.begin(), values.end(), a.data());
+    return a;
+}
+
+/** \returns \a n random doubles in [\a lo, \a hi], half of them uniform, half of them of uniform exponent */
+static Array<double> double_range(double lo, double hi, Index n, unsigned seed)
+{
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    const double largest = numext::maxi(std::fabs(lo), std::fabs(hi));
+    Array<double> a(n);
+    for(Index i=0; i<n; ++i)
+    {
+        const double u = uniform(gen);
+        double v = lo + (hi - lo) * u;
+        if(i % 2 == 0)
+        {
+            const double t = std::exp(std::log(1e-300) + (std::log(largest) - std::log(1e-300)) * u);
+            const double s = (gen() & 1) ? t : -t;
+            if(s >= lo && s <= hi) v = s;
+        }
+        a.data()[i] = v;
+    }
+    return a;
+}
+
+/** Checks x.FUNC() of the Scalar array \a x is within \a BOUND ULP of \a REF, an expression of the long double v */
+#define CHECK_ULP(FUNC, Scalar, x, REF, BOUND) \
+    check_ulp<internal::scalar_##FUNC##_op<Scalar> >(#FUNC, x,                                          \
+                                                     [](const Array<Scalar>& a) { return Array<Scalar>(a.FUNC()); }, \
+                                                     [](long double v) { return REF; }, BOUND)
+
+static void check_float_functions()
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const Array<float> all = float_range(-inf, inf, 4099);
+    const Array<float> positive = float_range(0, inf, 4099);
+    const Array<float> trig = float_range(-16777216.f, 16777216.f, 4099);     // |x| < 2^24
+    const Array<float> moderate = float_range(-20, 20, 4099);
+
+    CHECK_ULP(sqrt, float, positive, std::sqrt(v), 0.5);
+    CHECK_ULP(rsqrt, float, positive, 1 / std::sqrt(v), 1.5);
+    CHECK_ULP(exp, float, all, std::exp(v), 1.1);
+    CHECK_ULP(log, float, positive, std::log(v), 0.85);
+    CHECK_ULP(log1p, float, all, std::log1p(v), 2.5);
+    CHECK_ULP(expm1, float, all, std::expm1(v), 2.5);
+    CHECK_ULP(sin, float, trig, std::sin(v), 1.6);
+    CHECK_ULP(cos, float, trig, std::cos(v), 1.6);
+    CHECK_ULP(tanh, float, all, std::tanh(v), 1.35);
+    CHECK_ULP(sigmoid, float, all, 1 / (1 + std::exp(-v)), 2.8);
+    CHECK_ULP(erf, float, all, std::erf(v), 1.4);
+    CHECK_ULP(floor, float, all, std::floor(v), 0);
+    CHECK_ULP(round, float, all, std::round(v), 0);
+
+    typedef internal::scalar_pow_op<float> pow_op;
+    check_ulp<pow_op>("pow", positive, [](const Array<float>& a) { return Array<float>(a.pow(2.5f)); },
+                      [](long double v) { return std::pow(v, 2.5L); }, 0.51);
+    check_ulp<pow_op>("pow", moderate, [](const Array<float>& a) { return Array<float>(a.pow(-7.f)); },
+                      [](long double v) { return std::pow(v, -7.0L); }, 0.51);
+    check_ulp<pow_op>("pow", positive, [](const Array<float>& a) { return Array<float>(a.pow(1.f / 3)); },
+                      [](long double v) { return std::pow(v, (long double)(1.f / 3)); }, 0.51);
+}
+
+static void check_double_functions()
+{
+    const Index n = 200000;
+    const Array<double> wide = double_range(-800, 800, n, 1);
+    const Array<double> positive = double_range(0, 1e300, n, 2).abs();
+    const Array<double> trig = double_range(-1e6, 1e6, n, 3);
+    const Array<double> moderate = double_range(-30, 30, n, 4);
+    const Array<double> logs = double_range(-0.9, 30, n, 5);
+
+    CHECK_ULP(sqrt, double, positive, std::sqrt(v), 0.5);
+    CHECK_ULP(rsqrt, double, positive, 1 / std::sqrt(v), 1.5);
+    CHECK_ULP(exp, double, wide, std::exp(v), 1.8);
+    CHECK_ULP(log, double, positive, std::log(v), 0.95);
+    CHECK_ULP(log1p, double, logs, std::log1p(v), 2.5);
+    CHECK_ULP(expm1, double, wide, std::expm1(v), 2.9);
+    CHECK_ULP(sin, double, trig, std::sin(v), 1.6);
+    CHECK_ULP(cos, double, trig, std::cos(v), 1.6);
+    CHECK_ULP(tanh, double, moderate, std::tanh(v), 1.45);
+    CHECK_ULP(sigmoid, double, wide, 1 / (1 + std::exp(-v)), 3);
+    CHECK_ULP(erf, double, moderate, std::erf(v), 1.5);
+}
+
+/** Checks the special values, 0, infinities, NaN, overflow and underflow, follow the C library */
+static void check_special_values()
+{
+    const float inf = std::numeric_limits<float>::infinity(), nan = std::numeric_limits<float>::quiet_NaN();
+    const float values[] = { 0.f, -0.f, 1.f, -1.f, inf, -inf, nan, 1e-45f, -1e-45f, 1e-40f, 88.7f, 88.73f, -103.f,
+                             -104.5f, 0.5f, -2.5f, 8388609.f, 1e38f };
+    const Index n = Index(sizeof(values) / sizeof(values[0]));
+    // longer than a packet, so that the values are computed by the vectorized paths
+    Array<float> x(4 * n);
+    for(Index i=0; i<4*n; ++i) x.data()[i] = values[i % n];
+
+    const auto same = [](float a, float b) {
+        return (std::isnan(a) && std::isnan(b)) || (a == b && std::signbit(a) == std::signbit(b))
+            || std::fabs(a - b) <= 4e-7f * std::fabs(b);
+    };
+    const Array<float> e = x.exp(), l = x.log(), t = x.tanh(), s = x.sin(), r = x.erf(), q = x.sqrt();
+    for(Index i=0; i<4*n; ++i)
+    {
+        const float v = x.data()[i];
+        CHECK(same(e.data()[i], std::exp(v)));
+        CHECK(same(l.data()[i], std::log(v)));
+        CHECK(same(t.data()[i], std::tanh(v)));
+        CHECK(same(s.data()[i], std::sin(v)));
+        CHECK(same(r.data()[i], std::erf(v)));
+        CHECK(same(q.data()[i], std::sqrt(v)));
+    }
+}
+
+void check_math()
+{
+    // the functions do not depend on the number of threads
+    if(check_threads() > 1) return;
+    check_float_functions();
+    check_double_functions();
+    check_special_values();
+}
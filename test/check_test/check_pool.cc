@@ -0,0 +1,62 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+#ifdef NC_USE_BUFFER_POOL
+
+/** Frees an array and allocates another one of the same size class, and checks the counters of the pool. The
+  * buffers cached by the worker threads are left alone: only the calling thread allocates here. */
+static void check_recycling()
+{
+    // 4096 floats fill a size class exactly, 4000 floats are rounded up to it
+    const std::size_t bytes = 4096 * sizeof(float);
+    CHECK(internal::buffer_pool::class_bytes(internal::buffer_pool::size_class(4000 * sizeof(float))) == bytes);
+
+    BufferPool::release();
+    BufferPool::reset_stats();
+    const BufferPoolStats before = BufferPool::stats();
+    CHECK(before.allocations == 0 && before.hits == 0 && before.hitRate() == 0.);
+
+    {
+        Array<float> a(4096);
+        const BufferPoolStats s = BufferPool::stats();
+        CHECK(s.allocations == 1 && s.hits == 0);
+        CHECK(s.liveBytes == before.liveBytes + bytes);
+        CHECK(s.residentBytes == before.residentBytes);
+    }
+    BufferPoolStats s = BufferPool::stats();
+    CHECK(s.liveBytes == before.liveBytes);
+    CHECK(s.residentBytes == before.residentBytes + bytes);
+
+    {
+        Array<float> b(4000);
+        s = BufferPool::stats();
+        CHECK(s.allocations == 2 && s.hits == 1 && s.hitRate() == 0.5);
+        CHECK(s.liveBytes == before.liveBytes + bytes);
+        CHECK(s.residentBytes == before.residentBytes);
+    }
+
+    BufferPool::release();
+    s = BufferPool::stats();
+    CHECK(s.liveBytes == before.liveBytes);
+    CHECK(s.residentBytes == before.residentBytes);
+}
+
+void check_pool()
+{
+    check_recycling();
+}
+
+#else
+
+void check_pool() {}
+
+#endif
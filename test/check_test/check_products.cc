@@ -0,0 +1,164 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+/** Checks matmul() on matrices of \a rows x \a depth and \a depth x \a cols, read as they are, transposed and
+  * through strided slices. The coefficients are small integers, so that the products are exact. */
+template<typename Scalar>
+static void check_gemm(Index rows, Index cols, Index depth, unsigned seed)
+{
+    Array<Scalar> a(rows, depth), b(depth, cols);
+    fill_random(a.view(), seed);
+    fill_random(b.view(), seed + 1);
+    const Array<Scalar> expected = naive_matmul<Scalar>(a.view(), b.view());
+    CHECK(same_values(matmul(a, b), expected));
+    CHECK(same_values(a.matmul(b), expected));
+
+    // the same matrices stored transposed, and read through transposed views
+    const Array<Scalar> at = a.transpose(), bt = b.transpose();
+    CHECK(same_values(matmul(at.transpose(), bt.transpose()), expected));
+    CHECK(same_values(matmul(at.transpose(), b), expected));
+    CHECK(same_values(matmul(bt, at), naive_matmul<Scalar>(bt.view(), at.view())));
+
+    // every other row and column of larger matrices, the columns of the rhs backward
+    Array<Scalar> big(2 * rows + 1, 2 * depth + 1), bigRhs(2 * depth + 1, 3 * cols + 2);
+    fill_random(big.view(), seed + 2);
+    fill_random(bigRhs.view(), seed + 3);
+    ArrayView<const Scalar> sa = big.slice({{1, Slice::None, 2}, {1, Slice::None, 2}});
+    ArrayView<const Scalar> sb = bigRhs.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -3}});
+    CHECK(same_values(matmul(sa, sb), naive_matmul<Scalar>(sa, sb)));
+
+    // an expression operand is evaluated first
+    const Array<Scalar> shifted = a * Scalar(2) - Scalar(1);
+    CHECK(same_values(matmul(a * Scalar(2) - Scalar(1), b), naive_matmul<Scalar>(shifted.view(), b.view())));
+}
+
+template<typename Scalar>
+static void check_gemm_sizes()
+{
+    // around the register blocks, the packed panels and the cache blocks, and empty products
+    const Index sizes[][3] = {
+        {1, 1, 1}, {2, 3, 4}, {5, 7, 3}, {6, 16, 8}, {13, 33, 129}, {17, 1, 40}, {1, 50, 60}, {31, 29, 1},
+        {63, 65, 257}, {100, 100, 100}, {129, 67, 300}, {37, 520, 1100}, {300, 20, 700},
+        {0, 4, 2}, {5, 0, 3}, {4, 5, 0}
+    };
+    unsigned seed = 200;
+    for(const auto& s : sizes)
+    {
+        check_gemm<Scalar>(s[0], s[1], s[2], seed);
+        seed += 4;
+    }
+}
+
+/** Checks a batched matmul() of operands of shapes \a lhsShape and \a rhsShape, whose batch dimensions are
+  * broadcast, against naive products of each pair of matrices */
+template<typename Scalar>
+static void check_batched(const Shape& lhsShape, const Shape& rhsShape, unsigned seed)
+{
+    Array<Scalar> lhs(lhsShape), rhs(rhsShape);
+    fill_random(lhs.view(), seed);
+    fill_random(rhs.view(), seed + 1);
+    const Array<Scalar> c = matmul(lhs, rhs);
+
+    // the batch shape of the result, dimensions aligned on the right
+    const Index lhsBatch = lhs.dims() - 2, rhsBatch = rhs.dims() - 2;
+    const Index batchDims = numext::maxi(lhsBatch, rhsBatch);
+    Index extents[MAX_ARRAY_DIMENSIONS];
+    for(Index d=0; d<batchDims; ++d)
+    {
+        const Index l = d - (batchDims - lhsBatch), r = d - (batchDims - rhsBatch);
+        extents[d] = numext::maxi(l >= 0 ? lhsShape[l] : 1, r >= 0 ? rhsShape[r] : 1);
+    }
+    const Index rows = lhsShape[lhsBatch], cols = rhsShape[rhsBatch + 1];
+    extents[batchDims] = rows;
+    extents[batchDims + 1] = cols;
+    CHECK(c.shape() == Shape(extents, batchDims + 2));
+    if(c.shape() != Shape(extents, batchDims + 2)) return;
+
+    bool same = true;
+    for_each_index(Shape(extents, batchDims), [&](const Index* batch) {
+        // the matrix of an operand for this batch index, an extent of 1 being broadcast
+        Index lhsOffset = 0, rhsOffset = 0, resultOffset = 0;
+        for(Index d=0; d<batchDims; ++d)
+        {
+            const Index l = d - (batchDims - lhsBatch), r = d - (batchDims - rhsBatch);
+            if(l >= 0 && lhsShape[l] != 1) lhsOffset += batch[d] * lhs.strides()[l];
+            if(r >= 0 && rhsShape[r] != 1) rhsOffset += batch[d] * rhs.strides()[r];
+            resultOffset += batch[d] * c.strides()[d];
+        }
+        const ArrayView<const Scalar> l(lhs.data() + lhsOffset, Shape(rows, lhsShape[lhsBatch + 1]));
+        const ArrayView<const Scalar> r(rhs.data() + rhsOffset, Shape(rhsShape[rhsBatch], cols));
+        const ArrayView<const Scalar> result(c.data() + resultOffset, Shape(rows, cols));
+        same = same && same_coeffs(result, naive_matmul<Scalar>(l, r).view());
+    });
+    CHECK(same);
+}
+
+static void check_batches()
+{
+    check_batched<float>(Shape(7, 3, 5), Shape(7, 5, 4), 300);
+    check_batched<float>(Shape(100, 4, 4), Shape(4, 4), 301);          // a matrix multiplied by each of a batch
+    check_batched<float>(Shape(3, 3), Shape(9, 3, 2), 302);
+    check_batched<float>(Shape(2, 1, 5, 3), Shape(4, 3, 6), 303);       // batch dimensions broadcast to (2, 4)
+    check_batched<double>(Shape(3, 1, 17, 9), Shape(1, 5, 9, 33), 304);
+    check_batched<double>(Shape(2, 70, 65), Shape(2, 65, 80), 305);     // large enough for the blocked kernel
+    check_batched<int>(Shape(6, 2, 3), Shape(6, 3, 2), 306);
+
+    // a transposed batch is read in place
+    Array<float> s(4, 6, 5), t(4, 6, 3);
+    fill_random(s.view(), 307);
+    fill_random(t.view(), 308);
+    const Array<float> st = matmul(s.transpose({0, 2, 1}), t);
+    CHECK(st.shape() == Shape(4, 5, 3));
+    for(Index n=0; n<4; ++n)
+    {
+        const ArrayView<const float> sn = s.slice({{n, n + 1}}).squeeze(0), tn = t.slice({{n, n + 1}}).squeeze(0);
+        CHECK(same_coeffs(st.slice({{n, n + 1}}).squeeze(0), naive_matmul<float>(sn.transpose(), tn).view()));
+    }
+}
+
+static void check_vectors()
+{
+    // a 1-dimension operand is a row vector on the left, a column vector on the right
+    const Index sizes[] = { 1, 3, 17, 64, 259 };
+    unsigned seed = 400;
+    for(Index n : sizes)
+    {
+        Array<float> a(n + 2, n), x(n), y(n + 2);
+        fill_random(a.view(), seed++);
+        fill_random(x.view(), seed++);
+        fill_random(y.view(), seed++);
+
+        const Array<float> ax = matmul(a, x), ya = matmul(y, a), xx = matmul(x, x);
+        CHECK(ax.shape() == Shape(n + 2) && ya.shape() == Shape(n) && xx.dims() == 0);
+        const Array<float> expectedAx = naive_matmul<float>(a.view(), x.reshape(Shape(n, 1)));
+        const Array<float> expectedYa = naive_matmul<float>(y.reshape(Shape(1, n + 2)), a.view());
+        CHECK(same_values(ax, expectedAx.reshape(Shape(n + 2))));
+        CHECK(same_values(ya, expectedYa.reshape(Shape(n))));
+        double xdotx = 0;
+        for(Index i=0; i<n; ++i) xdotx += double(x.data()[i]) * x.data()[i];
+        CHECK(xx.data()[0] == float(xdotx));
+    }
+
+    // a fixed-size matrix
+    FixedArray<float, 4, 4> f;
+    fill_random(f.view(), 410);
+    CHECK(same_values(matmul(f, f), naive_matmul<float>(f.view(), f.view())));
+}
+
+void check_products()
+{
+    check_gemm_sizes<float>();
+    check_gemm_sizes<double>();
+    check_gemm<int>(37, 29, 41, 500);
+    check_batches();
+    check_vectors();
+}
@@ -0,0 +1,251 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include <algorithm>
+#include "check.h"
+
+/** \brief The naive reductions of a view along some axes, accumulated in long double
+  *
+  * Each coefficient of the view is added into the coefficient of the result it is reduced into, whose
+  * multi-index is the one of the coefficient without the reduced axes. */
+struct naive_redux
+{
+    Shape shape;
+    std::vector<long double> sum, prod, min, max, sumSquares;
+    Index count;
+
+    template<typename Scalar>
+    naive_redux(const ArrayView<Scalar>& v, const std::vector<bool>& reduced)
+    {
+        Index extents[MAX_ARRAY_DIMENSIONS];
+        Index dims = 0;
+        count = 1;
+        for(Index d=0; d<v.dims(); ++d)
+        {
+            if(reduced[std::size_t(d)]) count *= v.shape()[d];
+            else extents[dims++] = v.shape()[d];
+        }
+        shape = Shape(extents, dims);
+        const std::size_t size = std::size_t(shape.size());
+        sum.assign(size, 0);
+        prod.assign(size, 1);
+        min.assign(size, HUGE_VALL);
+        max.assign(size, -HUGE_VALL);
+        sumSquares.assign(size, 0);
+        for_each_index(v.shape(), [&](const Index* index) {
+            std::size_t r = 0;
+            for(Index d=0; d<v.dims(); ++d)
+                if(!reduced[std::size_t(d)]) r = r * std::size_t(v.shape()[d]) + std::size_t(index[d]);
+            const long double x = raw_at(v, index);
+            sum[r] += x;
+            prod[r] *= x;
+            min[r] = std::min(min[r], x);
+            max[r] = std::max(max[r], x);
+            sumSquares[r] += x * x;
+        });
+    }
+
+    long double mean(std::size_t r) const { return sum[r] / count; }
+
+    long double var(std::size_t r) const
+    {
+        const long double m = mean(r);
+        return numext::maxi(sumSquares[r] / count - m * m, 0.0L);
+    }
+};
+
+template<typename Scalar, typename Values>
+static bool close_to(const ArrayView<const Scalar>& result, const Values& expected, double tol)
+{
+    bool close = true;
+    std::size_t r = 0;
+    for_each_index(result.shape(), [&](const Index* index) {
+        const long double x = raw_at(result, index), y = expected(r++);
+        if(close && !(std::fabs(double(x - y)) <= tol * (1 + std::fabs(double(y)))))
+        {
+            std::printf("  reduction %lu: %.17g vs %.17g\n", (unsigned long)(r - 1), double(x), double(y));
+            close = false;
+        }
+    });
+    return close;
+}
+
+/** Checks the reductions of \a v along \a axes against naive_redux, \a tol being the relative error allowed
+  * to the sums and the variances, which numc computes pairwise and in another order */
+template<typename Scalar>
+static void check_partial(const ArrayView<const Scalar>& v, std::initializer_list<Index> axes, double tol)
+{
+    std::vector<bool> reduced(std::size_t(v.dims()), false);
+    for(Index axis : axes) reduced[std::size_t(axis < 0 ? axis + v.dims() : axis)] = true;
+    const naive_redux ref(v, reduced);
+
+    const Array<Scalar> sum = v.sum(axes), prod = v.prod(axes), min = v.min(axes), max = v.max(axes), mean = v.mean(axes);
+    const Array<Scalar> var = v.var(axes), norm = v.norm(axes);
+    CHECK(sum.shape() == ref.shape && var.shape() == ref.shape && norm.shape() == ref.shape);
+    if(sum.shape() != ref.shape) return;
+    CHECK(close_to(sum.view(), [&](std::size_t r) { return ref.sum[r]; }, tol));
+    // a product of more than 8 coefficients of at most 4 in magnitude may be rounded, or overflow
+    if(ref.count <= 8) CHECK(close_to(prod.view(), [&](std::size_t r) { return ref.prod[r]; }, 0));
+    CHECK(close_to(min.view(), [&](std::size_t r) { return ref.min[r]; }, 0));
+    CHECK(close_to(max.view(), [&](std::size_t r) { return ref.max[r]; }, 0));
+    CHECK(close_to(mean.view(), [&](std::size_t r) { return ref.mean(r); }, tol));
+    CHECK(close_to(var.view(), [&](std::size_t r) { return ref.var(r); }, 100 * tol));
+    CHECK(close_to(norm.view(), [&](std::size_t r) { return std::sqrt(ref.sumSquares[r]); }, tol));
+}
+
+template<typename Scalar>
+static void check_full(const ArrayView<const Scalar>& v, double tol)
+{
+    const naive_redux ref(v, std::vector<bool>(std::size_t(v.dims()), true));
+    CHECK(std::fabs(double(v.sum() - ref.sum[0])) <= tol * (1 + std::fabs(double(ref.sum[0]))));
+    CHECK(v.min() == ref.min[0] && v.max() == ref.max[0]);
+    CHECK(std::fabs(double(v.mean() - ref.mean(0))) <= tol * (1 + std::fabs(double(ref.mean(0)))));
+    CHECK(std::fabs(double(v.var() - ref.var(0))) <= 100 * tol * (1 + double(ref.var(0))));
+    CHECK(std::fabs(double(v.norm() - std::sqrt(ref.sumSquares[0]))) <= tol * (1 + double(std::sqrt(ref.sumSquares[0]))));
+
+    // the first extremum in row-major order
+    const std::vector<Scalar> values = raw_values(v);
+    Index argmin = 0, argmax = 0;
+    for(std::size_t i=1; i<values.size(); ++i)
+    {
+        if(values[i] < values[std::size_t(argmin)]) argmin = Index(i);
+        if(values[i] > values[std::size_t(argmax)]) argmax = Index(i);
+    }
+    CHECK(v.argmin() == argmin && v.argmax() == argmax);
+}
+
+/** Checks argmin(axis) and argmax(axis) of the 2-dimension view \a v against a naive scan */
+template<typename Scalar>
+static void check_arg_axis(const ArrayView<const Scalar>& v)
+{
+    const Index rows = v.shape()[0], cols = v.shape()[1];
+    const Array<Index> minRows = v.argmin(0), maxRows = v.argmax(0), minCols = v.argmin(1), maxCols = v.argmax(-1);
+    CHECK(minRows.shape() == Shape(cols) && minCols.shape() == Shape(rows));
+    bool same = true;
+    for(Index j=0; j<cols; ++j)
+    {
+        Index lo = 0, hi = 0;
+        for(Index i=1; i<rows; ++i)
+        {
+            if(raw_at(v, i, j) < raw_at(v, lo, j)) lo = i;
+            if(raw_at(v, i, j) > raw_at(v, hi, j)) hi = i;
+        }
+        same = same && minRows.data()[j] == lo && maxRows.data()[j] == hi;
+    }
+    for(Index i=0; i<rows; ++i)
+    {
+        Index lo = 0, hi = 0;
+        for(Index j=1; j<cols; ++j)
+        {
+            if(raw_at(v, i, j) < raw_at(v, i, lo)) lo = j;
+            if(raw_at(v, i, j) > raw_at(v, i, hi)) hi = j;
+        }
+        same = same && minCols.data()[i] == lo && maxCols.data()[i] == hi;
+    }
+    CHECK(same);
+}
+
+template<typename Scalar>
+static void check_redux_type(double tol)
+{
+    const Shape shapes[] = { Shape(1), Shape(7), Shape(33), Shape(1001), Shape(3, 5), Shape(17, 31), Shape(5, 129),
+                             Shape(257, 3), Shape(3, 7, 11), Shape(2, 1, 67), Shape(301, 257) };
+    unsigned seed = 70;
+    for(const Shape& shape : shapes)
+    {
+        Array<Scalar> a(shape);
+        fill_random(a.view(), seed++);
+        check_full<Scalar>(a.view(), tol);
+        for(Index axis=-1; axis<a.dims(); ++axis)
+            check_partial<Scalar>(a.view(), {axis}, tol);
+        if(a.dims() == 3)
+        {
+            check_partial<Scalar>(a.view(), {0, 2}, tol);
+            check_partial<Scalar>(a.view(), {0, 1}, tol);
+            check_partial<Scalar>(a.view(), {0, 1, 2}, tol);
+        }
+        if(a.dims() == 2)
+        {
+            check_arg_axis<Scalar>(a.view());
+            check_partial<Scalar>(a.view(), {0, 1}, tol);
+            // strided and transposed views, reduced in place
+            check_full<Scalar>(a.transpose(), tol);
+            check_partial<Scalar>(a.transpose(), {0}, tol);
+            check_partial<Scalar>(a.transpose(), {1}, tol);
+            check_arg_axis<Scalar>(a.transpose());
+            ArrayView<const Scalar> strided = a.slice({{Slice::None, Slice::None, 2}, {Slice::None, Slice::None, -3}});
+            if(strided.size() == 0) continue;
+            check_full<Scalar>(strided, tol);
+            check_partial<Scalar>(strided, {0}, tol);
+            check_partial<Scalar>(strided, {-1}, tol);
+            check_arg_axis<Scalar>(strided);
+        }
+    }
+
+    // the products of few small coefficients are exact, those of many would overflow
+    Array<Scalar> p(9, 7);
+    fill_random(p.view(), 99, 2);
+    check_partial<Scalar>(p.view(), {1}, tol);
+    check_partial<Scalar>(p.transpose(), {1}, tol);
+}
+
+static void check_complex()
+{
+    typedef std::complex<double> Complex;
+    Array<Complex> z(5, 7);
+    for(Index i=0; i<z.size(); ++i) z.data()[i] = Complex(double(i % 5) - 2, double(i % 3) - 1);
+
+    long double squares = 0;
+    Complex sum = 0;
+    for(Index i=0; i<z.size(); ++i)
+    {
+        squares += std::norm(z.data()[i]);
+        sum += z.data()[i];
+    }
+    const Complex mean = sum / double(z.size());
+    long double var = 0;
+    for(Index i=0; i<z.size(); ++i) var += std::norm(z.data()[i] - mean);
+    var /= z.size();
+
+    // the norm and the variance of complex coefficients are real, from their squared magnitudes
+    const double norm = z.norm(), zvar = z.var();
+    CHECK(std::fabs(norm - std::sqrt(double(squares))) <= 1e-12 * norm);
+    CHECK(std::fabs(zvar - double(var)) <= 1e-12 * zvar);
+    const Array<double> rowNorms = z.norm({1});
+    for(Index i=0; i<5; ++i)
+    {
+        double s = 0;
+        for(Index j=0; j<7; ++j) s += std::norm(z.data()[i * 7 + j]);
+        CHECK(std::fabs(rowNorms.data()[i] - std::sqrt(s)) <= 1e-12 * std::sqrt(s));
+    }
+    const Array<double> abs2 = z.abs2();
+    for(Index i=0; i<z.size(); ++i) CHECK(abs2.data()[i] == std::norm(z.data()[i]));
+}
+
+void check_redux()
+{
+    check_redux_type<float>(1e-6);
+    check_redux_type<double>(1e-13);
+    check_complex();
+
+    // integers are reduced exactly
+    Array<int> k(37, 13);
+    fill_random(k.view(), 91, 1000);
+    long long sum = 0;
+    for(Index i=0; i<k.size(); ++i) sum += k.data()[i];
+    CHECK(k.sum() == sum);
+    const Array<int> cols = k.sum({0});
+    for(Index j=0; j<13; ++j)
+    {
+        int s = 0;
+        for(Index i=0; i<37; ++i) s += k.data()[i * 13 + j];
+        CHECK(cols.data()[j] == s);
+    }
+}
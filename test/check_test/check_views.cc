@@ -0,0 +1,166 @@
+// This file is part of numc, a lightweight C++ n-dimension array library
+// for linear algebra.
+//
+// Copyright (C) 2018 <Yi Gu 390512308@qq.com>
+//
+// This Source Code Form is subject to the terms of the Mozilla
+// Public License v. 2.0. If a copy of the MPL was not distributed
+// with this file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+
+#include "check.h"
+
+/** \returns the indices start:stop:step of a dimension of \a extent, the way numpy resolves them */
+static std::vector<Index> slice_indices(const Slice& s, Index extent)
+{
+    std::vector<Index> indices;
+    const bool forward = s.step > 0;
+    Index start = s.start == Slice::None ? (forward ? 0 : extent - 1) : s.start < 0 ? s.start + extent : s.start;
+    Index stop = s.stop == Slice::None ? (forward ? extent : -1) : s.stop < 0 ? s.stop + extent : s.stop;
+    if(forward)
+    {
+        start = numext::maxi(start, Index(0));
+        stop = numext::mini(stop, extent);
+        for(Index i=start; i<stop; i+=s.step) indices.push_back(i);
+    }
+    else
+    {
+        start = numext::mini(start, extent - 1);
+        stop = numext::maxi(stop, Index(-1));
+        for(Index i=start; i>stop; i+=s.step) indices.push_back(i);
+    }
+    return indices;
+}
+
+static void check_slice(const Array<float>& a, const Slice& s0, const Slice& s1)
+{
+    const std::vector<Index> rows = slice_indices(s0, a.shape()[0]), cols = slice_indices(s1, a.shape()[1]);
+    ArrayView<const float> v = a.slice({s0, s1});
+    CHECK(v.shape() == Shape(Index(rows.size()), Index(cols.size())));
+    if(v.shape() != Shape(Index(rows.size()), Index(cols.size()))) return;
+
+    Array<float> expected(v.shape()), expectedExp(v.shape());
+    for(std::size_t i=0; i<rows.size(); ++i)
+        for(std::size_t j=0; j<cols.size(); ++j)
+        {
+            const float x = a.data()[rows[i] * a.shape()[1] + cols[j]];
+            expected.data()[i * cols.size() + j] = x;
+            expectedExp.data()[i * cols.size() + j] = x * 2.f + 1.f;
+        }
+    CHECK(same_values(Array<float>(v), expected));
+    CHECK(same_values(Array<float>(v * 2.f + 1.f), expectedExp));
+    CHECK(same_values(Array<float>(v.transpose()), Array<float>(expected.transpose())));
+}
+
+static void check_slices()
+{
+    Array<float> a(37, 29);
+    fill_random(a.view(), 7, 100);
+    const Slice slices[] = {
+        Slice(), Slice(1, 36), Slice(3, Slice::None, 2), Slice(Slice::None, Slice::None, -1),
+        Slice(-5, Slice::None), Slice(30, 2, -3), Slice(5, 6), Slice(10, 10), Slice(-100, 100, 7)
+    };
+    for(const Slice& s0 : slices)
+        for(const Slice& s1 : slices)
+            check_slice(a, s0, s1);
+
+    // writes through a strided view land in the viewed array, and nowhere else
+    Array<float> b(11, 13);
+    b = b.constant(0.f);
+    ArrayView<float> odd = b.slice({{1, Slice::None, 2}, {Slice::None, Slice::None, -3}});
+    odd = odd + 1.f;
+    for(Index i=0; i<11; ++i)
+        for(Index j=0; j<13; ++j)
+            CHECK(b.data()[i * 13 + j] == ((i % 2 == 1 && (12 - j) % 3 == 0) ? 1.f : 0.f));
+}
+
+static void check_transposes()
+{
+    const Shape shapes[] = { Shape(1, 1), Shape(3, 7), Shape(17, 33), Shape(128, 3), Shape(301, 257) };
+    unsigned seed = 20;
+    for(const Shape& shape : shapes)
+    {
+        Array<double> a(shape);
+        fill_random(a.view(), seed++);
+        const Index rows = shape[0], cols = shape[1];
+        Array<double> t = a.transpose();
+        Array<double> u = a.transpose() * 2.0 - a.transpose().abs();
+        CHECK(t.shape() == Shape(cols, rows) && u.shape() == Shape(cols, rows));
+        bool same = true;
+        for(Index i=0; i<rows; ++i)
+            for(Index j=0; j<cols; ++j)
+            {
+                const double x = a.data()[i * cols + j];
+                same = same && t.data()[j * rows + i] == x && u.data()[j * rows + i] == x * 2.0 - std::fabs(x);
+            }
+        CHECK(same);
+    }
+
+    // a permutation of the dimensions of a 3-dimension array
+    Array<float> a(5, 7, 3);
+    fill_random(a.view(), 30);
+    Array<float> p = a.transpose({2, 0, 1});
+    CHECK(p.shape() == Shape(3, 5, 7));
+    bool same = true;
+    for(Index i=0; i<5; ++i)
+        for(Index j=0; j<7; ++j)
+            for(Index k=0; k<3; ++k)
+                same = same && p.data()[(k * 5 + i) * 7 + j] == a.data()[(i * 7 + j) * 3 + k];
+    CHECK(same);
+}
+
+static void check_reshapes()
+{
+    Array<float> a(6, 35);
+    fill_random(a.view(), 40);
+    std::vector<float> values = raw_values(a.view());
+
+    ArrayView<float> r = a.reshape(Shape(3, 2, 5, 7));
+    CHECK(r.shape() == Shape(3, 2, 5, 7) && r.data() == a.data());
+    CHECK(raw_values(r) == values);
+    CHECK(raw_values(a.reshape(Shape(210))) == values);
+
+    // a slice of whole rows is still contiguous, and a reshape of a transpose may split its dimensions
+    ArrayView<float> rows = a.slice({{2, 5}});
+    CHECK(raw_values(rows.reshape(Shape(15, 7))) == raw_values(rows));
+    ArrayView<float> split = a.transpose().reshape(Shape(5, 7, 6));
+    std::vector<float> expected;
+    for(Index j=0; j<35; ++j)
+        for(Index i=0; i<6; ++i)
+            expected.push_back(a.data()[i * 35 + j]);
+    CHECK(raw_values(split) == expected);
+
+    ArrayView<float> e = a.expand_dims(1);
+    CHECK(e.shape() == Shape(6, 1, 35) && raw_values(e) == values);
+    CHECK(e.squeeze(1).shape() == Shape(6, 35) && raw_values(e.squeeze()) == values);
+
+    // broadcasting against expanded views
+    Array<float> x(9), y(4);
+    fill_random(x.view(), 41);
+    fill_random(y.view(), 42);
+    Array<float> outer = x.expand_dims(1) * y.expand_dims(0);
+    CHECK(outer.shape() == Shape(9, 4));
+    for(Index i=0; i<9; ++i)
+        for(Index j=0; j<4; ++j)
+            CHECK(outer.data()[i * 4 + j] == x.data()[i] * y.data()[j]);
+}
+
+static void check_maps()
+{
+    std::vector<double> buffer(1 + 7 * 9);
+    Map<Array<double> > m(buffer.data() + 1, Shape(7, 9));     // not aligned
+    fill_random(m.view(), 50);
+    Array<double> twice = m * 2.0;
+    for(Index i=0; i<63; ++i) CHECK(twice.data()[i] == 2.0 * buffer[std::size_t(i) + 1]);
+    m = m + 1.0;
+    for(Index i=0; i<63; ++i) CHECK(buffer[std::size_t(i) + 1] == twice.data()[i] * 0.5 + 1.0);
+    CHECK(same_values(Array<double>(m.transpose()), Array<double>(twice.transpose() * 0.5 + 1.0)));
+}
+
+void check_views()
+{
+    check_slices();
+    check_transposes();
+    check_reshapes();
+    check_maps();
+}
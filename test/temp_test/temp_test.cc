@@ -1,7 +1,8 @@
 #include <stdio.h>
 #include <iostream>
-#include "numc.h"
 #include "../../eigen-git-mirror/Eigen/Eigen"
+#define NC_USE_EIGEN
+#include "numc.h"
 //#include "test.h"
 
 using namespace std;
@@ -21,6 +22,64 @@ int main()
 
     auto op2 = op + c;
 
+    Array<float> d = op2;
+    d = a * b - c;
+
+    ArrayView<float> row = a.slice({{0, 1}});
+    d = row + b.transpose().slice({{1, 2}});
+
+    Array<float> bias(2);
+    d = a * b + bias;
+
+    FixedArray<float, 4, 4> fa, fb, fc;
+    fc = fa * fb + fc;
+
+    {
+        ScopedNumThreads threads(2);
+        d = a * b + bias;
+    }
+
+    float total = (a * b).sum();
+    Array<float> rows = d.mean({-1});
+    Array<Index> best = d.argmax(0);
+    NC_UNUSED_VARIABLE(total);
+
+    Array<float> gram = matmul(d, d.transpose());
+    Array<float> batch(8, 2, 2);
+    Array<float> batchProd = matmul(batch, d);
+
+    d = 2.f * d + bias;
+    axpy(0.5f, a, b);
+    Array<float> ab2(2);
+    gemv(1.f, a, bias, 0.f, ab2);
+    float ab = dot(a, b);
+    NC_UNUSED_VARIABLE(ab);
+
+    Array<float> act = (d * 0.5f + bias).tanh() + d.sigmoid() - d.abs().pow(1.5f);
+    Array<float> gelu = d * ((d * 0.70710678f).erf() + 1.f) * 0.5f;
+
+    d = d.transpose() + gram;
+    d.noalias() = a * b + c;
+
+    {
+        ScratchScope scratch;
+        for(int i = 0; i < 4; ++i)
+            d = matmul(a * 0.5f, b).transpose() + c;
+    }
+
+    save_npy("temp_test_d.npy", d);
+    Array<float> mapped = load_npy<float>("temp_test_d.npy", true);
+    mapped = mapped * 2.f;
+
+    Map<const Array<float> > external(mapped.data() + 1, Shape(mapped.size() - 1));
+    Array<float> shifted = external + 1.f;
+
+    Eigen::MatrixXf eigenGram = to_eigen(d).transpose() * to_eigen(d);
+    Array<float> inverse(2, 2);
+    to_eigen(inverse) = to_eigen(gram).inverse();
+    ArrayView<float> eigenView = from_eigen(eigenGram);
+    d = eigenView + bias;
+
 
 
     return 0;